@@ -0,0 +1,83 @@
+#include "bench.hpp"
+#include "memory.hpp"
+#include "mutex.hpp"
+#include "shared_mutex.hpp"
+
+/* One writer repeatedly publishes a new configuration object while N readers take a snapshot of the current one and read from it, through
+ * atomic<shared_ptr> against a shared_ptr guarded by a shared_mutex. The figure is reader time per snapshot; the writer runs until every
+ * reader is done. */
+namespace {
+    constexpr std::size_t reads_per_thread = 500000;
+
+    struct config {
+        long values[8];
+    };
+
+    struct with_atomic {
+        std::atomic<std::shared_ptr<config>> current{std::make_shared<config>()};
+
+        std::shared_ptr<config> read() const {
+            return current.load(std::memory_order_acquire);
+        }
+
+        void write(std::shared_ptr<config> c) {
+            current.store(std::move(c), std::memory_order_release);
+        }
+    };
+
+    struct with_shared_mutex {
+        mutable std::shared_mutex mtx;
+        std::shared_ptr<config> current = std::make_shared<config>();
+
+        std::shared_ptr<config> read() const {
+            const std::shared_lock<std::shared_mutex> lock(mtx);
+            return current;
+        }
+
+        void write(std::shared_ptr<config> c) {
+            const std::unique_lock<std::shared_mutex> lock(mtx);
+            current.swap(c);
+        }
+    };
+
+    template<class Holder>
+    double run(std::size_t readers) {
+        Holder holder;
+        std::atomic<std::size_t> remaining(readers);
+        std::uint64_t reader_ns[64] = {};
+        auto f = [&](std::size_t i) {
+            if (i == readers) {
+                for (long version = 1; remaining.load(std::memory_order_relaxed) != 0; ++version) {
+                    std::shared_ptr<config> c = std::make_shared<config>();
+                    c->values[0] = version;
+                    holder.write(std::move(c));
+                }
+                return;
+            }
+            const std::uint64_t start = bench::now_ns();
+            long sum = 0;
+            for (std::size_t j = 0; j < reads_per_thread; ++j) {
+                sum += holder.read()->values[0];
+            }
+            bench::keep(sum);
+            reader_ns[i] = bench::now_ns() - start;
+            remaining.fetch_sub(1, std::memory_order_relaxed);
+        };
+        bench::run_threads(readers + 1, f);
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < readers; ++i) {
+            total += reader_ns[i];
+        }
+        return double(total) / double(readers * reads_per_thread);
+    }
+}
+
+int main() {
+    char label[64];
+    for (std::size_t readers : {1, 4, 16, 63}) {
+        std::snprintf(label, sizeof(label), "atomic<shared_ptr> 1 writer %zu readers", readers);
+        bench::report(label, readers * reads_per_thread, run<with_atomic>(readers));
+        std::snprintf(label, sizeof(label), "shared_mutex 1 writer %zu readers", readers);
+        bench::report(label, readers * reads_per_thread, run<with_shared_mutex>(readers));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "atomic.hpp"
+#include "cstddef.hpp"
+#include "cstdint.hpp"
+#include "cstdio.hpp"
+#include "ctime.hpp"
+
+#include "../support/rng.hpp"
+
+#include "pthread.h"
+#include "sched.h"
+
+/* Helpers shared by the benchmarks. Each benchmark is a standalone program that prints one line per measurement, in nanoseconds per operation,
+ * so that two runs (or a run against the host standard library) can be compared with diff. */
+namespace bench {
+    using support::rng;
+
+    // Keeps the optimizer from discarding a computed value.
+    template<class T>
+    inline void keep(T&& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Reads CLOCK_MONOTONIC directly, as src/chrono.cpp does for steady_clock.
+    inline std::uint64_t now_ns() {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return std::uint64_t(t.tv_sec) * 1000000000 + std::uint64_t(t.tv_nsec);
+    }
+
+    /* Runs f once and returns the elapsed time divided by ops, in nanoseconds. f is run once beforehand to warm up the caches and the allocator,
+     * unless warm_up is false (for callables that can only run once per setup). */
+    template<class F>
+    double ns_per(std::size_t ops, F&& f, bool warm_up = true) {
+        if (warm_up) {
+            f();
+        }
+        const std::uint64_t start = now_ns();
+        f();
+        return double(now_ns() - start) / double(ops == 0 ? 1 : ops);
+    }
+
+    inline void report(const char* name, std::size_t n, double ns) {
+        std::printf("%-48s n=%-10zu %10.2f ns/op\n", name, n, ns);
+    }
+
+    /* Runs f(i) for every i in [0, count) on its own thread and returns the wall-clock time, in nanoseconds, from the moment all threads have
+     * been created until the last one finishes. The threads are started through pthreads directly, as the resources under test do. */
+    template<class F>
+    std::uint64_t run_threads(std::size_t count, F& f) {
+        struct context {
+            F* f;
+            std::size_t index;
+            std::atomic<bool>* go;
+        };
+        static constexpr std::size_t max_threads = 256;
+        pthread_t threads[max_threads];
+        context contexts[max_threads];
+        std::atomic<bool> go(false);
+        count = count < max_threads ? count : max_threads;
+        for (std::size_t i = 0; i < count; ++i) {
+            contexts[i] = context{&f, i, &go};
+            pthread_create(&threads[i], nullptr, [](void* p) -> void* {
+                context* const c = static_cast<context*>(p);
+                while (!c->go->load(std::memory_order_acquire)) {
+                    sched_yield();
+                }
+                (*c->f)(c->index);
+                return nullptr;
+            }, &contexts[i]);
+        }
+        const std::uint64_t start = now_ns();
+        go.store(true, std::memory_order_release);
+        for (std::size_t i = 0; i < count; ++i) {
+            pthread_join(threads[i], nullptr);
+        }
+        return now_ns() - start;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "bench.hpp"
+#include "bit.hpp"
+#include "charconv.hpp"
+#include "cstdlib.hpp"
+#include "vector.hpp"
+
+/* Floating-point conversion with to_chars and from_chars against snprintf and strtod, over 1e7 values drawn from every binade. The values
+ * and their texts are cycled from a pool of 65536 so that the measurement is of the conversions and not of cache misses on the inputs.
+ * snprintf needs %.17g (%.9g for float) to round-trip, where to_chars writes the shortest digits that do. Pass a smaller count on the
+ * command line for slow machines. */
+namespace {
+    constexpr std::size_t pool_size = 65536;
+    constexpr std::size_t text_size = 32;
+
+    template<class Float, class Bits>
+    std::vector<Float> make_values(bench::rng& rng) {
+        std::vector<Float> values;
+        while (values.size() < pool_size) {
+            const Float v = std::bit_cast<Float>(static_cast<Bits>(rng()));
+            // Random bits land on nan or inf about once in 2048 draws; those are not what is being measured.
+            if (v == v && v - v == 0) {
+                values.push_back(v);
+            }
+        }
+        return values;
+    }
+
+    // Every value's shortest text in a slot of its own, for the parsing benchmarks.
+    template<class Float>
+    std::vector<char> make_texts(const std::vector<Float>& values) {
+        std::vector<char> texts(pool_size * text_size);
+        for (std::size_t i = 0; i < pool_size; ++i) {
+            char* const slot = texts.data() + i * text_size;
+            *std::to_chars(slot, slot + text_size - 1, values[i]).ptr = '\0';
+        }
+        return texts;
+    }
+
+    void run(std::size_t n) {
+        bench::rng rng;
+        const std::vector<double> doubles = make_values<double, std::uint64_t>(rng);
+        const std::vector<float> floats = make_values<float, std::uint32_t>(rng);
+        const std::vector<char> double_texts = make_texts(doubles);
+        const std::vector<char> float_texts = make_texts(floats);
+        char buf[64];
+
+        bench::report("to_chars double shortest", n, bench::ns_per(n, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                bench::keep(std::to_chars(buf, buf + sizeof(buf), doubles[i % pool_size]).ptr);
+            }
+        }));
+
+        bench::report("snprintf double %.17g", n, bench::ns_per(n, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                bench::keep(std::snprintf(buf, sizeof(buf), "%.17g", doubles[i % pool_size]));
+            }
+        }));
+
+        bench::report("to_chars double scientific precision 16", n, bench::ns_per(n, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                bench::keep(std::to_chars(buf, buf + sizeof(buf), doubles[i % pool_size], std::chars_format::scientific, 16).ptr);
+            }
+        }));
+
+        bench::report("snprintf double %.16e", n, bench::ns_per(n, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                bench::keep(std::snprintf(buf, sizeof(buf), "%.16e", doubles[i % pool_size]));
+            }
+        }));
+
+        bench::report("to_chars float shortest", n, bench::ns_per(n, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                bench::keep(std::to_chars(buf, buf + sizeof(buf), floats[i % pool_size]).ptr);
+            }
+        }));
+
+        bench::report("snprintf float %.9g", n, bench::ns_per(n, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                bench::keep(std::snprintf(buf, sizeof(buf), "%.9g", double(floats[i % pool_size])));
+            }
+        }));
+
+        bench::report("from_chars double", n, bench::ns_per(n, [&] {
+            double sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const char* const text = double_texts.data() + i % pool_size * text_size;
+                double v;
+                std::from_chars(text, text + text_size, v);
+                sum += v;
+            }
+            bench::keep(sum);
+        }));
+
+        bench::report("strtod double", n, bench::ns_per(n, [&] {
+            double sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += std::strtod(double_texts.data() + i % pool_size * text_size, nullptr);
+            }
+            bench::keep(sum);
+        }));
+
+        bench::report("from_chars float", n, bench::ns_per(n, [&] {
+            float sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const char* const text = float_texts.data() + i % pool_size * text_size;
+                float v;
+                std::from_chars(text, text + text_size, v);
+                sum += v;
+            }
+            bench::keep(sum);
+        }));
+
+        bench::report("strtof float", n, bench::ns_per(n, [&] {
+            float sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += std::strtof(float_texts.data() + i % pool_size * text_size, nullptr);
+            }
+            bench::keep(sum);
+        }));
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t n = 10000000;
+    if (argc > 1) {
+        n = std::strtoull(argv[1], nullptr, 10);
+    }
+    run(n);
+}
\ No newline at end of file
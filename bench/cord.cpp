@@ -0,0 +1,105 @@
+#include "bench.hpp"
+#include "cord.hpp"
+#include "cstdlib.hpp"
+#include "streambuf.hpp"
+#include "string.hpp"
+
+/* Builds a 100 MB document and writes it out, with a cord and with a string for comparison. The document is built from 64-byte lines
+ * appended one at a time, and from 64 KiB sections that are built separately and then concatenated. Writing goes to a streambuf that
+ * discards what it's given, so that only the cost of handing over the text is measured. Pass a smaller size in MB on the command line for
+ * machines with less memory. */
+namespace {
+    constexpr std::size_t line_size = 64;
+    constexpr std::size_t section_size = 65536;
+
+    class sink : public std::streambuf {
+    public:
+        std::size_t written = 0;
+    protected:
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            bench::keep(s);
+            written += static_cast<std::size_t>(n);
+            return n;
+        }
+    };
+
+    void run(std::size_t megabytes) {
+        const std::size_t total = megabytes * 1000000;
+        const std::size_t lines = total / line_size;
+        const std::size_t sections = total / section_size;
+        char line[line_size];
+        for (std::size_t i = 0; i < line_size; ++i) {
+            line[i] = char('a' + i % 26);
+        }
+        line[line_size - 1] = '\n';
+        const std::string_view piece(line, line_size);
+
+        std::cord doc;
+        bench::report("cord append 64-byte lines", lines, bench::ns_per(lines, [&] {
+            std::cord c;
+            for (std::size_t i = 0; i < lines; ++i) {
+                c.append(piece);
+            }
+            doc = std::move(c);
+        }));
+
+        bench::report("string append 64-byte lines", lines, bench::ns_per(lines, [&] {
+            std::string s;
+            for (std::size_t i = 0; i < lines; ++i) {
+                s.append(piece);
+            }
+            bench::keep(s.data());
+        }));
+
+        // Every section is a cord of its own, as when the parts of a document are produced independently.
+        std::cord section;
+        for (std::size_t i = 0; i < section_size / line_size; ++i) {
+            section.append(piece);
+        }
+
+        bench::report("cord join 64 KiB sections", sections, bench::ns_per(sections, [&] {
+            std::cord c;
+            for (std::size_t i = 0; i < sections; ++i) {
+                c += section;
+            }
+            bench::keep(c.size());
+        }));
+
+        const std::string flat_section = section.str();
+        bench::report("string append 64 KiB sections", sections, bench::ns_per(sections, [&] {
+            std::string s;
+            for (std::size_t i = 0; i < sections; ++i) {
+                s += flat_section;
+            }
+            bench::keep(s.data());
+        }));
+
+        // Writing is measured per KiB of text.
+        const std::size_t kib = doc.size() / 1024;
+        bench::report("cord write", kib, bench::ns_per(kib, [&] {
+            sink out;
+            doc.write(out);
+            bench::keep(out.written);
+        }));
+
+        bench::report("cord str", kib, bench::ns_per(kib, [&] {
+            const std::string s = doc.str();
+            bench::keep(s.data());
+        }));
+
+        const std::string flat = doc.str();
+        bench::report("string write", kib, bench::ns_per(kib, [&] {
+            sink out;
+            out.sputn(flat.data(), static_cast<std::streamsize>(flat.size()));
+            bench::keep(out.written);
+        }));
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t megabytes = 100;
+    if (argc > 1) {
+        megabytes = std::strtoull(argv[1], nullptr, 10);
+    }
+    run(megabytes);
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "bench.hpp"
+#include "cstdlib.hpp"
+#include "flat_map.hpp"
+#include "map.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+/* flat_map against map, the node-based tree, on the read-heavy workload flat_map is meant for: building the container once from an
+ * unsorted range, then looking keys up (present and absent) and iterating over all of it, at 1e3 to 1e6 keys. Every size is looked up with
+ * the same number of random keys, so that the larger sizes miss the caches as a real table would. Pass a smaller maximum on the command
+ * line for slow machines. */
+namespace {
+    constexpr std::size_t lookups = 1000000;
+
+    void run(std::size_t n) {
+        char label[64];
+        bench::rng rng;
+        std::vector<std::pair<long, long>> elements;
+        for (std::size_t i = 0; i < n; ++i) {
+            // Even keys are present; the odd ones are for unsuccessful lookups.
+            elements.push_back(std::pair<long, long>(static_cast<long>(rng() >> 2) * 2, static_cast<long>(i)));
+        }
+        std::vector<long> hits;
+        std::vector<long> misses;
+        for (std::size_t i = 0; i < lookups; ++i) {
+            hits.push_back(elements[rng.below(n)].first);
+            misses.push_back(static_cast<long>(rng() >> 2) * 2 + 1);
+        }
+
+        std::flat_map<long, long> flat;
+        std::snprintf(label, sizeof(label), "flat_map build from unsorted range");
+        bench::report(label, n, bench::ns_per(n, [&] {
+            flat = std::flat_map<long, long>(elements.begin(), elements.end());
+        }));
+
+        std::map<long, long> tree;
+        std::snprintf(label, sizeof(label), "map build from unsorted range");
+        bench::report(label, n, bench::ns_per(n, [&] {
+            tree = std::map<long, long>(elements.begin(), elements.end());
+        }));
+
+        std::snprintf(label, sizeof(label), "flat_map find hit, %zu keys", n);
+        bench::report(label, lookups, bench::ns_per(lookups, [&] {
+            long sum = 0;
+            for (const long k : hits) {
+                sum += flat.find(k)->second;
+            }
+            bench::keep(sum);
+        }));
+
+        std::snprintf(label, sizeof(label), "map find hit, %zu keys", n);
+        bench::report(label, lookups, bench::ns_per(lookups, [&] {
+            long sum = 0;
+            for (const long k : hits) {
+                sum += tree.find(k)->second;
+            }
+            bench::keep(sum);
+        }));
+
+        std::snprintf(label, sizeof(label), "flat_map find miss, %zu keys", n);
+        bench::report(label, lookups, bench::ns_per(lookups, [&] {
+            std::size_t found = 0;
+            for (const long k : misses) {
+                found += flat.contains(k);
+            }
+            bench::keep(found);
+        }));
+
+        std::snprintf(label, sizeof(label), "map find miss, %zu keys", n);
+        bench::report(label, lookups, bench::ns_per(lookups, [&] {
+            std::size_t found = 0;
+            for (const long k : misses) {
+                found += tree.contains(k);
+            }
+            bench::keep(found);
+        }));
+
+        // Lookups are reported per lookup and iteration per element, so the container size is in the labels.
+        // Enough passes to make up a million elements.
+        const std::size_t passes = lookups / n + 1;
+        std::snprintf(label, sizeof(label), "flat_map iterate, %zu keys", n);
+        bench::report(label, passes * n, bench::ns_per(passes * n, [&] {
+            long sum = 0;
+            for (std::size_t pass = 0; pass < passes; ++pass) {
+                for (const auto [key, value] : flat) {
+                    sum += value;
+                }
+            }
+            bench::keep(sum);
+        }));
+
+        std::snprintf(label, sizeof(label), "map iterate, %zu keys", n);
+        bench::report(label, passes * n, bench::ns_per(passes * n, [&] {
+            long sum = 0;
+            for (std::size_t pass = 0; pass < passes; ++pass) {
+                for (const auto& element : tree) {
+                    sum += element.second;
+                }
+            }
+            bench::keep(sum);
+        }));
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t max_n = 1000000;
+    if (argc > 1) {
+        max_n = std::strtoull(argv[1], nullptr, 10);
+    }
+    for (std::size_t n = 1000; n <= max_n; n *= 10) {
+        run(n);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "bench.hpp"
+#include "cstdlib.hpp"
+#include "interned_string.hpp"
+#include "string.hpp"
+#include "unordered_map.hpp"
+#include "vector.hpp"
+
+/* An unordered_map keyed by interned strings against one keyed by plain strings, at 1e3 to 1e6 keys of 20 to 30 characters: inserting
+ * the keys, looking them up in random order, and interning the lookup keys from text first, as when they come from a parser. Interned keys
+ * hash by returning the cached hash and compare by pointer, while plain keys hash and compare the characters. Pass a smaller maximum on the
+ * command line for slow machines. */
+namespace {
+    std::string make_key(std::size_t i) {
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "namespace::identifier_%zu", i * 2654435761u % 1000000007u);
+        return std::string(buf);
+    }
+
+    void run(std::size_t max_n) {
+        char label[64];
+        bench::rng rng;
+        for (std::size_t n = 1000; n <= max_n; n *= 10) {
+            std::vector<std::string> keys;
+            for (std::size_t i = 0; i < n; ++i) {
+                keys.push_back(make_key(i + n));
+            }
+            // Every key is looked up once, in an order that defeats the caches.
+            std::vector<std::size_t> order;
+            for (std::size_t i = 0; i < n; ++i) {
+                order.push_back(rng.below(n));
+            }
+
+            std::vector<std::interned_string> handles;
+            std::snprintf(label, sizeof(label), "intern new strings");
+            bench::report(label, n, bench::ns_per(n, [&] {
+                handles.clear();
+                for (const std::string& k : keys) {
+                    handles.push_back(std::interned_string(k));
+                }
+            }, false));
+
+            std::snprintf(label, sizeof(label), "intern existing strings");
+            bench::report(label, n, bench::ns_per(n, [&] {
+                for (const std::string& k : keys) {
+                    bench::keep(std::interned_string(k).data());
+                }
+            }));
+
+            std::unordered_map<std::interned_string, std::size_t> interned_map;
+            std::snprintf(label, sizeof(label), "unordered_map<interned_string> insert");
+            bench::report(label, n, bench::ns_per(n, [&] {
+                interned_map.clear();
+                for (std::size_t i = 0; i < n; ++i) {
+                    interned_map.emplace(handles[i], i);
+                }
+            }));
+
+            std::unordered_map<std::string, std::size_t> string_map;
+            std::snprintf(label, sizeof(label), "unordered_map<string> insert");
+            bench::report(label, n, bench::ns_per(n, [&] {
+                string_map.clear();
+                for (std::size_t i = 0; i < n; ++i) {
+                    string_map.emplace(keys[i], i);
+                }
+            }));
+
+            std::snprintf(label, sizeof(label), "unordered_map<interned_string> find");
+            bench::report(label, n, bench::ns_per(n, [&] {
+                std::size_t sum = 0;
+                for (const std::size_t i : order) {
+                    sum += interned_map.find(handles[i])->second;
+                }
+                bench::keep(sum);
+            }));
+
+            std::snprintf(label, sizeof(label), "unordered_map<string> find");
+            bench::report(label, n, bench::ns_per(n, [&] {
+                std::size_t sum = 0;
+                for (const std::size_t i : order) {
+                    sum += string_map.find(keys[i])->second;
+                }
+                bench::keep(sum);
+            }));
+
+            std::snprintf(label, sizeof(label), "unordered_map<interned_string> intern + find");
+            bench::report(label, n, bench::ns_per(n, [&] {
+                std::size_t sum = 0;
+                for (const std::size_t i : order) {
+                    sum += interned_map.find(std::interned_string(keys[i]))->second;
+                }
+                bench::keep(sum);
+            }));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t max_n = 1000000;
+    if (argc > 1) {
+        max_n = std::strtoull(argv[1], nullptr, 10);
+    }
+    run(max_n);
+}
\ No newline at end of file
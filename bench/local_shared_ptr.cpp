@@ -0,0 +1,63 @@
+#include "bench.hpp"
+#include "memory.hpp"
+
+/* Builds a complete binary tree whose children are owned through local_shared_ptr or shared_ptr, walks it while copying every child pointer
+ * the way a traversal holding its own references would, and tears it down by dropping the root. The two pointer types share their control
+ * blocks, so the difference is the cost of the atomic count updates. */
+namespace {
+    template<template<class> class Ptr>
+    struct node {
+        Ptr<node> left;
+        Ptr<node> right;
+        int value;
+    };
+
+    template<template<class> class Ptr, class Make>
+    Ptr<node<Ptr>> build(int depth, Make make) {
+        Ptr<node<Ptr>> n = make();
+        n->value = depth;
+        if (depth > 1) {
+            n->left = build<Ptr>(depth - 1, make);
+            n->right = build<Ptr>(depth - 1, make);
+        }
+        return n;
+    }
+
+    template<template<class> class Ptr>
+    long walk(Ptr<node<Ptr>> n) {
+        if (!n) {
+            return 0;
+        }
+        return n->value + walk<Ptr>(n->left) + walk<Ptr>(n->right);
+    }
+
+    template<template<class> class Ptr, class Make>
+    void run(const char* name, int depth, Make make) {
+        const std::size_t nodes = (std::size_t(1) << depth) - 1;
+        char label[64];
+        Ptr<node<Ptr>> root;
+        std::snprintf(label, sizeof(label), "%s build depth %d", name, depth);
+        bench::report(label, nodes, bench::ns_per(nodes, [&] {
+            root = build<Ptr>(depth, make);
+        }, false));
+        std::snprintf(label, sizeof(label), "%s walk depth %d", name, depth);
+        bench::report(label, nodes, bench::ns_per(nodes, [&] {
+            bench::keep(walk<Ptr>(root));
+        }));
+        std::snprintf(label, sizeof(label), "%s teardown depth %d", name, depth);
+        bench::report(label, nodes, bench::ns_per(nodes, [&] {
+            root.reset();
+        }, false));
+    }
+}
+
+int main() {
+    for (int depth : {10, 16, 20}) {
+        run<std::shared_ptr>("shared_ptr", depth, [] {
+            return std::make_shared<node<std::shared_ptr>>();
+        });
+        run<std::local_shared_ptr>("local_shared_ptr", depth, [] {
+            return std::make_local_shared<node<std::local_shared_ptr>>();
+        });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "bench.hpp"
+#include "memory.hpp"
+#include "memory_resource.hpp"
+
+/* Construction and destruction of shared_ptr<int> through make_shared, allocate_shared and the pointer constructor. The pointer constructor
+ * allocates the object and the control block separately, as make_shared did before it fused them, so the lines marked "baseline" measure
+ * the unfused blocks in the same binary: shared_ptr(new int) for make_shared and allocate_shared with std::allocator, and the pointer
+ * constructor with a pool deleter and allocator for allocate_shared with the pool. */
+namespace {
+    constexpr std::size_t count = 1000000;
+    constexpr std::size_t batch = 1000;
+
+    std::shared_ptr<int> ptrs[batch];
+
+    // Creates count pointers in batches, so that each batch is destroyed while the next one is created and the allocator sees both.
+    template<class F>
+    double create_ns(F make) {
+        return bench::ns_per(count, [&] {
+            for (std::size_t i = 0; i < count; ++i) {
+                ptrs[i % batch] = make(int(i));
+            }
+            for (std::size_t i = 0; i < batch; ++i) {
+                ptrs[i].reset();
+            }
+        });
+    }
+}
+
+int main() {
+    bench::report("baseline: shared_ptr<int>(new int)", count, create_ns([](int v) {
+        return std::shared_ptr<int>(new int(v));
+    }));
+    bench::report("make_shared<int>", count, create_ns([](int v) {
+        return std::make_shared<int>(v);
+    }));
+    bench::report("allocate_shared<int> allocator", count, create_ns([](int v) {
+        return std::allocate_shared<int>(std::allocator<int>(), v);
+    }));
+    std::pmr::unsynchronized_pool_resource pool;
+    // The object and the control block both come from the pool, in two allocations.
+    bench::report("baseline: shared_ptr<int>(pool int, deleter, pool)", count, create_ns([&](int v) {
+        std::pmr::polymorphic_allocator<int> alloc(&pool);
+        return std::shared_ptr<int>(alloc.new_object<int>(int(v)), [alloc](int* p) mutable noexcept { alloc.delete_object(p); }, alloc);
+    }));
+    bench::report("allocate_shared<int> pool", count, create_ns([&](int v) {
+        return std::allocate_shared<int>(std::pmr::polymorphic_allocator<int>(&pool), int(v));
+    }));
+}
\ No newline at end of file
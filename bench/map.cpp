@@ -0,0 +1,90 @@
+#include "bench.hpp"
+#include "cstdlib.hpp"
+#include "map.hpp"
+#include "memory_resource.hpp"
+#include "vector.hpp"
+
+/* Bulk loading of sorted keys and random insertion and erasure in a map, at 1e3 to 1e6 elements, with the default allocator and with
+ * pmr::map over an unsynchronized_pool_resource, which is how a map gets pooled nodes. Sorted keys are loaded from a range, one at a time
+ * with the end as the hint (constant time per element), and one at a time without a hint (a search each). The random phase inserts keys
+ * in random order, then replaces a random element at a time at steady size, then moves every element to a second map through node
+ * handles. Pass a smaller maximum on the command line for slow machines. */
+namespace {
+    template<class Map, class MakeMap>
+    void run(const char* map_name, std::size_t n, MakeMap make_map) {
+        char label[64];
+        bench::rng rng;
+        std::vector<std::pair<long, long>> sorted;
+        std::vector<long> keys;
+        for (std::size_t i = 0; i < n; ++i) {
+            sorted.push_back(std::pair<long, long>(static_cast<long>(i) * 3, static_cast<long>(i)));
+            keys.push_back(static_cast<long>(rng.below(4 * n)));
+        }
+
+        std::snprintf(label, sizeof(label), "%s insert sorted range", map_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            Map map = make_map();
+            map.insert(sorted.begin(), sorted.end());
+            bench::keep(map.size());
+        }));
+
+        std::snprintf(label, sizeof(label), "%s emplace_hint(end) sorted", map_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            Map map = make_map();
+            for (const std::pair<long, long>& p : sorted) {
+                map.emplace_hint(map.end(), p.first, p.second);
+            }
+            bench::keep(map.size());
+        }));
+
+        std::snprintf(label, sizeof(label), "%s emplace sorted", map_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            Map map = make_map();
+            for (const std::pair<long, long>& p : sorted) {
+                map.emplace(p.first, p.second);
+            }
+            bench::keep(map.size());
+        }));
+
+        Map map = make_map();
+        std::snprintf(label, sizeof(label), "%s emplace random", map_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            for (const long k : keys) {
+                map.emplace(k, k);
+            }
+        }, false));
+
+        // Each step erases a key that is most likely present and inserts one that is most likely new, so the size stays about the same.
+        std::snprintf(label, sizeof(label), "%s erase + emplace random", map_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                map.erase(keys[i]);
+                map.emplace(keys[(i * 7 + 3) % n] + 1, 1);
+            }
+        }, false));
+
+        std::snprintf(label, sizeof(label), "%s extract + insert node", map_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            Map other = make_map();
+            for (const long k : keys) {
+                auto node = map.extract(k + 1);
+                if (!node.empty()) {
+                    other.insert(std::move(node));
+                }
+            }
+            bench::keep(other.size());
+        }, false));
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t max_n = 1000000;
+    if (argc > 1) {
+        max_n = std::strtoull(argv[1], nullptr, 10);
+    }
+    for (std::size_t n = 1000; n <= max_n; n *= 10) {
+        run<std::map<long, long>>("map", n, [] { return std::map<long, long>(); });
+        std::pmr::unsynchronized_pool_resource pool;
+        run<std::pmr::map<long, long>>("pmr::map, pool", n, [&] { return std::pmr::map<long, long>(&pool); });
+    }
+}
\ No newline at end of file
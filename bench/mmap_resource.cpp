@@ -0,0 +1,55 @@
+#include "bench.hpp"
+#include "algorithm.hpp"
+#include "cstdlib.hpp"
+#include "memory_resource.hpp"
+
+/* Multi-gigabyte arenas: a monotonic_buffer_resource whose single buffer is the whole arena is filled with 64-byte objects, each of which is
+ * written to, and then released. mmap_resource as the upstream, with each of its options, is compared against new_delete_resource(). Every
+ * arena is built twice in a row, so the second round shows the effect of the mapping cache. The arena sizes can be capped by passing a size
+ * in MiB on the command line, for machines with less memory. */
+namespace {
+    constexpr std::size_t object_size = 64;
+
+    double fill_ns(std::pmr::memory_resource* upstream, std::size_t arena_size) {
+        const std::size_t objects = arena_size / object_size - 1;
+        std::pmr::monotonic_buffer_resource arena(arena_size, upstream);
+        return bench::ns_per(objects, [&] {
+            for (std::size_t i = 0; i < objects; ++i) {
+                char* const p = static_cast<char*>(arena.allocate(object_size));
+                p[0] = char(i);
+                bench::keep(p);
+            }
+            arena.release();
+        }, false);
+    }
+
+    void run(const char* name, std::pmr::memory_resource* upstream, std::size_t arena_size) {
+        char label[64];
+        for (int round = 1; round <= 2; ++round) {
+            std::snprintf(label, sizeof(label), "%s %zuMiB round %d", name, arena_size >> 20, round);
+            bench::report(label, arena_size / object_size, fill_ns(upstream, arena_size));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t cap = std::size_t(4) << 30;
+    if (argc > 1) {
+        cap = std::size_t(std::strtoull(argv[1], nullptr, 10)) << 20;
+    }
+    for (std::size_t arena_size = std::min(std::size_t(1) << 30, cap); arena_size <= cap; arena_size *= 2) {
+        run("new_delete_resource", std::pmr::new_delete_resource(), arena_size);
+        {
+            std::pmr::mmap_resource upstream;
+            run("mmap_resource", &upstream, arena_size);
+        }
+        {
+            std::pmr::mmap_resource upstream({ .huge_pages = true });
+            run("mmap_resource huge_pages", &upstream, arena_size);
+        }
+        {
+            std::pmr::mmap_resource upstream({ .populate = true });
+            run("mmap_resource populate", &upstream, arena_size);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "bench.hpp"
+#include "memory_resource.hpp"
+
+/* A request-scoped arena: every simulated request makes a burst of small allocations of mixed sizes, none of which is freed individually, and
+ * then the whole arena is reset. Compares monotonic_buffer_resource, with and without chunk retention, against freeing every block through
+ * new_delete_resource() and unsynchronized_pool_resource. The tiny initial sizes check that a 1-byte start still grows to a usable buffer. */
+namespace {
+    constexpr std::size_t requests = 20000;
+    constexpr std::size_t allocations_per_request = 200;
+
+    void* blocks[allocations_per_request];
+    std::size_t sizes[allocations_per_request];
+
+    void fill_sizes() {
+        bench::rng gen;
+        for (std::size_t i = 0; i < allocations_per_request; ++i) {
+            sizes[i] = 8 + gen.below(249);
+        }
+    }
+
+    void one_request(std::pmr::memory_resource* r) {
+        for (std::size_t i = 0; i < allocations_per_request; ++i) {
+            blocks[i] = r->allocate(sizes[i]);
+            bench::keep(blocks[i]);
+        }
+    }
+
+    void report_monotonic(const char* name, std::pmr::monotonic_buffer_resource& r) {
+        bench::report(name, requests, bench::ns_per(requests, [&] {
+            for (std::size_t i = 0; i < requests; ++i) {
+                one_request(&r);
+                r.release();
+            }
+        }));
+    }
+
+    void report_freeing(const char* name, std::pmr::memory_resource* r) {
+        bench::report(name, requests, bench::ns_per(requests, [&] {
+            for (std::size_t i = 0; i < requests; ++i) {
+                one_request(r);
+                for (std::size_t j = 0; j < allocations_per_request; ++j) {
+                    r->deallocate(blocks[j], sizes[j]);
+                }
+            }
+        }));
+    }
+}
+
+int main() {
+    fill_sizes();
+    {
+        std::pmr::monotonic_buffer_resource r;
+        report_monotonic("monotonic_buffer_resource", r);
+    }
+    {
+        std::pmr::monotonic_buffer_resource r;
+        r.set_retain_chunks(true);
+        report_monotonic("monotonic_buffer_resource retained", r);
+    }
+    {
+        std::pmr::monotonic_buffer_resource r(1);
+        report_monotonic("monotonic_buffer_resource initial_size=1", r);
+    }
+    {
+        alignas(std::max_align_t) char buffer[1];
+        std::pmr::monotonic_buffer_resource r(buffer, sizeof(buffer));
+        report_monotonic("monotonic_buffer_resource 1-byte buffer", r);
+    }
+    {
+        alignas(std::max_align_t) char buffer[64 * 1024];
+        std::pmr::monotonic_buffer_resource r(buffer, sizeof(buffer));
+        report_monotonic("monotonic_buffer_resource 64KiB stack buffer", r);
+    }
+    report_freeing("new_delete_resource", std::pmr::new_delete_resource());
+    {
+        std::pmr::unsynchronized_pool_resource r;
+        report_freeing("unsynchronized_pool_resource", &r);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "bench.hpp"
+#include "memory_resource.hpp"
+
+/* Small-object allocation through the pool resources against new_delete_resource(), for block sizes from 16 to 512 bytes. Two patterns are
+ * measured: a batch of allocations freed in allocation order, and a steady state in which a random live block is freed and replaced. */
+namespace {
+    constexpr std::size_t batch = 100000;
+    constexpr std::size_t live = 10000;
+    constexpr std::size_t churn = 1000000;
+
+    void* blocks[batch];
+
+    double batch_ns(std::pmr::memory_resource* r, std::size_t size) {
+        return bench::ns_per(batch, [&] {
+            for (std::size_t i = 0; i < batch; ++i) {
+                blocks[i] = r->allocate(size);
+            }
+            for (std::size_t i = 0; i < batch; ++i) {
+                r->deallocate(blocks[i], size);
+            }
+        });
+    }
+
+    double churn_ns(std::pmr::memory_resource* r, std::size_t size) {
+        for (std::size_t i = 0; i < live; ++i) {
+            blocks[i] = r->allocate(size);
+        }
+        bench::rng gen;
+        const double ns = bench::ns_per(churn, [&] {
+            for (std::size_t i = 0; i < churn; ++i) {
+                const std::size_t j = gen.below(live);
+                r->deallocate(blocks[j], size);
+                blocks[j] = r->allocate(size);
+            }
+        });
+        for (std::size_t i = 0; i < live; ++i) {
+            r->deallocate(blocks[i], size);
+        }
+        return ns;
+    }
+
+    void run(const char* name, std::pmr::memory_resource* r) {
+        char label[64];
+        for (std::size_t size = 16; size <= 512; size *= 2) {
+            std::snprintf(label, sizeof(label), "%s batch %zuB", name, size);
+            bench::report(label, batch, batch_ns(r, size));
+            std::snprintf(label, sizeof(label), "%s churn %zuB", name, size);
+            bench::report(label, churn, churn_ns(r, size));
+        }
+    }
+}
+
+int main() {
+    run("new_delete_resource", std::pmr::new_delete_resource());
+    {
+        std::pmr::unsynchronized_pool_resource pool;
+        run("unsynchronized_pool_resource", &pool);
+    }
+    {
+        std::pmr::synchronized_pool_resource pool;
+        run("synchronized_pool_resource", &pool);
+    }
+}
\ No newline at end of file
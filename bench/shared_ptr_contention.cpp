@@ -0,0 +1,34 @@
+#include "bench.hpp"
+#include "memory.hpp"
+
+/* Copy contention on one control block: 32 threads repeatedly copy and drop the same shared_ptr, so every copy is an atomic increment and
+ * decrement of one shared word. Also measures the uncontended case, where each thread copies its own pointer, and a single thread for scale. */
+namespace {
+    constexpr std::size_t copies_per_thread = 1000000;
+    constexpr std::size_t thread_count = 32;
+
+    void copy_loop(const std::shared_ptr<int>& source) {
+        for (std::size_t i = 0; i < copies_per_thread; ++i) {
+            std::shared_ptr<int> copy(source);
+            bench::keep(copy.get());
+        }
+    }
+
+    double run(std::size_t threads, bool shared) {
+        std::shared_ptr<int> common = std::make_shared<int>(0);
+        std::shared_ptr<int> own[thread_count];
+        for (std::size_t i = 0; i < threads; ++i) {
+            own[i] = std::make_shared<int>(int(i));
+        }
+        auto f = [&](std::size_t i) {
+            copy_loop(shared ? common : own[i]);
+        };
+        return double(bench::run_threads(threads, f)) / double(threads * copies_per_thread);
+    }
+}
+
+int main() {
+    bench::report("shared_ptr copy 1 thread", copies_per_thread, run(1, true));
+    bench::report("shared_ptr copy 32 threads, one block", thread_count * copies_per_thread, run(thread_count, true));
+    bench::report("shared_ptr copy 32 threads, own blocks", thread_count * copies_per_thread, run(thread_count, false));
+}
\ No newline at end of file
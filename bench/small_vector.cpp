@@ -0,0 +1,94 @@
+#include "bench.hpp"
+#include "small_vector.hpp"
+#include "string.hpp"
+#include "type_traits.hpp"
+#include "vector.hpp"
+
+/* small_vector<T, N> against vector<T> for the short-lived, short containers small_vector is meant for: push_back and emplace_back into an
+ * empty container, copying one, and destroying the copies, at N = 4, 8 and 16 and at sizes below N, at N, and just past it, where
+ * small_vector moves to the heap. Each measurement is in nanoseconds per container, and the n column is the number of elements. Measured
+ * with int, which is relocated with memcpy, and with string, which is not trivially copyable. */
+namespace {
+    constexpr std::size_t containers = 100000;
+
+    template<class T>
+    T make(std::size_t i) {
+        if constexpr (std::is_same_v<T, int>) {
+            return int(i);
+        } else {
+            return T(16, char('a' + i % 26));
+        }
+    }
+
+    template<class C>
+    void measure(const char* name, std::size_t n) {
+        using T = typename C::value_type;
+        char label[64];
+        const T value = make<T>(n);
+
+        std::snprintf(label, sizeof(label), "%s push_back", name);
+        bench::report(label, n, bench::ns_per(containers, [&] {
+            for (std::size_t c = 0; c < containers; ++c) {
+                C v;
+                for (std::size_t i = 0; i < n; ++i) {
+                    v.push_back(value);
+                }
+                bench::keep(v.data());
+            }
+        }));
+
+        std::snprintf(label, sizeof(label), "%s emplace_back", name);
+        bench::report(label, n, bench::ns_per(containers, [&] {
+            for (std::size_t c = 0; c < containers; ++c) {
+                C v;
+                for (std::size_t i = 0; i < n; ++i) {
+                    v.emplace_back(make<T>(i));
+                }
+                bench::keep(v.data());
+            }
+        }));
+
+        // The copies go into a vector reserved up front, so that making them and destroying them are measured separately.
+        C source;
+        for (std::size_t i = 0; i < n; ++i) {
+            source.push_back(make<T>(i));
+        }
+        std::vector<C> copies;
+        copies.reserve(containers);
+        const auto copy_all = [&] {
+            for (std::size_t c = 0; c < containers; ++c) {
+                copies.emplace_back(source);
+            }
+        };
+        copy_all();
+        copies.clear();
+
+        std::snprintf(label, sizeof(label), "%s copy", name);
+        bench::report(label, n, bench::ns_per(containers, copy_all, false));
+        std::snprintf(label, sizeof(label), "%s destroy", name);
+        bench::report(label, n, bench::ns_per(containers, [&] {
+            copies.clear();
+        }, false));
+    }
+
+    template<class T, std::size_t N>
+    void run(const char* type) {
+        char vector_name[32];
+        char small_vector_name[32];
+        std::snprintf(vector_name, sizeof(vector_name), "vector<%s>", type);
+        std::snprintf(small_vector_name, sizeof(small_vector_name), "small_vector<%s, %zu>", type, N);
+        for (const std::size_t n : {N / 2, N, N + 1}) {
+            measure<std::vector<T>>(vector_name, n);
+            measure<std::small_vector<T, N>>(small_vector_name, n);
+        }
+    }
+}
+
+int main() {
+    run<int, 4>("int");
+    run<int, 8>("int");
+    run<int, 16>("int");
+    run<std::string, 4>("string");
+    run<std::string, 8>("string");
+    run<std::string, 16>("string");
+}
\ No newline at end of file
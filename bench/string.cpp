@@ -0,0 +1,110 @@
+#include "algorithm.hpp"
+#include "bench.hpp"
+#include "cstdlib.hpp"
+#include "string.hpp"
+
+/* String construction, appending, concatenation and comparison around the short-string boundary and beyond it: 8 and 22 characters fit
+ * inline, 23 is the shortest heap string, and 256 and 4096 stay on the heap. Each operation is repeated over a batch of strings so that
+ * the allocator sees a realistic mix of live blocks. Pass a smaller number of operations on the command line for slow machines. */
+namespace {
+    constexpr std::size_t lengths[] = {8, 22, 23, 256, 4096};
+
+    void run(std::size_t ops) {
+        char label[64];
+        for (const std::size_t length : lengths) {
+            // Longer strings cost more per operation, so fewer of them keep every case at a similar duration.
+            const std::size_t n = length <= 256 ? ops : ops / 16;
+            const std::string source(length, 'x');
+            const char* const chars = source.c_str();
+
+            std::snprintf(label, sizeof(label), "string(const char*) length %zu", length);
+            bench::report(label, n, bench::ns_per(n, [&] {
+                for (std::size_t i = 0; i < n; ++i) {
+                    std::string s(chars);
+                    bench::keep(s.data());
+                }
+            }));
+
+            std::snprintf(label, sizeof(label), "string copy length %zu", length);
+            bench::report(label, n, bench::ns_per(n, [&] {
+                for (std::size_t i = 0; i < n; ++i) {
+                    std::string s(source);
+                    bench::keep(s.data());
+                }
+            }));
+
+            // Building strings one character or one chunk at a time is measured per character appended.
+            const std::size_t strings = n / length + 1;
+
+            std::snprintf(label, sizeof(label), "string push_back to length %zu", length);
+            bench::report(label, strings * length, bench::ns_per(strings * length, [&] {
+                for (std::size_t i = 0; i < strings; ++i) {
+                    std::string s;
+                    for (std::size_t j = 0; j < length; ++j) {
+                        s.push_back(char('a' + j % 26));
+                    }
+                    bench::keep(s.data());
+                }
+            }));
+
+            std::snprintf(label, sizeof(label), "string append 8 chars to length %zu", length);
+            bench::report(label, strings * length, bench::ns_per(strings * length, [&] {
+                for (std::size_t i = 0; i < strings; ++i) {
+                    std::string s;
+                    while (s.size() < length) {
+                        s.append(chars, std::min<std::size_t>(8, length - s.size()));
+                    }
+                    bench::keep(s.data());
+                }
+            }));
+
+            std::snprintf(label, sizeof(label), "string a + b length %zu", length);
+            bench::report(label, n, bench::ns_per(n, [&] {
+                for (std::size_t i = 0; i < n; ++i) {
+                    std::string s = source + source;
+                    bench::keep(s.data());
+                }
+            }));
+
+            std::snprintf(label, sizeof(label), "string a + b + c + d length %zu", length);
+            bench::report(label, n, bench::ns_per(n, [&] {
+                for (std::size_t i = 0; i < n; ++i) {
+                    std::string s = source + source + source + source;
+                    bench::keep(s.data());
+                }
+            }));
+
+            // The strings differ in their last character only, so comparing them reads both in full.
+            std::string other = source;
+            other.back() = 'y';
+
+            std::snprintf(label, sizeof(label), "string == length %zu", length);
+            bench::report(label, n, bench::ns_per(n, [&] {
+                std::size_t equal = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    bench::keep(other.data());
+                    equal += source == other;
+                }
+                bench::keep(equal);
+            }));
+
+            std::snprintf(label, sizeof(label), "string compare length %zu", length);
+            bench::report(label, n, bench::ns_per(n, [&] {
+                int sum = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    bench::keep(other.data());
+                    sum += source.compare(other);
+                }
+                bench::keep(sum);
+            }));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t ops = 10000000;
+    if (argc > 1) {
+        ops = std::strtoull(argv[1], nullptr, 10);
+    }
+    run(ops);
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "bench.hpp"
+#include "memory_resource.hpp"
+
+/* Aggregate allocate/free throughput of synchronized_pool_resource against new_delete_resource() with 1, 4, 16 and 64 threads sharing one
+ * resource. Every thread keeps its own window of live blocks of random sizes between 16 and 512 bytes and repeatedly frees one and allocates a
+ * replacement. The reported figure is wall-clock time divided by the total number of allocate/free pairs over all threads. */
+namespace {
+    constexpr std::size_t window = 1024;
+    constexpr std::size_t ops_per_thread = 200000;
+
+    void worker(std::pmr::memory_resource* r, std::uint64_t seed) {
+        void* blocks[window];
+        std::size_t sizes[window];
+        bench::rng gen(seed);
+        for (std::size_t i = 0; i < window; ++i) {
+            sizes[i] = 16 + gen.below(497);
+            blocks[i] = r->allocate(sizes[i]);
+        }
+        for (std::size_t i = 0; i < ops_per_thread; ++i) {
+            const std::size_t j = gen.below(window);
+            r->deallocate(blocks[j], sizes[j]);
+            sizes[j] = 16 + gen.below(497);
+            blocks[j] = r->allocate(sizes[j]);
+        }
+        for (std::size_t i = 0; i < window; ++i) {
+            r->deallocate(blocks[i], sizes[i]);
+        }
+    }
+
+    double run(std::pmr::memory_resource* r, std::size_t thread_count) {
+        auto f = [r](std::size_t i) {
+            worker(r, i + 1);
+        };
+        return double(bench::run_threads(thread_count, f)) / double(thread_count * ops_per_thread);
+    }
+}
+
+int main() {
+    char label[64];
+    for (std::size_t thread_count : {1, 4, 16, 64}) {
+        std::snprintf(label, sizeof(label), "new_delete_resource %zu threads", thread_count);
+        bench::report(label, thread_count * ops_per_thread, run(std::pmr::new_delete_resource(), thread_count));
+        std::pmr::synchronized_pool_resource pool;
+        std::snprintf(label, sizeof(label), "synchronized_pool_resource %zu threads", thread_count);
+        bench::report(label, thread_count * ops_per_thread, run(&pool, thread_count));
+    }
+}
\ No newline at end of file
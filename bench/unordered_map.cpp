@@ -0,0 +1,94 @@
+#include "bench.hpp"
+#include "cstdlib.hpp"
+#include "string.hpp"
+#include "unordered_map.hpp"
+#include "vector.hpp"
+
+/* unordered_map insert, successful and unsuccessful find, erase and iteration at 1e3 to 1e8 keys, with 64-bit integer keys and with string
+ * keys of 29 characters. Integer keys are computed from their index as they are needed, so that only the table grows with n; string keys
+ * are built up front and stop at a tenth of the maximum, since 1e8 of them would need several gigabytes besides the table. Lookups and
+ * erasures visit the keys in random order. Pass a smaller maximum on the command line for machines with less memory. */
+namespace {
+    // Odd multipliers permute the 64-bit integers, so hit keys (even indices) and miss keys (odd indices) never collide.
+    std::uint64_t int_key(std::size_t i) {
+        return std::uint64_t(i) * 0x9e3779b97f4a7c15;
+    }
+
+    std::string string_key(std::size_t i) {
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "config.entry_%016llx", static_cast<unsigned long long>(int_key(i)));
+        return std::string(buf);
+    }
+
+    /* key(2 * i) is the i-th key inserted, and key(2 * i + 1) is a key that isn't in the map. The lookup order is drawn from rng as
+     * the loops run, which adds the same few nanoseconds to every lookup but keeps 1e8 indices out of memory. */
+    template<class Key, class KeyAt>
+    void run(const char* key_name, std::size_t n, KeyAt key) {
+        char label[64];
+        bench::rng rng;
+        std::unordered_map<Key, std::size_t> map;
+
+        std::snprintf(label, sizeof(label), "unordered_map<%s> insert", key_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            map = std::unordered_map<Key, std::size_t>();
+            for (std::size_t i = 0; i < n; ++i) {
+                map.emplace(key(2 * i), i);
+            }
+        }));
+
+        std::snprintf(label, sizeof(label), "unordered_map<%s> find hit", key_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += map.find(key(2 * rng.below(n)))->second;
+            }
+            bench::keep(sum);
+        }));
+
+        std::snprintf(label, sizeof(label), "unordered_map<%s> find miss", key_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            std::size_t found = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                found += map.find(key(2 * rng.below(n) + 1)) != map.end();
+            }
+            bench::keep(found);
+        }));
+
+        std::snprintf(label, sizeof(label), "unordered_map<%s> iterate", key_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            std::size_t sum = 0;
+            for (const auto& element : map) {
+                sum += element.second;
+            }
+            bench::keep(sum);
+        }));
+
+        /* Every key is erased once, stepping through the indices by a prime that doesn't divide n so that the order defeats the caches.
+         * The table can only be emptied once, so there is no warm-up run. */
+        std::snprintf(label, sizeof(label), "unordered_map<%s> erase", key_name);
+        bench::report(label, n, bench::ns_per(n, [&] {
+            std::size_t erased = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                erased += map.erase(key(2 * (i * 2654435761u % n)));
+            }
+            bench::keep(erased);
+        }, false));
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t max_n = 100000000;
+    if (argc > 1) {
+        max_n = std::strtoull(argv[1], nullptr, 10);
+    }
+    for (std::size_t n = 1000; n <= max_n; n *= 10) {
+        run<std::uint64_t>("uint64_t", n, int_key);
+    }
+    for (std::size_t n = 1000; n <= max_n / 10; n *= 10) {
+        std::vector<std::string> keys;
+        for (std::size_t i = 0; i < 2 * n; ++i) {
+            keys.push_back(string_key(i));
+        }
+        run<std::string>("string", n, [&](std::size_t i) -> const std::string& { return keys[i]; });
+    }
+}
\ No newline at end of file
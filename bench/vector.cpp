@@ -0,0 +1,75 @@
+#include "bench.hpp"
+#include "cstdlib.hpp"
+#include "string.hpp"
+#include "type_traits.hpp"
+#include "vector.hpp"
+
+/* Growth-heavy vector operations at 1e3 to 1e8 elements: push_back and emplace_back into an empty vector, resize in steps, and insert near
+ * the front, which moves the whole tail. Measured with int, which is relocated with memcpy, and with string, which is not trivially copyable.
+ * The insert sizes stop at 1e5, since every insert is linear. Pass a smaller maximum on the command line for machines with less memory. */
+namespace {
+    template<class T>
+    T make(std::size_t i) {
+        if constexpr (std::is_same_v<T, int>) {
+            return int(i);
+        } else {
+            return T(16, char('a' + i % 26));
+        }
+    }
+
+    template<class T>
+    void run(const char* type, std::size_t max_n) {
+        char label[64];
+        for (std::size_t n = 1000; n <= max_n; n *= 10) {
+            const T value = make<T>(n);
+
+            std::snprintf(label, sizeof(label), "vector<%s> push_back", type);
+            bench::report(label, n, bench::ns_per(n, [&] {
+                std::vector<T> v;
+                for (std::size_t i = 0; i < n; ++i) {
+                    v.push_back(value);
+                }
+                bench::keep(v.data());
+            }));
+
+            std::snprintf(label, sizeof(label), "vector<%s> emplace_back", type);
+            bench::report(label, n, bench::ns_per(n, [&] {
+                std::vector<T> v;
+                for (std::size_t i = 0; i < n; ++i) {
+                    v.emplace_back(make<T>(i));
+                }
+                bench::keep(v.data());
+            }));
+
+            std::snprintf(label, sizeof(label), "vector<%s> resize by n/100", type);
+            bench::report(label, n, bench::ns_per(n, [&] {
+                std::vector<T> v;
+                for (std::size_t size = n / 100; size <= n; size += n / 100) {
+                    v.resize(size);
+                }
+                bench::keep(v.data());
+            }));
+
+            if (n <= 100000) {
+                std::snprintf(label, sizeof(label), "vector<%s> insert at begin + 1", type);
+                bench::report(label, n, bench::ns_per(n, [&] {
+                    std::vector<T> v(1);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        v.insert(v.begin() + 1, value);
+                    }
+                    bench::keep(v.data());
+                }));
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t max_n = 100000000;
+    if (argc > 1) {
+        max_n = std::strtoull(argv[1], nullptr, 10);
+    }
+    run<int>("int", max_n);
+    // Strings are larger, so their sizes stop one step earlier.
+    run<std::string>("string", max_n / 10);
+}
\ No newline at end of file
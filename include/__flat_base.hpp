@@ -0,0 +1,111 @@
+// Declares the sorted-input tags and the search and sort routines shared by <flat_map> and <flat_set>.
+
+#pragma once
+
+#include "__key_policy.hpp"
+#include "cstddef.hpp"
+#include "type_traits.hpp"
+#include "vector.hpp"
+
+namespace std {
+    /* C++23 24.6.4 Tags for constructing from or inserting input that is already sorted */
+    struct sorted_unique_t {
+        explicit sorted_unique_t() = default;
+    };
+
+    inline constexpr sorted_unique_t sorted_unique{};
+
+    struct sorted_equivalent_t {
+        explicit sorted_equivalent_t() = default;
+    };
+
+    inline constexpr sorted_equivalent_t sorted_equivalent{};
+
+    namespace __internal {
+        /* The first of the n elements from first that doesn't compare less than key. Each step keeps one half or the other through a
+         * conditional add instead of a branch, so that lookups in a large table don't stall on a mispredicted branch per level; the cost is
+         * that the search always takes the full log2(n) + 1 comparisons. */
+        template<class RandomAccessIterator, class K, class Compare>
+        constexpr RandomAccessIterator __flat_lower_bound(RandomAccessIterator first, std::size_t n, const K& key, const Compare& comp) {
+            if (n == 0) {
+                return first;
+            }
+            while (n > 1) {
+                const std::size_t half = n / 2;
+                first += comp(first[half], key) ? half : 0;
+                n -= half;
+            }
+            return first + comp(*first, key);
+        }
+
+        /* The first of the n elements from first that compares greater than key, found the same way as __flat_lower_bound. */
+        template<class RandomAccessIterator, class K, class Compare>
+        constexpr RandomAccessIterator __flat_upper_bound(RandomAccessIterator first, std::size_t n, const K& key, const Compare& comp) {
+            if (n == 0) {
+                return first;
+            }
+            while (n > 1) {
+                const std::size_t half = n / 2;
+                first += comp(key, first[half]) ? 0 : half;
+                n -= half;
+            }
+            return first + !comp(key, *first);
+        }
+
+        /* Returns the positions 0 to n - 1 ordered stably by less, which compares the elements at two positions. The flat containers sort
+         * positions rather than elements, so that one ordering can then be applied to the key and the mapped containers together. Runs of
+         * 16 are insertion sorted, then merged pairwise into runs of doubling length. */
+        template<class Less>
+        vector<std::size_t> __flat_sorted_positions(std::size_t n, Less less) {
+            vector<std::size_t> order(n);
+            for (std::size_t i = 0; i < n; i++) {
+                order[i] = i;
+            }
+
+            constexpr std::size_t run = 16;
+            for (std::size_t lo = 0; lo < n; lo += run) {
+                const std::size_t hi = lo + run < n ? lo + run : n;
+                for (std::size_t i = lo + 1; i < hi; i++) {
+                    const std::size_t p = order[i];
+                    std::size_t j = i;
+                    for (; j > lo && less(p, order[j - 1]); j--) {
+                        order[j] = order[j - 1];
+                    }
+                    order[j] = p;
+                }
+            }
+
+            if (n <= run) {
+                return order;
+            }
+
+            vector<std::size_t> buffer(n);
+            for (std::size_t width = run; width < n; width *= 2) {
+                for (std::size_t lo = 0; lo < n; lo += 2 * width) {
+                    const std::size_t mid = lo + width < n ? lo + width : n;
+                    const std::size_t hi = lo + 2 * width < n ? lo + 2 * width : n;
+                    std::size_t i = lo, j = mid, k = lo;
+                    // Taking from the right run only when it's strictly less keeps equivalent elements in order.
+                    while (i < mid && j < hi) {
+                        buffer[k++] = less(order[j], order[i]) ? order[j++] : order[i++];
+                    }
+                    while (i < mid) {
+                        buffer[k++] = order[i++];
+                    }
+                    while (j < hi) {
+                        buffer[k++] = order[j++];
+                    }
+                }
+                order.swap(buffer);
+            }
+            return order;
+        }
+
+        template<class Container>
+        void __flat_reserve(Container& c, std::size_t n) {
+            if constexpr (requires { c.reserve(n); }) {
+                c.reserve(n);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,1073 @@
+// Declares the open-addressing hash table that <unordered_set> and <unordered_map> are built on.
+
+#pragma once
+
+#include "__key_policy.hpp"
+#include "bit.hpp"
+#include "cstddef.hpp"
+#include "cstdint.hpp"
+#include "functional.hpp"
+#include "initializer_list.hpp"
+#include "iterator.hpp"
+#include "limits.hpp"
+#include "memory.hpp"
+#include "stdexcept.hpp"
+#include "tuple.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+#if defined(__SSE2__)
+#include "emmintrin.h"
+#endif
+
+namespace std {
+    namespace __internal {
+        /* Every slot of a table has a control byte. A full slot stores the low 7 bits of its element's hash there, so that a probe can rule out
+         * most slots without touching the elements. The other states are negative: empty, deleted (a tombstone that keeps probe sequences
+         * going past an erased element), and the sentinel that follows the last slot and stops iteration. */
+        using __ctrl_t = signed char;
+
+        inline constexpr __ctrl_t __ctrl_empty = -128;
+        inline constexpr __ctrl_t __ctrl_deleted = -2;
+        inline constexpr __ctrl_t __ctrl_sentinel = -1;
+
+        /* The set of slots within a group that satisfy a condition, with one bit per slot for SSE2, and the top bit of one byte per slot for
+         * the portable group. Iterating over it yields the slot offsets in increasing order. */
+        template<class T, int Shift>
+        class __probe_mask {
+        private:
+            T mask;
+        public:
+            explicit __probe_mask(T mask) noexcept : mask(mask) {}
+
+            explicit operator bool() const noexcept {
+                return mask != 0;
+            }
+
+            int lowest() const noexcept {
+                return countr_zero(mask) >> Shift;
+            }
+
+            /* The number of slots before the first one in the mask, or the group width if there is none. */
+            int trailing_zeros() const noexcept {
+                return countr_zero(mask) >> Shift;
+            }
+
+            /* The number of slots after the last one in the mask, or the group width if there is none. */
+            int leading_zeros() const noexcept {
+                return countl_zero(mask) >> Shift;
+            }
+
+            __probe_mask begin() const noexcept {
+                return *this;
+            }
+
+            __probe_mask end() const noexcept {
+                return __probe_mask(0);
+            }
+
+            int operator*() const noexcept {
+                return lowest();
+            }
+
+            __probe_mask& operator++() noexcept {
+                mask &= mask - 1;
+                return *this;
+            }
+
+            bool operator!=(const __probe_mask& other) const noexcept {
+                return mask != other.mask;
+            }
+        };
+
+#if defined(__SSE2__)
+        /* The control bytes of 16 consecutive slots, compared all at once. */
+        class __ctrl_group {
+        private:
+            __m128i ctrl;
+        public:
+            static constexpr std::size_t width = 16;
+
+            explicit __ctrl_group(const __ctrl_t* p) noexcept : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+            __probe_mask<uint16_t, 0> match(__ctrl_t h2) const noexcept {
+                return __probe_mask<uint16_t, 0>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))));
+            }
+
+            __probe_mask<uint16_t, 0> mask_empty() const noexcept {
+                return match(__ctrl_empty);
+            }
+
+            __probe_mask<uint16_t, 0> mask_empty_or_deleted() const noexcept {
+                return __probe_mask<uint16_t, 0>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(__ctrl_sentinel), ctrl))));
+            }
+
+            /* The number of empty or deleted slots before the first full slot or the sentinel. */
+            int count_leading_empty_or_deleted() const noexcept {
+                const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(__ctrl_sentinel), ctrl)));
+                return countr_zero(mask + 1);
+            }
+        };
+#else
+        /* The control bytes of 8 consecutive slots, compared as the bytes of one 64-bit word. */
+        class __ctrl_group {
+        private:
+            static constexpr uint64_t lsbs = 0x0101010101010101ull;
+            static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+            uint64_t ctrl;
+        public:
+            static constexpr std::size_t width = 8;
+
+            explicit __ctrl_group(const __ctrl_t* p) noexcept {
+                __builtin_memcpy(&ctrl, p, sizeof(ctrl));
+                if constexpr (endian::native == endian::big) {
+                    ctrl = __builtin_bswap64(ctrl);
+                }
+            }
+
+            /* Bytes equal to h2 become zero, and subtracting one from every byte sets the top bit of exactly those. A borrow can also flag the
+             * byte after a match, but only a full one, and the caller compares the keys anyway. */
+            __probe_mask<uint64_t, 3> match(__ctrl_t h2) const noexcept {
+                const uint64_t x = ctrl ^ (lsbs * static_cast<unsigned char>(h2));
+                return __probe_mask<uint64_t, 3>((x - lsbs) & ~x & msbs);
+            }
+
+            // Empty is the only state with the top bit set and bit 1 clear.
+            __probe_mask<uint64_t, 3> mask_empty() const noexcept {
+                return __probe_mask<uint64_t, 3>(ctrl & ~(ctrl << 6) & msbs);
+            }
+
+            // Empty and deleted are the only states with the top bit set and bit 0 clear.
+            __probe_mask<uint64_t, 3> mask_empty_or_deleted() const noexcept {
+                return __probe_mask<uint64_t, 3>(ctrl & ~(ctrl << 7) & msbs);
+            }
+
+            /* The number of empty or deleted slots before the first full slot or the sentinel. */
+            int count_leading_empty_or_deleted() const noexcept {
+                return __probe_mask<uint64_t, 3>(~(ctrl & ~(ctrl << 7)) & msbs).trailing_zeros();
+            }
+        };
+#endif
+
+        /* The control bytes of a table without slots. Lookups read one group from it, find no match and an empty slot, and stop. */
+        alignas(16) inline constexpr __ctrl_t __empty_ctrl_group[16] = {
+            __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty,
+            __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty, __ctrl_empty
+        };
+
+        /* hash<> maps integers to themselves, so the table spreads every hash over all bits before splitting it into the probe start (H1) and
+         * the 7 bits kept in the control byte (H2). */
+        inline std::size_t __mix_hash(std::size_t h) noexcept {
+#if defined(__SIZEOF_INT128__)
+            if constexpr (sizeof(std::size_t) == 8) {
+                const __uint128_t m = static_cast<__uint128_t>(h) * 0x9e3779b97f4a7c15ull;
+                return static_cast<std::size_t>(m) ^ static_cast<std::size_t>(m >> 64);
+            }
+#endif
+            const uint64_t m = static_cast<uint64_t>(h) * 0x9e3779b97f4a7c15ull;
+            return static_cast<std::size_t>(m ^ (m >> 32));
+        }
+
+        /* Visits the groups starting at H1, each one further away than the previous: the offsets grow by 1, 2, 3... groups, which covers
+         * every group of a table whose capacity plus one is a power of two. */
+        class __probe_seq {
+        private:
+            std::size_t mask;
+            std::size_t index;
+        public:
+            std::size_t offset;
+
+            __probe_seq(std::size_t hash, std::size_t mask) noexcept : mask(mask), index(0), offset((hash >> 7) & mask) {}
+
+            void next() noexcept {
+                index += __ctrl_group::width;
+                offset = (offset + index) & mask;
+            }
+        };
+
+        template<class Policy, class Hash, class Pred, class Allocator>
+        class __hash_table;
+
+        template<class Value, bool Const>
+        class __hash_table_iterator {
+        private:
+            template<class, class, class, class>
+            friend class __hash_table;
+
+            template<class, bool>
+            friend class __hash_table_iterator;
+
+            /* The control byte and slot of the element, or null for the past-the-end iterator. */
+            const __ctrl_t* ctrl;
+            Value* slot;
+
+            __hash_table_iterator(const __ctrl_t* ctrl, Value* slot) noexcept : ctrl(ctrl), slot(slot) {}
+
+            /* Moves forward to the next full slot, a whole group of empty slots at a time, and turns into the past-the-end iterator at the
+             * sentinel. */
+            void skip_empty_or_deleted() noexcept {
+                while (*ctrl < __ctrl_sentinel) {
+                    const int shift = __ctrl_group(ctrl).count_leading_empty_or_deleted();
+                    ctrl += shift;
+                    slot += shift;
+                }
+
+                if (*ctrl == __ctrl_sentinel) {
+                    ctrl = nullptr;
+                    slot = nullptr;
+                }
+            }
+        public:
+            using value_type = Value;
+            using difference_type = std::ptrdiff_t;
+            using reference = conditional_t<Const, const Value&, Value&>;
+            using pointer = conditional_t<Const, const Value*, Value*>;
+            using iterator_category = forward_iterator_tag;
+
+            __hash_table_iterator() noexcept : ctrl(nullptr), slot(nullptr) {}
+
+            template<bool OtherConst>
+            requires Const && (!OtherConst)
+            __hash_table_iterator(const __hash_table_iterator<Value, OtherConst>& other) noexcept : ctrl(other.ctrl), slot(other.slot) {}
+
+            reference operator*() const noexcept {
+                return *slot;
+            }
+
+            pointer operator->() const noexcept {
+                return slot;
+            }
+
+            __hash_table_iterator& operator++() noexcept {
+                ++ctrl;
+                ++slot;
+                skip_empty_or_deleted();
+                return *this;
+            }
+
+            __hash_table_iterator operator++(int) noexcept {
+                const __hash_table_iterator temp = *this;
+                ++*this;
+                return temp;
+            }
+
+            friend bool operator==(const __hash_table_iterator& x, const __hash_table_iterator& y) noexcept {
+                return x.ctrl == y.ctrl;
+            }
+        };
+
+        template<class Hash, class Pred>
+        concept __transparent_lookup = requires { typename Hash::is_transparent; typename Pred::is_transparent; };
+
+
+
+        /* A Swiss table: the elements live directly in an array of slots, whose count is one less than a power of two, next to an array with
+         * one control byte per slot (see __ctrl_t). A lookup hashes the key once, compares the control bytes of a whole group of slots against
+         * H2 in a few instructions, and only compares keys for the rare slots that match; the first group with an empty slot ends it. Up to the
+         * maximum load factor of 7/8, that's usually one cache miss in the control bytes and one in the slots.
+         *
+         * The sentinel follows the last control byte, and then copies of the first group's worth of control bytes, so that a group can be
+         * loaded at any slot without wrapping around. Both arrays share one allocation, control bytes first.
+         *
+         * Unlike in a node-based table, rehashing moves the elements, so it invalidates references as well as iterators. Trivially relocatable
+         * elements are moved with memcpy. */
+        template<class Policy, class Hash, class Pred, class Allocator>
+        class __hash_table {
+        private:
+            static_assert(is_same_v<typename Allocator::value_type, typename Policy::value_type>);
+            static_assert(is_same_v<typename allocator_traits<Allocator>::pointer, typename Policy::value_type*>,
+                "The control bytes and slots share one block, which needs an allocator that uses raw pointers.");
+
+            using traits_type = allocator_traits<Allocator>;
+
+            /* The unit of allocation of the block holding the control bytes and the slots, aligned for the slots. */
+            struct alignas(typename Policy::value_type) block_unit {
+                unsigned char bytes[alignof(typename Policy::value_type)];
+            };
+
+            using block_allocator = typename traits_type::template rebind_alloc<block_unit>;
+            using block_traits = allocator_traits<block_allocator>;
+
+            static constexpr bool relocates_bitwise = __internal::relocates_bitwise<typename Policy::value_type, Allocator>;
+        public:
+            using key_type = typename Policy::key_type;
+            using value_type = typename Policy::value_type;
+            using hasher = Hash;
+            using key_equal = Pred;
+            using allocator_type = Allocator;
+            using pointer = typename allocator_traits<Allocator>::pointer;
+            using const_pointer = typename allocator_traits<Allocator>::const_pointer;
+            using reference = value_type&;
+            using const_reference = const value_type&;
+            using size_type = typename allocator_traits<Allocator>::size_type;
+            using difference_type = typename allocator_traits<Allocator>::difference_type;
+            // The elements of a set are its keys, so neither of its iterators may modify them.
+            using iterator = __hash_table_iterator<value_type, is_same_v<key_type, value_type>>;
+            using const_iterator = __hash_table_iterator<value_type, true>;
+
+            __hash_table() : __hash_table(0) {}
+
+            explicit __hash_table(size_type n, const hasher& hf = hasher(), const key_equal& eql = key_equal(), const allocator_type& a = allocator_type())
+                : alloc(a), hf(hf), eql(eql), ctrl(empty_ctrl()), slots(nullptr), cap(0), len(0), growth_left(0) {
+                if (n != 0) {
+                    allocate_block(normalize_capacity(n));
+                }
+            }
+
+            template<__internal::legacy_input_iterator InputIterator>
+            __hash_table(InputIterator first, InputIterator last, size_type n = 0, const hasher& hf = hasher(), const key_equal& eql = key_equal(),
+                const allocator_type& a = allocator_type()) : __hash_table(n, hf, eql, a) {
+                insert(first, last);
+            }
+
+            __hash_table(const __hash_table& x) : __hash_table(x, traits_type::select_on_container_copy_construction(x.alloc)) {}
+
+            __hash_table(__hash_table&& x) noexcept
+                : alloc(move(x.alloc)), hf(move(x.hf)), eql(move(x.eql)), ctrl(x.ctrl), slots(x.slots), cap(x.cap), len(x.len), growth_left(x.growth_left) {
+                x.reset_to_empty();
+            }
+
+            explicit __hash_table(const allocator_type& a) : __hash_table(0, hasher(), key_equal(), a) {}
+
+            /* A copy has the same capacity and puts every element in the same slot, so the control bytes are copied as they are and no key is
+             * hashed again. */
+            __hash_table(const __hash_table& x, const type_identity_t<allocator_type>& a) : __hash_table(0, x.hf, x.eql, a) {
+                if (x.len != 0) {
+                    copy_slots_from(x, [](const value_type& v) -> const value_type& { return v; });
+                }
+            }
+
+            __hash_table(__hash_table&& x, const type_identity_t<allocator_type>& a) : __hash_table(0, x.hf, x.eql, a) {
+                if (traits_type::is_always_equal::value || alloc == x.alloc) {
+                    steal(x);
+                } else if (x.len != 0) {
+                    copy_slots_from(x, [](value_type& v) -> value_type&& { return move(v); });
+                }
+            }
+
+            __hash_table(initializer_list<value_type> il, size_type n = 0, const hasher& hf = hasher(), const key_equal& eql = key_equal(),
+                const allocator_type& a = allocator_type()) : __hash_table(il.begin(), il.end(), n, hf, eql, a) {}
+
+            __hash_table(size_type n, const allocator_type& a) : __hash_table(n, hasher(), key_equal(), a) {}
+
+            __hash_table(size_type n, const hasher& hf, const allocator_type& a) : __hash_table(n, hf, key_equal(), a) {}
+
+            template<__internal::legacy_input_iterator InputIterator>
+            __hash_table(InputIterator first, InputIterator last, size_type n, const allocator_type& a)
+                : __hash_table(first, last, n, hasher(), key_equal(), a) {}
+
+            template<__internal::legacy_input_iterator InputIterator>
+            __hash_table(InputIterator first, InputIterator last, size_type n, const hasher& hf, const allocator_type& a)
+                : __hash_table(first, last, n, hf, key_equal(), a) {}
+
+            __hash_table(initializer_list<value_type> il, size_type n, const allocator_type& a) : __hash_table(il, n, hasher(), key_equal(), a) {}
+
+            __hash_table(initializer_list<value_type> il, size_type n, const hasher& hf, const allocator_type& a)
+                : __hash_table(il, n, hf, key_equal(), a) {}
+
+            ~__hash_table() {
+                destroy_elements();
+                deallocate_block();
+            }
+
+            __hash_table& operator=(const __hash_table& x) {
+                if (this == addressof(x)) {
+                    return *this;
+                }
+
+                // The copy is made with the allocator this table ends up with, so that the swap below never mixes allocators.
+                if constexpr (traits_type::propagate_on_container_copy_assignment::value) {
+                    __hash_table temp(x, x.alloc);
+                    destroy_elements();
+                    deallocate_block();
+                    alloc = x.alloc;
+                    steal(temp);
+                } else {
+                    __hash_table temp(x, alloc);
+                    swap_contents(temp);
+                }
+                hf = x.hf;
+                eql = x.eql;
+                return *this;
+            }
+
+            __hash_table& operator=(__hash_table&& x)
+            noexcept(allocator_traits<Allocator>::is_always_equal::value && is_nothrow_move_assignable_v<Hash> && is_nothrow_move_assignable_v<Pred>) {
+                if (this == addressof(x)) {
+                    return *this;
+                }
+
+                if (traits_type::propagate_on_container_move_assignment::value || traits_type::is_always_equal::value || alloc == x.alloc) {
+                    destroy_elements();
+                    deallocate_block();
+                    if constexpr (traits_type::propagate_on_container_move_assignment::value) {
+                        alloc = move(x.alloc);
+                    }
+                    steal(x);
+                } else {
+                    // The block of x can't be adopted, as it's owned by an allocator that doesn't compare equal to ours.
+                    __hash_table temp(move(x), alloc);
+                    swap_contents(temp);
+                }
+                hf = move(x.hf);
+                eql = move(x.eql);
+                return *this;
+            }
+
+            __hash_table& operator=(initializer_list<value_type> il) {
+                clear();
+                insert(il.begin(), il.end());
+                return *this;
+            }
+
+            allocator_type get_allocator() const noexcept {
+                return alloc;
+            }
+
+            iterator begin() noexcept {
+                return make_begin<iterator>();
+            }
+
+            const_iterator begin() const noexcept {
+                return make_begin<const_iterator>();
+            }
+
+            iterator end() noexcept {
+                return iterator();
+            }
+
+            const_iterator end() const noexcept {
+                return const_iterator();
+            }
+
+            const_iterator cbegin() const noexcept {
+                return begin();
+            }
+
+            const_iterator cend() const noexcept {
+                return end();
+            }
+
+            [[nodiscard]] bool empty() const noexcept {
+                return len == 0;
+            }
+
+            size_type size() const noexcept {
+                return len;
+            }
+
+            size_type max_size() const noexcept {
+                return min<size_type>(traits_type::max_size(alloc), static_cast<size_type>(numeric_limits<difference_type>::max()));
+            }
+
+            template<class ...Args>
+            pair<iterator, bool> emplace(Args&& ...args) {
+                if constexpr (requires { Policy::key_arg(args...); }) {
+                    return emplace_key(Policy::key_arg(args...), forward<Args>(args)...);
+                } else {
+                    // The key can only be told once the element exists, so the element is built on the side and moved in if its key is new.
+                    temp_value temp(alloc, forward<Args>(args)...);
+                    return emplace_key(Policy::key(*temp.get()), move(*temp.get()));
+                }
+            }
+
+            template<class ...Args>
+            iterator emplace_hint(const_iterator, Args&& ...args) {
+                return emplace(forward<Args>(args)...).first;
+            }
+
+            pair<iterator, bool> insert(const value_type& obj) {
+                return emplace_key(Policy::key(obj), obj);
+            }
+
+            pair<iterator, bool> insert(value_type&& obj) {
+                return emplace_key(Policy::key(obj), move(obj));
+            }
+
+            iterator insert(const_iterator, const value_type& obj) {
+                return insert(obj).first;
+            }
+
+            iterator insert(const_iterator, value_type&& obj) {
+                return insert(move(obj)).first;
+            }
+
+            template<__internal::legacy_input_iterator InputIterator>
+            void insert(InputIterator first, InputIterator last) {
+                for (; first != last; ++first) {
+                    emplace(*first);
+                }
+            }
+
+            void insert(initializer_list<value_type> il) {
+                insert(il.begin(), il.end());
+            }
+
+            iterator erase(iterator position) {
+                iterator next(position.ctrl, position.slot);
+                erase_at(static_cast<size_type>(position.slot - slots));
+                ++next;
+                return next;
+            }
+
+            iterator erase(const_iterator position)
+            requires (!is_same_v<iterator, const_iterator>) {
+                return erase(iterator(position.ctrl, position.slot));
+            }
+
+            size_type erase(const key_type& k) {
+                const size_type i = find_index(k, hash_of(k));
+                if (i == npos) {
+                    return 0;
+                }
+                erase_at(i);
+                return 1;
+            }
+
+            iterator erase(const_iterator first, const_iterator last) {
+                while (first != last) {
+                    const_iterator next = first;
+                    ++next;
+                    erase_at(static_cast<size_type>(first.slot - slots));
+                    first = next;
+                }
+                return iterator(last.ctrl, last.slot);
+            }
+
+            /* Extension: the elements of source whose keys are new to this table are moved into it and erased from source. There are no node
+             * handles to splice, so unlike the standard merge, this moves the elements and invalidates references to them. */
+            template<class H2, class P2>
+            void merge(__hash_table<Policy, H2, P2, Allocator>& source) {
+                for (auto it = source.begin(); it != source.end();) {
+                    if (contains(Policy::key(*it))) {
+                        ++it;
+                    } else {
+                        auto& v = const_cast<value_type&>(*it);
+                        emplace_key(Policy::key(v), move(v));
+                        it = source.erase(it);
+                    }
+                }
+            }
+
+            template<class H2, class P2>
+            void merge(__hash_table<Policy, H2, P2, Allocator>&& source) {
+                merge(source);
+            }
+
+            void swap(__hash_table& x)
+            noexcept(allocator_traits<Allocator>::is_always_equal::value && is_nothrow_swappable_v<Hash> && is_nothrow_swappable_v<Pred>) {
+                if constexpr (traits_type::propagate_on_container_swap::value) {
+                    std::swap(alloc, x.alloc);
+                }
+                std::swap(hf, x.hf);
+                std::swap(eql, x.eql);
+                swap_contents(x);
+            }
+
+            /* Keeps the capacity, so that refilling the table doesn't rehash. */
+            void clear() noexcept {
+                if (len == 0) {
+                    return;
+                }
+                destroy_elements();
+                __builtin_memset(ctrl, __ctrl_empty, cap + __ctrl_group::width);
+                ctrl[cap] = __ctrl_sentinel;
+                len = 0;
+                growth_left = capacity_to_growth(cap);
+            }
+
+            hasher hash_function() const {
+                return hf;
+            }
+
+            key_equal key_eq() const {
+                return eql;
+            }
+
+            iterator find(const key_type& k) {
+                return iterator_at<iterator>(find_index(k, hash_of(k)));
+            }
+
+            const_iterator find(const key_type& k) const {
+                return iterator_at<const_iterator>(find_index(k, hash_of(k)));
+            }
+
+            template<class K>
+            requires __transparent_lookup<Hash, Pred>
+            iterator find(const K& k) {
+                return iterator_at<iterator>(find_index(k, hash_of(k)));
+            }
+
+            template<class K>
+            requires __transparent_lookup<Hash, Pred>
+            const_iterator find(const K& k) const {
+                return iterator_at<const_iterator>(find_index(k, hash_of(k)));
+            }
+
+            size_type count(const key_type& k) const {
+                return find_index(k, hash_of(k)) != npos;
+            }
+
+            template<class K>
+            requires __transparent_lookup<Hash, Pred>
+            size_type count(const K& k) const {
+                return find_index(k, hash_of(k)) != npos;
+            }
+
+            bool contains(const key_type& k) const {
+                return find_index(k, hash_of(k)) != npos;
+            }
+
+            template<class K>
+            requires __transparent_lookup<Hash, Pred>
+            bool contains(const K& k) const {
+                return find_index(k, hash_of(k)) != npos;
+            }
+
+            pair<iterator, iterator> equal_range(const key_type& k) {
+                return make_range(find(k));
+            }
+
+            pair<const_iterator, const_iterator> equal_range(const key_type& k) const {
+                return make_range(find(k));
+            }
+
+            template<class K>
+            requires __transparent_lookup<Hash, Pred>
+            pair<iterator, iterator> equal_range(const K& k) {
+                return make_range(find(k));
+            }
+
+            template<class K>
+            requires __transparent_lookup<Hash, Pred>
+            pair<const_iterator, const_iterator> equal_range(const K& k) const {
+                return make_range(find(k));
+            }
+
+            /* Every slot counts as a bucket, which holds at most one element. */
+            size_type bucket_count() const noexcept {
+                return cap;
+            }
+
+            size_type max_bucket_count() const noexcept {
+                return max_size();
+            }
+
+            float load_factor() const noexcept {
+                return cap == 0 ? 0.0f : static_cast<float>(len) / static_cast<float>(cap);
+            }
+
+            float max_load_factor() const noexcept {
+                return 0.875f;
+            }
+
+            /* Extension: the maximum load factor is fixed at 7/8, which is what the control byte groups are tuned for, so the hint is ignored. */
+            void max_load_factor(float) noexcept {}
+
+            void rehash(size_type n) {
+                if (n == 0 && len == 0) {
+                    destroy_elements();
+                    deallocate_block();
+                    reset_to_empty();
+                    return;
+                }
+
+                const size_type new_cap = normalize_capacity(max(n, growth_to_capacity(len)));
+                if (new_cap != cap) {
+                    resize<false>(new_cap, 0);
+                }
+            }
+
+            void reserve(size_type n) {
+                if (n > len + growth_left) {
+                    if (n > max_size()) [[unlikely]] {
+                        throw length_error("Invalid argument to unordered container reserve.");
+                    }
+                    resize<false>(normalize_capacity(growth_to_capacity(n)), 0);
+                }
+            }
+        protected:
+            /* Inserts an element constructed from args unless key is already in the table. */
+            template<class K, class ...Args>
+            pair<iterator, bool> emplace_key(const K& key, Args&& ...args) {
+                const std::size_t hash = hash_of(key);
+                const size_type i = find_index(key, hash);
+                if (i != npos) {
+                    return { iterator_at<iterator>(i), false };
+                }
+                return { iterator_at<iterator>(emplace_new(hash, forward<Args>(args)...)), true };
+            }
+
+            template<class K>
+            value_type* find_slot(const K& key) const {
+                const size_type i = find_index(key, hash_of(key));
+                return i == npos ? nullptr : slots + i;
+            }
+        private:
+            template<class, class, class, class>
+            friend class __hash_table;
+
+            static constexpr size_type npos = static_cast<size_type>(-1);
+
+            /* An element constructed with the allocator outside of the table, and destroyed on scope exit. */
+            class temp_value {
+            private:
+                Allocator& alloc;
+                alignas(value_type) unsigned char storage[sizeof(value_type)];
+            public:
+                template<class ...Args>
+                temp_value(Allocator& alloc, Args&& ...args) : alloc(alloc) {
+                    traits_type::construct(alloc, get(), forward<Args>(args)...);
+                }
+
+                temp_value(const temp_value&) = delete;
+                temp_value& operator=(const temp_value&) = delete;
+
+                ~temp_value() {
+                    traits_type::destroy(alloc, get());
+                }
+
+                value_type* get() noexcept {
+                    return reinterpret_cast<value_type*>(storage);
+                }
+            };
+
+            [[no_unique_address]] Allocator alloc;
+            [[no_unique_address]] Hash hf;
+            [[no_unique_address]] Pred eql;
+            __ctrl_t* ctrl;
+            value_type* slots;
+            /* The number of slots, either 0 or one less than a power of two. */
+            size_type cap;
+            size_type len;
+            /* The number of empty slots that can still be filled before the load factor reaches 7/8. Tombstones don't count. */
+            size_type growth_left;
+
+            static __ctrl_t* empty_ctrl() noexcept {
+                return const_cast<__ctrl_t*>(__empty_ctrl_group);
+            }
+
+            static size_type normalize_capacity(size_type n) noexcept {
+                return n == 0 ? 1 : numeric_limits<size_type>::max() >> countl_zero(n);
+            }
+
+            /* The load factor is capped at 7/8. A capacity of 7 with 8-slot groups can't go that high, as a lookup must always find an empty
+             * slot to stop at; smaller tables fit in one group along with the empty bytes after the copied control bytes. */
+            static size_type capacity_to_growth(size_type c) noexcept {
+                return __ctrl_group::width == 8 && c == 7 ? 6 : c - c / 8;
+            }
+
+            static size_type growth_to_capacity(size_type n) noexcept {
+                return __ctrl_group::width == 8 && n == 7 ? 8 : n + (n == 0 ? 0 : (n - 1) / 7);
+            }
+
+            static size_type slots_offset(size_type c) noexcept {
+                return (c + __ctrl_group::width + alignof(value_type) - 1) / alignof(value_type) * alignof(value_type);
+            }
+
+            static size_type block_units(size_type c) noexcept {
+                return (slots_offset(c) + c * sizeof(value_type)) / sizeof(block_unit);
+            }
+
+            static __ctrl_t h2(std::size_t hash) noexcept {
+                return static_cast<__ctrl_t>(hash & 0x7f);
+            }
+
+            template<class K>
+            std::size_t hash_of(const K& key) const {
+                return __mix_hash(hf(key));
+            }
+
+            /* Allocates the block for c slots, all of them empty. The current block is left to the caller. */
+            void allocate_block(size_type c) {
+                block_allocator ba(alloc);
+                unsigned char* const block = reinterpret_cast<unsigned char*>(block_traits::allocate(ba, block_units(c)));
+                ctrl = reinterpret_cast<__ctrl_t*>(block);
+                slots = reinterpret_cast<value_type*>(block + slots_offset(c));
+                cap = c;
+                growth_left = capacity_to_growth(c);
+                __builtin_memset(ctrl, __ctrl_empty, c + __ctrl_group::width);
+                ctrl[c] = __ctrl_sentinel;
+            }
+
+            void deallocate_block() noexcept {
+                if (cap != 0) {
+                    block_allocator ba(alloc);
+                    block_traits::deallocate(ba, reinterpret_cast<block_unit*>(ctrl), block_units(cap));
+                }
+            }
+
+            void reset_to_empty() noexcept {
+                ctrl = empty_ctrl();
+                slots = nullptr;
+                cap = 0;
+                len = 0;
+                growth_left = 0;
+            }
+
+            void destroy_elements() noexcept {
+                if constexpr (!is_trivially_destructible_v<value_type> || requires (Allocator& a, value_type* p) { a.destroy(p); }) {
+                    for (size_type i = 0; len != 0 && i < cap; i++) {
+                        if (ctrl[i] >= 0) {
+                            traits_type::destroy(alloc, slots + i);
+                        }
+                    }
+                }
+            }
+
+            void steal(__hash_table& x) noexcept {
+                ctrl = x.ctrl;
+                slots = x.slots;
+                cap = x.cap;
+                len = x.len;
+                growth_left = x.growth_left;
+                x.reset_to_empty();
+            }
+
+            void swap_contents(__hash_table& x) noexcept {
+                std::swap(ctrl, x.ctrl);
+                std::swap(slots, x.slots);
+                std::swap(cap, x.cap);
+                std::swap(len, x.len);
+                std::swap(growth_left, x.growth_left);
+            }
+
+            /* Takes over the layout of x, constructing each element from get(element of x) in the slot it has in x. */
+            template<class Table, class Get>
+            void copy_slots_from(Table& x, Get get) {
+                allocate_block(x.cap);
+                size_type i = 0;
+                try {
+                    for (; i < x.cap; i++) {
+                        if (x.ctrl[i] >= 0) {
+                            traits_type::construct(alloc, slots + i, get(x.slots[i]));
+                        }
+                    }
+                } catch (...) {
+                    for (size_type j = 0; j < i; j++) {
+                        if (x.ctrl[j] >= 0) {
+                            traits_type::destroy(alloc, slots + j);
+                        }
+                    }
+                    deallocate_block();
+                    reset_to_empty();
+                    throw;
+                }
+                __builtin_memcpy(ctrl, x.ctrl, x.cap + __ctrl_group::width);
+                len = x.len;
+                growth_left = x.growth_left;
+            }
+
+            /* Sets the control byte of slot i, and its copy after the sentinel if it's among the first group's worth of slots. For the others,
+             * the second store writes the same byte again, which is cheaper than a branch. */
+            void set_ctrl(size_type i, __ctrl_t h) noexcept {
+                ctrl[i] = h;
+                ctrl[((i - (__ctrl_group::width - 1)) & cap) + ((__ctrl_group::width - 1) & cap)] = h;
+            }
+
+            template<class K>
+            size_type find_index(const K& key, std::size_t hash) const {
+                __probe_seq seq(hash, cap);
+                const __ctrl_t h = h2(hash);
+                while (true) {
+                    const __ctrl_group g(ctrl + seq.offset);
+                    for (const int i : g.match(h)) {
+                        const size_type index = (seq.offset + i) & cap;
+                        if (eql(key, Policy::key(slots[index]))) [[likely]] {
+                            return index;
+                        }
+                    }
+                    if (g.mask_empty()) [[likely]] {
+                        return npos;
+                    }
+                    seq.next();
+                }
+            }
+
+            /* The first empty or deleted slot on the probe sequence of hash. The table must have one. */
+            size_type find_first_non_full(std::size_t hash) const noexcept {
+                __probe_seq seq(hash, cap);
+                while (true) {
+                    const auto mask = __ctrl_group(ctrl + seq.offset).mask_empty_or_deleted();
+                    if (mask) {
+                        return (seq.offset + mask.lowest()) & cap;
+                    }
+                    seq.next();
+                }
+            }
+
+            /* Constructs a new element with the given hash from args, growing the table if it's out of empty slots, and returns its slot. */
+            template<class ...Args>
+            size_type emplace_new(std::size_t hash, Args&& ...args) {
+                const size_type i = find_first_non_full(hash);
+                if (growth_left == 0 && ctrl[i] != __ctrl_deleted) [[unlikely]] {
+                    return resize<true>(next_capacity(), hash, forward<Args>(args)...);
+                }
+
+                traits_type::construct(alloc, slots + i, forward<Args>(args)...);
+                growth_left -= ctrl[i] == __ctrl_empty;
+                set_ctrl(i, h2(hash));
+                len++;
+                return i;
+            }
+
+            /* A table that ran out of empty slots mostly because of tombstones is rehashed at the same capacity, which clears them. */
+            size_type next_capacity() const noexcept {
+                if (cap > __ctrl_group::width && len * 32 <= cap * 25) {
+                    return cap;
+                }
+                return cap * 2 + 1;
+            }
+
+            /* Moves the elements to a new block of new_cap slots. With Emplace, a new element with the given hash is first constructed from
+             * args in the new block, while any element that args refer to is still in place, and its slot is returned. If anything but the
+             * hash function throws, the table is left as it was. */
+            template<bool Emplace, class ...Args>
+            size_type resize(size_type new_cap, std::size_t hash, Args&& ...args) {
+                __ctrl_t* const old_ctrl = ctrl;
+                value_type* const old_slots = slots;
+                const size_type old_cap = cap;
+                const size_type old_growth_left = growth_left;
+
+                allocate_block(new_cap);
+                size_type index = npos;
+                try {
+                    if constexpr (Emplace) {
+                        const size_type i = find_first_non_full(hash);
+                        traits_type::construct(alloc, slots + i, forward<Args>(args)...);
+                        set_ctrl(i, h2(hash));
+                        growth_left--;
+                        index = i;
+                    }
+                    transfer_from(old_ctrl, old_slots, old_cap);
+                } catch (...) {
+                    // The elements were copied, so the originals are all still in place.
+                    if constexpr (relocates_bitwise) {
+                        if (index != npos) {
+                            traits_type::destroy(alloc, slots + index);
+                        }
+                    } else {
+                        for (size_type i = 0; i < cap; i++) {
+                            if (ctrl[i] >= 0) {
+                                traits_type::destroy(alloc, slots + i);
+                            }
+                        }
+                    }
+                    deallocate_block();
+                    ctrl = old_ctrl;
+                    slots = old_slots;
+                    cap = old_cap;
+                    growth_left = old_growth_left;
+                    throw;
+                }
+
+                if constexpr (!relocates_bitwise) {
+                    for (size_type i = 0; i < old_cap; i++) {
+                        if (old_ctrl[i] >= 0) {
+                            traits_type::destroy(alloc, old_slots + i);
+                        }
+                    }
+                }
+                if (old_cap != 0) {
+                    block_allocator ba(alloc);
+                    block_traits::deallocate(ba, reinterpret_cast<block_unit*>(old_ctrl), block_units(old_cap));
+                }
+                len += Emplace;
+                return index;
+            }
+
+            /* Puts a copy of every element of the old block into the current one. Trivially relocatable elements are copied bitwise, which
+             * ends the lifetime of the originals once their block is freed; the others are left for the caller to destroy. */
+            void transfer_from(const __ctrl_t* old_ctrl, value_type* old_slots, size_type old_cap) {
+                size_type moved = 0;
+                for (size_type i = 0; i < old_cap; i++) {
+                    if (old_ctrl[i] >= 0) {
+                        const std::size_t hash = hash_of(Policy::key(old_slots[i]));
+                        const size_type j = find_first_non_full(hash);
+                        if constexpr (relocates_bitwise) {
+                            __builtin_memcpy(static_cast<void*>(slots + j), static_cast<const void*>(old_slots + i), sizeof(value_type));
+                        } else {
+                            traits_type::construct(alloc, slots + j, move_if_noexcept(old_slots[i]));
+                        }
+                        set_ctrl(j, h2(hash));
+                        moved++;
+                    }
+                }
+                growth_left -= moved;
+            }
+
+            /* An erased slot can become empty again if no probe sequence ever had to go past it, i.e. if it was never part of a full group.
+             * Every group containing slot i includes either the slot right after the last empty one before i or the first empty one after
+             * it, so it's enough to check that those are less than a group apart. */
+            void erase_at(size_type i) noexcept {
+                traits_type::destroy(alloc, slots + i);
+                len--;
+
+                const size_type before = (i - __ctrl_group::width) & cap;
+                const auto empty_after = __ctrl_group(ctrl + i).mask_empty();
+                const auto empty_before = __ctrl_group(ctrl + before).mask_empty();
+                const bool was_never_full = empty_before && empty_after
+                    && static_cast<size_type>(empty_after.trailing_zeros() + empty_before.leading_zeros()) < __ctrl_group::width;
+                set_ctrl(i, was_never_full ? __ctrl_empty : __ctrl_deleted);
+                growth_left += was_never_full;
+            }
+
+            template<class It>
+            It iterator_at(size_type i) const noexcept {
+                return i == npos ? It() : It(ctrl + i, slots + i);
+            }
+
+            template<class It>
+            It make_begin() const noexcept {
+                if (len == 0) {
+                    return It();
+                }
+                It it(ctrl, slots);
+                it.skip_empty_or_deleted();
+                return it;
+            }
+
+            template<class It>
+            static pair<It, It> make_range(It it) noexcept {
+                if (it == It()) {
+                    return { it, it };
+                }
+                It next = it;
+                ++next;
+                return { it, next };
+            }
+        };
+
+        /* The tables are equal if they have the same size and every element of x has an equal element in y under the key lookup of y. */
+        template<class Policy, class Hash, class Pred, class Allocator>
+        bool __hash_table_equal(const __hash_table<Policy, Hash, Pred, Allocator>& x, const __hash_table<Policy, Hash, Pred, Allocator>& y) {
+            if (x.size() != y.size()) {
+                return false;
+            }
+
+            for (const auto& v : x) {
+                const auto it = y.find(Policy::key(v));
+                if (it == y.end() || !(*it == v)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<class Policy, class Hash, class Pred, class Allocator, class Predicate>
+        typename __hash_table<Policy, Hash, Pred, Allocator>::size_type __hash_table_erase_if(__hash_table<Policy, Hash, Pred, Allocator>& c,
+            Predicate pred) {
+            const auto old_size = c.size();
+            for (auto it = c.begin(); it != c.end();) {
+                if (pred(*it)) {
+                    it = c.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            return old_size - c.size();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+// Declares how the associative containers get the key of an element, and when their comparison is transparent.
+
+#pragma once
+
+#include "concepts.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+
+namespace std {
+    namespace __internal {
+        template<class Compare>
+        concept __transparent_compare = requires { typename Compare::is_transparent; };
+
+        template<class Key>
+        struct __set_policy {
+            using key_type = Key;
+            using value_type = Key;
+
+            static const Key& key(const value_type& v) noexcept {
+                return v;
+            }
+
+            /* The key of the element that emplace would construct from the arguments, if it can be told without constructing it. */
+            template<class K>
+            requires same_as<remove_cvref_t<K>, Key>
+            static const Key& key_arg(const K& k) noexcept {
+                return k;
+            }
+        };
+
+        template<class Key, class T>
+        struct __map_policy {
+            using key_type = Key;
+            using mapped_type = T;
+            using value_type = pair<const Key, T>;
+
+            static const Key& key(const value_type& v) noexcept {
+                return v.first;
+            }
+
+            template<class K, class V>
+            requires same_as<remove_cvref_t<K>, Key>
+            static const Key& key_arg(const K& k, const V&) noexcept {
+                return k;
+            }
+
+            template<class P>
+            requires requires { typename P::first_type; typename P::second_type; } && same_as<remove_cvref_t<typename P::first_type>, Key>
+            static const Key& key_arg(const P& p) noexcept {
+                return p.first;
+            }
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,1521 @@
+// Declares the red-black tree that <map> and <set> are built on.
+
+#pragma once
+
+#include "__key_policy.hpp"
+#include "compare.hpp"
+#include "cstddef.hpp"
+#include "initializer_list.hpp"
+#include "iterator.hpp"
+#include "limits.hpp"
+#include "memory.hpp"
+#include "new.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+
+namespace std {
+    namespace __internal {
+        /* The links of a node. The tree also has a header node, whose parent is the root and whose left and right are the leftmost and
+         * rightmost nodes, so that begin() and end() are one load each and insertions at either end find their place without a search.
+         * The header is the past-the-end position. It's red and the root is always black, which is how decrementing tells it apart from
+         * the root, the only other node that is the parent of its parent. */
+        struct __tree_node_base {
+            __tree_node_base* parent;
+            __tree_node_base* left;
+            __tree_node_base* right;
+            bool red;
+        };
+
+        inline __tree_node_base* __tree_min(__tree_node_base* x) noexcept {
+            while (x->left != nullptr) {
+                x = x->left;
+            }
+            return x;
+        }
+
+        inline __tree_node_base* __tree_max(__tree_node_base* x) noexcept {
+            while (x->right != nullptr) {
+                x = x->right;
+            }
+            return x;
+        }
+
+        inline __tree_node_base* __tree_next(__tree_node_base* x) noexcept {
+            if (x->right != nullptr) {
+                return __tree_min(x->right);
+            }
+
+            __tree_node_base* p = x->parent;
+            while (x == p->right) {
+                x = p;
+                p = p->parent;
+            }
+            // Going up from the rightmost node when the root has no right child ends with x at the header and p at the root.
+            return x->right != p ? p : x;
+        }
+
+        inline __tree_node_base* __tree_prev(__tree_node_base* x) noexcept {
+            if (x->red && x->parent->parent == x) {
+                return x->right;
+            }
+            if (x->left != nullptr) {
+                return __tree_max(x->left);
+            }
+
+            __tree_node_base* p = x->parent;
+            while (x == p->left) {
+                x = p;
+                p = p->parent;
+            }
+            return p;
+        }
+
+        inline void __tree_rotate_left(__tree_node_base* x, __tree_node_base*& root) noexcept {
+            __tree_node_base* const y = x->right;
+            x->right = y->left;
+            if (y->left != nullptr) {
+                y->left->parent = x;
+            }
+            y->parent = x->parent;
+            if (x == root) {
+                root = y;
+            } else if (x == x->parent->left) {
+                x->parent->left = y;
+            } else {
+                x->parent->right = y;
+            }
+            y->left = x;
+            x->parent = y;
+        }
+
+        inline void __tree_rotate_right(__tree_node_base* x, __tree_node_base*& root) noexcept {
+            __tree_node_base* const y = x->left;
+            x->left = y->right;
+            if (y->right != nullptr) {
+                y->right->parent = x;
+            }
+            y->parent = x->parent;
+            if (x == root) {
+                root = y;
+            } else if (x == x->parent->right) {
+                x->parent->right = y;
+            } else {
+                x->parent->left = y;
+            }
+            y->right = x;
+            x->parent = y;
+        }
+
+        /* Links x as the left or right child of parent, which must not have one yet, and restores the red-black invariants with at most two
+         * rotations. parent is the header if the tree is empty. */
+        inline void __tree_insert_and_rebalance(bool left, __tree_node_base* x, __tree_node_base* parent, __tree_node_base& header) noexcept {
+            __tree_node_base*& root = header.parent;
+            x->parent = parent;
+            x->left = nullptr;
+            x->right = nullptr;
+            x->red = true;
+
+            if (left) {
+                parent->left = x;
+                if (parent == &header) {
+                    header.parent = x;
+                    header.right = x;
+                } else if (parent == header.left) {
+                    header.left = x;
+                }
+            } else {
+                parent->right = x;
+                if (parent == header.right) {
+                    header.right = x;
+                }
+            }
+
+            while (x != root && x->parent->red) {
+                __tree_node_base* const grandparent = x->parent->parent;
+                if (x->parent == grandparent->left) {
+                    __tree_node_base* const uncle = grandparent->right;
+                    if (uncle != nullptr && uncle->red) {
+                        x->parent->red = false;
+                        uncle->red = false;
+                        grandparent->red = true;
+                        x = grandparent;
+                    } else {
+                        if (x == x->parent->right) {
+                            x = x->parent;
+                            __tree_rotate_left(x, root);
+                        }
+                        x->parent->red = false;
+                        grandparent->red = true;
+                        __tree_rotate_right(grandparent, root);
+                    }
+                } else {
+                    __tree_node_base* const uncle = grandparent->left;
+                    if (uncle != nullptr && uncle->red) {
+                        x->parent->red = false;
+                        uncle->red = false;
+                        grandparent->red = true;
+                        x = grandparent;
+                    } else {
+                        if (x == x->parent->left) {
+                            x = x->parent;
+                            __tree_rotate_right(x, root);
+                        }
+                        x->parent->red = false;
+                        grandparent->red = true;
+                        __tree_rotate_left(grandparent, root);
+                    }
+                }
+            }
+            root->red = false;
+        }
+
+        /* Unlinks z and restores the red-black invariants with at most three rotations. A node with two children is replaced by its
+         * successor, which is relinked rather than having its element moved, so that no other node changes and z can be handed out as it is,
+         * e.g. in a node handle. */
+        inline void __tree_erase_and_rebalance(__tree_node_base* z, __tree_node_base& header) noexcept {
+            __tree_node_base*& root = header.parent;
+            __tree_node_base* y = z;
+            __tree_node_base* x = nullptr;
+            __tree_node_base* x_parent = nullptr;
+
+            if (y->left == nullptr) {
+                x = y->right;
+            } else if (y->right == nullptr) {
+                x = y->left;
+            } else {
+                y = __tree_min(y->right);
+                x = y->right;
+            }
+
+            if (y != z) {
+                // y is the successor of z, which it replaces. It has no left child, and x takes its place.
+                z->left->parent = y;
+                y->left = z->left;
+                if (y != z->right) {
+                    x_parent = y->parent;
+                    if (x != nullptr) {
+                        x->parent = y->parent;
+                    }
+                    y->parent->left = x;
+                    y->right = z->right;
+                    z->right->parent = y;
+                } else {
+                    x_parent = y;
+                }
+
+                if (root == z) {
+                    root = y;
+                } else if (z->parent->left == z) {
+                    z->parent->left = y;
+                } else {
+                    z->parent->right = y;
+                }
+                y->parent = z->parent;
+                std::swap(y->red, z->red);
+                // z, with the color of the position that y left, is what's missing from the tree now.
+            } else {
+                x_parent = y->parent;
+                if (x != nullptr) {
+                    x->parent = y->parent;
+                }
+
+                if (root == z) {
+                    root = x;
+                } else if (z->parent->left == z) {
+                    z->parent->left = x;
+                } else {
+                    z->parent->right = x;
+                }
+
+                // z has at most one child, so if it's at either end, its replacement is either its child or its parent.
+                if (header.left == z) {
+                    header.left = z->right == nullptr ? z->parent : __tree_min(x);
+                }
+                if (header.right == z) {
+                    header.right = z->left == nullptr ? z->parent : __tree_max(x);
+                }
+            }
+
+            if (z->red) {
+                return;
+            }
+
+            // The path through x is one black node short.
+            while (x != root && (x == nullptr || !x->red)) {
+                if (x == x_parent->left) {
+                    __tree_node_base* w = x_parent->right;
+                    if (w->red) {
+                        w->red = false;
+                        x_parent->red = true;
+                        __tree_rotate_left(x_parent, root);
+                        w = x_parent->right;
+                    }
+                    if ((w->left == nullptr || !w->left->red) && (w->right == nullptr || !w->right->red)) {
+                        w->red = true;
+                        x = x_parent;
+                        x_parent = x_parent->parent;
+                    } else {
+                        if (w->right == nullptr || !w->right->red) {
+                            w->left->red = false;
+                            w->red = true;
+                            __tree_rotate_right(w, root);
+                            w = x_parent->right;
+                        }
+                        w->red = x_parent->red;
+                        x_parent->red = false;
+                        if (w->right != nullptr) {
+                            w->right->red = false;
+                        }
+                        __tree_rotate_left(x_parent, root);
+                        break;
+                    }
+                } else {
+                    __tree_node_base* w = x_parent->left;
+                    if (w->red) {
+                        w->red = false;
+                        x_parent->red = true;
+                        __tree_rotate_right(x_parent, root);
+                        w = x_parent->left;
+                    }
+                    if ((w->right == nullptr || !w->right->red) && (w->left == nullptr || !w->left->red)) {
+                        w->red = true;
+                        x = x_parent;
+                        x_parent = x_parent->parent;
+                    } else {
+                        if (w->left == nullptr || !w->left->red) {
+                            w->right->red = false;
+                            w->red = true;
+                            __tree_rotate_left(w, root);
+                            w = x_parent->left;
+                        }
+                        w->red = x_parent->red;
+                        x_parent->red = false;
+                        if (w->left != nullptr) {
+                            w->left->red = false;
+                        }
+                        __tree_rotate_right(x_parent, root);
+                        break;
+                    }
+                }
+            }
+            if (x != nullptr) {
+                x->red = false;
+            }
+        }
+
+        /* The number of black nodes on every path from x down to a null link, or 0 if the paths disagree, a red node has a red child, or a
+         * child doesn't link back to its parent. count is increased by the number of nodes below x, including x. */
+        inline std::size_t __tree_black_height(const __tree_node_base* x, const __tree_node_base* parent, std::size_t& count) noexcept {
+            if (x == nullptr) {
+                return 1;
+            }
+            if (x->parent != parent || (x->red && ((x->left != nullptr && x->left->red) || (x->right != nullptr && x->right->red)))) {
+                return 0;
+            }
+            ++count;
+            const std::size_t left = __tree_black_height(x->left, x, count);
+            const std::size_t right = __tree_black_height(x->right, x, count);
+            return left == 0 || left != right ? 0 : left + !x->red;
+        }
+
+        /* Whether the links and colours below header make a red-black tree of size nodes, with the header set up as described for
+         * __tree_node_base. Nothing in the library calls this; it's for tests, which reach it through __tree::invariant. */
+        inline bool __tree_invariant(const __tree_node_base& header, std::size_t size) noexcept {
+            if (!header.red) {
+                return false;
+            }
+            const __tree_node_base* const root = header.parent;
+            if (root == nullptr) {
+                return size == 0 && header.left == &header && header.right == &header;
+            }
+            std::size_t count = 0;
+            return !root->red && __tree_black_height(root, &header, count) != 0 && count == size
+                && header.left == __tree_min(const_cast<__tree_node_base*>(root)) && header.right == __tree_max(const_cast<__tree_node_base*>(root));
+        }
+
+        /* The element lives in a union so that the links can be set up on their own. The tree constructs and destroys it through the
+         * allocator of the container. */
+        template<class Value>
+        struct __tree_node : __tree_node_base {
+            union {
+                Value value;
+            };
+
+            __tree_node() noexcept {}
+            ~__tree_node() {}
+        };
+
+        template<class Policy, class Compare, class Allocator, bool Multi>
+        class __tree;
+
+        template<class Value, bool Const>
+        class __tree_iterator {
+        private:
+            template<class, class, class, bool>
+            friend class __tree;
+
+            template<class, bool>
+            friend class __tree_iterator;
+
+            __tree_node_base* node;
+
+            explicit __tree_iterator(__tree_node_base* node) noexcept : node(node) {}
+        public:
+            using value_type = Value;
+            using difference_type = std::ptrdiff_t;
+            using reference = conditional_t<Const, const Value&, Value&>;
+            using pointer = conditional_t<Const, const Value*, Value*>;
+            using iterator_category = bidirectional_iterator_tag;
+
+            __tree_iterator() noexcept : node(nullptr) {}
+
+            template<bool OtherConst>
+            requires Const && (!OtherConst)
+            __tree_iterator(const __tree_iterator<Value, OtherConst>& other) noexcept : node(other.node) {}
+
+            reference operator*() const noexcept {
+                return static_cast<__tree_node<Value>*>(node)->value;
+            }
+
+            pointer operator->() const noexcept {
+                return addressof(static_cast<__tree_node<Value>*>(node)->value);
+            }
+
+            __tree_iterator& operator++() noexcept {
+                node = __tree_next(node);
+                return *this;
+            }
+
+            __tree_iterator operator++(int) noexcept {
+                const __tree_iterator temp = *this;
+                node = __tree_next(node);
+                return temp;
+            }
+
+            __tree_iterator& operator--() noexcept {
+                node = __tree_prev(node);
+                return *this;
+            }
+
+            __tree_iterator operator--(int) noexcept {
+                const __tree_iterator temp = *this;
+                node = __tree_prev(node);
+                return temp;
+            }
+
+            friend bool operator==(const __tree_iterator& x, const __tree_iterator& y) noexcept {
+                return x.node == y.node;
+            }
+        };
+
+        template<class Policy>
+        struct __node_handle_types {
+            using value_type = typename Policy::value_type;
+        };
+
+        template<class Policy>
+        requires requires { typename Policy::mapped_type; }
+        struct __node_handle_types<Policy> {
+            using key_type = typename Policy::key_type;
+            using mapped_type = typename Policy::mapped_type;
+        };
+
+        /* 22.2.4 Node handles
+         *
+         * Owns a node extracted from a tree, along with a copy of the allocator of the tree, which is alive exactly when there's a node. The
+         * node type depends only on the elements and the allocator, so a node can move between a map and a multimap, and between containers
+         * with different comparisons. */
+        template<class Policy, class Allocator>
+        class __tree_node_handle : public __node_handle_types<Policy> {
+        private:
+            template<class, class, class, bool>
+            friend class __tree;
+
+            using traits_type = allocator_traits<Allocator>;
+            using node = __tree_node<typename Policy::value_type>;
+            using node_allocator = typename traits_type::template rebind_alloc<node>;
+            using node_traits = allocator_traits<node_allocator>;
+
+            static constexpr bool is_map = requires { typename Policy::mapped_type; };
+
+            node* ptr;
+            union {
+                Allocator alloc;
+            };
+
+            __tree_node_handle(node* ptr, const Allocator& a) noexcept : ptr(ptr) {
+                construct_at(addressof(alloc), a);
+            }
+
+            /* Gives up the node without destroying it. */
+            node* release() noexcept {
+                node* const n = ptr;
+                alloc.~Allocator();
+                ptr = nullptr;
+                return n;
+            }
+
+            void destroy_node() noexcept {
+                traits_type::destroy(alloc, addressof(ptr->value));
+                node_allocator na(alloc);
+                node_traits::deallocate(na, ptr, 1);
+            }
+        public:
+            using allocator_type = Allocator;
+
+            constexpr __tree_node_handle() noexcept : ptr(nullptr) {}
+
+            __tree_node_handle(__tree_node_handle&& nh) noexcept : ptr(nh.ptr) {
+                if (ptr != nullptr) {
+                    construct_at(addressof(alloc), move(nh.alloc));
+                    nh.release();
+                }
+            }
+
+            /* The allocator is taken from nh if this handle is empty or the allocator propagates on move assignment; otherwise the two must
+             * compare equal. */
+            __tree_node_handle& operator=(__tree_node_handle&& nh) noexcept(traits_type::propagate_on_container_move_assignment::value
+                || traits_type::is_always_equal::value) {
+                if (this == addressof(nh)) {
+                    return *this;
+                }
+
+                const bool had_node = ptr != nullptr;
+                if (had_node) {
+                    destroy_node();
+                }
+                if (nh.ptr != nullptr) {
+                    if (!had_node) {
+                        construct_at(addressof(alloc), move(nh.alloc));
+                    } else if constexpr (traits_type::propagate_on_container_move_assignment::value) {
+                        alloc = move(nh.alloc);
+                    }
+                    ptr = nh.ptr;
+                    nh.release();
+                } else if (had_node) {
+                    alloc.~Allocator();
+                    ptr = nullptr;
+                }
+                return *this;
+            }
+
+            ~__tree_node_handle() {
+                if (ptr != nullptr) {
+                    destroy_node();
+                    alloc.~Allocator();
+                }
+            }
+
+            typename Policy::value_type& value() const
+            requires (!is_map) {
+                return ptr->value;
+            }
+
+            // The key is const in the element, but a node outside of any container may have it changed before it's inserted again.
+            auto& key() const
+            requires is_map {
+                return const_cast<typename Policy::key_type&>(ptr->value.first);
+            }
+
+            auto& mapped() const
+            requires is_map {
+                return ptr->value.second;
+            }
+
+            allocator_type get_allocator() const {
+                return alloc;
+            }
+
+            explicit operator bool() const noexcept {
+                return ptr != nullptr;
+            }
+
+            [[nodiscard]] bool empty() const noexcept {
+                return ptr == nullptr;
+            }
+
+            void swap(__tree_node_handle& nh) noexcept(traits_type::propagate_on_container_swap::value || traits_type::is_always_equal::value) {
+                if (ptr != nullptr && nh.ptr != nullptr) {
+                    if constexpr (traits_type::propagate_on_container_swap::value) {
+                        std::swap(alloc, nh.alloc);
+                    }
+                    std::swap(ptr, nh.ptr);
+                } else if (ptr != nullptr) {
+                    construct_at(addressof(nh.alloc), move(alloc));
+                    nh.ptr = release();
+                } else if (nh.ptr != nullptr) {
+                    construct_at(addressof(alloc), move(nh.alloc));
+                    ptr = nh.release();
+                }
+            }
+
+            friend void swap(__tree_node_handle& x, __tree_node_handle& y) noexcept(noexcept(x.swap(y))) {
+                x.swap(y);
+            }
+        };
+
+        /* 22.2.6 Insert return type */
+        template<class Iterator, class NodeType>
+        struct __insert_return_type {
+            Iterator position;
+            bool inserted;
+            NodeType node;
+        };
+
+        /* A red-black tree of nodes holding one element each, ordered by the keys of the elements under Compare. With Multi, equivalent keys
+         * are allowed and kept in the order they were inserted in.
+         *
+         * Each node is allocated on its own through the allocator rebound to the node type, so the node memory comes from wherever the
+         * allocator gets it: a pmr container over an unsynchronized_pool_resource takes its nodes from fixed-size pools and gives them back
+         * there. Assigning to a tree reuses its nodes for the new elements before it allocates any. Nodes don't move, so iterators and
+         * references stay valid until their element is erased, and extract, insert of a node handle and merge relink nodes without
+         * allocating or touching the elements. */
+        template<class Policy, class Compare, class Allocator, bool Multi>
+        class __tree {
+        private:
+            static_assert(is_same_v<typename Allocator::value_type, typename Policy::value_type>);
+            static_assert(is_same_v<typename allocator_traits<Allocator>::pointer, typename Policy::value_type*>,
+                "The nodes link to each other with raw pointers, which needs an allocator that uses them.");
+
+            using traits_type = allocator_traits<Allocator>;
+            using node = __tree_node<typename Policy::value_type>;
+            using node_allocator = typename traits_type::template rebind_alloc<node>;
+            using node_traits = allocator_traits<node_allocator>;
+        public:
+            using key_type = typename Policy::key_type;
+            using value_type = typename Policy::value_type;
+            using key_compare = Compare;
+            using allocator_type = Allocator;
+            using pointer = typename allocator_traits<Allocator>::pointer;
+            using const_pointer = typename allocator_traits<Allocator>::const_pointer;
+            using reference = value_type&;
+            using const_reference = const value_type&;
+            using size_type = typename allocator_traits<Allocator>::size_type;
+            using difference_type = typename allocator_traits<Allocator>::difference_type;
+            // The elements of a set are its keys, so neither of its iterators may modify them.
+            using iterator = __tree_iterator<value_type, is_same_v<key_type, value_type>>;
+            using const_iterator = __tree_iterator<value_type, true>;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+            using node_type = __tree_node_handle<Policy, Allocator>;
+
+            __tree() : __tree(Compare()) {}
+
+            explicit __tree(const Compare& comp, const Allocator& a = Allocator())
+                : alloc(a), compare(comp), header{ nullptr, &header, &header, true }, len(0) {}
+
+            template<__internal::legacy_input_iterator InputIterator>
+            __tree(InputIterator first, InputIterator last, const Compare& comp = Compare(), const Allocator& a = Allocator()) : __tree(comp, a) {
+                insert(first, last);
+            }
+
+            __tree(const __tree& x) : __tree(x, traits_type::select_on_container_copy_construction(x.alloc)) {}
+
+            __tree(__tree&& x) noexcept : alloc(move(x.alloc)), compare(move(x.compare)), header{ nullptr, &header, &header, true }, len(0) {
+                steal(x);
+            }
+
+            explicit __tree(const Allocator& a) : __tree(Compare(), a) {}
+
+            /* A copy has the shape and the colors of x, so no key is compared. */
+            __tree(const __tree& x, const type_identity_t<Allocator>& a) : __tree(x.compare, a) {
+                if (x.len != 0) {
+                    clone_from(x, [this](__tree_node_base* n) { return make_node(value_of(n)); });
+                }
+            }
+
+            __tree(__tree&& x, const type_identity_t<Allocator>& a) : __tree(x.compare, a) {
+                if (traits_type::is_always_equal::value || alloc == x.alloc) {
+                    steal(x);
+                } else if (x.len != 0) {
+                    clone_from(x, [this](__tree_node_base* n) { return make_node(move(value_of(n))); });
+                }
+            }
+
+            __tree(initializer_list<value_type> il, const Compare& comp = Compare(), const Allocator& a = Allocator())
+                : __tree(il.begin(), il.end(), comp, a) {}
+
+            template<__internal::legacy_input_iterator InputIterator>
+            __tree(InputIterator first, InputIterator last, const Allocator& a) : __tree(first, last, Compare(), a) {}
+
+            __tree(initializer_list<value_type> il, const Allocator& a) : __tree(il, Compare(), a) {}
+
+            ~__tree() {
+                destroy_subtree(header.parent);
+            }
+
+            __tree& operator=(const __tree& x) {
+                if (this == addressof(x)) {
+                    return *this;
+                }
+
+                if constexpr (traits_type::propagate_on_container_copy_assignment::value) {
+                    // The nodes can only be reused if the allocator that gets them back could have made them.
+                    if (!traits_type::is_always_equal::value && alloc != x.alloc) {
+                        clear();
+                    }
+                    alloc = x.alloc;
+                }
+                compare = x.compare;
+                node_recycler recycler(*this);
+                if (x.len != 0) {
+                    clone_from(x, [&recycler](__tree_node_base* n) { return recycler.get(value_of(n)); });
+                }
+                return *this;
+            }
+
+            __tree& operator=(__tree&& x) noexcept(allocator_traits<Allocator>::is_always_equal::value && is_nothrow_move_assignable_v<Compare>) {
+                if (this == addressof(x)) {
+                    return *this;
+                }
+
+                compare = move(x.compare);
+                if (traits_type::propagate_on_container_move_assignment::value || traits_type::is_always_equal::value || alloc == x.alloc) {
+                    clear();
+                    if constexpr (traits_type::propagate_on_container_move_assignment::value) {
+                        alloc = move(x.alloc);
+                    }
+                    steal(x);
+                } else {
+                    // The nodes of x can't be adopted, as they're owned by an allocator that doesn't compare equal to ours.
+                    node_recycler recycler(*this);
+                    if (x.len != 0) {
+                        clone_from(x, [&recycler](__tree_node_base* n) { return recycler.get(move(value_of(n))); });
+                    }
+                    x.clear();
+                }
+                return *this;
+            }
+
+            __tree& operator=(initializer_list<value_type> il) {
+                node_recycler recycler(*this);
+                for (const value_type& v : il) {
+                    insert_node(cend(), recycler.get(v));
+                }
+                return *this;
+            }
+
+            allocator_type get_allocator() const noexcept {
+                return alloc;
+            }
+
+            iterator begin() noexcept {
+                return iterator(header.left);
+            }
+
+            const_iterator begin() const noexcept {
+                return const_iterator(header.left);
+            }
+
+            iterator end() noexcept {
+                return iterator(&header);
+            }
+
+            const_iterator end() const noexcept {
+                return const_iterator(end_node());
+            }
+
+            reverse_iterator rbegin() noexcept {
+                return reverse_iterator(end());
+            }
+
+            const_reverse_iterator rbegin() const noexcept {
+                return const_reverse_iterator(end());
+            }
+
+            reverse_iterator rend() noexcept {
+                return reverse_iterator(begin());
+            }
+
+            const_reverse_iterator rend() const noexcept {
+                return const_reverse_iterator(begin());
+            }
+
+            const_iterator cbegin() const noexcept {
+                return begin();
+            }
+
+            const_iterator cend() const noexcept {
+                return end();
+            }
+
+            const_reverse_iterator crbegin() const noexcept {
+                return rbegin();
+            }
+
+            const_reverse_iterator crend() const noexcept {
+                return rend();
+            }
+
+            [[nodiscard]] bool empty() const noexcept {
+                return len == 0;
+            }
+
+            size_type size() const noexcept {
+                return len;
+            }
+
+            size_type max_size() const noexcept {
+                const node_allocator na(alloc);
+                const size_type n = node_traits::max_size(na);
+                const size_type limit = static_cast<size_type>(numeric_limits<difference_type>::max());
+                return n < limit ? n : limit;
+            }
+
+            template<class ...Args>
+            conditional_t<Multi, iterator, pair<iterator, bool>> emplace(Args&& ...args) {
+                if constexpr (Multi) {
+                    return emplace_at(const_iterator(), forward<Args>(args)...).first;
+                } else {
+                    return emplace_at(const_iterator(), forward<Args>(args)...);
+                }
+            }
+
+            template<class ...Args>
+            iterator emplace_hint(const_iterator position, Args&& ...args) {
+                return emplace_at(position, forward<Args>(args)...).first;
+            }
+
+            conditional_t<Multi, iterator, pair<iterator, bool>> insert(const value_type& x) {
+                return emplace(x);
+            }
+
+            conditional_t<Multi, iterator, pair<iterator, bool>> insert(value_type&& x) {
+                return emplace(move(x));
+            }
+
+            iterator insert(const_iterator position, const value_type& x) {
+                return emplace_at(position, x).first;
+            }
+
+            iterator insert(const_iterator position, value_type&& x) {
+                return emplace_at(position, move(x)).first;
+            }
+
+            /* Every element is inserted with end() as the hint, so sorted input is appended in constant time per element, and anything else
+             * costs one extra comparison before the usual search. */
+            template<__internal::legacy_input_iterator InputIterator>
+            void insert(InputIterator first, InputIterator last) {
+                for (; first != last; ++first) {
+                    emplace_at(cend(), *first);
+                }
+            }
+
+            void insert(initializer_list<value_type> il) {
+                insert(il.begin(), il.end());
+            }
+
+            /* The node is linked in as it is. If its key is taken, it stays in nh, which is returned in the result. */
+            conditional_t<Multi, iterator, __insert_return_type<iterator, node_type>> insert(node_type&& nh) {
+                if constexpr (Multi) {
+                    return insert(cend(), move(nh));
+                } else {
+                    if (nh.empty()) {
+                        return { end(), false, node_type() };
+                    }
+                    const insert_position pos = position_for(const_iterator(), Policy::key(nh.ptr->value));
+                    if (pos.found != nullptr) {
+                        return { iterator(pos.found), false, move(nh) };
+                    }
+                    return { link(pos, nh.release()), true, node_type() };
+                }
+            }
+
+            iterator insert(const_iterator position, node_type&& nh) {
+                if (nh.empty()) {
+                    return end();
+                }
+                const insert_position pos = position_for(position, Policy::key(nh.ptr->value));
+                if (pos.found != nullptr) {
+                    return iterator(pos.found);
+                }
+                return link(pos, nh.release());
+            }
+
+            node_type extract(const_iterator position) {
+                __tree_erase_and_rebalance(position.node, header);
+                len--;
+                return node_type(static_cast<node*>(position.node), alloc);
+            }
+
+            node_type extract(const key_type& x) {
+                const const_iterator it = find(x);
+                if (it == end()) {
+                    return node_type();
+                }
+                return extract(it);
+            }
+
+            iterator erase(iterator position) {
+                __tree_node_base* const next = __tree_next(position.node);
+                erase_node(position.node);
+                return iterator(next);
+            }
+
+            iterator erase(const_iterator position)
+            requires (!is_same_v<iterator, const_iterator>) {
+                return erase(iterator(position.node));
+            }
+
+            size_type erase(const key_type& x) {
+                if constexpr (Multi) {
+                    const pair<const_iterator, const_iterator> r = equal_range(x);
+                    const size_type old_len = len;
+                    erase(r.first, r.second);
+                    return old_len - len;
+                } else {
+                    __tree_node_base* const n = find_node(x);
+                    if (n == end_node()) {
+                        return 0;
+                    }
+                    erase_node(n);
+                    return 1;
+                }
+            }
+
+            iterator erase(const_iterator first, const_iterator last) {
+                if (first == cbegin() && last == cend()) {
+                    clear();
+                    return end();
+                }
+                while (first != last) {
+                    __tree_node_base* const n = first.node;
+                    ++first;
+                    erase_node(n);
+                }
+                return iterator(last.node);
+            }
+
+            /* The nodes of source whose keys are new to this tree (all of them with Multi) are unlinked from source and linked into this tree,
+             * without allocating or touching the elements. The allocators must compare equal. */
+            template<class C2, bool M2>
+            void merge(__tree<Policy, C2, Allocator, M2>& source) {
+                if (static_cast<const void*>(addressof(source)) == static_cast<const void*>(this)) {
+                    return;
+                }
+
+                for (__tree_node_base* x = source.header.left; x != &source.header;) {
+                    __tree_node_base* const next = __tree_next(x);
+                    const insert_position pos = position_for(const_iterator(), key_of(x));
+                    if (pos.found == nullptr) {
+                        __tree_erase_and_rebalance(x, source.header);
+                        source.len--;
+                        link(pos, x);
+                    }
+                    x = next;
+                }
+            }
+
+            template<class C2, bool M2>
+            void merge(__tree<Policy, C2, Allocator, M2>&& source) {
+                merge(source);
+            }
+
+            void swap(__tree& x) noexcept(allocator_traits<Allocator>::is_always_equal::value && is_nothrow_swappable_v<Compare>) {
+                if constexpr (traits_type::propagate_on_container_swap::value) {
+                    std::swap(alloc, x.alloc);
+                }
+                std::swap(compare, x.compare);
+                swap_contents(x);
+            }
+
+            void clear() noexcept {
+                destroy_subtree(header.parent);
+                reset_to_empty();
+            }
+
+            key_compare key_comp() const {
+                return compare;
+            }
+
+            iterator find(const key_type& x) {
+                return iterator(find_node(x));
+            }
+
+            const_iterator find(const key_type& x) const {
+                return const_iterator(find_node(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            iterator find(const K& x) {
+                return iterator(find_node(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            const_iterator find(const K& x) const {
+                return const_iterator(find_node(x));
+            }
+
+            size_type count(const key_type& x) const {
+                if constexpr (Multi) {
+                    return count_range(x);
+                } else {
+                    return find_node(x) != end_node();
+                }
+            }
+
+            // Even in a map, more than one key can be equivalent to a key of another type.
+            template<class K>
+            requires __transparent_compare<Compare>
+            size_type count(const K& x) const {
+                return count_range(x);
+            }
+
+            bool contains(const key_type& x) const {
+                return find_node(x) != end_node();
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            bool contains(const K& x) const {
+                return find_node(x) != end_node();
+            }
+
+            iterator lower_bound(const key_type& x) {
+                return iterator(lower_node(x));
+            }
+
+            const_iterator lower_bound(const key_type& x) const {
+                return const_iterator(lower_node(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            iterator lower_bound(const K& x) {
+                return iterator(lower_node(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            const_iterator lower_bound(const K& x) const {
+                return const_iterator(lower_node(x));
+            }
+
+            iterator upper_bound(const key_type& x) {
+                return iterator(upper_node(x));
+            }
+
+            const_iterator upper_bound(const key_type& x) const {
+                return const_iterator(upper_node(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            iterator upper_bound(const K& x) {
+                return iterator(upper_node(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            const_iterator upper_bound(const K& x) const {
+                return const_iterator(upper_node(x));
+            }
+
+            pair<iterator, iterator> equal_range(const key_type& x) {
+                const pair<__tree_node_base*, __tree_node_base*> r = equal_nodes<!Multi>(x);
+                return { iterator(r.first), iterator(r.second) };
+            }
+
+            pair<const_iterator, const_iterator> equal_range(const key_type& x) const {
+                const pair<__tree_node_base*, __tree_node_base*> r = equal_nodes<!Multi>(x);
+                return { const_iterator(r.first), const_iterator(r.second) };
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            pair<iterator, iterator> equal_range(const K& x) {
+                const pair<__tree_node_base*, __tree_node_base*> r = equal_nodes<false>(x);
+                return { iterator(r.first), iterator(r.second) };
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            pair<const_iterator, const_iterator> equal_range(const K& x) const {
+                const pair<__tree_node_base*, __tree_node_base*> r = equal_nodes<false>(x);
+                return { const_iterator(r.first), const_iterator(r.second) };
+            }
+        protected:
+            using insert_return_type = __insert_return_type<iterator, node_type>;
+
+            /* Inserts an element constructed from args unless key is already in the tree, searching from hint if it isn't a
+             * value-initialized iterator. */
+            template<class K, class ...Args>
+            pair<iterator, bool> emplace_key(const_iterator hint, const K& key, Args&& ...args) {
+                const insert_position pos = position_for(hint, key);
+                if (pos.found != nullptr) {
+                    return { iterator(pos.found), false };
+                }
+                return { link(pos, make_node(forward<Args>(args)...)), true };
+            }
+
+            template<class K>
+            __tree_node_base* find_node(const K& x) const {
+                __tree_node_base* const n = lower_node(x);
+                return n == end_node() || compare(x, key_of(n)) ? end_node() : n;
+            }
+
+            // Whether the tree is a red-black tree whose keys are in order, and unique unless Multi. For tests.
+            bool invariant() const {
+                if (!__tree_invariant(header, len)) {
+                    return false;
+                }
+                for (__tree_node_base* x = header.left; x != end_node(); ) {
+                    __tree_node_base* const next = __tree_next(x);
+                    if (next != end_node() && (Multi ? compare(key_of(next), key_of(x)) : !compare(key_of(x), key_of(next)))) {
+                        return false;
+                    }
+                    x = next;
+                }
+                return true;
+            }
+        private:
+            template<class, class, class, bool>
+            friend class __tree;
+
+            /* Where a new element goes: as the left or the right child of parent. For a tree of unique keys, found is instead the node of an
+             * element with an equivalent key, if there is one. */
+            struct insert_position {
+                __tree_node_base* parent;
+                bool left;
+                __tree_node_base* found;
+            };
+
+            /* The nodes of a tree that is being assigned to, detached from it and then handed out again with new elements, so that an
+             * assignment only allocates for the elements beyond the old size. The ones left over are freed on scope exit. */
+            class node_recycler {
+            private:
+                __tree& t;
+                // Chained through their right links.
+                __tree_node_base* nodes;
+            public:
+                explicit node_recycler(__tree& t) noexcept : t(t), nodes(t.detach_nodes()) {}
+
+                node_recycler(const node_recycler&) = delete;
+                node_recycler& operator=(const node_recycler&) = delete;
+
+                ~node_recycler() {
+                    while (nodes != nullptr) {
+                        __tree_node_base* const next = nodes->right;
+                        t.drop_node(nodes);
+                        nodes = next;
+                    }
+                }
+
+                template<class ...Args>
+                node* get(Args&& ...args) {
+                    if (nodes == nullptr) {
+                        return t.make_node(forward<Args>(args)...);
+                    }
+
+                    node* const n = static_cast<node*>(nodes);
+                    nodes = nodes->right;
+                    traits_type::destroy(t.alloc, addressof(n->value));
+                    try {
+                        traits_type::construct(t.alloc, addressof(n->value), forward<Args>(args)...);
+                    } catch (...) {
+                        node_allocator na(t.alloc);
+                        node_traits::deallocate(na, n, 1);
+                        throw;
+                    }
+                    return n;
+                }
+            };
+
+            [[no_unique_address]] Allocator alloc;
+            [[no_unique_address]] Compare compare;
+            __tree_node_base header;
+            size_type len;
+
+            static value_type& value_of(__tree_node_base* x) noexcept {
+                return static_cast<node*>(x)->value;
+            }
+
+            static const key_type& key_of(__tree_node_base* x) noexcept {
+                return Policy::key(static_cast<node*>(x)->value);
+            }
+
+            __tree_node_base* end_node() const noexcept {
+                return const_cast<__tree_node_base*>(&header);
+            }
+
+            template<class ...Args>
+            node* make_node(Args&& ...args) {
+                node_allocator na(alloc);
+                node* const n = node_traits::allocate(na, 1);
+                ::new (static_cast<void*>(n)) node;
+                try {
+                    traits_type::construct(alloc, addressof(n->value), forward<Args>(args)...);
+                } catch (...) {
+                    node_traits::deallocate(na, n, 1);
+                    throw;
+                }
+                return n;
+            }
+
+            void drop_node(__tree_node_base* x) noexcept {
+                node* const n = static_cast<node*>(x);
+                traits_type::destroy(alloc, addressof(n->value));
+                node_allocator na(alloc);
+                node_traits::deallocate(na, n, 1);
+            }
+
+            // Recurses on the right subtrees only, so the depth is bounded by the height of the tree.
+            void destroy_subtree(__tree_node_base* x) noexcept {
+                while (x != nullptr) {
+                    destroy_subtree(x->right);
+                    __tree_node_base* const left = x->left;
+                    drop_node(x);
+                    x = left;
+                }
+            }
+
+            void reset_to_empty() noexcept {
+                header.parent = nullptr;
+                header.left = &header;
+                header.right = &header;
+                len = 0;
+            }
+
+            /* Empties the tree and returns its nodes, elements still in place, as a list chained through their right links. Rotating every left
+             * child up turns the tree into such a list without a stack. */
+            __tree_node_base* detach_nodes() noexcept {
+                __tree_node_base* list = nullptr;
+                __tree_node_base* x = header.parent;
+                while (x != nullptr) {
+                    if (x->left != nullptr) {
+                        __tree_node_base* const y = x->left;
+                        x->left = y->right;
+                        y->right = x;
+                        x = y;
+                    } else {
+                        __tree_node_base* const next = x->right;
+                        x->right = list;
+                        list = x;
+                        x = next;
+                    }
+                }
+                reset_to_empty();
+                return list;
+            }
+
+            /* Takes over the nodes of x. This tree must be empty. */
+            void steal(__tree& x) noexcept {
+                if (x.len == 0) {
+                    return;
+                }
+                header.parent = x.header.parent;
+                header.left = x.header.left;
+                header.right = x.header.right;
+                header.parent->parent = &header;
+                len = x.len;
+                x.reset_to_empty();
+            }
+
+            void swap_contents(__tree& x) noexcept {
+                std::swap(header.parent, x.header.parent);
+                std::swap(header.left, x.header.left);
+                std::swap(header.right, x.header.right);
+                std::swap(len, x.len);
+                fix_header();
+                x.fix_header();
+            }
+
+            // The root points back at the header it belongs to, and an empty tree's header points at itself.
+            void fix_header() noexcept {
+                if (len == 0) {
+                    reset_to_empty();
+                } else {
+                    header.parent->parent = &header;
+                }
+            }
+
+            /* Gives this empty tree a copy of the shape and colors of x, with nodes from get(node of x). */
+            template<class Get>
+            void clone_from(const __tree& x, Get get) {
+                header.parent = clone(x.header.parent, &header, get);
+                header.left = __tree_min(header.parent);
+                header.right = __tree_max(header.parent);
+                len = x.len;
+            }
+
+            // Recurses on the right subtrees only, like destroy_subtree.
+            template<class Get>
+            __tree_node_base* clone(__tree_node_base* x, __tree_node_base* parent, Get& get) {
+                __tree_node_base* const top = get(x);
+                top->parent = parent;
+                top->left = nullptr;
+                top->right = nullptr;
+                top->red = x->red;
+                try {
+                    if (x->right != nullptr) {
+                        top->right = clone(x->right, top, get);
+                    }
+                    parent = top;
+                    for (x = x->left; x != nullptr; x = x->left) {
+                        __tree_node_base* const y = get(x);
+                        y->parent = parent;
+                        y->left = nullptr;
+                        y->right = nullptr;
+                        y->red = x->red;
+                        parent->left = y;
+                        if (x->right != nullptr) {
+                            y->right = clone(x->right, y, get);
+                        }
+                        parent = y;
+                    }
+                } catch (...) {
+                    destroy_subtree(top);
+                    throw;
+                }
+                return top;
+            }
+
+            iterator link(const insert_position& pos, __tree_node_base* n) noexcept {
+                __tree_insert_and_rebalance(pos.left, n, pos.parent, header);
+                len++;
+                return iterator(n);
+            }
+
+            void erase_node(__tree_node_base* n) noexcept {
+                __tree_erase_and_rebalance(n, header);
+                len--;
+                drop_node(n);
+            }
+
+            template<class K>
+            __tree_node_base* lower_node(const K& k) const {
+                __tree_node_base* result = end_node();
+                for (__tree_node_base* x = header.parent; x != nullptr;) {
+                    if (!compare(key_of(x), k)) {
+                        result = x;
+                        x = x->left;
+                    } else {
+                        x = x->right;
+                    }
+                }
+                return result;
+            }
+
+            template<class K>
+            __tree_node_base* upper_node(const K& k) const {
+                __tree_node_base* result = end_node();
+                for (__tree_node_base* x = header.parent; x != nullptr;) {
+                    if (compare(k, key_of(x))) {
+                        result = x;
+                        x = x->left;
+                    } else {
+                        x = x->right;
+                    }
+                }
+                return result;
+            }
+
+            /* With Unique, there is at most one equivalent node, so the range ends right after the lower bound if that one is equivalent. */
+            template<bool Unique, class K>
+            pair<__tree_node_base*, __tree_node_base*> equal_nodes(const K& k) const {
+                if constexpr (Unique) {
+                    __tree_node_base* const n = lower_node(k);
+                    return { n, n == end_node() || compare(k, key_of(n)) ? n : __tree_next(n) };
+                } else {
+                    return { lower_node(k), upper_node(k) };
+                }
+            }
+
+            template<class K>
+            size_type count_range(const K& k) const {
+                size_type n = 0;
+                const pair<__tree_node_base*, __tree_node_base*> r = equal_nodes<false>(k);
+                for (__tree_node_base* x = r.first; x != r.second; x = __tree_next(x)) {
+                    n++;
+                }
+                return n;
+            }
+
+            /* The place of a new unique key, found by going down from the root. */
+            template<class K>
+            insert_position unique_position(const K& k) const {
+                __tree_node_base* x = header.parent;
+                __tree_node_base* y = end_node();
+                bool less = true;
+                while (x != nullptr) {
+                    y = x;
+                    less = compare(k, key_of(x));
+                    x = less ? x->left : x->right;
+                }
+
+                // The key is new unless it's equivalent to its predecessor, the last node passed on the way down that it didn't go left of.
+                __tree_node_base* before = y;
+                if (less) {
+                    if (y == header.left) {
+                        return { y, true, nullptr };
+                    }
+                    before = __tree_prev(y);
+                }
+                if (compare(key_of(before), k)) {
+                    return { y, less, nullptr };
+                }
+                return { nullptr, false, before };
+            }
+
+            /* The place of a new key in a multi tree: after its equivalent keys, or with Lower, before them. */
+            template<bool Lower, class K>
+            insert_position equal_position(const K& k) const {
+                __tree_node_base* x = header.parent;
+                __tree_node_base* y = end_node();
+                bool left = true;
+                while (x != nullptr) {
+                    y = x;
+                    left = Lower ? !compare(key_of(x), k) : compare(k, key_of(x));
+                    x = left ? x->left : x->right;
+                }
+                return { y, left, nullptr };
+            }
+
+            /* The place of a new key right before hint, if that keeps the order, or the one found from the root otherwise. Checking the
+             * neighbors takes at most two comparisons, and the new node goes either into the empty right link of the node before hint or into
+             * the empty left link of hint, one of which is always free. With end() as the hint, sorted input is appended in constant time. */
+            template<class K>
+            insert_position unique_hint_position(__tree_node_base* hint, const K& k) const {
+                if (hint == end_node()) {
+                    if (len != 0 && compare(key_of(header.right), k)) {
+                        return { header.right, false, nullptr };
+                    }
+                    return unique_position(k);
+                }
+
+                if (compare(k, key_of(hint))) {
+                    if (hint == header.left) {
+                        return { hint, true, nullptr };
+                    }
+                    __tree_node_base* const before = __tree_prev(hint);
+                    if (compare(key_of(before), k)) {
+                        return before->right == nullptr ? insert_position{ before, false, nullptr } : insert_position{ hint, true, nullptr };
+                    }
+                    return unique_position(k);
+                }
+
+                if (compare(key_of(hint), k)) {
+                    if (hint == header.right) {
+                        return { hint, false, nullptr };
+                    }
+                    __tree_node_base* const after = __tree_next(hint);
+                    if (compare(k, key_of(after))) {
+                        return hint->right == nullptr ? insert_position{ hint, false, nullptr } : insert_position{ after, true, nullptr };
+                    }
+                    return unique_position(k);
+                }
+
+                return { nullptr, false, hint };
+            }
+
+            /* As unique_hint_position, for a multi tree: a key equivalent to some around hint goes as close to hint as the order allows. */
+            template<class K>
+            insert_position equal_hint_position(__tree_node_base* hint, const K& k) const {
+                if (hint == end_node()) {
+                    if (len != 0 && !compare(k, key_of(header.right))) {
+                        return { header.right, false, nullptr };
+                    }
+                    return equal_position<false>(k);
+                }
+
+                if (!compare(key_of(hint), k)) {
+                    if (hint == header.left) {
+                        return { hint, true, nullptr };
+                    }
+                    __tree_node_base* const before = __tree_prev(hint);
+                    if (!compare(k, key_of(before))) {
+                        return before->right == nullptr ? insert_position{ before, false, nullptr } : insert_position{ hint, true, nullptr };
+                    }
+                    return equal_position<false>(k);
+                }
+
+                if (hint == header.right) {
+                    return { hint, false, nullptr };
+                }
+                __tree_node_base* const after = __tree_next(hint);
+                if (!compare(key_of(after), k)) {
+                    return hint->right == nullptr ? insert_position{ hint, false, nullptr } : insert_position{ after, true, nullptr };
+                }
+                return equal_position<true>(k);
+            }
+
+            template<class K>
+            insert_position position_for(const_iterator hint, const K& k) const {
+                if constexpr (Multi) {
+                    return hint.node == nullptr ? equal_position<false>(k) : equal_hint_position(hint.node, k);
+                } else {
+                    return hint.node == nullptr ? unique_position(k) : unique_hint_position(hint.node, k);
+                }
+            }
+
+            /* Links n in unless its key is taken, in which case n is freed. */
+            pair<iterator, bool> insert_node(const_iterator hint, node* n) {
+                insert_position pos;
+                try {
+                    pos = position_for(hint, Policy::key(n->value));
+                } catch (...) {
+                    drop_node(n);
+                    throw;
+                }
+                if (pos.found != nullptr) {
+                    drop_node(n);
+                    return { iterator(pos.found), false };
+                }
+                return { link(pos, n), true };
+            }
+
+            template<class ...Args>
+            pair<iterator, bool> emplace_at(const_iterator hint, Args&& ...args) {
+                if constexpr (requires { Policy::key_arg(args...); }) {
+                    return emplace_key(hint, Policy::key_arg(args...), forward<Args>(args)...);
+                } else {
+                    // The key can only be told once the element exists, so the node is made first, and freed again if the key is taken.
+                    return insert_node(hint, make_node(forward<Args>(args)...));
+                }
+            }
+        };
+
+        /* The trees are equal if they have the same size and their elements are equal in order. */
+        template<class Policy, class Compare, class Allocator, bool Multi>
+        bool __tree_equal(const __tree<Policy, Compare, Allocator, Multi>& x, const __tree<Policy, Compare, Allocator, Multi>& y) {
+            if (x.size() != y.size()) {
+                return false;
+            }
+
+            for (auto i = x.begin(), j = y.begin(); i != x.end(); ++i, ++j) {
+                if (!(*i == *j)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<class Policy, class Compare, class Allocator, bool Multi>
+        synth_three_way_result<typename Policy::value_type> __tree_three_way(const __tree<Policy, Compare, Allocator, Multi>& x,
+            const __tree<Policy, Compare, Allocator, Multi>& y) {
+            auto i = x.begin();
+            auto j = y.begin();
+            for (; i != x.end() && j != y.end(); ++i, ++j) {
+                if (const auto cmp = synth_three_way(*i, *j); cmp != 0) {
+                    return cmp;
+                }
+            }
+            return x.size() <=> y.size();
+        }
+
+        template<class Policy, class Compare, class Allocator, bool Multi, class Predicate>
+        typename __tree<Policy, Compare, Allocator, Multi>::size_type __tree_erase_if(__tree<Policy, Compare, Allocator, Multi>& c, Predicate pred) {
+            const auto old_size = c.size();
+            for (auto it = c.begin(); it != c.end();) {
+                if (pred(*it)) {
+                    it = c.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            return old_size - c.size();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,319 @@
+#pragma once
+
+#include "cstddef.hpp"
+#include "cstdint.hpp"
+#include "type_traits.hpp"
+
+namespace std {
+    /* 31.4 Order and consistency */
+    // The enumerators have the values of the __ATOMIC_* macros, so an order can be passed to the builtins as is.
+    enum class memory_order : int {
+        relaxed = __ATOMIC_RELAXED,
+        consume = __ATOMIC_CONSUME,
+        acquire = __ATOMIC_ACQUIRE,
+        release = __ATOMIC_RELEASE,
+        acq_rel = __ATOMIC_ACQ_REL,
+        seq_cst = __ATOMIC_SEQ_CST
+    };
+    inline constexpr memory_order memory_order_relaxed = memory_order::relaxed;
+    inline constexpr memory_order memory_order_consume = memory_order::consume;
+    inline constexpr memory_order memory_order_acquire = memory_order::acquire;
+    inline constexpr memory_order memory_order_release = memory_order::release;
+    inline constexpr memory_order memory_order_acq_rel = memory_order::acq_rel;
+    inline constexpr memory_order memory_order_seq_cst = memory_order::seq_cst;
+
+    template<class T>
+    T kill_dependency(T y) noexcept {
+        return y;
+    }
+
+    namespace __internal {
+        constexpr int __to_builtin_order(memory_order order) noexcept {
+            return static_cast<int>(order);
+        }
+
+        /* The order used for the load performed by a failed compare-exchange, which may be neither a release nor an acq_rel one. */
+        constexpr int __to_builtin_failure_order(memory_order order) noexcept {
+            switch (order) {
+            case memory_order::release: return __ATOMIC_RELAXED;
+            case memory_order::acq_rel: return __ATOMIC_ACQUIRE;
+            default: return static_cast<int>(order);
+            }
+        }
+
+        /* 31.6 Waiting and notifying
+         *
+         * Waiters don't sleep on the atomic object itself, whose size may not be one the platform can wait on, but on the 32-bit epoch of one of
+         * a fixed set of slots, picked by hashing the address of the object. A notification bumps the epoch and wakes the sleepers. Since
+         * unrelated objects can share a slot, a waiter may wake up for someone else's notification, and notify_one has to wake every sleeper
+         * on the slot so that the one it was meant for isn't missed. The sleeping itself is done by futex on Linux and __ulock on Darwin; see
+         * atomic.cpp. */
+        struct __wait_slot {
+            alignas(64) std::uint32_t epoch;
+            std::uint32_t waiters;
+        };
+
+        __wait_slot& __wait_slot_for(const volatile void* addr) noexcept;
+        /* Sleeps for as long as the epoch of the slot equals `epoch`. May return early. */
+        void __wait_on_slot(__wait_slot& slot, std::uint32_t epoch) noexcept;
+        void __wake_slot(__wait_slot& slot) noexcept;
+
+        /* Blocks until changed() returns true, which it is expected to do after a notification on addr. Every access to the slot is
+         * sequentially consistent, so a notifier that modified the object before bumping the epoch either finds the waiter registered, or
+         * is seen by the waiter's check. */
+        template<class Changed>
+        void __atomic_wait(const volatile void* addr, Changed changed) noexcept {
+            if (changed()) {
+                return;
+            }
+            __wait_slot& slot = __wait_slot_for(addr);
+            __atomic_fetch_add(&slot.waiters, 1, __ATOMIC_SEQ_CST);
+            while (true) {
+                const std::uint32_t epoch = __atomic_load_n(&slot.epoch, __ATOMIC_SEQ_CST);
+                if (changed()) {
+                    break;
+                }
+                __wait_on_slot(slot, epoch);
+            }
+            __atomic_fetch_sub(&slot.waiters, 1, __ATOMIC_SEQ_CST);
+        }
+
+        inline void __atomic_notify(const volatile void* addr) noexcept {
+            __wait_slot& slot = __wait_slot_for(addr);
+            __atomic_fetch_add(&slot.epoch, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&slot.waiters, __ATOMIC_SEQ_CST) != 0) {
+                __wake_slot(slot);
+            }
+        }
+
+        /* Objects whose size is a power of two no larger than 16 bytes are aligned to their size, as the lock-free instructions require. */
+        template<class T>
+        inline constexpr std::size_t __atomic_alignment = (sizeof(T) & (sizeof(T) - 1)) == 0 && sizeof(T) <= 16 && sizeof(T) > alignof(T)
+            ? sizeof(T) : alignof(T);
+
+        /* The operations common to every specialization of atomic. */
+        template<class T>
+        struct __atomic_base {
+        protected:
+            alignas(__atomic_alignment<T>) T value;
+        public:
+            using value_type = T;
+
+            static constexpr bool is_always_lock_free = __atomic_always_lock_free(sizeof(T), 0);
+
+            constexpr __atomic_base() noexcept(is_nothrow_default_constructible_v<T>) : value() {}
+            constexpr __atomic_base(T desired) noexcept : value(desired) {}
+            __atomic_base(const __atomic_base&) = delete;
+            __atomic_base& operator=(const __atomic_base&) = delete;
+
+            bool is_lock_free() const noexcept {
+                return __atomic_is_lock_free(sizeof(T), &value);
+            }
+
+            void store(T desired, memory_order order = memory_order::seq_cst) noexcept {
+                __atomic_store(&value, &desired, __to_builtin_order(order));
+            }
+
+            T operator=(T desired) noexcept {
+                store(desired);
+                return desired;
+            }
+
+            T load(memory_order order = memory_order::seq_cst) const noexcept {
+                alignas(__atomic_alignment<T>) unsigned char buf[sizeof(T)];
+                T* const result = reinterpret_cast<T*>(buf);
+                __atomic_load(&value, result, __to_builtin_order(order));
+                return *result;
+            }
+
+            operator T() const noexcept {
+                return load();
+            }
+
+            T exchange(T desired, memory_order order = memory_order::seq_cst) noexcept {
+                alignas(__atomic_alignment<T>) unsigned char buf[sizeof(T)];
+                T* const result = reinterpret_cast<T*>(buf);
+                __atomic_exchange(&value, &desired, result, __to_builtin_order(order));
+                return *result;
+            }
+
+            bool compare_exchange_weak(T& expected, T desired, memory_order success, memory_order failure) noexcept {
+                return __atomic_compare_exchange(&value, __builtin_addressof(expected), &desired, true, __to_builtin_order(success),
+                    __to_builtin_failure_order(failure));
+            }
+
+            bool compare_exchange_strong(T& expected, T desired, memory_order success, memory_order failure) noexcept {
+                return __atomic_compare_exchange(&value, __builtin_addressof(expected), &desired, false, __to_builtin_order(success),
+                    __to_builtin_failure_order(failure));
+            }
+
+            bool compare_exchange_weak(T& expected, T desired, memory_order order = memory_order::seq_cst) noexcept {
+                return compare_exchange_weak(expected, desired, order, order);
+            }
+
+            bool compare_exchange_strong(T& expected, T desired, memory_order order = memory_order::seq_cst) noexcept {
+                return compare_exchange_strong(expected, desired, order, order);
+            }
+
+            // Values are compared by their object representations, as the standard requires.
+            void wait(T old, memory_order order = memory_order::seq_cst) const noexcept {
+                __atomic_wait(&value, [&] {
+                    const T curr = load(order);
+                    return __builtin_memcmp(&curr, &old, sizeof(T)) != 0;
+                });
+            }
+
+            void notify_one() noexcept {
+                __atomic_notify(&value);
+            }
+
+            void notify_all() noexcept {
+                __atomic_notify(&value);
+            }
+        };
+    }
+
+    /* 31.7 Class template atomic */
+    // The volatile overloads are not provided.
+    template<class T>
+    struct atomic : public __internal::__atomic_base<T> {
+        static_assert(is_trivially_copyable_v<T> && is_copy_constructible_v<T> && is_move_constructible_v<T> && is_copy_assignable_v<T>
+            && is_move_assignable_v<T>, "The argument to atomic must be trivially copyable, copy constructible and copy assignable.");
+
+        using __internal::__atomic_base<T>::__atomic_base;
+        using __internal::__atomic_base<T>::operator=;
+    };
+
+    /* 31.7.3 Specializations for integers */
+    template<class T> requires is_integral_v<T> && (!is_same_v<T, bool>)
+    struct atomic<T> : public __internal::__atomic_base<T> {
+        using difference_type = T;
+
+        using __internal::__atomic_base<T>::__atomic_base;
+        using __internal::__atomic_base<T>::operator=;
+
+        T fetch_add(T operand, memory_order order = memory_order::seq_cst) noexcept {
+            return __atomic_fetch_add(&this->value, operand, __internal::__to_builtin_order(order));
+        }
+
+        T fetch_sub(T operand, memory_order order = memory_order::seq_cst) noexcept {
+            return __atomic_fetch_sub(&this->value, operand, __internal::__to_builtin_order(order));
+        }
+
+        T fetch_and(T operand, memory_order order = memory_order::seq_cst) noexcept {
+            return __atomic_fetch_and(&this->value, operand, __internal::__to_builtin_order(order));
+        }
+
+        T fetch_or(T operand, memory_order order = memory_order::seq_cst) noexcept {
+            return __atomic_fetch_or(&this->value, operand, __internal::__to_builtin_order(order));
+        }
+
+        T fetch_xor(T operand, memory_order order = memory_order::seq_cst) noexcept {
+            return __atomic_fetch_xor(&this->value, operand, __internal::__to_builtin_order(order));
+        }
+
+        T operator++(int) noexcept { return fetch_add(1); }
+        T operator--(int) noexcept { return fetch_sub(1); }
+        T operator++() noexcept { return __atomic_add_fetch(&this->value, 1, __ATOMIC_SEQ_CST); }
+        T operator--() noexcept { return __atomic_sub_fetch(&this->value, 1, __ATOMIC_SEQ_CST); }
+        T operator+=(T operand) noexcept { return __atomic_add_fetch(&this->value, operand, __ATOMIC_SEQ_CST); }
+        T operator-=(T operand) noexcept { return __atomic_sub_fetch(&this->value, operand, __ATOMIC_SEQ_CST); }
+        T operator&=(T operand) noexcept { return __atomic_and_fetch(&this->value, operand, __ATOMIC_SEQ_CST); }
+        T operator|=(T operand) noexcept { return __atomic_or_fetch(&this->value, operand, __ATOMIC_SEQ_CST); }
+        T operator^=(T operand) noexcept { return __atomic_xor_fetch(&this->value, operand, __ATOMIC_SEQ_CST); }
+    };
+
+    /* 31.7.5 Partial specialization for pointers */
+    template<class T>
+    struct atomic<T*> : public __internal::__atomic_base<T*> {
+        using difference_type = std::ptrdiff_t;
+
+        using __internal::__atomic_base<T*>::__atomic_base;
+        using __internal::__atomic_base<T*>::operator=;
+
+        // The builtins don't scale the operand by the size of the pointee.
+        T* fetch_add(std::ptrdiff_t operand, memory_order order = memory_order::seq_cst) noexcept {
+            return __atomic_fetch_add(&this->value, operand * static_cast<std::ptrdiff_t>(sizeof(T)), __internal::__to_builtin_order(order));
+        }
+
+        T* fetch_sub(std::ptrdiff_t operand, memory_order order = memory_order::seq_cst) noexcept {
+            return __atomic_fetch_sub(&this->value, operand * static_cast<std::ptrdiff_t>(sizeof(T)), __internal::__to_builtin_order(order));
+        }
+
+        T* operator++(int) noexcept { return fetch_add(1); }
+        T* operator--(int) noexcept { return fetch_sub(1); }
+        T* operator++() noexcept { return fetch_add(1) + 1; }
+        T* operator--() noexcept { return fetch_sub(1) - 1; }
+        T* operator+=(std::ptrdiff_t operand) noexcept { return fetch_add(operand) + operand; }
+        T* operator-=(std::ptrdiff_t operand) noexcept { return fetch_sub(operand) - operand; }
+    };
+
+    /* 31.3 Type aliases */
+    using atomic_bool = atomic<bool>;
+    using atomic_char = atomic<char>;
+    using atomic_schar = atomic<signed char>;
+    using atomic_uchar = atomic<unsigned char>;
+    using atomic_short = atomic<short>;
+    using atomic_ushort = atomic<unsigned short>;
+    using atomic_int = atomic<int>;
+    using atomic_uint = atomic<unsigned int>;
+    using atomic_long = atomic<long>;
+    using atomic_ulong = atomic<unsigned long>;
+    using atomic_llong = atomic<long long>;
+    using atomic_ullong = atomic<unsigned long long>;
+    using atomic_char8_t = atomic<char8_t>;
+    using atomic_char16_t = atomic<char16_t>;
+    using atomic_char32_t = atomic<char32_t>;
+    using atomic_wchar_t = atomic<wchar_t>;
+    using atomic_intptr_t = atomic<std::intptr_t>;
+    using atomic_uintptr_t = atomic<std::uintptr_t>;
+    using atomic_size_t = atomic<std::size_t>;
+    using atomic_ptrdiff_t = atomic<std::ptrdiff_t>;
+    using atomic_intmax_t = atomic<std::intmax_t>;
+    using atomic_uintmax_t = atomic<std::uintmax_t>;
+
+    /* 31.10 Flag type and operations */
+    struct atomic_flag {
+    private:
+        bool flag;
+    public:
+        constexpr atomic_flag() noexcept : flag(false) {}
+        atomic_flag(const atomic_flag&) = delete;
+        atomic_flag& operator=(const atomic_flag&) = delete;
+
+        bool test(memory_order order = memory_order::seq_cst) const noexcept {
+            return __atomic_load_n(&flag, __internal::__to_builtin_order(order));
+        }
+
+        bool test_and_set(memory_order order = memory_order::seq_cst) noexcept {
+            return __atomic_test_and_set(&flag, __internal::__to_builtin_order(order));
+        }
+
+        void clear(memory_order order = memory_order::seq_cst) noexcept {
+            __atomic_clear(&flag, __internal::__to_builtin_order(order));
+        }
+
+        void wait(bool old, memory_order order = memory_order::seq_cst) const noexcept {
+            __internal::__atomic_wait(&flag, [&] {
+                return test(order) != old;
+            });
+        }
+
+        void notify_one() noexcept {
+            __internal::__atomic_notify(&flag);
+        }
+
+        void notify_all() noexcept {
+            __internal::__atomic_notify(&flag);
+        }
+    };
+
+    /* 31.11 Fences */
+    inline void atomic_thread_fence(memory_order order) noexcept {
+        __atomic_thread_fence(__internal::__to_builtin_order(order));
+    }
+
+    inline void atomic_signal_fence(memory_order order) noexcept {
+        __atomic_signal_fence(__internal::__to_builtin_order(order));
+    }
+}
\ No newline at end of file
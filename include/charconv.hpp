@@ -0,0 +1,269 @@
+#pragma once
+
+#include "type_traits.hpp"
+#include "concepts.hpp"
+#include "limits.hpp"
+#include "system_error.hpp"
+
+namespace std {
+    /* 20.19.1 Header <charconv> synopsis */
+    enum class chars_format {
+        scientific = 0x1,
+        fixed = 0x2,
+        hex = 0x4,
+        general = fixed | scientific
+    };
+
+    constexpr chars_format operator|(chars_format l, chars_format r) noexcept {
+        return static_cast<chars_format>(static_cast<unsigned int>(l) | static_cast<unsigned int>(r));
+    }
+
+    constexpr chars_format& operator|=(chars_format& l, chars_format r) noexcept {
+        return l = l | r;
+    }
+
+    constexpr chars_format operator&(chars_format l, chars_format r) noexcept {
+        return static_cast<chars_format>(static_cast<unsigned int>(l) & static_cast<unsigned int>(r));
+    }
+
+    constexpr chars_format& operator&=(chars_format& l, chars_format r) noexcept {
+        return l = l & r;
+    }
+
+    constexpr chars_format operator^(chars_format l, chars_format r) noexcept {
+        return static_cast<chars_format>(static_cast<unsigned int>(l) ^ static_cast<unsigned int>(r));
+    }
+
+    constexpr chars_format& operator^=(chars_format& l, chars_format r) noexcept {
+        return l = l ^ r;
+    }
+
+    constexpr chars_format operator~(chars_format f) noexcept {
+        return static_cast<chars_format>(~static_cast<unsigned int>(f));
+    }
+
+    struct to_chars_result {
+        char* ptr;
+        errc ec;
+
+        friend bool operator==(const to_chars_result&, const to_chars_result&) = default;
+    };
+
+    struct from_chars_result {
+        const char* ptr;
+        errc ec;
+
+        friend bool operator==(const from_chars_result&, const from_chars_result&) = default;
+    };
+
+    namespace __internal {
+        /* The integer overloads take every signed and unsigned integer type and char, but none of the other character types or bool. */
+        template<class T>
+        concept __charconv_integer = integral<T> && (!same_as<T, bool>) && (!same_as<T, char8_t>) && (!same_as<T, char16_t>)
+            && (!same_as<T, char32_t>) && (!same_as<T, wchar_t>);
+
+        /* The arithmetic is done in unsigned int or unsigned long long, so that every integer type shares one of two instantiations. */
+        template<class T>
+        using __charconv_unsigned = conditional_t<(sizeof(T) <= sizeof(unsigned int)), unsigned int, unsigned long long>;
+
+        inline constexpr char __digit_pairs[201] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+        inline constexpr char __digit_chars[37] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+        inline constexpr unsigned long long __powers_of_10[20] = {
+            1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+            100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+            100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+        };
+
+        /* Number of decimal digits in v, at least 1. The bit width times log10(2) is either exact or one short, and a single comparison
+         * against a power of ten settles which. */
+        template<class U>
+        constexpr int __decimal_length(U v) noexcept {
+            const unsigned long long w = static_cast<unsigned long long>(v) | 1;
+            const int t = ((64 - __builtin_clzll(w)) * 1233) >> 12;
+            return t + (w >= __powers_of_10[t]);
+        }
+
+        /* Writes the decimal digits of v backwards so that the last one lands just before end, two digits per division. */
+        template<class U>
+        constexpr void __write_decimal(char* end, U v) noexcept {
+            while (v >= 100) {
+                const unsigned int r = static_cast<unsigned int>(v % 100) * 2;
+                v /= 100;
+                *--end = __digit_pairs[r + 1];
+                *--end = __digit_pairs[r];
+            }
+            if (v >= 10) {
+                const unsigned int r = static_cast<unsigned int>(v) * 2;
+                *--end = __digit_pairs[r + 1];
+                *--end = __digit_pairs[r];
+            } else {
+                *--end = static_cast<char>('0' + v);
+            }
+        }
+
+        template<class U>
+        constexpr to_chars_result __to_chars_unsigned(char* first, char* last, U v, int base) noexcept {
+            int length;
+            if (base == 10) {
+                length = __decimal_length(v);
+                if (last - first < length) {
+                    return { last, errc::value_too_large };
+                }
+                __write_decimal(first + length, v);
+            } else if ((base & (base - 1)) == 0) {
+                const int shift = __builtin_ctz(base);
+                const int width = numeric_limits<unsigned long long>::digits - __builtin_clzll(static_cast<unsigned long long>(v) | 1);
+                length = (width + shift - 1) / shift;
+                if (last - first < length) {
+                    return { last, errc::value_too_large };
+                }
+                for (char* p = first + length; p != first; v >>= shift) {
+                    *--p = __digit_chars[v & (base - 1)];
+                }
+            } else {
+                length = 1;
+                for (U t = v; t >= static_cast<U>(base); t /= base) {
+                    length++;
+                }
+                if (last - first < length) {
+                    return { last, errc::value_too_large };
+                }
+                for (char* p = first + length; p != first; v /= base) {
+                    *--p = __digit_chars[v % base];
+                }
+            }
+            return { first + length, errc() };
+        }
+
+        /* Maps '0'-'9', 'a'-'z' and 'A'-'Z' to their digit values and every other byte to 255, so that one comparison against the base
+         * both classifies a character and bounds it. */
+        struct __digit_value_table {
+            unsigned char values[256];
+
+            constexpr __digit_value_table() : values() {
+                for (int c = 0; c < 256; c++) {
+                    values[c] = 255;
+                }
+                for (int c = 0; c < 10; c++) {
+                    values['0' + c] = c;
+                }
+                for (int c = 0; c < 26; c++) {
+                    values['a' + c] = 10 + c;
+                    values['A' + c] = 10 + c;
+                }
+            }
+        };
+
+        inline constexpr __digit_value_table __digit_values;
+
+        template<class U>
+        constexpr const char* __from_chars_unsigned(const char* first, const char* last, U& value, int base, bool& overflow) noexcept {
+            U acc = 0;
+            const U b = static_cast<U>(base);
+            if (base == 10) {
+                // The first digits10 digits can never overflow, so they skip the checks.
+                const char* const safe = first + (last - first < numeric_limits<U>::digits10 ? last - first : numeric_limits<U>::digits10);
+                for (; first != safe; first++) {
+                    const unsigned int d = static_cast<unsigned char>(*first) - static_cast<unsigned int>('0');
+                    if (d >= 10) {
+                        value = acc;
+                        return first;
+                    }
+                    acc = acc * 10 + d;
+                }
+            }
+            for (; first != last; first++) {
+                const unsigned int d = __digit_values.values[static_cast<unsigned char>(*first)];
+                if (d >= static_cast<unsigned int>(base)) {
+                    break;
+                }
+                if (__builtin_mul_overflow(acc, b, &acc) || __builtin_add_overflow(acc, static_cast<U>(d), &acc)) {
+                    overflow = true;
+                }
+            }
+            value = acc;
+            return first;
+        }
+    }
+
+    /* 20.19.2 Primitive numeric output conversion */
+    template<__internal::__charconv_integer T>
+    constexpr to_chars_result to_chars(char* first, char* last, T value, int base = 10) {
+        using U = __internal::__charconv_unsigned<T>;
+        U u = static_cast<U>(static_cast<make_unsigned_t<T>>(value));
+        if constexpr (is_signed_v<T>) {
+            if (value < 0) {
+                if (first == last) {
+                    return { last, errc::value_too_large };
+                }
+                *first++ = '-';
+                u = static_cast<U>(static_cast<make_unsigned_t<T>>(0 - static_cast<make_unsigned_t<T>>(value)));
+            }
+        }
+        return __internal::__to_chars_unsigned(first, last, u, base);
+    }
+
+    to_chars_result to_chars(char* first, char* last, bool value, int base = 10) = delete;
+
+    to_chars_result to_chars(char* first, char* last, float value);
+    to_chars_result to_chars(char* first, char* last, double value);
+    to_chars_result to_chars(char* first, char* last, long double value);
+
+    to_chars_result to_chars(char* first, char* last, float value, chars_format fmt);
+    to_chars_result to_chars(char* first, char* last, double value, chars_format fmt);
+    to_chars_result to_chars(char* first, char* last, long double value, chars_format fmt);
+
+    to_chars_result to_chars(char* first, char* last, float value, chars_format fmt, int precision);
+    to_chars_result to_chars(char* first, char* last, double value, chars_format fmt, int precision);
+    to_chars_result to_chars(char* first, char* last, long double value, chars_format fmt, int precision);
+
+    /* 20.19.3 Primitive numeric input conversion */
+    template<__internal::__charconv_integer T>
+    constexpr from_chars_result from_chars(const char* first, const char* last, T& value, int base = 10) {
+        using U = make_unsigned_t<T>;
+        const char* p = first;
+        bool negative = false;
+        if constexpr (is_signed_v<T>) {
+            if (p != last && *p == '-') {
+                negative = true;
+                p++;
+            }
+        }
+
+        U magnitude;
+        bool overflow = false;
+        const char* const end = __internal::__from_chars_unsigned(p, last, magnitude, base, overflow);
+        if (end == p) {
+            return { first, errc::invalid_argument };
+        }
+
+        if constexpr (is_signed_v<T>) {
+            if (overflow || magnitude > static_cast<U>(numeric_limits<T>::max()) + static_cast<U>(negative)) {
+                return { end, errc::result_out_of_range };
+            }
+            value = negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+        } else {
+            if (overflow) {
+                return { end, errc::result_out_of_range };
+            }
+            value = magnitude;
+        }
+        return { end, errc() };
+    }
+
+    from_chars_result from_chars(const char* first, const char* last, float& value, chars_format fmt = chars_format::general);
+    from_chars_result from_chars(const char* first, const char* last, double& value, chars_format fmt = chars_format::general);
+    from_chars_result from_chars(const char* first, const char* last, long double& value, chars_format fmt = chars_format::general);
+}
\ No newline at end of file
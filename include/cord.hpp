@@ -0,0 +1,636 @@
+#pragma once
+
+#include "string.hpp"
+#include "string_view.hpp"
+#include "streambuf.hpp"
+#include "stdexcept.hpp"
+#include "new.hpp"
+
+namespace std {
+    /* Extension: a rope of characters for building large strings piece by piece. The text is kept as a tree of immutable, reference counted
+     * chunks, so that copying a cord is O(1), concatenating two cords or taking a substring is O(log n) and shares the chunks instead of copying
+     * them, and appending a few characters at a time fills the last chunk in place for as long as no other cord shares it. The tree is kept
+     * height balanced the way an AVL tree is.
+     *
+     * Joining two cords is O(log n), not O(1): rather than stacking a concat node on top, join rebalances along the spine of the taller tree.
+     * This is deliberate, as it keeps indexing and substr logarithmic however the cord was built, where unbalanced O(1) joins would let a
+     * cord built by repeated appends degrade into a list.
+     *
+     * Reading goes through the chunks, either one character at a time, which descends the tree, or as a sequence of basic_string_views handed
+     * to for_each_chunk. write() hands the chunks to a basic_streambuf without flattening them first, and str() copies the text into a
+     * basic_string. Cords that share chunks may be used from different threads. Chunks come from the global operator new. */
+    template<class charT, class traits = char_traits<charT>>
+    class basic_cord {
+    public:
+        using traits_type = traits;
+        using value_type = charT;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        static constexpr size_type npos = size_type(-1);
+
+        basic_cord() noexcept : root(nullptr) {}
+
+        basic_cord(const basic_cord& x) noexcept : root(acquire(x.root)) {}
+
+        basic_cord(basic_cord&& x) noexcept : root(x.root) {
+            x.root = nullptr;
+        }
+
+        explicit basic_cord(basic_string_view<charT, traits> sv) : root(nullptr) {
+            append(sv);
+        }
+
+        basic_cord(const charT* s) : basic_cord(basic_string_view<charT, traits>(s)) {}
+
+        ~basic_cord() {
+            release(root);
+        }
+
+        basic_cord& operator=(const basic_cord& x) noexcept {
+            node* const old = root;
+            root = acquire(x.root);
+            release(old);
+            return *this;
+        }
+
+        basic_cord& operator=(basic_cord&& x) noexcept {
+            if (this != addressof(x)) {
+                release(root);
+                root = x.root;
+                x.root = nullptr;
+            }
+            return *this;
+        }
+
+        basic_cord& operator=(basic_string_view<charT, traits> sv) {
+            basic_cord(sv).swap(*this);
+            return *this;
+        }
+
+        size_type size() const noexcept {
+            return root != nullptr ? root->length : 0;
+        }
+
+        size_type length() const noexcept {
+            return size();
+        }
+
+        size_type max_size() const noexcept {
+            return (numeric_limits<size_type>::max() - sizeof(leaf)) / sizeof(charT);
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return root == nullptr;
+        }
+
+        void clear() noexcept {
+            release(root);
+            root = nullptr;
+        }
+
+        charT operator[](size_type pos) const noexcept {
+            const node* n = root;
+            while (n->kind == node_kind::concat) {
+                const concat* c = static_cast<const concat*>(n);
+                if (pos < c->left->length) {
+                    n = c->left;
+                } else {
+                    pos -= c->left->length;
+                    n = c->right;
+                }
+            }
+            return chunk_data(n)[pos];
+        }
+
+        charT at(size_type pos) const {
+            if (pos >= size()) {
+                throw out_of_range("Calling std::cord::at with invalid argument.");
+            }
+            return (*this)[pos];
+        }
+
+        charT front() const noexcept {
+            return (*this)[0];
+        }
+
+        charT back() const noexcept {
+            return (*this)[size() - 1];
+        }
+
+        basic_cord& operator+=(const basic_cord& x) {
+            return append(x);
+        }
+
+        basic_cord& operator+=(basic_string_view<charT, traits> sv) {
+            return append(sv);
+        }
+
+        basic_cord& operator+=(const charT* s) {
+            return append(basic_string_view<charT, traits>(s));
+        }
+
+        basic_cord& operator+=(charT c) {
+            return append(basic_string_view<charT, traits>(addressof(c), 1));
+        }
+
+        basic_cord& append(const basic_cord& x) {
+            if (x.empty()) {
+                return *this;
+            }
+            check_length(x.size());
+
+            // Short cords are cheaper to copy into the last chunk than to keep as chunks of their own. The copy of x keeps its chunks alive
+            // and unshared with *this, even when x is *this.
+            const basic_cord tmp(x);
+            if (tmp.size() <= copy_limit) {
+                tmp.for_each_chunk([this](basic_string_view<charT, traits> chunk) { append(chunk); });
+            } else {
+                root = root != nullptr ? join(root, acquire(tmp.root)) : acquire(tmp.root);
+            }
+            return *this;
+        }
+
+        basic_cord& append(basic_string_view<charT, traits> sv) {
+            if (sv.empty()) {
+                return *this;
+            }
+            check_length(sv.size());
+
+            sv.remove_prefix(fill_tail(sv));
+            if (!sv.empty()) {
+                // Chunks grow with the cord up to max_flat, so that building a cord from many small pieces allocates O(log n) small chunks
+                // and then one chunk every few kilobytes.
+                const size_type capacity = sv.size() >= max_flat ? sv.size() : min(max_flat, max(sv.size(), size()));
+                node* const l = make_leaf(sv, capacity);
+                root = root != nullptr ? join(root, l) : l;
+            }
+            return *this;
+        }
+
+        basic_cord& append(const charT* s, size_type n) {
+            return append(basic_string_view<charT, traits>(s, n));
+        }
+
+        void push_back(charT c) {
+            append(basic_string_view<charT, traits>(addressof(c), 1));
+        }
+
+        basic_cord& prepend(const basic_cord& x) {
+            if (x.empty()) {
+                return *this;
+            }
+            check_length(x.size());
+
+            node* const r = acquire(x.root);
+            root = root != nullptr ? join(r, root) : r;
+            return *this;
+        }
+
+        basic_cord& prepend(basic_string_view<charT, traits> sv) {
+            if (sv.empty()) {
+                return *this;
+            }
+            check_length(sv.size());
+
+            node* const l = make_leaf(sv, sv.size());
+            root = root != nullptr ? join(l, root) : l;
+            return *this;
+        }
+
+        basic_cord substr(size_type pos = 0, size_type n = npos) const {
+            if (pos > size()) {
+                throw out_of_range("Calling std::cord::substr with invalid argument.");
+            }
+
+            basic_cord result;
+            if (const size_type len = min(n, size() - pos); len != 0) {
+                result.root = sub(root, pos, len);
+            }
+            return result;
+        }
+
+        size_type copy(charT* s, size_type n, size_type pos = 0) const {
+            if (pos > size()) {
+                throw out_of_range("Calling std::cord::copy with invalid argument.");
+            }
+
+            const size_type len = min(n, size() - pos);
+            if (len != 0) {
+                visit(root, pos, len, [&s](const charT* p, size_type k) {
+                    traits::copy(s, p, k);
+                    s += k;
+                    return true;
+                });
+            }
+            return len;
+        }
+
+        /* Flattens the cord into a single string. */
+        basic_string<charT, traits> str() const {
+            basic_string<charT, traits> result;
+            result.reserve(size());
+            for_each_chunk([&result](basic_string_view<charT, traits> chunk) { result.append(chunk.data(), chunk.size()); });
+            return result;
+        }
+
+        /* Calls f with each chunk of the cord in order, as a basic_string_view that stays valid as long as the cord isn't modified. */
+        template<class F>
+        void for_each_chunk(F f) const {
+            if (root != nullptr) {
+                visit(root, 0, size(), [&f](const charT* p, size_type k) {
+                    f(basic_string_view<charT, traits>(p, k));
+                    return true;
+                });
+            }
+        }
+
+        /* Writes the chunks to buf with sputn, stopping at the first short write. Returns whether all of the cord was written. */
+        bool write(basic_streambuf<charT, traits>& buf) const {
+            return root == nullptr || visit(root, 0, size(), [&buf](const charT* p, size_type k) {
+                return buf.sputn(p, static_cast<streamsize>(k)) == static_cast<streamsize>(k);
+            });
+        }
+
+        int compare(const basic_cord& x) const noexcept {
+            int r = 0;
+            if (const size_type n = min(size(), x.size()); n != 0 && root != x.root) {
+                size_type offset = 0;
+                visit(root, 0, n, [&](const charT* p, size_type k) {
+                    visit(x.root, offset, k, [&](const charT* q, size_type m) {
+                        r = traits::compare(p, q, m);
+                        p += m;
+                        return r == 0;
+                    });
+                    offset += k;
+                    return r == 0;
+                });
+            }
+            return r != 0 ? r : size() < x.size() ? -1 : size() > x.size() ? 1 : 0;
+        }
+
+        int compare(basic_string_view<charT, traits> sv) const noexcept {
+            int r = 0;
+            if (const size_type n = min(size(), sv.size()); n != 0) {
+                const charT* q = sv.data();
+                visit(root, 0, n, [&](const charT* p, size_type k) {
+                    r = traits::compare(p, q, k);
+                    q += k;
+                    return r == 0;
+                });
+            }
+            return r != 0 ? r : size() < sv.size() ? -1 : size() > sv.size() ? 1 : 0;
+        }
+
+        void swap(basic_cord& x) noexcept {
+            std::swap(root, x.root);
+        }
+
+    private:
+        enum class node_kind : unsigned char { leaf, slice, concat };
+
+        struct node {
+            node(node_kind kind, size_type length, unsigned char height) noexcept : refs(1), length(length), kind(kind), height(height) {}
+
+            size_type refs;
+            size_type length;
+            node_kind kind;
+            unsigned char height; // 0 for chunks.
+        };
+
+        // A chunk that owns its characters, which are allocated right after it.
+        struct leaf : node {
+            leaf(size_type length, size_type capacity) noexcept : node(node_kind::leaf, length, 0), capacity(capacity) {}
+
+            charT* data() noexcept {
+                return reinterpret_cast<charT*>(this + 1);
+            }
+
+            size_type capacity;
+        };
+
+        // A chunk that is part of a leaf, left behind by substr.
+        struct slice : node {
+            slice(leaf* base, size_type offset, size_type length) noexcept : node(node_kind::slice, length, 0), base(base), offset(offset) {}
+
+            leaf* base;
+            size_type offset;
+        };
+
+        struct concat : node {
+            concat(node* left, node* right) noexcept
+                : node(node_kind::concat, left->length + right->length, static_cast<unsigned char>(max(left->height, right->height) + 1)),
+                  left(left), right(right) {}
+
+            node* left;
+            node* right;
+        };
+
+        // Leaves are kept to about a page, and substrings up to copy_limit characters long are copied rather than shared.
+        static constexpr size_type max_flat = (4096 - sizeof(leaf)) / sizeof(charT);
+        static constexpr size_type copy_limit = 128 / sizeof(charT);
+
+        static node* acquire(node* n) noexcept {
+            if (n != nullptr) {
+                __atomic_fetch_add(&n->refs, 1, __ATOMIC_RELAXED);
+            }
+            return n;
+        }
+
+        static void release(node* n) noexcept {
+            if (n == nullptr || __atomic_fetch_sub(&n->refs, 1, __ATOMIC_ACQ_REL) != 1) {
+                return;
+            }
+
+            switch (n->kind) {
+                case node_kind::leaf:
+                    static_cast<leaf*>(n)->~leaf();
+                    ::operator delete(n);
+                    break;
+                case node_kind::slice:
+                    release(static_cast<slice*>(n)->base);
+                    delete static_cast<slice*>(n);
+                    break;
+                case node_kind::concat:
+                    release(static_cast<concat*>(n)->left);
+                    release(static_cast<concat*>(n)->right);
+                    delete static_cast<concat*>(n);
+                    break;
+            }
+        }
+
+        static bool unique(const node* n) noexcept {
+            return __atomic_load_n(&n->refs, __ATOMIC_ACQUIRE) == 1;
+        }
+
+        static const charT* chunk_data(const node* n) noexcept {
+            if (n->kind == node_kind::leaf) {
+                return const_cast<leaf*>(static_cast<const leaf*>(n))->data();
+            }
+            const slice* s = static_cast<const slice*>(n);
+            return s->base->data() + s->offset;
+        }
+
+        static leaf* make_leaf(basic_string_view<charT, traits> sv, size_type capacity) {
+            const __internal::sized_allocation block = __internal::allocate_at_least(sizeof(leaf) + capacity * sizeof(charT));
+            leaf* const l = ::new (block.ptr) leaf(sv.size(), (block.size - sizeof(leaf)) / sizeof(charT));
+            traits::copy(l->data(), sv.data(), sv.size());
+            return l;
+        }
+
+        static unsigned char height(const node* n) noexcept {
+            return n->height;
+        }
+
+        /* Takes over a reference to the concat node n, and hands out references to its children. */
+        static void unpack(node* n, node*& left, node*& right) noexcept {
+            concat* const c = static_cast<concat*>(n);
+            if (unique(c)) {
+                left = c->left;
+                right = c->right;
+                delete c;
+            } else {
+                left = acquire(c->left);
+                right = acquire(c->right);
+                release(c);
+            }
+        }
+
+        static node* rotate_left(node* n) {
+            node* a;
+            node* b;
+            node* c;
+            node* d;
+            unpack(n, a, b);
+            unpack(b, c, d);
+            return new concat(new concat(a, c), d);
+        }
+
+        static node* rotate_right(node* n) {
+            node* a;
+            node* b;
+            node* c;
+            node* d;
+            unpack(n, a, b);
+            unpack(a, c, d);
+            return new concat(c, new concat(d, b));
+        }
+
+        /* Concatenates two non-empty trees, taking over the references to both, and rebalances along the spine of the taller one, which costs
+         * O(1 + the difference of their heights). */
+        static node* join(node* l, node* r) {
+            if (height(l) > height(r) + 1) {
+                return join_right(l, r);
+            }
+            if (height(r) > height(l) + 1) {
+                return join_left(l, r);
+            }
+            return new concat(l, r);
+        }
+
+        static node* join_right(node* l, node* r) {
+            node* a;
+            node* c;
+            unpack(l, a, c);
+            if (height(c) <= height(r) + 1) {
+                node* const t = new concat(c, r);
+                if (height(t) <= height(a) + 1) {
+                    return new concat(a, t);
+                }
+                return rotate_left(new concat(a, rotate_right(t)));
+            }
+
+            node* const t = join_right(c, r);
+            if (height(t) <= height(a) + 1) {
+                return new concat(a, t);
+            }
+            return rotate_left(new concat(a, t));
+        }
+
+        static node* join_left(node* l, node* r) {
+            node* c;
+            node* a;
+            unpack(r, c, a);
+            if (height(c) <= height(l) + 1) {
+                node* const t = new concat(l, c);
+                if (height(t) <= height(a) + 1) {
+                    return new concat(t, a);
+                }
+                return rotate_right(new concat(rotate_left(t), a));
+            }
+
+            node* const t = join_left(l, c);
+            if (height(t) <= height(a) + 1) {
+                return new concat(t, a);
+            }
+            return rotate_right(new concat(t, a));
+        }
+
+        /* Returns a new reference to the characters [pos, pos + len) of n. len must be positive. */
+        static node* sub(node* n, size_type pos, size_type len) {
+            if (pos == 0 && len == n->length) {
+                return acquire(n);
+            }
+
+            if (n->kind == node_kind::concat) {
+                concat* const c = static_cast<concat*>(n);
+                const size_type left_length = c->left->length;
+                if (pos + len <= left_length) {
+                    return sub(c->left, pos, len);
+                }
+                if (pos >= left_length) {
+                    return sub(c->right, pos - left_length, len);
+                }
+                node* const l = sub(c->left, pos, left_length - pos);
+                return join(l, sub(c->right, 0, pos + len - left_length));
+            }
+
+            if (len <= copy_limit) {
+                return make_leaf(basic_string_view<charT, traits>(chunk_data(n) + pos, len), len);
+            }
+            if (n->kind == node_kind::slice) {
+                const slice* s = static_cast<const slice*>(n);
+                return new slice(static_cast<leaf*>(acquire(s->base)), s->offset + pos, len);
+            }
+            return new slice(static_cast<leaf*>(acquire(n)), pos, len);
+        }
+
+        /* Calls f(p, k) on the pieces of the characters [pos, pos + len) of n in order, as long as f returns true. len must be positive. */
+        template<class F>
+        static bool visit(const node* n, size_type pos, size_type len, F&& f) {
+            while (n->kind == node_kind::concat) {
+                const concat* c = static_cast<const concat*>(n);
+                const size_type left_length = c->left->length;
+                if (pos >= left_length) {
+                    pos -= left_length;
+                    n = c->right;
+                } else if (pos + len <= left_length) {
+                    n = c->left;
+                } else {
+                    if (!visit(c->left, pos, left_length - pos, f)) {
+                        return false;
+                    }
+                    len -= left_length - pos;
+                    pos = 0;
+                    n = c->right;
+                }
+            }
+            return f(chunk_data(n) + pos, len);
+        }
+
+        /* Copies as much of sv as fits into the spare capacity of the last leaf, when the whole right spine of the tree belongs to this cord
+         * alone. Returns the number of characters copied. */
+        size_type fill_tail(basic_string_view<charT, traits> sv) noexcept {
+            node* n = root;
+            if (n == nullptr) {
+                return 0;
+            }
+            for (; unique(n); n = static_cast<concat*>(n)->right) {
+                if (n->kind != node_kind::concat) {
+                    break;
+                }
+            }
+            if (!unique(n) || n->kind != node_kind::leaf) {
+                return 0;
+            }
+
+            leaf* const l = static_cast<leaf*>(n);
+            const size_type k = min(sv.size(), l->capacity - l->length);
+            traits::copy(l->data() + l->length, sv.data(), k);
+            for (n = root; n != l; n = static_cast<concat*>(n)->right) {
+                n->length += k;
+            }
+            l->length += k;
+            return k;
+        }
+
+        void check_length(size_type n) const {
+            if (n > max_size() - size()) {
+                throw length_error("The resulting cord would exceed max_size().");
+            }
+        }
+
+        node* root;
+    };
+
+    template<class charT, class traits>
+    bool operator==(const basic_cord<charT, traits>& x, const basic_cord<charT, traits>& y) noexcept {
+        return x.size() == y.size() && x.compare(y) == 0;
+    }
+
+    template<class charT, class traits>
+    bool operator==(const basic_cord<charT, traits>& x, type_identity_t<basic_string_view<charT, traits>> y) noexcept {
+        return x.size() == y.size() && x.compare(y) == 0;
+    }
+
+    template<class charT, class traits>
+    auto operator<=>(const basic_cord<charT, traits>& x, const basic_cord<charT, traits>& y) noexcept {
+        if constexpr (requires { typename traits::comparison_category; }) {
+            return static_cast<typename traits::comparison_category>(x.compare(y) <=> 0);
+        } else {
+            return static_cast<weak_ordering>(x.compare(y) <=> 0);
+        }
+    }
+
+    template<class charT, class traits>
+    auto operator<=>(const basic_cord<charT, traits>& x, type_identity_t<basic_string_view<charT, traits>> y) noexcept {
+        if constexpr (requires { typename traits::comparison_category; }) {
+            return static_cast<typename traits::comparison_category>(x.compare(y) <=> 0);
+        } else {
+            return static_cast<weak_ordering>(x.compare(y) <=> 0);
+        }
+    }
+
+    template<class charT, class traits>
+    basic_cord<charT, traits> operator+(const basic_cord<charT, traits>& x, const basic_cord<charT, traits>& y) {
+        basic_cord<charT, traits> result(x);
+        result.append(y);
+        return result;
+    }
+
+    template<class charT, class traits>
+    basic_cord<charT, traits> operator+(basic_cord<charT, traits>&& x, const basic_cord<charT, traits>& y) {
+        x.append(y);
+        return move(x);
+    }
+
+    template<class charT, class traits>
+    basic_cord<charT, traits> operator+(basic_cord<charT, traits>&& x, type_identity_t<basic_string_view<charT, traits>> y) {
+        x.append(y);
+        return move(x);
+    }
+
+    template<class charT, class traits>
+    void swap(basic_cord<charT, traits>& x, basic_cord<charT, traits>& y) noexcept {
+        x.swap(y);
+    }
+
+    template<class charT, class traits>
+    basic_ostream<charT, traits>& operator<<(basic_ostream<charT, traits>& os, const basic_cord<charT, traits>& cord) {
+        os.__formatted_output_function([&](ios_base::iostate& err) {
+            const std::streamsize padsize = os.width() > static_cast<std::streamsize>(cord.size()) ? os.width() - cord.size() : 0;
+            const charT fill_char = os.fill();
+            const bool left = (os.flags() & ios_base::adjustfield) == ios_base::left;
+
+            for (std::streamsize i = 0; !left && i < padsize; i++) {
+                os.rdbuf()->sputn(addressof(fill_char), 1);
+            }
+            if (!cord.write(*os.rdbuf())) {
+                err |= ios_base::badbit;
+            }
+            for (std::streamsize i = 0; left && i < padsize; i++) {
+                os.rdbuf()->sputn(addressof(fill_char), 1);
+            }
+
+            os.width(0);
+        });
+
+        return os;
+    }
+
+    using cord = basic_cord<char>;
+    using u8cord = basic_cord<char8_t>;
+    using u16cord = basic_cord<char16_t>;
+    using u32cord = basic_cord<char32_t>;
+    using wcord = basic_cord<wchar_t>;
+}
\ No newline at end of file
@@ -0,0 +1,984 @@
+#pragma once
+
+#include "__flat_base.hpp"
+#include "compare.hpp"
+#include "functional.hpp"
+#include "initializer_list.hpp"
+#include "iterator.hpp"
+#include "stdexcept.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+namespace std {
+    namespace __internal {
+        template<class Key, class T, class Compare, class KeyContainer, class MappedContainer, bool Multi>
+        class __flat_map_base;
+
+        /* Walks the key and the mapped containers in step. Dereferencing yields a pair of references into the two containers rather than a
+         * reference to a stored pair, so the iterator models random_access_iterator but only claims to be a legacy input iterator. */
+        template<class KeyContainer, class MappedContainer, bool Const>
+        class __flat_map_iterator {
+        private:
+            using key_iterator = typename KeyContainer::const_iterator;
+            using mapped_iterator = conditional_t<Const, typename MappedContainer::const_iterator, typename MappedContainer::iterator>;
+
+            template<class, class, class, class, class, bool>
+            friend class __flat_map_base;
+
+            template<class, class, bool>
+            friend class __flat_map_iterator;
+
+            key_iterator key_it;
+            mapped_iterator mapped_it;
+
+            constexpr __flat_map_iterator(key_iterator key_it, mapped_iterator mapped_it) : key_it(key_it), mapped_it(mapped_it) {}
+        public:
+            using iterator_concept = random_access_iterator_tag;
+            using iterator_category = input_iterator_tag;
+            using value_type = pair<typename KeyContainer::value_type, typename MappedContainer::value_type>;
+            using difference_type = ptrdiff_t;
+            using reference = pair<const typename KeyContainer::value_type&,
+                conditional_t<Const, const typename MappedContainer::value_type&, typename MappedContainer::value_type&>>;
+
+            // Keeps the pair of references alive for the duration of a member access through operator->.
+            class pointer {
+            private:
+                friend class __flat_map_iterator;
+
+                reference ref;
+
+                constexpr explicit pointer(reference ref) : ref(ref) {}
+            public:
+                constexpr const reference* operator->() const noexcept {
+                    return addressof(ref);
+                }
+            };
+
+            __flat_map_iterator() = default;
+
+            template<bool OtherConst>
+            requires Const && (!OtherConst)
+            constexpr __flat_map_iterator(__flat_map_iterator<KeyContainer, MappedContainer, OtherConst> i)
+                : key_it(i.key_it), mapped_it(i.mapped_it) {}
+
+            constexpr reference operator*() const {
+                return reference(*key_it, *mapped_it);
+            }
+
+            constexpr pointer operator->() const {
+                return pointer(**this);
+            }
+
+            constexpr reference operator[](difference_type n) const {
+                return reference(key_it[n], mapped_it[n]);
+            }
+
+            constexpr __flat_map_iterator& operator++() {
+                ++key_it;
+                ++mapped_it;
+                return *this;
+            }
+
+            constexpr __flat_map_iterator operator++(int) {
+                __flat_map_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            constexpr __flat_map_iterator& operator--() {
+                --key_it;
+                --mapped_it;
+                return *this;
+            }
+
+            constexpr __flat_map_iterator operator--(int) {
+                __flat_map_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            constexpr __flat_map_iterator& operator+=(difference_type n) {
+                key_it += n;
+                mapped_it += n;
+                return *this;
+            }
+
+            constexpr __flat_map_iterator& operator-=(difference_type n) {
+                key_it -= n;
+                mapped_it -= n;
+                return *this;
+            }
+
+            friend constexpr __flat_map_iterator operator+(__flat_map_iterator i, difference_type n) {
+                return i += n;
+            }
+
+            friend constexpr __flat_map_iterator operator+(difference_type n, __flat_map_iterator i) {
+                return i += n;
+            }
+
+            friend constexpr __flat_map_iterator operator-(__flat_map_iterator i, difference_type n) {
+                return i -= n;
+            }
+
+            friend constexpr difference_type operator-(const __flat_map_iterator& x, const __flat_map_iterator& y) {
+                return x.key_it - y.key_it;
+            }
+
+            friend constexpr bool operator==(const __flat_map_iterator& x, const __flat_map_iterator& y) {
+                return x.key_it == y.key_it;
+            }
+
+            friend constexpr auto operator<=>(const __flat_map_iterator& x, const __flat_map_iterator& y) {
+                return x.key_it <=> y.key_it;
+            }
+        };
+
+        /* What flat_map and flat_multimap share. The keys and the mapped values are kept in two containers sorted by key, so lookups are a
+         * binary search over contiguous keys and iteration is a linear scan, at the cost of inserting or erasing a single element in linear
+         * time. Inserting a range therefore sorts the new elements on their own and merges them into the map in one pass. */
+        template<class Key, class T, class Compare, class KeyContainer, class MappedContainer, bool Multi>
+        class __flat_map_base {
+        public:
+            using key_type = Key;
+            using mapped_type = T;
+            using value_type = pair<key_type, mapped_type>;
+            using key_compare = Compare;
+            using reference = pair<const key_type&, mapped_type&>;
+            using const_reference = pair<const key_type&, const mapped_type&>;
+            using size_type = std::size_t;
+            using difference_type = ptrdiff_t;
+            using iterator = __flat_map_iterator<KeyContainer, MappedContainer, false>;
+            using const_iterator = __flat_map_iterator<KeyContainer, MappedContainer, true>;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+            using key_container_type = KeyContainer;
+            using mapped_container_type = MappedContainer;
+
+            static_assert(is_same_v<key_type, typename KeyContainer::value_type>, "The key container must hold the key type.");
+            static_assert(is_same_v<mapped_type, typename MappedContainer::value_type>, "The mapped container must hold the mapped type.");
+
+            class value_compare {
+            private:
+                friend class __flat_map_base;
+
+                key_compare comp;
+
+                value_compare(const key_compare& c) : comp(c) {}
+            public:
+                bool operator()(const_reference x, const_reference y) const {
+                    return comp(x.first, y.first);
+                }
+            };
+
+            struct containers {
+                key_container_type keys;
+                mapped_container_type values;
+            };
+        protected:
+            using sorted_tag = conditional_t<Multi, sorted_equivalent_t, sorted_unique_t>;
+            using insert_result = conditional_t<Multi, iterator, pair<iterator, bool>>;
+        public:
+            /* C++23 24.6.9.3 Constructors */
+            __flat_map_base() : __flat_map_base(key_compare()) {}
+
+            explicit __flat_map_base(const key_compare& comp) : c(), compare(comp) {}
+
+            __flat_map_base(key_container_type key_cont, mapped_container_type mapped_cont, const key_compare& comp = key_compare())
+                : c(), compare(comp) {
+                merge_in(key_cont, mapped_cont, false);
+            }
+
+            __flat_map_base(sorted_tag, key_container_type key_cont, mapped_container_type mapped_cont, const key_compare& comp = key_compare())
+                : c{move(key_cont), move(mapped_cont)}, compare(comp) {}
+
+            template<legacy_input_iterator InputIterator>
+            __flat_map_base(InputIterator first, InputIterator last, const key_compare& comp = key_compare()) : c(), compare(comp) {
+                insert(first, last);
+            }
+
+            template<legacy_input_iterator InputIterator>
+            __flat_map_base(sorted_tag s, InputIterator first, InputIterator last, const key_compare& comp = key_compare()) : c(), compare(comp) {
+                insert(s, first, last);
+            }
+
+            __flat_map_base(initializer_list<value_type> il, const key_compare& comp = key_compare()) : __flat_map_base(il.begin(), il.end(), comp) {}
+
+            __flat_map_base(sorted_tag s, initializer_list<value_type> il, const key_compare& comp = key_compare())
+                : __flat_map_base(s, il.begin(), il.end(), comp) {}
+
+            __flat_map_base& operator=(initializer_list<value_type> il) {
+                clear();
+                insert(il);
+                return *this;
+            }
+
+            /* Iterators */
+            iterator begin() noexcept {
+                return iterator(c.keys.cbegin(), c.values.begin());
+            }
+
+            const_iterator begin() const noexcept {
+                return const_iterator(c.keys.cbegin(), c.values.cbegin());
+            }
+
+            iterator end() noexcept {
+                return iterator(c.keys.cend(), c.values.end());
+            }
+
+            const_iterator end() const noexcept {
+                return const_iterator(c.keys.cend(), c.values.cend());
+            }
+
+            reverse_iterator rbegin() noexcept {
+                return reverse_iterator(end());
+            }
+
+            const_reverse_iterator rbegin() const noexcept {
+                return const_reverse_iterator(end());
+            }
+
+            reverse_iterator rend() noexcept {
+                return reverse_iterator(begin());
+            }
+
+            const_reverse_iterator rend() const noexcept {
+                return const_reverse_iterator(begin());
+            }
+
+            const_iterator cbegin() const noexcept {
+                return begin();
+            }
+
+            const_iterator cend() const noexcept {
+                return end();
+            }
+
+            const_reverse_iterator crbegin() const noexcept {
+                return rbegin();
+            }
+
+            const_reverse_iterator crend() const noexcept {
+                return rend();
+            }
+
+            /* Capacity */
+            [[nodiscard]] bool empty() const noexcept {
+                return c.keys.empty();
+            }
+
+            size_type size() const noexcept {
+                return c.keys.size();
+            }
+
+            size_type max_size() const noexcept {
+                return c.keys.max_size() < c.values.max_size() ? c.keys.max_size() : c.values.max_size();
+            }
+
+            /* C++23 24.6.9.6 Modifiers */
+            template<class ...Args>
+            requires is_constructible_v<value_type, Args...>
+            insert_result emplace(Args&& ...args) {
+                value_type t(forward<Args>(args)...);
+                if constexpr (Multi) {
+                    return insert_at(upper_index(t.first), move(t.first), move(t.second));
+                } else {
+                    const size_type i = lower_index(t.first);
+                    if (i != size() && !compare(t.first, c.keys[i])) {
+                        return {iterator_at(i), false};
+                    }
+                    return {insert_at(i, move(t.first), move(t.second)), true};
+                }
+            }
+
+            // A flat_multimap inserts as close to the hint as the order allows, and a flat_map ignores the hint.
+            template<class ...Args>
+            requires is_constructible_v<value_type, Args...>
+            iterator emplace_hint(const_iterator hint, Args&& ...args) {
+                if constexpr (Multi) {
+                    value_type t(forward<Args>(args)...);
+                    size_type i = static_cast<size_type>(hint - cbegin());
+                    if (i != 0 && compare(t.first, c.keys[i - 1])) {
+                        i = upper_index(t.first);
+                    } else if (i != size() && compare(c.keys[i], t.first)) {
+                        i = lower_index(t.first);
+                    }
+                    return insert_at(i, move(t.first), move(t.second));
+                } else {
+                    return emplace(forward<Args>(args)...).first;
+                }
+            }
+
+            insert_result insert(const value_type& x) {
+                return emplace(x);
+            }
+
+            insert_result insert(value_type&& x) {
+                return emplace(move(x));
+            }
+
+            iterator insert(const_iterator hint, const value_type& x) {
+                return emplace_hint(hint, x);
+            }
+
+            iterator insert(const_iterator hint, value_type&& x) {
+                return emplace_hint(hint, move(x));
+            }
+
+            template<class P>
+            requires is_constructible_v<value_type, P>
+            insert_result insert(P&& x) {
+                return emplace(forward<P>(x));
+            }
+
+            template<class P>
+            requires is_constructible_v<value_type, P>
+            iterator insert(const_iterator hint, P&& x) {
+                return emplace_hint(hint, forward<P>(x));
+            }
+
+            template<legacy_input_iterator InputIterator>
+            void insert(InputIterator first, InputIterator last) {
+                insert_range(first, last, false);
+            }
+
+            // The range must be sorted by key, and for a flat_map hold no equivalent keys, so only the merge is left to do.
+            template<legacy_input_iterator InputIterator>
+            void insert(sorted_tag, InputIterator first, InputIterator last) {
+                insert_range(first, last, true);
+            }
+
+            void insert(initializer_list<value_type> il) {
+                insert(il.begin(), il.end());
+            }
+
+            void insert(sorted_tag s, initializer_list<value_type> il) {
+                insert(s, il.begin(), il.end());
+            }
+
+            /* Leaves the map empty. */
+            containers extract() && {
+                containers r{move(c.keys), move(c.values)};
+                clear();
+                return r;
+            }
+
+            // The keys must be sorted, and for a flat_map unique.
+            void replace(key_container_type&& key_cont, mapped_container_type&& mapped_cont) {
+                try {
+                    c.keys = move(key_cont);
+                    c.values = move(mapped_cont);
+                } catch (...) {
+                    clear();
+                    throw;
+                }
+            }
+
+            iterator erase(iterator position) {
+                return erase(const_iterator(position));
+            }
+
+            iterator erase(const_iterator position) {
+                const size_type i = static_cast<size_type>(position - cbegin());
+                erase_indices(i, i + 1);
+                return iterator_at(i);
+            }
+
+            size_type erase(const key_type& x) {
+                return erase_key(x);
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare> && (!is_convertible_v<K&&, iterator>) && (!is_convertible_v<K&&, const_iterator>)
+            size_type erase(K&& x) {
+                return erase_key(x);
+            }
+
+            iterator erase(const_iterator first, const_iterator last) {
+                const size_type i = static_cast<size_type>(first - cbegin());
+                erase_indices(i, static_cast<size_type>(last - cbegin()));
+                return iterator_at(i);
+            }
+
+            void swap(__flat_map_base& y) noexcept {
+                std::swap(c.keys, y.c.keys);
+                std::swap(c.values, y.c.values);
+                std::swap(compare, y.compare);
+            }
+
+            void clear() noexcept {
+                c.keys.clear();
+                c.values.clear();
+            }
+
+            /* Observers */
+            key_compare key_comp() const {
+                return compare;
+            }
+
+            value_compare value_comp() const {
+                return value_compare(compare);
+            }
+
+            const key_container_type& keys() const noexcept {
+                return c.keys;
+            }
+
+            const mapped_container_type& values() const noexcept {
+                return c.values;
+            }
+
+            /* Map operations */
+            iterator find(const key_type& x) {
+                return iterator_at(find_index(x));
+            }
+
+            const_iterator find(const key_type& x) const {
+                return iterator_at(find_index(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            iterator find(const K& x) {
+                return iterator_at(find_index(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            const_iterator find(const K& x) const {
+                return iterator_at(find_index(x));
+            }
+
+            size_type count(const key_type& x) const {
+                return count_key(x);
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            size_type count(const K& x) const {
+                return count_key(x);
+            }
+
+            bool contains(const key_type& x) const {
+                return find_index(x) != size();
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            bool contains(const K& x) const {
+                return find_index(x) != size();
+            }
+
+            iterator lower_bound(const key_type& x) {
+                return iterator_at(lower_index(x));
+            }
+
+            const_iterator lower_bound(const key_type& x) const {
+                return iterator_at(lower_index(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            iterator lower_bound(const K& x) {
+                return iterator_at(lower_index(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            const_iterator lower_bound(const K& x) const {
+                return iterator_at(lower_index(x));
+            }
+
+            iterator upper_bound(const key_type& x) {
+                return iterator_at(upper_index(x));
+            }
+
+            const_iterator upper_bound(const key_type& x) const {
+                return iterator_at(upper_index(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            iterator upper_bound(const K& x) {
+                return iterator_at(upper_index(x));
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            const_iterator upper_bound(const K& x) const {
+                return iterator_at(upper_index(x));
+            }
+
+            pair<iterator, iterator> equal_range(const key_type& x) {
+                const pair<size_type, size_type> r = equal_indices(x);
+                return {iterator_at(r.first), iterator_at(r.second)};
+            }
+
+            pair<const_iterator, const_iterator> equal_range(const key_type& x) const {
+                const pair<size_type, size_type> r = equal_indices(x);
+                return {iterator_at(r.first), iterator_at(r.second)};
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            pair<iterator, iterator> equal_range(const K& x) {
+                const pair<size_type, size_type> r = equal_indices(x);
+                return {iterator_at(r.first), iterator_at(r.second)};
+            }
+
+            template<class K>
+            requires __transparent_compare<Compare>
+            pair<const_iterator, const_iterator> equal_range(const K& x) const {
+                const pair<size_type, size_type> r = equal_indices(x);
+                return {iterator_at(r.first), iterator_at(r.second)};
+            }
+
+            // Equal ranges of pairs are ranges of equal keys and of equal mapped values, so the containers are compared directly.
+            friend bool operator==(const __flat_map_base& x, const __flat_map_base& y) {
+                return x.c.keys == y.c.keys && x.c.values == y.c.values;
+            }
+
+            friend common_comparison_category_t<synth_three_way_result<key_type>, synth_three_way_result<mapped_type>>
+            operator<=>(const __flat_map_base& x, const __flat_map_base& y) {
+                const size_type n = x.size() < y.size() ? x.size() : y.size();
+                for (size_type i = 0; i < n; i++) {
+                    if (const auto cmp = synth_three_way(x.c.keys[i], y.c.keys[i]); cmp != 0) {
+                        return cmp;
+                    }
+                    if (const auto cmp = synth_three_way(x.c.values[i], y.c.values[i]); cmp != 0) {
+                        return cmp;
+                    }
+                }
+                return x.size() <=> y.size();
+            }
+        protected:
+            containers c;
+            [[no_unique_address]] key_compare compare;
+
+            iterator iterator_at(size_type i) noexcept {
+                return begin() + static_cast<difference_type>(i);
+            }
+
+            const_iterator iterator_at(size_type i) const noexcept {
+                return begin() + static_cast<difference_type>(i);
+            }
+
+            template<class K>
+            size_type lower_index(const K& x) const {
+                return static_cast<size_type>(__flat_lower_bound(c.keys.begin(), c.keys.size(), x, compare) - c.keys.begin());
+            }
+
+            template<class K>
+            size_type upper_index(const K& x) const {
+                return static_cast<size_type>(__flat_upper_bound(c.keys.begin(), c.keys.size(), x, compare) - c.keys.begin());
+            }
+
+            // Returns size() if there is no element with key x.
+            template<class K>
+            size_type find_index(const K& x) const {
+                const size_type i = lower_index(x);
+                return i != size() && !compare(x, c.keys[i]) ? i : size();
+            }
+
+            template<class K>
+            pair<size_type, size_type> equal_indices(const K& x) const {
+                const size_type i = lower_index(x);
+                if constexpr (Multi) {
+                    return {i, upper_index(x)};
+                } else {
+                    return {i, i != size() && !compare(x, c.keys[i]) ? i + 1 : i};
+                }
+            }
+
+            template<class K>
+            size_type count_key(const K& x) const {
+                const pair<size_type, size_type> r = equal_indices(x);
+                return r.second - r.first;
+            }
+
+            template<class K>
+            size_type erase_key(const K& x) {
+                const pair<size_type, size_type> r = equal_indices(x);
+                erase_indices(r.first, r.second);
+                return r.second - r.first;
+            }
+
+            void erase_indices(size_type i, size_type j) {
+                if (i == j) {
+                    return;
+                }
+                try {
+                    c.keys.erase(c.keys.begin() + i, c.keys.begin() + j);
+                    c.values.erase(c.values.begin() + i, c.values.begin() + j);
+                } catch (...) {
+                    clear();
+                    throw;
+                }
+            }
+
+            /* Inserts the key and the mapped value at index i. If the mapped value can't be inserted, takes the key back out. */
+            template<class K, class ...Args>
+            iterator insert_at(size_type i, K&& k, Args&& ...args) {
+                const auto key_it = c.keys.emplace(c.keys.begin() + i, forward<K>(k));
+                try {
+                    c.values.emplace(c.values.begin() + i, forward<Args>(args)...);
+                } catch (...) {
+                    c.keys.erase(key_it);
+                    throw;
+                }
+                return iterator_at(i);
+            }
+
+            template<class InputIterator>
+            void insert_range(InputIterator first, InputIterator last, bool sorted) {
+                key_container_type new_keys;
+                mapped_container_type new_values;
+                for (; first != last; ++first) {
+                    value_type t(*first);
+                    new_keys.insert(new_keys.end(), move(t.first));
+                    new_values.insert(new_values.end(), move(t.second));
+                }
+                merge_in(new_keys, new_values, sorted);
+            }
+
+            /* Adds the elements of new_keys and new_values, sorting them first unless they already are. Rather than inserting the elements one
+             * at a time, which moves the elements after each insertion point, merges the two sorted sequences into new containers in one
+             * pass; if every new key goes after the existing ones, appends them in place instead. Equivalent keys keep their order, with the
+             * existing elements first, and a flat_map keeps only the first of them. If anything throws, the map is left empty. */
+            void merge_in(key_container_type& new_keys, mapped_container_type& new_values, bool sorted) {
+                const size_type m = new_keys.size();
+                if (m == 0) {
+                    return;
+                }
+
+                if (!sorted) {
+                    sorted = true;
+                    for (size_type j = 1; j < m && sorted; j++) {
+                        sorted = !compare(new_keys[j], new_keys[j - 1]);
+                    }
+                }
+                vector<std::size_t> order;
+                if (!sorted) {
+                    order = __flat_sorted_positions(m, [&](std::size_t a, std::size_t b) { return compare(new_keys[a], new_keys[b]); });
+                }
+                const auto at = [&](size_type j) { return order.empty() ? j : order[j]; };
+
+                try {
+                    if (c.keys.empty() || compare(c.keys.back(), new_keys[at(0)])) {
+                        __flat_reserve(c.keys, size() + m);
+                        __flat_reserve(c.values, size() + m);
+                        for (size_type j = 0; j < m; j++) {
+                            append_new(c, new_keys, new_values, at(j));
+                        }
+                        return;
+                    }
+
+                    const size_type n = size();
+                    containers merged;
+                    __flat_reserve(merged.keys, n + m);
+                    __flat_reserve(merged.values, n + m);
+                    size_type i = 0, j = 0;
+                    while (i < n && j < m) {
+                        if (const size_type p = at(j); compare(new_keys[p], c.keys[i])) {
+                            append_new(merged, new_keys, new_values, p);
+                            j++;
+                        } else {
+                            merged.keys.insert(merged.keys.end(), move(c.keys[i]));
+                            merged.values.insert(merged.values.end(), move(c.values[i]));
+                            i++;
+                        }
+                    }
+                    for (; i < n; i++) {
+                        merged.keys.insert(merged.keys.end(), move(c.keys[i]));
+                        merged.values.insert(merged.values.end(), move(c.values[i]));
+                    }
+                    for (; j < m; j++) {
+                        append_new(merged, new_keys, new_values, at(j));
+                    }
+                    c.keys = move(merged.keys);
+                    c.values = move(merged.values);
+                } catch (...) {
+                    clear();
+                    throw;
+                }
+            }
+
+            // Appends the new element at index p, unless this is a flat_map and to already ends with an equivalent key.
+            void append_new(containers& to, key_container_type& new_keys, mapped_container_type& new_values, size_type p) {
+                if constexpr (!Multi) {
+                    if (!to.keys.empty() && !compare(to.keys.back(), new_keys[p])) {
+                        return;
+                    }
+                }
+                to.keys.insert(to.keys.end(), move(new_keys[p]));
+                to.values.insert(to.values.end(), move(new_values[p]));
+            }
+        };
+
+        template<class Map, class Predicate>
+        typename Map::size_type __flat_map_erase_if(Map& x, Predicate& pred) {
+            typename Map::containers cont = move(x).extract();
+            const typename Map::size_type n = cont.keys.size();
+            typename Map::size_type kept = 0;
+            for (typename Map::size_type i = 0; i < n; i++) {
+                if (!pred(typename Map::const_reference(cont.keys[i], cont.values[i]))) {
+                    if (i != kept) {
+                        cont.keys[kept] = move(cont.keys[i]);
+                        cont.values[kept] = move(cont.values[i]);
+                    }
+                    kept++;
+                }
+            }
+            cont.keys.erase(cont.keys.begin() + kept, cont.keys.end());
+            cont.values.erase(cont.values.begin() + kept, cont.values.end());
+            x.replace(move(cont.keys), move(cont.values));
+            return n - kept;
+        }
+    }
+
+    /* C++23 24.6.9 Class template flat_map
+     *
+     * Follows the standard except that there are no allocator-extended constructors; construct the containers with the allocator and pass
+     * them in instead. */
+    template<class Key, class T, class Compare = less<Key>, class KeyContainer = vector<Key>, class MappedContainer = vector<T>>
+    class flat_map : public __internal::__flat_map_base<Key, T, Compare, KeyContainer, MappedContainer, false> {
+    private:
+        using base = __internal::__flat_map_base<Key, T, Compare, KeyContainer, MappedContainer, false>;
+    public:
+        using typename base::key_type;
+        using typename base::mapped_type;
+        using typename base::value_type;
+        using typename base::size_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        using base::base;
+
+        // Declared here rather than inherited so that class template argument deduction sees an initializer-list constructor.
+        flat_map(initializer_list<value_type> il, const Compare& comp = Compare()) : base(il, comp) {}
+
+        flat_map& operator=(initializer_list<value_type> il) {
+            base::operator=(il);
+            return *this;
+        }
+
+        /* C++23 24.6.9.5 Access */
+        mapped_type& operator[](const key_type& x) {
+            return try_emplace(x).first->second;
+        }
+
+        mapped_type& operator[](key_type&& x) {
+            return try_emplace(move(x)).first->second;
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare> && is_constructible_v<key_type, K>
+        mapped_type& operator[](K&& x) {
+            return try_emplace(forward<K>(x)).first->second;
+        }
+
+        mapped_type& at(const key_type& x) {
+            return this->c.values[checked_index(x)];
+        }
+
+        const mapped_type& at(const key_type& x) const {
+            return this->c.values[checked_index(x)];
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare>
+        mapped_type& at(const K& x) {
+            return this->c.values[checked_index(x)];
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare>
+        const mapped_type& at(const K& x) const {
+            return this->c.values[checked_index(x)];
+        }
+
+        /* C++23 24.6.9.6 Modifiers */
+        template<class ...Args>
+        requires is_constructible_v<mapped_type, Args...>
+        pair<iterator, bool> try_emplace(const key_type& k, Args&& ...args) {
+            return try_emplace_key(k, forward<Args>(args)...);
+        }
+
+        template<class ...Args>
+        requires is_constructible_v<mapped_type, Args...>
+        pair<iterator, bool> try_emplace(key_type&& k, Args&& ...args) {
+            return try_emplace_key(move(k), forward<Args>(args)...);
+        }
+
+        template<class K, class ...Args>
+        requires __internal::__transparent_compare<Compare> && is_constructible_v<key_type, K> && is_constructible_v<mapped_type, Args...>
+            && (!is_convertible_v<K&&, const_iterator>) && (!is_convertible_v<K&&, iterator>)
+        pair<iterator, bool> try_emplace(K&& k, Args&& ...args) {
+            return try_emplace_key(forward<K>(k), forward<Args>(args)...);
+        }
+
+        template<class ...Args>
+        requires is_constructible_v<mapped_type, Args...>
+        iterator try_emplace(const_iterator, const key_type& k, Args&& ...args) {
+            return try_emplace(k, forward<Args>(args)...).first;
+        }
+
+        template<class ...Args>
+        requires is_constructible_v<mapped_type, Args...>
+        iterator try_emplace(const_iterator, key_type&& k, Args&& ...args) {
+            return try_emplace(move(k), forward<Args>(args)...).first;
+        }
+
+        // obj is only used if try_emplace didn't use it.
+        template<class M>
+        requires is_assignable_v<mapped_type&, M> && is_constructible_v<mapped_type, M>
+        pair<iterator, bool> insert_or_assign(const key_type& k, M&& obj) {
+            const pair<iterator, bool> r = try_emplace(k, forward<M>(obj));
+            if (!r.second) {
+                r.first->second = forward<M>(obj);
+            }
+            return r;
+        }
+
+        template<class M>
+        requires is_assignable_v<mapped_type&, M> && is_constructible_v<mapped_type, M>
+        pair<iterator, bool> insert_or_assign(key_type&& k, M&& obj) {
+            const pair<iterator, bool> r = try_emplace(move(k), forward<M>(obj));
+            if (!r.second) {
+                r.first->second = forward<M>(obj);
+            }
+            return r;
+        }
+
+        template<class M>
+        requires is_assignable_v<mapped_type&, M> && is_constructible_v<mapped_type, M>
+        iterator insert_or_assign(const_iterator, const key_type& k, M&& obj) {
+            return insert_or_assign(k, forward<M>(obj)).first;
+        }
+
+        template<class M>
+        requires is_assignable_v<mapped_type&, M> && is_constructible_v<mapped_type, M>
+        iterator insert_or_assign(const_iterator, key_type&& k, M&& obj) {
+            return insert_or_assign(move(k), forward<M>(obj)).first;
+        }
+    private:
+        template<class K>
+        size_type checked_index(const K& x) const {
+            const size_type i = this->find_index(x);
+            if (i == this->size()) [[unlikely]] {
+                throw out_of_range("Invalid argument to flat_map::at.");
+            }
+            return i;
+        }
+
+        template<class K, class ...Args>
+        pair<iterator, bool> try_emplace_key(K&& k, Args&& ...args) {
+            const size_type i = this->lower_index(k);
+            if (i != this->size() && !this->compare(k, this->c.keys[i])) {
+                return {this->iterator_at(i), false};
+            }
+            return {this->insert_at(i, forward<K>(k), forward<Args>(args)...), true};
+        }
+    };
+
+    /* C++23 24.6.10 Class template flat_multimap
+     *
+     * Equivalent keys are kept in insertion order. Like flat_map, there are no allocator-extended constructors. */
+    template<class Key, class T, class Compare = less<Key>, class KeyContainer = vector<Key>, class MappedContainer = vector<T>>
+    class flat_multimap : public __internal::__flat_map_base<Key, T, Compare, KeyContainer, MappedContainer, true> {
+    private:
+        using base = __internal::__flat_map_base<Key, T, Compare, KeyContainer, MappedContainer, true>;
+    public:
+        using typename base::value_type;
+
+        using base::base;
+
+        // Declared here rather than inherited so that class template argument deduction sees an initializer-list constructor.
+        flat_multimap(initializer_list<value_type> il, const Compare& comp = Compare()) : base(il, comp) {}
+
+        flat_multimap& operator=(initializer_list<value_type> il) {
+            base::operator=(il);
+            return *this;
+        }
+    };
+
+    template<class Key, class T, class Compare, class KeyContainer, class MappedContainer>
+    struct is_trivially_relocatable<flat_map<Key, T, Compare, KeyContainer, MappedContainer>>
+        : bool_constant<is_trivially_relocatable_v<Compare> && is_trivially_relocatable_v<KeyContainer>
+            && is_trivially_relocatable_v<MappedContainer>> {};
+
+    template<class Key, class T, class Compare, class KeyContainer, class MappedContainer>
+    struct is_trivially_relocatable<flat_multimap<Key, T, Compare, KeyContainer, MappedContainer>>
+        : bool_constant<is_trivially_relocatable_v<Compare> && is_trivially_relocatable_v<KeyContainer>
+            && is_trivially_relocatable_v<MappedContainer>> {};
+
+    template<class KeyContainer, class MappedContainer, class Compare = less<typename KeyContainer::value_type>>
+    requires (!__internal::legacy_input_iterator<KeyContainer>)
+    flat_map(KeyContainer, MappedContainer, Compare = Compare())
+        -> flat_map<typename KeyContainer::value_type, typename MappedContainer::value_type, Compare, KeyContainer, MappedContainer>;
+
+    template<class KeyContainer, class MappedContainer, class Compare = less<typename KeyContainer::value_type>>
+    flat_map(sorted_unique_t, KeyContainer, MappedContainer, Compare = Compare())
+        -> flat_map<typename KeyContainer::value_type, typename MappedContainer::value_type, Compare, KeyContainer, MappedContainer>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<__internal::__iter_key_t<InputIterator>>>
+    flat_map(InputIterator, InputIterator, Compare = Compare())
+        -> flat_map<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>, Compare>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<__internal::__iter_key_t<InputIterator>>>
+    flat_map(sorted_unique_t, InputIterator, InputIterator, Compare = Compare())
+        -> flat_map<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>, Compare>;
+
+    template<class Key, class T, class Compare = less<Key>>
+    flat_map(initializer_list<pair<Key, T>>, Compare = Compare()) -> flat_map<Key, T, Compare>;
+
+    template<class Key, class T, class Compare = less<Key>>
+    flat_map(sorted_unique_t, initializer_list<pair<Key, T>>, Compare = Compare()) -> flat_map<Key, T, Compare>;
+
+    template<class KeyContainer, class MappedContainer, class Compare = less<typename KeyContainer::value_type>>
+    requires (!__internal::legacy_input_iterator<KeyContainer>)
+    flat_multimap(KeyContainer, MappedContainer, Compare = Compare())
+        -> flat_multimap<typename KeyContainer::value_type, typename MappedContainer::value_type, Compare, KeyContainer, MappedContainer>;
+
+    template<class KeyContainer, class MappedContainer, class Compare = less<typename KeyContainer::value_type>>
+    flat_multimap(sorted_equivalent_t, KeyContainer, MappedContainer, Compare = Compare())
+        -> flat_multimap<typename KeyContainer::value_type, typename MappedContainer::value_type, Compare, KeyContainer, MappedContainer>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<__internal::__iter_key_t<InputIterator>>>
+    flat_multimap(InputIterator, InputIterator, Compare = Compare())
+        -> flat_multimap<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>, Compare>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<__internal::__iter_key_t<InputIterator>>>
+    flat_multimap(sorted_equivalent_t, InputIterator, InputIterator, Compare = Compare())
+        -> flat_multimap<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>, Compare>;
+
+    template<class Key, class T, class Compare = less<Key>>
+    flat_multimap(initializer_list<pair<Key, T>>, Compare = Compare()) -> flat_multimap<Key, T, Compare>;
+
+    template<class Key, class T, class Compare = less<Key>>
+    flat_multimap(sorted_equivalent_t, initializer_list<pair<Key, T>>, Compare = Compare()) -> flat_multimap<Key, T, Compare>;
+
+    template<class Key, class T, class Compare, class KeyContainer, class MappedContainer>
+    void swap(flat_map<Key, T, Compare, KeyContainer, MappedContainer>& x, flat_map<Key, T, Compare, KeyContainer, MappedContainer>& y) noexcept {
+        x.swap(y);
+    }
+
+    template<class Key, class T, class Compare, class KeyContainer, class MappedContainer>
+    void swap(flat_multimap<Key, T, Compare, KeyContainer, MappedContainer>& x,
+        flat_multimap<Key, T, Compare, KeyContainer, MappedContainer>& y) noexcept {
+        x.swap(y);
+    }
+
+    /* If pred throws, the map is left empty. */
+    template<class Key, class T, class Compare, class KeyContainer, class MappedContainer, class Predicate>
+    typename flat_map<Key, T, Compare, KeyContainer, MappedContainer>::size_type
+    erase_if(flat_map<Key, T, Compare, KeyContainer, MappedContainer>& c, Predicate pred) {
+        return __internal::__flat_map_erase_if(c, pred);
+    }
+
+    template<class Key, class T, class Compare, class KeyContainer, class MappedContainer, class Predicate>
+    typename flat_multimap<Key, T, Compare, KeyContainer, MappedContainer>::size_type
+    erase_if(flat_multimap<Key, T, Compare, KeyContainer, MappedContainer>& c, Predicate pred) {
+        return __internal::__flat_map_erase_if(c, pred);
+    }
+}
\ No newline at end of file
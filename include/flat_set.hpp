@@ -0,0 +1,455 @@
+#pragma once
+
+#include "__flat_base.hpp"
+#include "compare.hpp"
+#include "functional.hpp"
+#include "initializer_list.hpp"
+#include "iterator.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+namespace std {
+    /* C++23 24.6.11 Class template flat_set
+     *
+     * The keys are kept sorted in one container, so lookups are a binary search over contiguous keys and iteration is a linear scan, at the
+     * cost of inserting or erasing a single key in linear time. Inserting a range therefore sorts the new keys on their own and merges them
+     * into the set in one pass. There are no allocator-extended constructors; construct the container with the allocator and pass it in
+     * instead. */
+    template<class Key, class Compare = less<Key>, class KeyContainer = vector<Key>>
+    class flat_set {
+    public:
+        using key_type = Key;
+        using value_type = Key;
+        using key_compare = Compare;
+        using value_compare = Compare;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using size_type = typename KeyContainer::size_type;
+        using difference_type = typename KeyContainer::difference_type;
+        using iterator = typename KeyContainer::const_iterator;
+        using const_iterator = typename KeyContainer::const_iterator;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using container_type = KeyContainer;
+
+        static_assert(is_same_v<key_type, typename KeyContainer::value_type>, "The container must hold the key type.");
+
+        /* C++23 24.6.11.2 Constructors */
+        flat_set() : flat_set(key_compare()) {}
+
+        explicit flat_set(const key_compare& comp) : c(), compare(comp) {}
+
+        explicit flat_set(container_type cont, const key_compare& comp = key_compare()) : c(), compare(comp) {
+            merge_in(cont, false);
+        }
+
+        flat_set(sorted_unique_t, container_type cont, const key_compare& comp = key_compare()) : c(move(cont)), compare(comp) {}
+
+        template<__internal::legacy_input_iterator InputIterator>
+        flat_set(InputIterator first, InputIterator last, const key_compare& comp = key_compare()) : c(), compare(comp) {
+            insert(first, last);
+        }
+
+        template<__internal::legacy_input_iterator InputIterator>
+        flat_set(sorted_unique_t s, InputIterator first, InputIterator last, const key_compare& comp = key_compare()) : c(), compare(comp) {
+            insert(s, first, last);
+        }
+
+        flat_set(initializer_list<value_type> il, const key_compare& comp = key_compare()) : flat_set(il.begin(), il.end(), comp) {}
+
+        flat_set(sorted_unique_t s, initializer_list<value_type> il, const key_compare& comp = key_compare())
+            : flat_set(s, il.begin(), il.end(), comp) {}
+
+        flat_set& operator=(initializer_list<value_type> il) {
+            clear();
+            insert(il);
+            return *this;
+        }
+
+        /* Iterators */
+        iterator begin() const noexcept {
+            return c.begin();
+        }
+
+        iterator end() const noexcept {
+            return c.end();
+        }
+
+        reverse_iterator rbegin() const noexcept {
+            return reverse_iterator(end());
+        }
+
+        reverse_iterator rend() const noexcept {
+            return reverse_iterator(begin());
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+        const_reverse_iterator crbegin() const noexcept {
+            return rbegin();
+        }
+
+        const_reverse_iterator crend() const noexcept {
+            return rend();
+        }
+
+        /* Capacity */
+        [[nodiscard]] bool empty() const noexcept {
+            return c.empty();
+        }
+
+        size_type size() const noexcept {
+            return c.size();
+        }
+
+        size_type max_size() const noexcept {
+            return c.max_size();
+        }
+
+        /* C++23 24.6.11.4 Modifiers */
+        template<class ...Args>
+        requires is_constructible_v<value_type, Args...>
+        pair<iterator, bool> emplace(Args&& ...args) {
+            value_type t(forward<Args>(args)...);
+            return insert_key(move(t));
+        }
+
+        // The hint is ignored.
+        template<class ...Args>
+        requires is_constructible_v<value_type, Args...>
+        iterator emplace_hint(const_iterator, Args&& ...args) {
+            return emplace(forward<Args>(args)...).first;
+        }
+
+        pair<iterator, bool> insert(const value_type& x) {
+            return insert_key(x);
+        }
+
+        pair<iterator, bool> insert(value_type&& x) {
+            return insert_key(move(x));
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare> && is_constructible_v<value_type, K>
+        pair<iterator, bool> insert(K&& x) {
+            return insert_key(forward<K>(x));
+        }
+
+        iterator insert(const_iterator, const value_type& x) {
+            return insert_key(x).first;
+        }
+
+        iterator insert(const_iterator, value_type&& x) {
+            return insert_key(move(x)).first;
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare> && is_constructible_v<value_type, K>
+        iterator insert(const_iterator, K&& x) {
+            return insert_key(forward<K>(x)).first;
+        }
+
+        template<__internal::legacy_input_iterator InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            insert_range(first, last, false);
+        }
+
+        // The range must be sorted and hold no equivalent keys, so only the merge is left to do.
+        template<__internal::legacy_input_iterator InputIterator>
+        void insert(sorted_unique_t, InputIterator first, InputIterator last) {
+            insert_range(first, last, true);
+        }
+
+        void insert(initializer_list<value_type> il) {
+            insert(il.begin(), il.end());
+        }
+
+        void insert(sorted_unique_t s, initializer_list<value_type> il) {
+            insert(s, il.begin(), il.end());
+        }
+
+        /* Leaves the set empty. */
+        container_type extract() && {
+            container_type r = move(c);
+            clear();
+            return r;
+        }
+
+        // The keys must be sorted and unique.
+        void replace(container_type&& cont) {
+            try {
+                c = move(cont);
+            } catch (...) {
+                clear();
+                throw;
+            }
+        }
+
+        iterator erase(const_iterator position) {
+            return c.erase(position);
+        }
+
+        size_type erase(const key_type& x) {
+            return erase_key(x);
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare> && (!is_convertible_v<K&&, iterator>) && (!is_convertible_v<K&&, const_iterator>)
+        size_type erase(K&& x) {
+            return erase_key(x);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            return c.erase(first, last);
+        }
+
+        void swap(flat_set& y) noexcept {
+            std::swap(c, y.c);
+            std::swap(compare, y.compare);
+        }
+
+        void clear() noexcept {
+            c.clear();
+        }
+
+        /* Observers */
+        key_compare key_comp() const {
+            return compare;
+        }
+
+        value_compare value_comp() const {
+            return compare;
+        }
+
+        /* Set operations */
+        iterator find(const key_type& x) const {
+            return find_key(x);
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare>
+        iterator find(const K& x) const {
+            return find_key(x);
+        }
+
+        size_type count(const key_type& x) const {
+            return find_key(x) != end();
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare>
+        size_type count(const K& x) const {
+            const pair<iterator, iterator> r = equal_range(x);
+            return static_cast<size_type>(r.second - r.first);
+        }
+
+        bool contains(const key_type& x) const {
+            return find_key(x) != end();
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare>
+        bool contains(const K& x) const {
+            return find_key(x) != end();
+        }
+
+        iterator lower_bound(const key_type& x) const {
+            return __internal::__flat_lower_bound(c.begin(), c.size(), x, compare);
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare>
+        iterator lower_bound(const K& x) const {
+            return __internal::__flat_lower_bound(c.begin(), c.size(), x, compare);
+        }
+
+        iterator upper_bound(const key_type& x) const {
+            return __internal::__flat_upper_bound(c.begin(), c.size(), x, compare);
+        }
+
+        template<class K>
+        requires __internal::__transparent_compare<Compare>
+        iterator upper_bound(const K& x) const {
+            return __internal::__flat_upper_bound(c.begin(), c.size(), x, compare);
+        }
+
+        pair<iterator, iterator> equal_range(const key_type& x) const {
+            const iterator i = lower_bound(x);
+            return {i, i != end() && !compare(x, *i) ? i + 1 : i};
+        }
+
+        // With a transparent comparison, several keys can be equivalent to x.
+        template<class K>
+        requires __internal::__transparent_compare<Compare>
+        pair<iterator, iterator> equal_range(const K& x) const {
+            return {lower_bound(x), upper_bound(x)};
+        }
+
+        friend bool operator==(const flat_set& x, const flat_set& y) {
+            return x.c == y.c;
+        }
+
+        friend __internal::synth_three_way_result<value_type> operator<=>(const flat_set& x, const flat_set& y) {
+            const size_type n = x.size() < y.size() ? x.size() : y.size();
+            for (size_type i = 0; i < n; i++) {
+                if (const auto cmp = __internal::synth_three_way(x.c[i], y.c[i]); cmp != 0) {
+                    return cmp;
+                }
+            }
+            return x.size() <=> y.size();
+        }
+    private:
+        container_type c;
+        [[no_unique_address]] key_compare compare;
+
+        template<class K>
+        iterator find_key(const K& x) const {
+            const iterator i = lower_bound(x);
+            return i != end() && !compare(x, *i) ? i : end();
+        }
+
+        template<class K>
+        pair<iterator, bool> insert_key(K&& x) {
+            const iterator i = lower_bound(x);
+            if (i != end() && !compare(x, *i)) {
+                return {i, false};
+            }
+            return {c.emplace(i, forward<K>(x)), true};
+        }
+
+        template<class K>
+        size_type erase_key(const K& x) {
+            const pair<iterator, iterator> r = equal_range(x);
+            const size_type n = static_cast<size_type>(r.second - r.first);
+            c.erase(r.first, r.second);
+            return n;
+        }
+
+        template<class InputIterator>
+        void insert_range(InputIterator first, InputIterator last, bool sorted) {
+            container_type new_keys;
+            for (; first != last; ++first) {
+                new_keys.insert(new_keys.end(), *first);
+            }
+            merge_in(new_keys, sorted);
+        }
+
+        /* Adds the keys in new_keys, sorting them first unless they already are. Rather than inserting the keys one at a time, which moves the
+         * keys after each insertion point, merges the two sorted sequences into a new container in one pass; if every new key goes after the
+         * existing ones, appends them in place instead. Of equivalent keys, the first, preferring the existing one, is kept. If anything
+         * throws, the set is left empty. */
+        void merge_in(container_type& new_keys, bool sorted) {
+            const size_type m = new_keys.size();
+            if (m == 0) {
+                return;
+            }
+
+            if (!sorted) {
+                sorted = true;
+                for (size_type j = 1; j < m && sorted; j++) {
+                    sorted = !compare(new_keys[j], new_keys[j - 1]);
+                }
+            }
+            vector<std::size_t> order;
+            if (!sorted) {
+                order = __internal::__flat_sorted_positions(m, [&](std::size_t a, std::size_t b) { return compare(new_keys[a], new_keys[b]); });
+            }
+            const auto at = [&](size_type j) { return order.empty() ? j : order[j]; };
+
+            try {
+                if (c.empty() || compare(c.back(), new_keys[at(0)])) {
+                    __internal::__flat_reserve(c, size() + m);
+                    for (size_type j = 0; j < m; j++) {
+                        append_new(c, new_keys[at(j)]);
+                    }
+                    return;
+                }
+
+                const size_type n = size();
+                container_type merged;
+                __internal::__flat_reserve(merged, n + m);
+                size_type i = 0, j = 0;
+                while (i < n && j < m) {
+                    if (const size_type p = at(j); compare(new_keys[p], c[i])) {
+                        append_new(merged, new_keys[p]);
+                        j++;
+                    } else {
+                        merged.insert(merged.end(), move(c[i]));
+                        i++;
+                    }
+                }
+                for (; i < n; i++) {
+                    merged.insert(merged.end(), move(c[i]));
+                }
+                for (; j < m; j++) {
+                    append_new(merged, new_keys[at(j)]);
+                }
+                c = move(merged);
+            } catch (...) {
+                clear();
+                throw;
+            }
+        }
+
+        // Appends the new key unless to already ends with an equivalent one.
+        void append_new(container_type& to, value_type& key) {
+            if (to.empty() || compare(to.back(), key)) {
+                to.insert(to.end(), move(key));
+            }
+        }
+    };
+
+    template<class Key, class Compare, class KeyContainer>
+    struct is_trivially_relocatable<flat_set<Key, Compare, KeyContainer>>
+        : bool_constant<is_trivially_relocatable_v<Compare> && is_trivially_relocatable_v<KeyContainer>> {};
+
+    template<class KeyContainer, class Compare = less<typename KeyContainer::value_type>>
+    requires (!__internal::legacy_input_iterator<KeyContainer>)
+    flat_set(KeyContainer, Compare = Compare()) -> flat_set<typename KeyContainer::value_type, Compare, KeyContainer>;
+
+    template<class KeyContainer, class Compare = less<typename KeyContainer::value_type>>
+    flat_set(sorted_unique_t, KeyContainer, Compare = Compare()) -> flat_set<typename KeyContainer::value_type, Compare, KeyContainer>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<typename iterator_traits<InputIterator>::value_type>>
+    flat_set(InputIterator, InputIterator, Compare = Compare()) -> flat_set<typename iterator_traits<InputIterator>::value_type, Compare>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<typename iterator_traits<InputIterator>::value_type>>
+    flat_set(sorted_unique_t, InputIterator, InputIterator, Compare = Compare())
+        -> flat_set<typename iterator_traits<InputIterator>::value_type, Compare>;
+
+    template<class Key, class Compare = less<Key>>
+    flat_set(initializer_list<Key>, Compare = Compare()) -> flat_set<Key, Compare>;
+
+    template<class Key, class Compare = less<Key>>
+    flat_set(sorted_unique_t, initializer_list<Key>, Compare = Compare()) -> flat_set<Key, Compare>;
+
+    template<class Key, class Compare, class KeyContainer>
+    void swap(flat_set<Key, Compare, KeyContainer>& x, flat_set<Key, Compare, KeyContainer>& y) noexcept {
+        x.swap(y);
+    }
+
+    /* If pred throws, the set is left empty. */
+    template<class Key, class Compare, class KeyContainer, class Predicate>
+    typename flat_set<Key, Compare, KeyContainer>::size_type erase_if(flat_set<Key, Compare, KeyContainer>& c, Predicate pred) {
+        KeyContainer cont = move(c).extract();
+        const typename KeyContainer::size_type n = cont.size();
+        typename KeyContainer::size_type kept = 0;
+        for (typename KeyContainer::size_type i = 0; i < n; i++) {
+            if (!pred(as_const(cont[i]))) {
+                if (i != kept) {
+                    cont[kept] = move(cont[i]);
+                }
+                kept++;
+            }
+        }
+        cont.erase(cont.begin() + kept, cont.end());
+        c.replace(move(cont));
+        return n - kept;
+    }
+}
\ No newline at end of file
@@ -663,6 +663,287 @@ namespace std {
         }
     };
 
+    /* 20.14.18 Searchers */
+    namespace __internal {
+        // iterator_traits lives in <iterator>, which includes this header, so the searchers work out the value and difference types themselves.
+        template<class I>
+        using __searcher_value_t = remove_cvref_t<decltype(*declval<I&>())>;
+
+        template<class I>
+        using __searcher_difference_t = decltype(declval<I&>() - declval<I&>());
+
+        /* An owning array of trivial values that deep copies, as the searchers have to be copyable and <memory> can't be included from here. */
+        template<class T>
+        class __searcher_buffer {
+        public:
+            explicit __searcher_buffer(std::size_t n) : p(n != 0 ? new T[n]() : nullptr), n(n) {}
+
+            __searcher_buffer(const __searcher_buffer& x) : __searcher_buffer(x.n) {
+                for (std::size_t i = 0; i < n; i++) {
+                    p[i] = x.p[i];
+                }
+            }
+
+            __searcher_buffer(__searcher_buffer&& x) noexcept : p(exchange(x.p, nullptr)), n(exchange(x.n, 0)) {}
+
+            __searcher_buffer& operator=(__searcher_buffer x) noexcept {
+                swap(p, x.p);
+                swap(n, x.n);
+                return *this;
+            }
+
+            ~__searcher_buffer() {
+                delete[] p;
+            }
+
+            T& operator[](std::size_t i) noexcept {
+                return p[i];
+            }
+
+            const T& operator[](std::size_t i) const noexcept {
+                return p[i];
+            }
+
+        private:
+            T* p;
+            std::size_t n;
+        };
+
+        /* The bad character rule shared by both Boyer-Moore searchers and string_view::find. A skip table maps the corpus element aligned with
+         * the last element of the pattern to how far the pattern can safely be shifted: m - 1 minus the last position of that value among the
+         * first m - 1 elements of the pattern, or m if it doesn't occur there. */
+        template<class Difference>
+        struct __byte_skip_table {
+            /* Indexed by the low byte of the value. For values wider than a byte, every value sharing a low byte with some element of the pattern
+             * gets the smallest shift of those elements, which is always safe. */
+            template<class RandomAccessIterator, class ...Unused>
+            constexpr __byte_skip_table(RandomAccessIterator pat, Difference m, const Unused& ...) : skips() {
+                for (Difference& skip : skips) {
+                    skip = m;
+                }
+                for (Difference i = 0; i + 1 < m; i++) {
+                    skips[static_cast<unsigned char>(pat[i])] = m - 1 - i;
+                }
+            }
+
+            template<class T>
+            constexpr Difference operator()(const T& value) const noexcept {
+                return skips[static_cast<unsigned char>(value)];
+            }
+
+            Difference skips[256];
+        };
+
+        /* The general skip table, an open addressing hash table keyed by positions in the pattern, so that the values themselves never have to be
+         * copied or default constructed. */
+        template<class RandomAccessIterator, class Hash, class BinaryPredicate>
+        class __hashed_skip_table {
+        public:
+            using value_type = __searcher_value_t<RandomAccessIterator>;
+            using difference_type = __searcher_difference_t<RandomAccessIterator>;
+
+            __hashed_skip_table(RandomAccessIterator pat, difference_type m, const Hash& hf, const BinaryPredicate& pred)
+                : pat(pat), m(m), hf(hf), pred(pred), mask(bucket_count(m) - 1), entries(mask + 1) {
+                for (difference_type i = 0; i + 1 < m; i++) {
+                    entry& e = entries[lookup(pat[i])];
+                    e.position = i + 1;
+                    e.skip = m - 1 - i;
+                }
+            }
+
+            difference_type operator()(const value_type& value) const {
+                const entry& e = entries[lookup(value)];
+                return e.position != 0 ? e.skip : m;
+            }
+
+        private:
+            struct entry {
+                difference_type position; // One past the position of the value in the pattern, 0 when the bucket is empty.
+                difference_type skip;
+            };
+
+            static std::size_t bucket_count(difference_type m) noexcept {
+                std::size_t n = 1;
+                while (n < 2 * static_cast<std::size_t>(m)) {
+                    n <<= 1;
+                }
+                return n;
+            }
+
+            std::size_t lookup(const value_type& value) const {
+                std::size_t i = hf(value) & mask;
+                while (entries[i].position != 0 && !pred(value, pat[entries[i].position - 1])) {
+                    i = (i + 1) & mask;
+                }
+                return i;
+            }
+
+            RandomAccessIterator pat;
+            difference_type m;
+            Hash hf;
+            BinaryPredicate pred;
+            std::size_t mask;
+            __searcher_buffer<entry> entries;
+        };
+
+        // Byte-sized values compared with the default hash and equality don't need hashing at all.
+        template<class T, class Hash, class BinaryPredicate>
+        concept __byte_keyed_search = is_integral_v<T> && sizeof(T) == 1 && is_same_v<Hash, hash<T>>
+                                      && (is_same_v<BinaryPredicate, equal_to<>> || is_same_v<BinaryPredicate, equal_to<T>>);
+
+        template<class RandomAccessIterator, class Hash, class BinaryPredicate>
+        using __skip_table = conditional_t<__byte_keyed_search<__searcher_value_t<RandomAccessIterator>, Hash, BinaryPredicate>,
+                                           __byte_skip_table<__searcher_difference_t<RandomAccessIterator>>,
+                                           __hashed_skip_table<RandomAccessIterator, Hash, BinaryPredicate>>;
+
+        /* Horspool's algorithm: compare the window from its last element backwards, then shift it by the skip of the corpus element under the last
+         * element of the pattern. Returns the start of the first match in [first, last), or last. m must be positive. */
+        template<class RandomAccessIterator1, class RandomAccessIterator2, class Difference, class Skip, class BinaryPredicate>
+        constexpr RandomAccessIterator2 __horspool_search(RandomAccessIterator2 first, RandomAccessIterator2 last, RandomAccessIterator1 pat, Difference m,
+                                                          const Skip& skip, const BinaryPredicate& pred) {
+            for (; last - first >= m; first += skip(first[m - 1])) {
+                for (Difference j = m - 1; pred(first[j], pat[j]); j--) {
+                    if (j == 0) {
+                        return first;
+                    }
+                }
+            }
+            return last;
+        }
+    }
+
+    template<class ForwardIterator1, class BinaryPredicate = equal_to<>>
+    class default_searcher {
+    public:
+        constexpr default_searcher(ForwardIterator1 pat_first, ForwardIterator1 pat_last, BinaryPredicate pred = BinaryPredicate())
+            : pat_first(pat_first), pat_last(pat_last), pred(pred) {}
+
+        template<class ForwardIterator2>
+        constexpr pair<ForwardIterator2, ForwardIterator2> operator()(ForwardIterator2 first, ForwardIterator2 last) const {
+            for (; ; ++first) {
+                ForwardIterator2 it = first;
+                for (ForwardIterator1 p = pat_first; ; ++it, ++p) {
+                    if (p == pat_last) {
+                        return { first, it };
+                    }
+                    if (it == last) {
+                        return { last, last };
+                    }
+                    if (!pred(*it, *p)) {
+                        break;
+                    }
+                }
+            }
+        }
+
+    private:
+        ForwardIterator1 pat_first;
+        ForwardIterator1 pat_last;
+        BinaryPredicate pred;
+    };
+
+    template<class RandomAccessIterator1, class Hash = hash<__internal::__searcher_value_t<RandomAccessIterator1>>, class BinaryPredicate = equal_to<>>
+    class boyer_moore_searcher {
+    public:
+        boyer_moore_searcher(RandomAccessIterator1 pat_first, RandomAccessIterator1 pat_last, Hash hf = Hash(), BinaryPredicate pred = BinaryPredicate())
+            : pat_first(pat_first), m(pat_last - pat_first), pred(pred), skip(pat_first, m, hf, pred), good_suffix(m) {
+            if (m == 0) {
+                return;
+            }
+
+            // suffix[i] is the length of the longest substring ending at i that is also a suffix of the pattern.
+            __internal::__searcher_buffer<difference_type> suffix(m);
+            suffix[m - 1] = m;
+            for (difference_type i = m - 2, f = 0, g = m - 1; i >= 0; i--) {
+                if (i > g && suffix[i + m - 1 - f] < i - g) {
+                    suffix[i] = suffix[i + m - 1 - f];
+                } else {
+                    g = i < g ? i : g;
+                    f = i;
+                    while (g >= 0 && pred(pat_first[g], pat_first[g + m - 1 - f])) {
+                        g--;
+                    }
+                    suffix[i] = f - g;
+                }
+            }
+
+            // good_suffix[j] is the shift after a mismatch at j, aligning the matched suffix with its previous occurrence, or the longest prefix of
+            // the pattern that is also a suffix of it.
+            for (difference_type j = 0; j < m; j++) {
+                good_suffix[j] = m;
+            }
+            for (difference_type i = m - 1, j = 0; i >= 0; i--) {
+                if (suffix[i] == i + 1) {
+                    for (; j < m - 1 - i; j++) {
+                        if (good_suffix[j] == m) {
+                            good_suffix[j] = m - 1 - i;
+                        }
+                    }
+                }
+            }
+            for (difference_type i = 0; i + 1 < m; i++) {
+                good_suffix[m - 1 - suffix[i]] = m - 1 - i;
+            }
+        }
+
+        template<class RandomAccessIterator2>
+        pair<RandomAccessIterator2, RandomAccessIterator2> operator()(RandomAccessIterator2 first, RandomAccessIterator2 last) const {
+            if (m == 0) {
+                return { first, first };
+            }
+
+            while (last - first >= m) {
+                difference_type j = m - 1;
+                for (; pred(first[j], pat_first[j]); j--) {
+                    if (j == 0) {
+                        return { first, first + m };
+                    }
+                }
+
+                const difference_type bad_char = skip(first[j]) - (m - 1 - j);
+                first += good_suffix[j] > bad_char ? good_suffix[j] : bad_char;
+            }
+            return { last, last };
+        }
+
+    private:
+        using difference_type = __internal::__searcher_difference_t<RandomAccessIterator1>;
+
+        RandomAccessIterator1 pat_first;
+        difference_type m;
+        BinaryPredicate pred;
+        __internal::__skip_table<RandomAccessIterator1, Hash, BinaryPredicate> skip;
+        __internal::__searcher_buffer<difference_type> good_suffix;
+    };
+
+    template<class RandomAccessIterator1, class Hash = hash<__internal::__searcher_value_t<RandomAccessIterator1>>, class BinaryPredicate = equal_to<>>
+    class boyer_moore_horspool_searcher {
+    public:
+        boyer_moore_horspool_searcher(RandomAccessIterator1 pat_first, RandomAccessIterator1 pat_last, Hash hf = Hash(), BinaryPredicate pred = BinaryPredicate())
+            : pat_first(pat_first), m(pat_last - pat_first), pred(pred), skip(pat_first, m, hf, pred) {}
+
+        template<class RandomAccessIterator2>
+        pair<RandomAccessIterator2, RandomAccessIterator2> operator()(RandomAccessIterator2 first, RandomAccessIterator2 last) const {
+            if (m == 0) {
+                return { first, first };
+            }
+
+            const RandomAccessIterator2 it = __internal::__horspool_search(first, last, pat_first, m, skip, pred);
+            if (it == last) {
+                return { last, last };
+            }
+            return { it, it + m };
+        }
+
+    private:
+        using difference_type = __internal::__searcher_difference_t<RandomAccessIterator1>;
+
+        RandomAccessIterator1 pat_first;
+        difference_type m;
+        BinaryPredicate pred;
+        __internal::__skip_table<RandomAccessIterator1, Hash, BinaryPredicate> skip;
+    };
+
     /* 20.14.9 Concept-constrained comparisons */
     namespace ranges {
         struct equal_to {
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "cstddef.hpp"
+#include "string.hpp"
+#include "string_view.hpp"
+#include "functional.hpp"
+#include "compare.hpp"
+
+namespace std {
+    namespace __internal {
+        /* The pooled copy of an interned string, with its characters stored right after it, followed by a terminator. Entries are never freed,
+         * so that handles stay valid for the whole run of the program, including static destructors. */
+        struct __interned_entry {
+            std::size_t hash;
+            std::size_t length;
+            const char* data;
+        };
+
+        extern constinit const __interned_entry __empty_interned_entry;
+
+        /* Returns the unique entry holding s, adding it to the pool if it isn't there yet. The pool is split into shards by hash, each guarded by
+         * its own shared_mutex, so that looking up strings that are already interned only takes a shared lock. See src/interned_string.cpp. */
+        const __interned_entry* __intern(string_view s);
+    }
+
+    /* Extension: a handle to a string kept in a process-wide pool, where equal strings are stored once. Interning costs a hash and a lookup in
+     * the pool, after which comparing two handles for equality compares pointers, and hashing one returns the hash computed when the string
+     * was added to the pool. Handles are the size of a pointer, and are trivially copyable. Interning is thread-safe.
+     *
+     * Ordering compares the characters, as the addresses in the pool would give an order that changes from run to run. */
+    class interned_string {
+    public:
+        constexpr interned_string() noexcept : e(&__internal::__empty_interned_entry) {}
+
+        explicit interned_string(string_view s) : e(__internal::__intern(s)) {}
+
+        explicit interned_string(const char* s) : interned_string(string_view(s)) {}
+
+        const char* data() const noexcept {
+            return e->data;
+        }
+
+        const char* c_str() const noexcept {
+            return e->data;
+        }
+
+        std::size_t size() const noexcept {
+            return e->length;
+        }
+
+        std::size_t length() const noexcept {
+            return e->length;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return e->length == 0;
+        }
+
+        string_view view() const noexcept {
+            return string_view(e->data, e->length);
+        }
+
+        operator string_view() const noexcept {
+            return view();
+        }
+
+        /* The hash cached in the pool. */
+        std::size_t hash() const noexcept {
+            return e->hash;
+        }
+
+        friend bool operator==(interned_string x, interned_string y) noexcept {
+            return x.e == y.e;
+        }
+
+        friend strong_ordering operator<=>(interned_string x, interned_string y) noexcept {
+            if (x.e == y.e) {
+                return strong_ordering::equal;
+            }
+            return x.view().compare(y.view()) <=> 0;
+        }
+
+    private:
+        const __internal::__interned_entry* e;
+    };
+
+    template<>
+    struct hash<interned_string> {
+        std::size_t operator()(const interned_string& s) const noexcept {
+            return s.hash();
+        }
+    };
+}
\ No newline at end of file
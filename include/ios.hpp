@@ -18,6 +18,13 @@ namespace std {
         && is_nothrow_destructible_v<stateT>
     class fpos {
     public:
+        /* 29.5.4.2 Requirements: a position converts to and from a streamoff, and moves by streamoff offsets. */
+        fpos(streamoff off = 0) : st(), off(off) {}
+
+        operator streamoff() const {
+            return off;
+        }
+
         stateT state() const {
             return st;
         }
@@ -26,8 +33,37 @@ namespace std {
             st = s;
         }
 
+        fpos& operator+=(streamoff o) {
+            off += o;
+            return *this;
+        }
+
+        fpos& operator-=(streamoff o) {
+            off -= o;
+            return *this;
+        }
+
+        fpos operator+(streamoff o) const {
+            fpos r = *this;
+            return r += o;
+        }
+
+        fpos operator-(streamoff o) const {
+            fpos r = *this;
+            return r -= o;
+        }
+
+        streamoff operator-(const fpos& p) const {
+            return off - p.off;
+        }
+
+        friend bool operator==(const fpos& p, const fpos& q) {
+            return p.off == q.off;
+        }
+
     private:
         stateT st;
+        streamoff off;
     };
 
     /* 29.5.7 Error reporting */
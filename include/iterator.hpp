@@ -172,7 +172,7 @@ namespace std {
     }
     struct iterator_traits<I> {
         using difference_type = typename I::difference_type;
-        using value_type = typename I::difference_type;
+        using value_type = typename I::value_type;
         using pointer = typename I::pointer;
         using reference = typename I::reference;
         using iterator_category = typename I::iterator_category;
@@ -185,10 +185,10 @@ namespace std {
         typename I::value_type;
         typename I::reference;
         typename I::iterator_category;
-    }
+    } && (!requires { typename I::pointer; })
     struct iterator_traits<I> {
         using difference_type = typename I::difference_type;
-        using value_type = typename I::difference_type;
+        using value_type = typename I::value_type;
         using pointer = void;
         using reference = typename I::reference;
         using iterator_category = typename I::iterator_category;
@@ -370,8 +370,9 @@ namespace std {
 
     /* 23.3.4 Iterator concepts */
     namespace __internal {
+        // The specializations of iterator_traits that stand in for the primary template, built from I itself, define __primary_template.
         template<class I>
-        using __iter_traits_t = conditional_t<!requires { typename iterator_traits<I>::__primary_template; }, I, iterator_traits<I>>;
+        using __iter_traits_t = conditional_t<requires { typename iterator_traits<I>::__primary_template; }, I, iterator_traits<I>>;
 
         template<class I>
         struct __iter_concept {
@@ -381,7 +382,7 @@ namespace std {
                     return declval<typename __iter_traits_t<I>::iterator_concept>();
                 } else if constexpr (requires { typename __iter_traits_t<I>::iterator_category; }) {
                     return declval<typename __iter_traits_t<I>::iterator_category>();
-                } else if constexpr (!requires { typename iterator_traits<I>::__primary_template; }) {
+                } else if constexpr (requires { typename iterator_traits<I>::__primary_template; }) {
                     return declval<random_access_iterator_tag>();
                 }
             }
@@ -650,6 +651,16 @@ namespace std {
                 { a <= b } -> convertible_to<bool>;
                 { a >= b } -> convertible_to<bool>;
             };
+
+        // Used by the deduction guides of the map containers.
+        template<class InputIterator>
+        using __iter_key_t = remove_const_t<typename iterator_traits<InputIterator>::value_type::first_type>;
+
+        template<class InputIterator>
+        using __iter_mapped_t = typename iterator_traits<InputIterator>::value_type::second_type;
+
+        template<class InputIterator>
+        using __iter_to_alloc_t = pair<const __iter_key_t<InputIterator>, __iter_mapped_t<InputIterator>>;
     }
 
     template<__internal::legacy_input_iterator InputIterator, class Distance>
@@ -1413,7 +1424,7 @@ namespace std {
             return *this;
         }
 
-        constexpr auto operator[](difference_type n) const -> decltype(this->current[-n - 1])
+        constexpr decltype(auto) operator[](difference_type n) const
         requires __internal::legacy_random_access_iterator<Iterator> || random_access_iterator<Iterator> {
             return current[-n - 1];
         }
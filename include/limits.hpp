@@ -309,10 +309,10 @@ namespace std {
             return 0.5F;
         }
 
-        static constexpr float min_exponent = FLT_MIN_EXP;
-        static constexpr float min_exponent10 = FLT_MIN_10_EXP;
-        static constexpr float max_exponent = FLT_MAX_EXP;
-        static constexpr float max_exponent10 = FLT_MAX_10_EXP;
+        static constexpr int min_exponent = FLT_MIN_EXP;
+        static constexpr int min_exponent10 = FLT_MIN_10_EXP;
+        static constexpr int max_exponent = FLT_MAX_EXP;
+        static constexpr int max_exponent10 = FLT_MAX_10_EXP;
 
         static constexpr bool has_infinity = true;
         static constexpr bool has_quiet_NaN = true;
@@ -386,10 +386,10 @@ namespace std {
             return 0.5;
         }
 
-        static constexpr double min_exponent = DBL_MIN_EXP;
-        static constexpr double min_exponent10 = DBL_MIN_10_EXP;
-        static constexpr double max_exponent = DBL_MAX_EXP;
-        static constexpr double max_exponent10 = DBL_MAX_10_EXP;
+        static constexpr int min_exponent = DBL_MIN_EXP;
+        static constexpr int min_exponent10 = DBL_MIN_10_EXP;
+        static constexpr int max_exponent = DBL_MAX_EXP;
+        static constexpr int max_exponent10 = DBL_MAX_10_EXP;
 
         static constexpr bool has_infinity = true;
         static constexpr bool has_quiet_NaN = true;
@@ -464,10 +464,10 @@ namespace std {
             return 0.5L;
         }
 
-        static constexpr long double min_exponent = LDBL_MIN_EXP;
-        static constexpr long double min_exponent10 = LDBL_MIN_10_EXP;
-        static constexpr long double max_exponent = LDBL_MAX_EXP;
-        static constexpr long double max_exponent10 = LDBL_MAX_10_EXP;
+        static constexpr int min_exponent = LDBL_MIN_EXP;
+        static constexpr int min_exponent10 = LDBL_MIN_10_EXP;
+        static constexpr int max_exponent = LDBL_MAX_EXP;
+        static constexpr int max_exponent10 = LDBL_MAX_10_EXP;
 
         static constexpr bool has_infinity = true;
         static constexpr bool has_quiet_NaN = true;
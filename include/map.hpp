@@ -0,0 +1,293 @@
+#pragma once
+
+#include "__tree.hpp"
+#include "compare.hpp"
+#include "functional.hpp"
+#include "initializer_list.hpp"
+#include "memory.hpp"
+#include "memory_resource.hpp"
+#include "stdexcept.hpp"
+#include "tuple.hpp"
+
+namespace std {
+    /* 22.4.4 Class template map
+     *
+     * The elements are the nodes of a red-black tree (see __internal::__tree). The allocator must use raw pointers.
+     *
+     * A map has no node pool of its own: every node is allocated on its own through the allocator. The only way to get pooled nodes is
+     * pmr::map over a pool resource such as unsynchronized_pool_resource, which hands out and takes back nodes from fixed-size pools. */
+    template<class Key, class T, class Compare = less<Key>, class Allocator = allocator<pair<const Key, T>>>
+    class map : public __internal::__tree<__internal::__map_policy<Key, T>, Compare, Allocator, false> {
+    private:
+        using base = __internal::__tree<__internal::__map_policy<Key, T>, Compare, Allocator, false>;
+    public:
+        using mapped_type = T;
+        using typename base::key_type;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+        using typename base::insert_return_type;
+
+        class value_compare {
+        private:
+            friend class map;
+        protected:
+            Compare comp;
+
+            value_compare(Compare c) : comp(c) {}
+        public:
+            bool operator()(const value_type& x, const value_type& y) const {
+                return comp(x.first, y.first);
+            }
+        };
+
+        using base::base;
+
+        // Declared here rather than inherited so that class template argument deduction sees an initializer-list constructor.
+        map(initializer_list<value_type> il, const Compare& comp = Compare(), const Allocator& a = Allocator()) : base(il, comp, a) {}
+
+        map& operator=(initializer_list<value_type> il) {
+            base::operator=(il);
+            return *this;
+        }
+
+        value_compare value_comp() const {
+            return value_compare(this->key_comp());
+        }
+
+        using base::insert;
+
+        template<class P>
+        requires is_constructible_v<value_type, P&&>
+        pair<iterator, bool> insert(P&& x) {
+            return this->emplace(forward<P>(x));
+        }
+
+        template<class P>
+        requires is_constructible_v<value_type, P&&>
+        iterator insert(const_iterator position, P&& x) {
+            return this->emplace_hint(position, forward<P>(x));
+        }
+
+        /* 22.4.4.4 Modifiers */
+        template<class ...Args>
+        pair<iterator, bool> try_emplace(const key_type& k, Args&& ...args) {
+            return this->emplace_key(const_iterator(), k, piecewise_construct, forward_as_tuple(k), forward_as_tuple(forward<Args>(args)...));
+        }
+
+        template<class ...Args>
+        pair<iterator, bool> try_emplace(key_type&& k, Args&& ...args) {
+            return this->emplace_key(const_iterator(), k, piecewise_construct, forward_as_tuple(move(k)), forward_as_tuple(forward<Args>(args)...));
+        }
+
+        template<class ...Args>
+        iterator try_emplace(const_iterator hint, const key_type& k, Args&& ...args) {
+            return this->emplace_key(hint, k, piecewise_construct, forward_as_tuple(k), forward_as_tuple(forward<Args>(args)...)).first;
+        }
+
+        template<class ...Args>
+        iterator try_emplace(const_iterator hint, key_type&& k, Args&& ...args) {
+            return this->emplace_key(hint, k, piecewise_construct, forward_as_tuple(move(k)), forward_as_tuple(forward<Args>(args)...)).first;
+        }
+
+        // obj is only used if try_emplace didn't use it.
+        template<class M>
+        requires is_assignable_v<T&, M&&>
+        pair<iterator, bool> insert_or_assign(const key_type& k, M&& obj) {
+            const pair<iterator, bool> r = try_emplace(k, forward<M>(obj));
+            if (!r.second) {
+                r.first->second = forward<M>(obj);
+            }
+            return r;
+        }
+
+        template<class M>
+        requires is_assignable_v<T&, M&&>
+        pair<iterator, bool> insert_or_assign(key_type&& k, M&& obj) {
+            const pair<iterator, bool> r = try_emplace(move(k), forward<M>(obj));
+            if (!r.second) {
+                r.first->second = forward<M>(obj);
+            }
+            return r;
+        }
+
+        template<class M>
+        requires is_assignable_v<T&, M&&>
+        iterator insert_or_assign(const_iterator hint, const key_type& k, M&& obj) {
+            const pair<iterator, bool> r = this->emplace_key(hint, k, piecewise_construct, forward_as_tuple(k), forward_as_tuple(forward<M>(obj)));
+            if (!r.second) {
+                r.first->second = forward<M>(obj);
+            }
+            return r.first;
+        }
+
+        template<class M>
+        requires is_assignable_v<T&, M&&>
+        iterator insert_or_assign(const_iterator hint, key_type&& k, M&& obj) {
+            const pair<iterator, bool> r = this->emplace_key(hint, k, piecewise_construct, forward_as_tuple(move(k)), forward_as_tuple(forward<M>(obj)));
+            if (!r.second) {
+                r.first->second = forward<M>(obj);
+            }
+            return r.first;
+        }
+
+        /* 22.4.4.3 Element access */
+        mapped_type& operator[](const key_type& k) {
+            return try_emplace(k).first->second;
+        }
+
+        mapped_type& operator[](key_type&& k) {
+            return try_emplace(move(k)).first->second;
+        }
+
+        mapped_type& at(const key_type& k) {
+            const iterator it = this->find(k);
+            if (it == this->end()) [[unlikely]] {
+                throw out_of_range("Invalid argument to map::at.");
+            }
+            return it->second;
+        }
+
+        const mapped_type& at(const key_type& k) const {
+            const const_iterator it = this->find(k);
+            if (it == this->end()) [[unlikely]] {
+                throw out_of_range("Invalid argument to map::at.");
+            }
+            return it->second;
+        }
+    };
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<__internal::__iter_key_t<InputIterator>>,
+        class Allocator = allocator<__internal::__iter_to_alloc_t<InputIterator>>>
+    map(InputIterator, InputIterator, Compare = Compare(), Allocator = Allocator())
+        -> map<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>, Compare, Allocator>;
+
+    template<class Key, class T, class Compare = less<Key>, class Allocator = allocator<pair<const Key, T>>>
+    map(initializer_list<pair<Key, T>>, Compare = Compare(), Allocator = Allocator()) -> map<Key, T, Compare, Allocator>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Allocator>
+    map(InputIterator, InputIterator, Allocator)
+        -> map<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>, less<__internal::__iter_key_t<InputIterator>>,
+            Allocator>;
+
+    template<class Key, class T, class Allocator>
+    map(initializer_list<pair<Key, T>>, Allocator) -> map<Key, T, less<Key>, Allocator>;
+
+    template<class Key, class T, class Compare, class Allocator>
+    bool operator==(const map<Key, T, Compare, Allocator>& x, const map<Key, T, Compare, Allocator>& y) {
+        return __internal::__tree_equal(x, y);
+    }
+
+    template<class Key, class T, class Compare, class Allocator>
+    __internal::synth_three_way_result<pair<const Key, T>> operator<=>(const map<Key, T, Compare, Allocator>& x, const map<Key, T, Compare, Allocator>& y) {
+        return __internal::__tree_three_way(x, y);
+    }
+
+    template<class Key, class T, class Compare, class Allocator>
+    void swap(map<Key, T, Compare, Allocator>& x, map<Key, T, Compare, Allocator>& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+
+    template<class Key, class T, class Compare, class Allocator, class Predicate>
+    typename map<Key, T, Compare, Allocator>::size_type erase_if(map<Key, T, Compare, Allocator>& c, Predicate pred) {
+        return __internal::__tree_erase_if(c, pred);
+    }
+
+    /* 22.4.5 Class template multimap */
+    template<class Key, class T, class Compare = less<Key>, class Allocator = allocator<pair<const Key, T>>>
+    class multimap : public __internal::__tree<__internal::__map_policy<Key, T>, Compare, Allocator, true> {
+    private:
+        using base = __internal::__tree<__internal::__map_policy<Key, T>, Compare, Allocator, true>;
+    public:
+        using mapped_type = T;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        class value_compare {
+        private:
+            friend class multimap;
+        protected:
+            Compare comp;
+
+            value_compare(Compare c) : comp(c) {}
+        public:
+            bool operator()(const value_type& x, const value_type& y) const {
+                return comp(x.first, y.first);
+            }
+        };
+
+        using base::base;
+
+        // Declared here rather than inherited so that class template argument deduction sees an initializer-list constructor.
+        multimap(initializer_list<value_type> il, const Compare& comp = Compare(), const Allocator& a = Allocator()) : base(il, comp, a) {}
+
+        multimap& operator=(initializer_list<value_type> il) {
+            base::operator=(il);
+            return *this;
+        }
+
+        value_compare value_comp() const {
+            return value_compare(this->key_comp());
+        }
+
+        using base::insert;
+
+        template<class P>
+        requires is_constructible_v<value_type, P&&>
+        iterator insert(P&& x) {
+            return this->emplace(forward<P>(x));
+        }
+
+        template<class P>
+        requires is_constructible_v<value_type, P&&>
+        iterator insert(const_iterator position, P&& x) {
+            return this->emplace_hint(position, forward<P>(x));
+        }
+    };
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<__internal::__iter_key_t<InputIterator>>,
+        class Allocator = allocator<__internal::__iter_to_alloc_t<InputIterator>>>
+    multimap(InputIterator, InputIterator, Compare = Compare(), Allocator = Allocator())
+        -> multimap<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>, Compare, Allocator>;
+
+    template<class Key, class T, class Compare = less<Key>, class Allocator = allocator<pair<const Key, T>>>
+    multimap(initializer_list<pair<Key, T>>, Compare = Compare(), Allocator = Allocator()) -> multimap<Key, T, Compare, Allocator>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Allocator>
+    multimap(InputIterator, InputIterator, Allocator)
+        -> multimap<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>,
+            less<__internal::__iter_key_t<InputIterator>>, Allocator>;
+
+    template<class Key, class T, class Allocator>
+    multimap(initializer_list<pair<Key, T>>, Allocator) -> multimap<Key, T, less<Key>, Allocator>;
+
+    template<class Key, class T, class Compare, class Allocator>
+    bool operator==(const multimap<Key, T, Compare, Allocator>& x, const multimap<Key, T, Compare, Allocator>& y) {
+        return __internal::__tree_equal(x, y);
+    }
+
+    template<class Key, class T, class Compare, class Allocator>
+    __internal::synth_three_way_result<pair<const Key, T>> operator<=>(const multimap<Key, T, Compare, Allocator>& x,
+        const multimap<Key, T, Compare, Allocator>& y) {
+        return __internal::__tree_three_way(x, y);
+    }
+
+    template<class Key, class T, class Compare, class Allocator>
+    void swap(multimap<Key, T, Compare, Allocator>& x, multimap<Key, T, Compare, Allocator>& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+
+    template<class Key, class T, class Compare, class Allocator, class Predicate>
+    typename multimap<Key, T, Compare, Allocator>::size_type erase_if(multimap<Key, T, Compare, Allocator>& c, Predicate pred) {
+        return __internal::__tree_erase_if(c, pred);
+    }
+
+    namespace pmr {
+        template<class Key, class T, class Compare = less<Key>>
+        using map = std::map<Key, T, Compare, polymorphic_allocator<pair<const Key, T>>>;
+
+        template<class Key, class T, class Compare = less<Key>>
+        using multimap = std::multimap<Key, T, Compare, polymorphic_allocator<pair<const Key, T>>>;
+    }
+}
\ No newline at end of file
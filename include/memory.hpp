@@ -7,4 +7,6 @@
 #include "memory/shared_ptr.hpp"
 #include "memory/specialized_algorithms.hpp"
 #include "memory/weak_ptr.hpp"
+#include "memory/local_shared_ptr.hpp"
+#include "memory/atomic_shared_ptr.hpp"
 #include "memory/smart_ptr_support.hpp"
\ No newline at end of file
@@ -9,6 +9,13 @@
 #include "cstddef.hpp"
 
 namespace std {
+    /* C++23 20.2.9.3 Allocation result */
+    template<class Pointer, class SizeType = std::size_t>
+    struct allocation_result {
+        Pointer ptr;
+        SizeType count;
+    };
+
     /* 20.10.9 Allocator traits */
     template<class Alloc>
     requires requires { typename Alloc::value_type; }
@@ -150,6 +157,28 @@ namespace std {
             }
         }
 
+        /* C++23: allocates storage for at least n objects, and returns how many objects it actually fits. The storage must be deallocated with
+         * that count. */
+        [[nodiscard]] static constexpr allocation_result<pointer, size_type> allocate_at_least(Alloc& a, size_type n)
+        requires requires { a.allocate(n); } {
+            if constexpr (requires { a.allocate_at_least(n); }) {
+                return a.allocate_at_least(n);
+            } else {
+                return { a.allocate(n), n };
+            }
+        }
+
+        /* Extension: attempts to grow the storage for n objects at p, which was obtained from `a`, in place so that it holds new_n objects, where
+         * new_n > n. Returns whether it did, in which case the storage must be deallocated with new_n. Allocators opt in by providing a try_expand
+         * member with the same parameters; for the others this always fails. */
+        static constexpr bool try_expand(Alloc& a, pointer p, size_type n, size_type new_n) {
+            if constexpr (requires { { a.try_expand(p, n, new_n) } -> convertible_to<bool>; }) {
+                return a.try_expand(p, n, new_n);
+            } else {
+                return false;
+            }
+        }
+
         static constexpr void deallocate(Alloc& a, pointer p, size_type n)
         requires requires { a.deallocate(p, n); }  {
             a.deallocate(p, n);
@@ -220,6 +249,19 @@ namespace std {
             }
         }
 
+        /* Extends the allocation to the size the underlying malloc handed out for it anyway. */
+        [[nodiscard]] constexpr allocation_result<T*> allocate_at_least(std::size_t n)
+        requires __internal::is_complete<T>::value {
+            if (numeric_limits<std::size_t>::max() / sizeof(T) < n) {
+                throw bad_array_new_length();
+            } else if (is_constant_evaluated()) {
+                return { allocate(n), n };
+            }
+
+            const __internal::sized_allocation block = __internal::allocate_at_least(n * sizeof(T));
+            return { static_cast<T*>(block.ptr), block.size / sizeof(T) };
+        }
+
         constexpr void deallocate(T* p, std::size_t n) {
             ::operator delete(p, n * sizeof(T));
         }
@@ -0,0 +1,338 @@
+#pragma once
+
+#include "atomic.hpp"
+#include "cstddef.hpp"
+#include "cstdint.hpp"
+#include "cstdlib.hpp"
+#include "memory/shared_ptr.hpp"
+#include "memory/weak_ptr.hpp"
+#include "utility.hpp"
+
+namespace std {
+    namespace __internal {
+        /* The implementation shared by atomic<shared_ptr<T>> and atomic<weak_ptr<T>>, where P is the smart pointer type. Loads never block, and
+         * never write to anything but the atomic word and the reference counts.
+         *
+         * The value is kept in a heap "box", a __ctrl_obj<P> that is created by every store and never modified afterwards. The atomic word holds
+         * the address of the box in its low 48 bits, and in its high 16 bits a count of the loads that have announced themselves on the box
+         * but haven't finished copying the value out of it yet (split reference counting):
+         * - A load announces itself with a single fetch_add on the word, which both reads the box address and keeps the box alive, copies the
+         *   value, and then takes its announcement back by decrementing the count in the word, as long as the word still holds the same box.
+         * - A store swaps in a new box and transfers the announcements found in the old word to the shared_count of the old box. The loads still
+         *   in flight will notice that the word has changed, and release their reference through the shared_count instead.
+         *
+         * A box installed in the word holds `bias` shared references on behalf of the atomic, rather than 1. A load may release its transferred
+         * reference before the store that unlinked the box has added the transferred count, so the bias keeps shared_count from hitting 0 in the
+         * meantime; it's larger than any number of announcements the word can hold.
+         *
+         * A box is never installed twice and can't be freed while any announcement on it is outstanding, so its address can't be reused behind
+         * the back of a load, which rules out ABA on the word. Every operation on the word is sequentially consistent, which the memory_order
+         * arguments are allowed to strengthen to. An empty value is represented by a null word, without a box; the announcement count on a
+         * null word is meaningless.
+         *
+         * The layout has two limits, and the program is aborted rather than left with a corrupted word when either is exceeded:
+         * - The box address must fit in 48 bits. User-space addresses do on x86-64 and AArch64, unless the program maps memory above 2^47 or
+         *   tags its pointers in the top byte (AArch64 top-byte ignore, as used by MTE and HWASan), which make_word checks for.
+         * - At most 65535 loads can be announced on a box at once, i.e. no more than that many threads may be inside load or compare_exchange
+         *   on the same atomic at the same time. One more would carry out of the word, which announce checks for. */
+        template<class P>
+        struct __atomic_smart_ptr {
+        private:
+            static_assert(sizeof(std::uintptr_t) == 8, "atomic<shared_ptr> packs a pointer and a count in a 64-bit word.");
+
+            using box_type = __ctrl_obj<P>;
+
+            static constexpr int count_shift = 48;
+            static constexpr std::uintptr_t count_one = std::uintptr_t(1) << count_shift;
+            static constexpr std::uintptr_t ptr_mask = count_one - 1;
+            static constexpr long bias = 1l << 16;
+
+            mutable std::uintptr_t word;
+
+            static box_type* box_of(std::uintptr_t w) noexcept {
+                return reinterpret_cast<box_type*>(w & ptr_mask);
+            }
+
+            static long announcements(std::uintptr_t w) noexcept {
+                return static_cast<long>(w >> count_shift);
+            }
+
+            static bool equivalent(const P& a, const P& b) noexcept {
+                return a.ptr == b.ptr && a.ctrl == b.ctrl;
+            }
+
+            /* Returns the word to install for `desired`, allocating a box unless it's empty. Failure to allocate terminates, as the standard
+             * requires every operation to be noexcept. */
+            static std::uintptr_t make_word(P&& desired) noexcept {
+                if (desired.ptr == nullptr && desired.ctrl == nullptr) {
+                    return 0;
+                }
+
+                box_type* const box = new box_type(move(desired));
+                if ((reinterpret_cast<std::uintptr_t>(box) & ~ptr_mask) != 0) [[unlikely]] {
+                    abort();
+                }
+                box->increment_shared_count(bias - 1);
+                return reinterpret_cast<std::uintptr_t>(box);
+            }
+
+            /* Drops the references held by the atomic on the box of a word that has just been unlinked, turning the announcements on it into
+             * references of the box, minus `own` announcements that belong to the caller and are dropped as well. */
+            static void retire(std::uintptr_t w, long own = 0) noexcept {
+                if (box_type* const box = box_of(w)) {
+                    box->add_shared_count(announcements(w) - own - bias);
+                }
+            }
+
+            /* Announces a load. Returns the box the announcement was made on, which stays alive until the announcement is released. */
+            box_type* announce() const noexcept {
+                const std::uintptr_t w = __atomic_fetch_add(&word, count_one, __ATOMIC_SEQ_CST);
+                // Loads on a null word never take their announcement back, so the count may wrap there.
+                if (announcements(w) == static_cast<long>(~ptr_mask >> count_shift) && box_of(w) != nullptr) [[unlikely]] {
+                    abort();
+                }
+                return box_of(w);
+            }
+
+            void release(box_type* box) const noexcept {
+                if (box == nullptr) {
+                    return;
+                }
+
+                std::uintptr_t curr = __atomic_load_n(&word, __ATOMIC_RELAXED);
+                while (box_of(curr) == box) {
+                    if (__atomic_compare_exchange_n(&word, &curr, curr - count_one, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+                        return;
+                    }
+                }
+                // The box has been unlinked, and the announcement transferred to its shared_count.
+                box->add_shared_count(-1);
+            }
+        public:
+            constexpr __atomic_smart_ptr() noexcept : word(0) {}
+            explicit __atomic_smart_ptr(P desired) noexcept : word(make_word(move(desired))) {}
+            __atomic_smart_ptr(const __atomic_smart_ptr&) = delete;
+            __atomic_smart_ptr& operator=(const __atomic_smart_ptr&) = delete;
+
+            ~__atomic_smart_ptr() noexcept {
+                retire(word);
+            }
+
+            P load() const noexcept {
+                box_type* const box = announce();
+                if (box == nullptr) {
+                    return P();
+                }
+
+                P result(*box->get_object_ptr());
+                release(box);
+                return result;
+            }
+
+            P exchange(P desired) noexcept {
+                const std::uintptr_t old = __atomic_exchange_n(&word, make_word(move(desired)), __ATOMIC_SEQ_CST);
+                P result;
+                if (box_type* const box = box_of(old)) {
+                    // Without announcements nobody else can be reading the box, since it's no longer reachable from the word.
+                    if (announcements(old) == 0) {
+                        result = move(*box->get_object_ptr());
+                    } else {
+                        result = *box->get_object_ptr();
+                    }
+                }
+                retire(old);
+                return result;
+            }
+
+            void store(P desired) noexcept {
+                retire(__atomic_exchange_n(&word, make_word(move(desired)), __ATOMIC_SEQ_CST));
+            }
+
+            bool compare_exchange(P& expected, P desired) noexcept {
+                const std::uintptr_t desired_word = make_word(move(desired));
+                while (true) {
+                    box_type* const box = announce();
+                    const P empty;
+                    const P& curr_value = box ? *box->get_object_ptr() : empty;
+
+                    if (!equivalent(curr_value, expected)) {
+                        expected = curr_value;
+                        release(box);
+                        retire(desired_word);
+                        return false;
+                    }
+
+                    std::uintptr_t curr = __atomic_load_n(&word, __ATOMIC_RELAXED);
+                    while (box_of(curr) == box) {
+                        if (__atomic_compare_exchange_n(&word, &curr, desired_word, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                            // `curr` counts the announcement made above, which is given up along with the references of the atomic.
+                            retire(curr, box ? 1 : 0);
+                            return true;
+                        }
+                    }
+                    // The word changed under us, but might hold an equivalent value again, so start over.
+                    release(box);
+                }
+            }
+
+            /* Every store installs a new box, so the value can only have changed if the box address in the word has. Only when it has is the
+             * value loaded and compared, as a store may have installed an equivalent value. `seen` starts out as no box address at all, so
+             * the first check always compares. */
+            void wait(const P& old) const noexcept {
+                std::uintptr_t seen = ~std::uintptr_t(0);
+                __atomic_wait(&word, [&] {
+                    const std::uintptr_t curr = __atomic_load_n(&word, __ATOMIC_SEQ_CST) & ptr_mask;
+                    if (curr == seen) {
+                        return false;
+                    }
+                    seen = curr;
+                    return !equivalent(load(), old);
+                });
+            }
+
+            void notify() noexcept {
+                __atomic_notify(&word);
+            }
+        };
+    }
+
+    /* 20.11.7.2 Partial specialization for shared_ptr */
+    template<class T>
+    struct atomic<shared_ptr<T>> {
+    private:
+        __internal::__atomic_smart_ptr<shared_ptr<T>> impl;
+    public:
+        using value_type = shared_ptr<T>;
+
+        /* The atomic word is only ever updated by lock-free operations, although the store operations allocate a box through operator new. */
+        static constexpr bool is_always_lock_free = true;
+        bool is_lock_free() const noexcept {
+            return true;
+        }
+
+        constexpr atomic() noexcept = default;
+        constexpr atomic(nullptr_t) noexcept : atomic() {}
+        atomic(shared_ptr<T> desired) noexcept : impl(move(desired)) {}
+        atomic(const atomic&) = delete;
+        void operator=(const atomic&) = delete;
+
+        void store(shared_ptr<T> desired, memory_order = memory_order::seq_cst) noexcept {
+            impl.store(move(desired));
+        }
+
+        void operator=(shared_ptr<T> desired) noexcept {
+            store(move(desired));
+        }
+
+        void operator=(nullptr_t) noexcept {
+            store(nullptr);
+        }
+
+        shared_ptr<T> load(memory_order = memory_order::seq_cst) const noexcept {
+            return impl.load();
+        }
+
+        operator shared_ptr<T>() const noexcept {
+            return load();
+        }
+
+        shared_ptr<T> exchange(shared_ptr<T> desired, memory_order = memory_order::seq_cst) noexcept {
+            return impl.exchange(move(desired));
+        }
+
+        bool compare_exchange_weak(shared_ptr<T>& expected, shared_ptr<T> desired, memory_order, memory_order) noexcept {
+            return impl.compare_exchange(expected, move(desired));
+        }
+
+        bool compare_exchange_strong(shared_ptr<T>& expected, shared_ptr<T> desired, memory_order, memory_order) noexcept {
+            return impl.compare_exchange(expected, move(desired));
+        }
+
+        bool compare_exchange_weak(shared_ptr<T>& expected, shared_ptr<T> desired, memory_order = memory_order::seq_cst) noexcept {
+            return impl.compare_exchange(expected, move(desired));
+        }
+
+        bool compare_exchange_strong(shared_ptr<T>& expected, shared_ptr<T> desired, memory_order = memory_order::seq_cst) noexcept {
+            return impl.compare_exchange(expected, move(desired));
+        }
+
+        void wait(shared_ptr<T> old, memory_order = memory_order::seq_cst) const noexcept {
+            impl.wait(old);
+        }
+
+        void notify_one() noexcept {
+            impl.notify();
+        }
+
+        void notify_all() noexcept {
+            impl.notify();
+        }
+    };
+
+    /* 20.11.7.3 Partial specialization for weak_ptr */
+    template<class T>
+    struct atomic<weak_ptr<T>> {
+    private:
+        __internal::__atomic_smart_ptr<weak_ptr<T>> impl;
+    public:
+        using value_type = weak_ptr<T>;
+
+        static constexpr bool is_always_lock_free = true;
+        bool is_lock_free() const noexcept {
+            return true;
+        }
+
+        constexpr atomic() noexcept = default;
+        atomic(weak_ptr<T> desired) noexcept : impl(move(desired)) {}
+        atomic(const atomic&) = delete;
+        void operator=(const atomic&) = delete;
+
+        void store(weak_ptr<T> desired, memory_order = memory_order::seq_cst) noexcept {
+            impl.store(move(desired));
+        }
+
+        void operator=(weak_ptr<T> desired) noexcept {
+            store(move(desired));
+        }
+
+        weak_ptr<T> load(memory_order = memory_order::seq_cst) const noexcept {
+            return impl.load();
+        }
+
+        operator weak_ptr<T>() const noexcept {
+            return load();
+        }
+
+        weak_ptr<T> exchange(weak_ptr<T> desired, memory_order = memory_order::seq_cst) noexcept {
+            return impl.exchange(move(desired));
+        }
+
+        bool compare_exchange_weak(weak_ptr<T>& expected, weak_ptr<T> desired, memory_order, memory_order) noexcept {
+            return impl.compare_exchange(expected, move(desired));
+        }
+
+        bool compare_exchange_strong(weak_ptr<T>& expected, weak_ptr<T> desired, memory_order, memory_order) noexcept {
+            return impl.compare_exchange(expected, move(desired));
+        }
+
+        bool compare_exchange_weak(weak_ptr<T>& expected, weak_ptr<T> desired, memory_order = memory_order::seq_cst) noexcept {
+            return impl.compare_exchange(expected, move(desired));
+        }
+
+        bool compare_exchange_strong(weak_ptr<T>& expected, weak_ptr<T> desired, memory_order = memory_order::seq_cst) noexcept {
+            return impl.compare_exchange(expected, move(desired));
+        }
+
+        void wait(weak_ptr<T> old, memory_order = memory_order::seq_cst) const noexcept {
+            impl.wait(old);
+        }
+
+        void notify_one() noexcept {
+            impl.notify();
+        }
+
+        void notify_all() noexcept {
+            impl.notify();
+        }
+    };
+}
\ No newline at end of file
@@ -32,7 +32,7 @@ namespace std {
     constexpr void destroy_at(T* location) {
         if constexpr (is_array<T>::value) {
             // Equivalent to destroy(begin(*location), end(*location)).
-            for (T& elem: *location) {
+            for (auto& elem: *location) {
                 destroy_at(addressof(elem));
             }
         } else {
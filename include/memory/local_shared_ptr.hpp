@@ -0,0 +1,418 @@
+#pragma once
+
+#include "cstddef.hpp"
+#include "compare.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+
+#include "memory/shared_ptr.hpp"
+#include "memory/unique_ptr.hpp"
+
+namespace std {
+    /* Extension: local_shared_ptr and local_weak_ptr
+     *
+     * Smart pointers with the semantics of shared_ptr and weak_ptr, for object graphs that never leave the thread that created them. They use the
+     * same control blocks as shared_ptr, but update the reference counts without atomic read-modify-write operations for as long as the block is
+     * only referenced by local pointers. Converting a local_shared_ptr to a shared_ptr upgrades its block, after which every pointer to the block,
+     * local or not, updates the counts atomically.
+     *
+     * All local pointers to a block must stay on one thread until the block is upgraded. enable_shared_from_this is not hooked up for objects
+     * owned by local pointers. */
+    template<class T>
+    class local_weak_ptr;
+
+    template<class T>
+    class local_shared_ptr {
+    public:
+        using element_type = remove_extent_t<T>;
+        using weak_type = local_weak_ptr<T>;
+    private:
+        template<class Y>
+        friend class local_shared_ptr;
+
+        template<class Y>
+        friend class local_weak_ptr;
+
+        element_type* ptr;
+        __internal::__ctrl* ctrl;
+
+    public:
+        constexpr local_shared_ptr() noexcept : ptr(nullptr), ctrl(nullptr) {}
+        constexpr local_shared_ptr(nullptr_t) noexcept : ptr(nullptr), ctrl(nullptr) {}
+
+        template<class Y>
+        requires __internal::is_complete<Y>::value && (!is_array_v<T>)
+            && is_convertible_v<Y*, T*> && requires (Y* p) { { delete p } noexcept; }
+        explicit local_shared_ptr(Y* p) : ptr(p) {
+            try {
+                ctrl = new __internal::__ctrl_ptr<T>(p);
+                ctrl->make_local();
+            } catch (...) {
+                delete p;
+                throw;
+            }
+        }
+
+        template<class Y, class D>
+        requires is_nothrow_move_constructible_v<D> && is_nothrow_convertible_v<Y*, T*> && requires (Y* p, D d) { { d(p) } noexcept; }
+        local_shared_ptr(Y* p, D d) : ptr(p) {
+            try {
+                ctrl = new __internal::__ctrl_ptr_with_deleter<T, D>(p, move(d));
+                ctrl->make_local();
+            } catch (...) {
+                d(p);
+                throw;
+            }
+        }
+
+        template<class Y>
+        local_shared_ptr(const local_shared_ptr<Y>& r, element_type* p) noexcept : ptr(p), ctrl(r.ctrl) {
+            if (ctrl) {
+                ctrl->local_increment_shared_count();
+            }
+        }
+
+        template<class Y>
+        local_shared_ptr(local_shared_ptr<Y>&& r, element_type* p) noexcept : ptr(p), ctrl(r.ctrl) {
+            r.ptr = nullptr;
+            r.ctrl = nullptr;
+        }
+
+        local_shared_ptr(const local_shared_ptr& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            if (ctrl) {
+                ctrl->local_increment_shared_count();
+            }
+        }
+
+        template<class Y>
+        requires is_convertible_v<Y*, T*>
+        local_shared_ptr(const local_shared_ptr<Y>& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            if (ctrl) {
+                ctrl->local_increment_shared_count();
+            }
+        }
+
+        local_shared_ptr(local_shared_ptr&& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            r.ptr = nullptr;
+            r.ctrl = nullptr;
+        }
+
+        template<class Y>
+        requires is_convertible_v<Y*, T*>
+        local_shared_ptr(local_shared_ptr<Y>&& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            r.ptr = nullptr;
+            r.ctrl = nullptr;
+        }
+
+        /* Shares ownership with a shared_ptr. The block is already shared across threads, so this pointer updates the counts atomically. */
+        template<class Y>
+        requires is_convertible_v<Y*, T*>
+        local_shared_ptr(const shared_ptr<Y>& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            if (ctrl) {
+                ctrl->increment_shared_count();
+            }
+        }
+
+        template<class Y>
+        requires is_convertible_v<Y*, T*>
+        explicit local_shared_ptr(const local_weak_ptr<Y>& r) : ptr(r.ptr), ctrl(r.ctrl) {
+            if (!ctrl || !ctrl->local_try_increment_shared_count()) {
+                throw std::bad_weak_ptr();
+            }
+        }
+
+        template<class Y, class D>
+        requires is_convertible_v<typename unique_ptr<Y, D>::pointer, element_type*> && (!is_reference_v<D>)
+        local_shared_ptr(unique_ptr<Y, D>&& r) : ptr(nullptr), ctrl(nullptr) {
+            if (r.get()) {
+                ctrl = new __internal::__ctrl_ptr_with_deleter<T, D>(r.get(), move(r.get_deleter()));
+                ctrl->make_local();
+                ptr = r.release();
+            }
+        }
+
+        /* Takes ownership of a freshly-created make_shared style block. Only used internally by make_local_shared and allocate_local_shared. */
+        static local_shared_ptr __make_local_shared(__internal::__ctrl_obj<T>* ctrl) noexcept {
+            ctrl->make_local();
+            local_shared_ptr result;
+            result.ptr = ctrl->get_object_ptr();
+            result.ctrl = ctrl;
+            return result;
+        }
+
+        ~local_shared_ptr() {
+            if (ctrl) {
+                ctrl->local_decrement_shared_count();
+            }
+        }
+
+        local_shared_ptr& operator=(const local_shared_ptr& r) noexcept {
+            local_shared_ptr(r).swap(*this);
+            return *this;
+        }
+
+        template<class Y>
+        local_shared_ptr& operator=(const local_shared_ptr<Y>& r) noexcept {
+            local_shared_ptr(r).swap(*this);
+            return *this;
+        }
+
+        local_shared_ptr& operator=(local_shared_ptr&& r) noexcept {
+            local_shared_ptr(move(r)).swap(*this);
+            return *this;
+        }
+
+        template<class Y>
+        local_shared_ptr& operator=(local_shared_ptr<Y>&& r) noexcept {
+            local_shared_ptr(move(r)).swap(*this);
+            return *this;
+        }
+
+        template<class Y, class D>
+        local_shared_ptr& operator=(unique_ptr<Y, D>&& r) {
+            local_shared_ptr(move(r)).swap(*this);
+            return *this;
+        }
+
+        /* Upgrades the control block so that it can be shared across threads, and returns a shared_ptr sharing ownership with this pointer. */
+        template<class Y>
+        requires is_convertible_v<T*, Y*>
+        explicit operator shared_ptr<Y>() const noexcept {
+            shared_ptr<Y> result;
+            if (ctrl) {
+                ctrl->upgrade();
+                ctrl->increment_shared_count();
+                result.ptr = ptr;
+                result.ctrl = ctrl;
+            }
+            return result;
+        }
+
+        void swap(local_shared_ptr& r) noexcept {
+            std::swap(ptr, r.ptr);
+            std::swap(ctrl, r.ctrl);
+        }
+
+        void reset() noexcept {
+            local_shared_ptr().swap(*this);
+        }
+
+        template<class Y>
+        void reset(Y* p) {
+            local_shared_ptr(p).swap(*this);
+        }
+
+        template<class Y, class D>
+        void reset(Y* p, D d) {
+            local_shared_ptr(p, d).swap(*this);
+        }
+
+        element_type* get() const noexcept {
+            return ptr;
+        }
+
+        T& operator*() const noexcept requires (!is_void_v<T>) {
+            return *get();
+        }
+
+        T* operator->() const noexcept {
+            return get();
+        }
+
+        long use_count() const noexcept {
+            return ctrl ? ctrl->get_shared_count() : 0;
+        }
+
+        explicit operator bool() const noexcept {
+            return get() != nullptr;
+        }
+
+        template<class U>
+        bool owner_before(const local_shared_ptr<U>& b) const noexcept {
+            return ctrl < b.ctrl;
+        }
+
+        template<class U>
+        bool owner_before(const local_weak_ptr<U>& b) const noexcept {
+            return ctrl < b.ctrl;
+        }
+    };
+
+    template<class T>
+    struct is_trivially_relocatable<local_shared_ptr<T>> : true_type {};
+
+    template<class T>
+    class local_weak_ptr {
+    public:
+        using element_type = remove_extent_t<T>;
+    private:
+        template<class Y>
+        friend class local_shared_ptr;
+
+        template<class Y>
+        friend class local_weak_ptr;
+
+        element_type* ptr;
+        __internal::__ctrl* ctrl;
+
+    public:
+        constexpr local_weak_ptr() noexcept : ptr(nullptr), ctrl(nullptr) {}
+
+        local_weak_ptr(const local_weak_ptr& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            if (ctrl) {
+                ctrl->local_increment_weak_count();
+            }
+        }
+
+        template<class Y>
+        requires is_convertible_v<Y*, T*>
+        local_weak_ptr(const local_weak_ptr<Y>& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            if (ctrl) {
+                ctrl->local_increment_weak_count();
+            }
+        }
+
+        template<class Y>
+        requires is_convertible_v<Y*, T*>
+        local_weak_ptr(const local_shared_ptr<Y>& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            if (ctrl) {
+                ctrl->local_increment_weak_count();
+            }
+        }
+
+        local_weak_ptr(local_weak_ptr&& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            r.ptr = nullptr;
+            r.ctrl = nullptr;
+        }
+
+        template<class Y>
+        requires is_convertible_v<Y*, T*>
+        local_weak_ptr(local_weak_ptr<Y>&& r) noexcept : ptr(r.ptr), ctrl(r.ctrl) {
+            r.ptr = nullptr;
+            r.ctrl = nullptr;
+        }
+
+        ~local_weak_ptr() {
+            if (ctrl) {
+                ctrl->local_decrement_weak_count();
+            }
+        }
+
+        local_weak_ptr& operator=(const local_weak_ptr& r) noexcept {
+            local_weak_ptr(r).swap(*this);
+            return *this;
+        }
+
+        template<class Y>
+        local_weak_ptr& operator=(const local_weak_ptr<Y>& r) noexcept {
+            local_weak_ptr(r).swap(*this);
+            return *this;
+        }
+
+        template<class Y>
+        local_weak_ptr& operator=(const local_shared_ptr<Y>& r) noexcept {
+            local_weak_ptr(r).swap(*this);
+            return *this;
+        }
+
+        local_weak_ptr& operator=(local_weak_ptr&& r) noexcept {
+            local_weak_ptr(move(r)).swap(*this);
+            return *this;
+        }
+
+        void swap(local_weak_ptr& r) noexcept {
+            std::swap(ptr, r.ptr);
+            std::swap(ctrl, r.ctrl);
+        }
+
+        void reset() noexcept {
+            local_weak_ptr().swap(*this);
+        }
+
+        long use_count() const noexcept {
+            return ctrl ? ctrl->get_shared_count() : 0;
+        }
+
+        bool expired() const noexcept {
+            return use_count() == 0;
+        }
+
+        local_shared_ptr<T> lock() const noexcept {
+            local_shared_ptr<T> result;
+            if (ctrl && ctrl->local_try_increment_shared_count()) {
+                result.ptr = ptr;
+                result.ctrl = ctrl;
+            }
+            return result;
+        }
+
+        template<class U>
+        bool owner_before(const local_shared_ptr<U>& b) const noexcept {
+            return ctrl < b.ctrl;
+        }
+
+        template<class U>
+        bool owner_before(const local_weak_ptr<U>& b) const noexcept {
+            return ctrl < b.ctrl;
+        }
+    };
+
+    template<class T>
+    struct is_trivially_relocatable<local_weak_ptr<T>> : true_type {};
+
+    template<class T, class ...Args>
+    requires (!is_array_v<T>)
+    local_shared_ptr<T> make_local_shared(Args&& ...args) {
+        return local_shared_ptr<T>::__make_local_shared(new __internal::__ctrl_obj<T>(forward<Args>(args)...));
+    }
+
+    template<class T, class A, class ...Args>
+    requires (!is_array_v<T>)
+    local_shared_ptr<T> allocate_local_shared(const A& a, Args&& ...args) {
+        return local_shared_ptr<T>::__make_local_shared(__internal::__ctrl_obj_with_alloc<T, A>::create(a, forward<Args>(args)...));
+    }
+
+    template<class T, class U>
+    bool operator==(const local_shared_ptr<T>& a, const local_shared_ptr<U>& b) noexcept {
+        return a.get() == b.get();
+    }
+
+    template<class T>
+    bool operator==(const local_shared_ptr<T>& a, nullptr_t) noexcept {
+        return !a;
+    }
+
+    template<class T, class U>
+    strong_ordering operator<=>(const local_shared_ptr<T>& a, const local_shared_ptr<U>& b) noexcept {
+        return compare_three_way()(a.get(), b.get());
+    }
+
+    template<class T>
+    void swap(local_shared_ptr<T>& a, local_shared_ptr<T>& b) noexcept {
+        a.swap(b);
+    }
+
+    template<class T>
+    void swap(local_weak_ptr<T>& a, local_weak_ptr<T>& b) noexcept {
+        a.swap(b);
+    }
+
+    template<class T, class U>
+    local_shared_ptr<T> static_pointer_cast(const local_shared_ptr<U>& r) noexcept {
+        return local_shared_ptr<T>(r, static_cast<typename local_shared_ptr<T>::element_type*>(r.get()));
+    }
+
+    template<class T, class U>
+    local_shared_ptr<T> dynamic_pointer_cast(const local_shared_ptr<U>& r) noexcept {
+        if (auto ptr = dynamic_cast<typename local_shared_ptr<T>::element_type*>(r.get()); ptr) {
+            return local_shared_ptr<T>(r, ptr);
+        } else {
+            return local_shared_ptr<T>();
+        }
+    }
+
+    template<class T, class U>
+    local_shared_ptr<T> const_pointer_cast(const local_shared_ptr<U>& r) noexcept {
+        return local_shared_ptr<T>(r, const_cast<typename local_shared_ptr<T>::element_type*>(r.get()));
+    }
+}
\ No newline at end of file
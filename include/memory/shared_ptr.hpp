@@ -24,37 +24,119 @@ namespace std {
     namespace __internal {
         struct __ctrl {
         protected:
-            // Current number of weak_ptrs holding this block, plus 1 if there's any shared_ptr holding the block.
-            long weak_count;
-            // Number of shared_ptrs holding this block.
-            long shared_count;
+            /* Both reference counts, packed into one word so that the common cases touch a single atomic:
+             * - The low 32 bits hold the number of shared_ptrs holding this block.
+             * - The high 32 bits hold the number of weak_ptrs holding this block, plus 1 if there's any shared_ptr holding the block.
+             *
+             * Increments are relaxed, as a new reference can only be made from an existing one, which already keeps the block alive. Decrements
+             * are acq_rel, so that every access made through a reference happens before the content or the block is deleted.
+             *
+             * This limits a block to 2^32 - 1 shared references and 2^31 - 1 weak ones (bit 63 is local_flag). Past that, an increment would
+             * carry into the next field and corrupt it, so every increment checks the count it started from and aborts the program instead. */
+            unsigned long long counts;
+
+            static constexpr unsigned long long shared_one = 1;
+            static constexpr unsigned long long weak_one = 1ull << 32;
+            static constexpr unsigned long long shared_mask = weak_one - 1;
+            /* Set while the block is only referenced by local_shared_ptrs and local_weak_ptrs, all of which live on one thread. Only the local_*
+             * member functions check it; they update the counts with plain loads and stores while it's set. It's cleared for good once the block is
+             * converted to a shared_ptr. */
+            static constexpr unsigned long long local_flag = 1ull << 63;
+            static constexpr unsigned long long weak_mask = ~shared_mask & ~local_flag;
+
+            /* Aborts the program if adding n to the shared count, or one to the weak count, of `c` would overflow. */
+            static void check_shared_increment(unsigned long long c, unsigned long long n) noexcept {
+                if ((c & shared_mask) > shared_mask - n) [[unlikely]] {
+                    count_overflow();
+                }
+            }
+
+            static void check_weak_increment(unsigned long long c) noexcept {
+                if ((c & weak_mask) == weak_mask) [[unlikely]] {
+                    count_overflow();
+                }
+            }
+
+            [[noreturn]] static void count_overflow() noexcept;
         public:
             // A block is always constructed by a shared_ptr, so we always initialize both counters by 1.
-            __ctrl() noexcept;
-
-            /* Returns whether this control block still holds an object. */
-            virtual bool is_null() const noexcept = 0;
+            __ctrl() noexcept : counts(shared_one | weak_one) {}
 
             /* Returns the deleter that this block controls if it exists, nullptr otherwise. */
             virtual void* get_deleter() const noexcept;
 
             /* Returns the weak_count. */
-            long get_weak_count() const noexcept;
+            long get_weak_count() const noexcept {
+                return (__atomic_load_n(&counts, __ATOMIC_RELAXED) & weak_mask) >> 32;
+            }
+
             /* Returns the shared_count */
-            long get_shared_count() const noexcept;
+            long get_shared_count() const noexcept {
+                return __atomic_load_n(&counts, __ATOMIC_RELAXED) & shared_mask;
+            }
 
-            /* Decrements the shared_count by 1. If the shared_count reaches 0, decrements weak_count as well (and triggers all consequences in decrement_weak_count).
-             * The operation on each counter is atomic, but this function is not. */
-            long decrement_shared_count() noexcept;
+            /* Decrements the shared_count by 1. If the shared_count reaches 0, deletes the content and decrements weak_count as well (and triggers all
+             * consequences in decrement_weak_count). */
+            void decrement_shared_count() noexcept;
 
             /* Decrements the weak_count by 1. If the weak_count reaches 0, the control block is self-deleted and deallocated. */
-            long decrement_weak_count() noexcept;
+            void decrement_weak_count() noexcept;
+
+            /* Increments shared_count by `n`. The caller must already hold a shared reference to this block. */
+            void increment_shared_count(long n = 1) noexcept {
+                check_shared_increment(__atomic_fetch_add(&counts, static_cast<unsigned long long>(n), __ATOMIC_RELAXED), static_cast<unsigned long long>(n));
+            }
+
+            /* Adds `delta`, which may be negative, to shared_count. If shared_count reaches 0, deletes the content and decrements weak_count, like
+             * decrement_shared_count. Used by atomic<shared_ptr> to settle several references in one operation. */
+            void add_shared_count(long delta) noexcept;
+
+            /* Increments shared_count by 1 if the current block still holds an object, i.e. if shared_count hasn't dropped to 0. Returns whether
+             * it did. Used to turn a weak reference into a shared one. */
+            bool try_increment_shared_count() noexcept;
+
+            /* Increments weak_count by 1. The caller must already hold a reference to this block. */
+            void increment_weak_count() noexcept {
+                check_weak_increment(__atomic_fetch_add(&counts, weak_one, __ATOMIC_RELAXED));
+            }
+
+            /* Marks a freshly-created block as referenced by local pointers only. */
+            void make_local() noexcept {
+                counts |= local_flag;
+            }
+
+            /* Lets the block be shared across threads. Must be called by the thread owning the local references, before any shared_ptr to the
+             * block is created. */
+            void upgrade() noexcept {
+                if (const unsigned long long c = __atomic_load_n(&counts, __ATOMIC_RELAXED); c & local_flag) {
+                    __atomic_store_n(&counts, c & ~local_flag, __ATOMIC_RELAXED);
+                }
+            }
 
-            /* Increments shared_count by 1 if the current block still holds an object. Returns the result shared_count. */
-            virtual long increment_shared_count() noexcept;
+            /* The counterparts of the functions above used by local_shared_ptr and local_weak_ptr, which avoid read-modify-write operations while
+             * the block is local. The counts are still accessed through relaxed atomics, as a block may be upgraded while local pointers to it
+             * remain. */
+            void local_increment_shared_count() noexcept {
+                if (const unsigned long long c = __atomic_load_n(&counts, __ATOMIC_RELAXED); c & local_flag) [[likely]] {
+                    check_shared_increment(c, shared_one);
+                    __atomic_store_n(&counts, c + shared_one, __ATOMIC_RELAXED);
+                } else {
+                    increment_shared_count();
+                }
+            }
 
-            /* Increments weak_count by 1. */
-            long increment_weak_count() noexcept;
+            void local_increment_weak_count() noexcept {
+                if (const unsigned long long c = __atomic_load_n(&counts, __ATOMIC_RELAXED); c & local_flag) [[likely]] {
+                    check_weak_increment(c);
+                    __atomic_store_n(&counts, c + weak_one, __ATOMIC_RELAXED);
+                } else {
+                    increment_weak_count();
+                }
+            }
+
+            void local_decrement_shared_count() noexcept;
+            void local_decrement_weak_count() noexcept;
+            bool local_try_increment_shared_count() noexcept;
 
             /* Deletes the content held by the pointers holding this control block. This function is executed immediately when shared_count hits 0. Depending on what
              * type of control block this is, the behavior of this function is different. */
@@ -72,9 +154,6 @@ namespace std {
         public:
             __ctrl_ptr(T* ptr) noexcept : __ctrl(), ptr(ptr) {}
 
-            bool is_null() const noexcept override {
-                return !ptr;
-            }
             // We don't have to check for nullptr here, because no shared_ptr can be constructed with a nullptr without a deleter, which will
             // use the overload from __ctrl_ptr_with_deleter.
             void delete_content() noexcept override {
@@ -99,6 +178,9 @@ namespace std {
             }
         };
 
+        /* The control block created by shared_ptr(p, d, a), allocated through Alloc rebound to the block type. It is constructed with placement
+         * new rather than through the allocator: since it has an allocator_type, polymorphic_allocator::construct would pass it the allocator
+         * as one more argument, which its constructor doesn't take. */
         template<class T, class Alloc, class D>
         struct __ctrl_ptr_with_deleter_alloc : public __ctrl_ptr_with_deleter<T, D> {
         private:
@@ -111,11 +193,13 @@ namespace std {
 
             void delete_block() noexcept {
                 allocator_type temp(alloc);
-                allocator_traits<allocator_type>::destroy(temp, this);
+                this->~__ctrl_ptr_with_deleter_alloc();
                 allocator_traits<allocator_type>::deallocate(temp, this, 1);
             }
         };
 
+        /* The control block created by make_shared, holding the object itself right after the counters so that a single allocation serves both.
+         * Whether the object is alive follows from shared_count, so no other state is kept. */
         template<class T>
         struct __ctrl_obj : public __ctrl {
         public:
@@ -123,78 +207,156 @@ namespace std {
             struct noop_t {
                 explicit noop_t() = default;
             };
-        private:
+        protected:
             aligned_storage_t<sizeof(T), alignof(T)> storage;
-            bool is_freed;
         public:
+            /* If the constructor of T throws, so does this constructor, and the new-expression creating the block frees it. */
             template<class ...Args>
-            __ctrl_obj(Args&& ...args) noexcept : __ctrl(), storage() {
+            __ctrl_obj(Args&& ...args) : __ctrl(), storage() {
                 ::new (static_cast<void*>(&storage)) T(forward<Args>(args)...);
-                __atomic_store_n(&is_freed, false, __ATOMIC_SEQ_CST);
             }
 
             /* Noop constructor that does not attempt to construct the storage in anyway. The caller needs to get a pointer to the storage by get_object_ptr()
              * and construct the object explicitly. */
-            explicit __ctrl_obj(noop_t) noexcept : storage() {
-                __atomic_store_n(&is_freed, false, __ATOMIC_SEQ_CST);
-            }
+            explicit __ctrl_obj(noop_t) noexcept : __ctrl(), storage() {}
 
             void delete_content() noexcept override {
-                __atomic_store_n(&is_freed, true, __ATOMIC_SEQ_CST);
                 destroy_at(launder(reinterpret_cast<T*>(&storage)));
             }
 
-            bool is_null() const noexcept override {
-                return __atomic_load_n(&is_freed, __ATOMIC_SEQ_CST);
-            }
-
             remove_extent_t<T>* get_object_ptr() noexcept {
                 return launder(reinterpret_cast<remove_extent_t<T>*>(&storage));
             }
+
+            /* For a block constructed with noop_t holding an array: initializes the innermost elements one by one in ascending order, either
+             * value-initialized or, if u is given, as copies of the corresponding elements of u. An array placement-new may store an array cookie
+             * beyond the storage, so it is not used. If a constructor throws, the elements constructed so far are destroyed in reverse order
+             * and the exception propagates. */
+            template<class ...U>
+            requires is_array_v<T>
+            void construct_elements(const U& ...u) {
+                using element = remove_cv_t<remove_all_extents_t<T>>;
+                element* const begin = reinterpret_cast<element*>(&storage);
+                element* curr = begin;
+                try {
+                    for (size_t i = 0; i != sizeof(T) / sizeof(element); ++i, ++curr) {
+                        if constexpr (sizeof...(U) == 0) {
+                            ::new (static_cast<void*>(curr)) element();
+                        } else {
+                            ::new (static_cast<void*>(curr)) element(__array_init_value<element>(i, u...));
+                        }
+                    }
+                } catch (...) {
+                    while (curr != begin) {
+                        destroy_at(--curr);
+                    }
+                    throw;
+                }
+            }
+
+        protected:
+            /* Returns the element of u matching the i-th innermost element of the array, when u is itself an array, as in make_shared<T[N][M]>(u). */
+            template<class Element, class U>
+            static const Element& __array_init_value(size_t i, const U& u) noexcept {
+                return reinterpret_cast<const Element*>(addressof(u))[i % (sizeof(U) / sizeof(Element))];
+            }
         };
 
+        /* The control block created by allocate_shared. The block itself is allocated through Alloc rebound to the block type, so that with a
+         * polymorphic_allocator the whole block is a single request of sizeof(__ctrl_obj_with_alloc) bytes, which the pool resources serve from
+         * their size classes. The object is constructed and destroyed through Alloc rebound to T, as required by the standard. */
         template<class T, class Alloc>
         struct __ctrl_obj_with_alloc : public __ctrl_obj<T> {
         private:
-            Alloc a;
+            [[no_unique_address]] Alloc a;
+
+            // For arrays, rebound to the innermost element type, through which every element is constructed and destroyed.
+            using object_allocator_type = typename allocator_traits<Alloc>::template rebind_alloc<remove_cv_t<remove_all_extents_t<T>>>;
         public:
-            using allocator_type = typename allocator_traits<Alloc>::template rebind_alloc<__ctrl_ptr_with_deleter_alloc>;
+            using allocator_type = typename allocator_traits<Alloc>::template rebind_alloc<__ctrl_obj_with_alloc>;
 
+            /* Constructs the object, unless T is an array, in which case the caller is responsible for initializing its elements. */
             template<class ...Args>
-            __ctrl_obj_with_alloc(Alloc&& a, Args&& ...args) noexcept : __ctrl_obj<T>(typename __ctrl_obj<T>::noop_t{}), a(move(a)) {
+            __ctrl_obj_with_alloc(const Alloc& a, Args&& ...args) : __ctrl_obj<T>(typename __ctrl_obj<T>::noop_t{}), a(a) {
                 if constexpr (!is_array_v<T>) {
-                    // It's the responsible of the caller to initialize arrays.
-                    using allocator_type = typename allocator_traits<Alloc>::template rebind_alloc<remove_cv_t<T>>;
-                    allocator_type temp(a);
-                    allocator_traits<allocator_type>::construct(temp, reinterpret_cast<remove_cv_t<T>*>(&__ctrl_obj<T>::storage), forward<Args>(args)...);
+                    object_allocator_type temp(this->a);
+                    allocator_traits<object_allocator_type>::construct(temp, reinterpret_cast<remove_cv_t<T>*>(&this->storage), forward<Args>(args)...);
                 }
             }
 
-            __ctrl_obj_with_alloc(typename __ctrl_obj<T>::noop_t) noexcept : __ctrl_obj<T>(typename __ctrl_obj<T>::noop_t{}), a(move(a)) {}
+            __ctrl_obj_with_alloc(const Alloc& a, typename __ctrl_obj<T>::noop_t) noexcept : __ctrl_obj<T>(typename __ctrl_obj<T>::noop_t{}), a(a) {}
 
             void delete_content() noexcept override {
-                atomic_store(&__ctrl_obj<T>::is_freed, true);
+                object_allocator_type temp(a);
                 if constexpr (is_array_v<T>) {
-                    destroy_at(launder(reinterpret_cast<T*>(&__ctrl_obj<T>::storage)));
+                    using element = remove_cv_t<remove_all_extents_t<T>>;
+                    element* const begin = launder(reinterpret_cast<element*>(&this->storage));
+                    for (element* curr = begin + sizeof(T) / sizeof(element); curr != begin;) {
+                        allocator_traits<object_allocator_type>::destroy(temp, --curr);
+                    }
                 } else {
-                    using allocator_type = typename allocator_traits<Alloc>::template rebind_alloc<remove_cv_t<T>>;
-                    allocator_type temp(a);
-                    allocator_traits<allocator_type>::destroy(temp, launder(reinterpret_cast<remove_cv<T>*>(&__ctrl_obj<T>::storage)));
+                    allocator_traits<object_allocator_type>::destroy(temp, launder(reinterpret_cast<remove_cv_t<T>*>(&this->storage)));
                 }
             }
 
-            void delete_block() noexcept {
+            /* Same as __ctrl_obj::construct_elements, except that every element is constructed, and destroyed on failure, through Alloc rebound
+             * to the element type, as allocate_shared requires. */
+            template<class ...U>
+            requires is_array_v<T>
+            void construct_elements(const U& ...u) {
+                using element = remove_cv_t<remove_all_extents_t<T>>;
+                object_allocator_type temp(a);
+                element* const begin = reinterpret_cast<element*>(&this->storage);
+                element* curr = begin;
+                try {
+                    for (size_t i = 0; i != sizeof(T) / sizeof(element); ++i, ++curr) {
+                        if constexpr (sizeof...(U) == 0) {
+                            allocator_traits<object_allocator_type>::construct(temp, curr);
+                        } else {
+                            allocator_traits<object_allocator_type>::construct(temp, curr, this->template __array_init_value<element>(i, u...));
+                        }
+                    }
+                } catch (...) {
+                    while (curr != begin) {
+                        allocator_traits<object_allocator_type>::destroy(temp, --curr);
+                    }
+                    throw;
+                }
+            }
+
+            void delete_block() noexcept override {
                 allocator_type temp(a);
-                allocator_traits<allocator_type>::destroy(temp, this);
+                this->~__ctrl_obj_with_alloc();
                 allocator_traits<allocator_type>::deallocate(temp, this, 1);
             }
+
+            /* Allocates a block through `a` and constructs it with the given arguments, freeing the block if the construction throws. */
+            template<class ...Args>
+            static __ctrl_obj_with_alloc* create(const Alloc& a, Args&& ...args) {
+                allocator_type alloc(a);
+                __ctrl_obj_with_alloc* const block = allocator_traits<allocator_type>::allocate(alloc, 1);
+                try {
+                    return ::new (static_cast<void*>(block)) __ctrl_obj_with_alloc(a, forward<Args>(args)...);
+                } catch (...) {
+                    allocator_traits<allocator_type>::deallocate(alloc, block, 1);
+                    throw;
+                }
+            }
         };
     }
 
+    namespace __internal {
+        template<class P>
+        struct __atomic_smart_ptr;
+    }
+
     // Forward declaration. Implemented directly below.
     template<class T>
     class weak_ptr;
 
+    template<class T>
+    class local_shared_ptr;
+
     template<class T>
     class enable_shared_from_this;
 
@@ -207,6 +369,12 @@ namespace std {
         template<class Y>
         friend class weak_ptr;
 
+        template<class Y>
+        friend class local_shared_ptr;
+
+        template<class P>
+        friend struct __internal::__atomic_smart_ptr;
+
         element_type* ptr;
         __internal::__ctrl* ctrl;
 
@@ -355,7 +523,7 @@ namespace std {
                 allocator_type alloc = a;
 
                 auto ptr = allocator_traits<allocator_type>::allocate(alloc, 1);
-                allocator_traits<allocator_type>::construct(alloc, ptr, p, move(d), move(a));
+                ::new (static_cast<void*>(ptr)) __internal::__ctrl_ptr_with_deleter_alloc<T, A, D>(p, move(d), move(a));
 
                 ctrl = ptr;
                 prepare_shared_from_this(p);
@@ -384,7 +552,7 @@ namespace std {
                 allocator_type alloc = a;
 
                 auto ptr = allocator_traits<allocator_type>::allocate(alloc, 1);
-                allocator_traits<allocator_type>::construct(alloc, ptr, p, move(d), move(a));
+                ::new (static_cast<void*>(ptr)) __internal::__ctrl_ptr_with_deleter_alloc<T, A, D>(p, move(d), move(a));
 
                 ctrl = ptr;
             } catch (const exception& e) {
@@ -404,7 +572,7 @@ namespace std {
         template<class Y>
         shared_ptr(shared_ptr<Y>&& r, element_type* p) noexcept
             : ptr(p), ctrl(r.ctrl) {
-            r.p = nullptr;
+            r.ptr = nullptr;
             r.ctrl = nullptr;
         }
 
@@ -437,10 +605,9 @@ namespace std {
         template<class Y>
         requires is_convertible_v<Y*, T*> || (is_bounded_array_v<Y> && is_same_v<remove_cv_t<T>, remove_cv_t<remove_all_extents_t<Y>>[]>)
         explicit shared_ptr(const weak_ptr<Y>& r) : ptr(r.ptr), ctrl(r.ctrl) {
-            if (r.expired()) {
+            if (!ctrl || !ctrl->try_increment_shared_count()) {
                 throw std::bad_weak_ptr();
             }
-            ctrl->increment_shared_count();
         }
 
         template<class Y, class D>
@@ -515,6 +682,9 @@ namespace std {
         friend D* get_deleter(const shared_ptr& p) noexcept;
     };
 
+    template<class T>
+    struct is_trivially_relocatable<shared_ptr<T>> : true_type {};
+
     template<class T>
     shared_ptr(weak_ptr<T>) -> shared_ptr<T>;
 
@@ -532,39 +702,46 @@ namespace std {
     template<class T, class A, class ...Args>
     requires (!is_array_v<T>)
     shared_ptr<T> allocate_shared(const A& a, Args&& ...args) {
-        using allocator_type = typename __internal::__ctrl_obj_with_alloc<T, A>::allocator_type;
-        allocator_type alloc = a;
-
-        auto ctrl = allocator_traits<allocator_type>::allocate(alloc, 1);
-        allocator_traits<allocator_type>::construct(alloc, ctrl, forward<Args>(args)...);
-        return shared_ptr<T>::__make_shared(ctrl, true);
+        return shared_ptr<T>::__make_shared(__internal::__ctrl_obj_with_alloc<T, A>::create(a, forward<Args>(args)...), true);
     }
 
     template<class T>
     requires is_bounded_array_v<T>
     shared_ptr<T> make_shared() {
-        // The array should be value initialized in the ctrl_obj constructor.
-        return shared_ptr<T>::__make_shared(new __internal::__ctrl_obj<T>());
+        auto ctrl = new __internal::__ctrl_obj<T>(typename __internal::__ctrl_obj<T>::noop_t{});
+        try {
+            ctrl->construct_elements();
+        } catch (...) {
+            delete ctrl;
+            throw;
+        }
+
+        return shared_ptr<T>::__make_shared(ctrl);
     }
 
     template<class T, class A>
     requires is_bounded_array_v<T>
     shared_ptr<T> allocate_shared(const A& a) {
-        using allocator_type = typename __internal::__ctrl_obj_with_alloc<T, A>::allocator_type;
-        allocator_type alloc = a;
+        auto ctrl = __internal::__ctrl_obj_with_alloc<T, A>::create(a, typename __internal::__ctrl_obj<T>::noop_t{});
+        try {
+            ctrl->construct_elements();
+        } catch (...) {
+            ctrl->delete_block();
+            throw;
+        }
 
-        auto ctrl = allocator_traits<allocator_type>::allocate(alloc, 1);
-        allocator_traits<allocator_type>::construct(alloc, ctrl);
         return shared_ptr<T>::__make_shared(ctrl);
     }
 
     template<class T>
     requires is_bounded_array_v<T>
     shared_ptr<T> make_shared(const remove_extent_t<T>& u) {
-        auto ctrl = new __internal::__ctrl_obj<T>();
-
-        for (auto curr = ctrl->get_object_ptr(); curr != ctrl->get_object_ptr() + sizeof(T); curr++) {
-            construct_at(curr, u);
+        auto ctrl = new __internal::__ctrl_obj<T>(typename __internal::__ctrl_obj<T>::noop_t{});
+        try {
+            ctrl->construct_elements(u);
+        } catch (...) {
+            delete ctrl;
+            throw;
         }
 
         return shared_ptr<T>::__make_shared(ctrl);
@@ -572,13 +749,13 @@ namespace std {
 
     template<class T, class A>
     requires is_bounded_array_v<T>
-    shared_ptr<T> make_shared(const A& a, const remove_extent_t<T>& u) {
-        using allocator_type = typename __internal::__ctrl_obj_with_alloc<T, A>::allocator_type;
-        allocator_type alloc = a;
-
-        auto ctrl = allocator_traits<allocator_type>::allocate(alloc, 1);
-        for (auto curr = ctrl->get_object_ptr(); curr != ctrl->get_object_ptr() + sizeof(T); curr++) {
-            construct_at(curr, u);
+    shared_ptr<T> allocate_shared(const A& a, const remove_extent_t<T>& u) {
+        auto ctrl = __internal::__ctrl_obj_with_alloc<T, A>::create(a, typename __internal::__ctrl_obj<T>::noop_t{});
+        try {
+            ctrl->construct_elements(u);
+        } catch (...) {
+            ctrl->delete_block();
+            throw;
         }
 
         return shared_ptr<T>::__make_shared(ctrl);
@@ -589,25 +766,25 @@ namespace std {
     shared_ptr<T> make_shared_for_overwrite() {
         if constexpr (is_array_v<T>) {
             return make_shared<T>();
-        }
-
-        auto ctrl = new __internal::__ctrl_obj<T>(typename __internal::__ctrl_obj<T>::noop_t{});
-        ::new (static_cast<void*>(ctrl->get_object_ptr())) T;
+        } else {
+            auto ctrl = new __internal::__ctrl_obj<T>(typename __internal::__ctrl_obj<T>::noop_t{});
+            ::new (static_cast<void*>(ctrl->get_object_ptr())) T;
 
-        return shared_ptr<T>::__make_shared(ctrl);
+            return shared_ptr<T>::__make_shared(ctrl);
+        }
     }
 
     template<class T, class A>
-    requires (!is_bounded_array_v<T>)
+    requires (!is_unbounded_array_v<T>)
     shared_ptr<T> allocate_shared_for_overwrite(const A& a) {
         if constexpr (is_array_v<T>) {
             return allocate_shared<T>(a);
-        }
-
-        auto ctrl = new __internal::__ctrl_obj<T>(typename __internal::__ctrl_obj<T>::noop_t{});
-        ::new (static_cast<void*>(ctrl->get_object_ptr())) T;
+        } else {
+            auto ctrl = __internal::__ctrl_obj_with_alloc<T, A>::create(a, typename __internal::__ctrl_obj<T>::noop_t{});
+            ::new (static_cast<void*>(ctrl->get_object_ptr())) T;
 
-        return shared_ptr<T>::__make_shared(ctrl);
+            return shared_ptr<T>::__make_shared(ctrl);
+        }
     }
 
     /* 20.11.3.8 Comparison */
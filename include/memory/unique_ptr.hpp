@@ -328,6 +328,9 @@ namespace std {
         unique_ptr& operator=(const unique_ptr&) = delete;
     };
 
+    template<class T, class D>
+    struct is_trivially_relocatable<unique_ptr<T, D>> : is_trivially_relocatable<D> {};
+
     /* 20.11.1.5 Creation */
     template<class T, class ...Args>
     requires (!is_array_v<T>)
@@ -12,6 +12,9 @@ namespace std {
         template<class U>
         friend class shared_ptr;
 
+        template<class P>
+        friend struct __internal::__atomic_smart_ptr;
+
         using element_type = remove_extent_t<T>;
 
     private:
@@ -61,7 +64,9 @@ namespace std {
 
         /* 20.11.4.3 Destructor */
         ~weak_ptr() {
-            ctrl->decrement_weak_count();
+            if (ctrl) {
+                ctrl->decrement_weak_count();
+            }
         }
 
         /* 20.11.4.4 Assignment */
@@ -110,8 +115,12 @@ namespace std {
         }
 
         shared_ptr<T> lock() const noexcept {
-            // TODO: Make this function atomic.
-            return expired() ? shared_ptr<T>() : shared_ptr<T>(*this);
+            shared_ptr<T> result;
+            if (ctrl && ctrl->try_increment_shared_count()) {
+                result.ptr = ptr;
+                result.ctrl = ctrl;
+            }
+            return result;
         }
 
         template<class U>
@@ -125,6 +134,9 @@ namespace std {
         }
     };
 
+    template<class T>
+    struct is_trivially_relocatable<weak_ptr<T>> : true_type {};
+
     template<class T>
     weak_ptr(shared_ptr<T>) -> weak_ptr<T>;
 
@@ -1,13 +1,14 @@
 #pragma once
 
+#include "pthread.h"
+
 #include "cstddef.hpp"
+#include "cstdint.hpp"
 #include "limits.hpp"
 #include "new.hpp"
 #include "utility.hpp"
 #include "memory.hpp"
 
-// TODO: Implement synchronized_pool_resource and unsynchronized_pool_resource.
-
 namespace std::pmr {
     /* 20.12.2 Class memory_resource */
     class memory_resource {
@@ -24,11 +25,18 @@ namespace std::pmr {
         void deallocate(void* p, std::size_t bytes, std::size_t alignment = max_align);
 
         bool is_equal(const memory_resource& other) const noexcept;
+
+        /* Extension: attempts to grow the block of `bytes` bytes at p, allocated from this resource with the given alignment, in place to
+         * new_bytes > bytes. Returns whether it did, in which case the block must be deallocated with new_bytes. */
+        bool try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t alignment = max_align);
     private:
         virtual void* do_allocate(std::size_t bytes, std::size_t alignment) = 0;
         virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) = 0;
 
         virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+
+        /* Resources that can grow blocks in place override this. The default implementation always fails. */
+        virtual bool do_try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t alignment);
     };
 
     bool operator==(const memory_resource& a, const memory_resource& b) noexcept;
@@ -67,6 +75,14 @@ namespace std::pmr {
             memory_rsrc->deallocate(p, n * sizeof(Tp), alignof(Tp));
         }
 
+        /* Extension: see allocator_traits::try_expand. */
+        bool try_expand(Tp* p, std::size_t n, std::size_t new_n) {
+            if (numeric_limits<std::size_t>::max() / sizeof(Tp) < new_n) {
+                return false;
+            }
+            return memory_rsrc->try_expand(p, n * sizeof(Tp), new_n * sizeof(Tp), alignof(Tp));
+        }
+
         [[nodiscard]] void* allocate_bytes(std::size_t nbytes, std::size_t alignment = alignof(std::max_align_t)) {
             return memory_rsrc->allocate(nbytes, alignment);
         }
@@ -139,12 +155,230 @@ namespace std::pmr {
     memory_resource* set_default_resource(memory_resource* r) noexcept;
     memory_resource* get_default_resource() noexcept;
 
+    /* Extension: overrides the default resource for the calling thread only, so that get_default_resource() returns `r` on this thread without
+     * any synchronization. Passing nullptr removes the override. Returns the previous override, or nullptr if there was none. */
+    memory_resource* set_thread_default_resource(memory_resource* r) noexcept;
+
+    /* Extension: installs a thread-local default resource for the lifetime of the guard, restoring the previous override on destruction. */
+    class scoped_default_resource {
+    private:
+        memory_resource* prev_rsrc;
+
+    public:
+        explicit scoped_default_resource(memory_resource* r) noexcept : prev_rsrc(set_thread_default_resource(r)) {}
+        scoped_default_resource(const scoped_default_resource&) = delete;
+        ~scoped_default_resource() { set_thread_default_resource(prev_rsrc); }
+
+        scoped_default_resource& operator=(const scoped_default_resource&) = delete;
+    };
+
     /* 20.12.5 Pool resource classes */
     struct pool_options {
         std::size_t max_blocks_per_chunk = 0;
         std::size_t largest_required_pool_block = 0;
     };
 
+    namespace __internal {
+        /* A pool of equally-sized blocks, all of which are carved out of chunks obtained from an upstream resource. Freed blocks are threaded onto an
+         * intrusive singly-linked free list and handed out again before any fresh block is carved from the current chunk. This is the building block
+         * of the pool resource classes, which keep one __pool per size class. */
+        struct __pool {
+            struct free_block {
+                free_block* next;
+            };
+
+            /* Stored at the very end of each chunk, so that blocks can start at the beginning of the chunk and stay aligned to the block size. */
+            struct chunk_footer {
+                chunk_footer* prev;
+                void* begin;
+                std::size_t size;
+            };
+
+            std::size_t block_size;
+            std::size_t next_blocks_per_chunk;
+            free_block* free_list;
+            /* The part of the most recent chunk from which no block has been handed out yet. Blocks are carved lazily, so a new chunk costs nothing
+             * beyond the upstream call. */
+            char* unused_begin;
+            char* unused_end;
+            chunk_footer* last_chunk;
+
+            constexpr __pool() noexcept
+                : block_size(0), next_blocks_per_chunk(0), free_list(nullptr), unused_begin(nullptr), unused_end(nullptr), last_chunk(nullptr) {}
+
+            void initialize(std::size_t block_size, std::size_t max_blocks_per_chunk) noexcept;
+
+            void* allocate(memory_resource* upstream, std::size_t max_blocks_per_chunk) {
+                if (free_block* const block = free_list; block) [[likely]] {
+                    free_list = block->next;
+                    return block;
+                } else if (unused_begin != unused_end) [[likely]] {
+                    void* const p = unused_begin;
+                    unused_begin += block_size;
+                    return p;
+                } else {
+                    return allocate_from_new_chunk(upstream, max_blocks_per_chunk);
+                }
+            }
+
+            void deallocate(void* p) noexcept {
+                free_block* const block = static_cast<free_block*>(p);
+                block->next = free_list;
+                free_list = block;
+            }
+
+            /* Returns every chunk to the upstream resource. The number of blocks per chunk reached so far is kept. */
+            void release(memory_resource* upstream) noexcept;
+
+            void* allocate_from_new_chunk(memory_resource* upstream, std::size_t max_blocks_per_chunk);
+        };
+
+        /* Keeps track of the allocations that are too large for any pool, so that they can be freed by release(). Each allocation is prefixed by a
+         * header linking it into an intrusive doubly-linked list. */
+        struct __oversized_list {
+            struct header {
+                header* prev;
+                header* next;
+            };
+
+            header* head;
+
+            constexpr __oversized_list() noexcept : head(nullptr) {}
+
+            void* allocate(memory_resource* upstream, std::size_t bytes, std::size_t alignment);
+            void deallocate(memory_resource* upstream, void* p, std::size_t bytes, std::size_t alignment) noexcept;
+            void release(memory_resource* upstream) noexcept;
+        };
+
+        /* The set of pools backing a pool resource, one per power-of-two size class from min_block_size up to the largest required pool block. */
+        struct __pool_set {
+            /* The smallest block has to be able to hold a free-list link. */
+            static constexpr std::size_t min_block_size = sizeof(__pool::free_block);
+            static constexpr std::size_t max_largest_required_pool_block = std::size_t(1) << 20;
+            static constexpr std::size_t default_largest_required_pool_block = 4096;
+            static constexpr std::size_t max_max_blocks_per_chunk = std::size_t(1) << 20;
+            static constexpr std::size_t default_max_blocks_per_chunk = 4096;
+            static constexpr std::size_t max_pool_count = 18;
+
+            /* The options actually in effect, with zero and out-of-range values replaced. */
+            pool_options opts;
+            std::size_t pool_count;
+            __pool pools[max_pool_count];
+
+            explicit __pool_set(const pool_options& opts) noexcept;
+
+            /* Returns the index of the pool serving the given request, or pool_count if the request should go to the upstream resource directly. */
+            std::size_t index(std::size_t bytes, std::size_t alignment) const noexcept;
+
+            void release(memory_resource* upstream) noexcept;
+        };
+
+        /* Forwards every request to another resource while holding a mutex, so that an unsynchronized upstream resource can be shared by several
+         * threads. */
+        class __locked_resource : public memory_resource {
+        private:
+            memory_resource* upstream;
+            pthread_mutex_t* mutex;
+
+        public:
+            __locked_resource(memory_resource* upstream, pthread_mutex_t* mutex) noexcept : memory_resource(), upstream(upstream), mutex(mutex) {}
+
+        protected:
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+            void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+            bool do_is_equal(const memory_resource& other) const noexcept override;
+        };
+    }
+
+    class unsynchronized_pool_resource : public memory_resource {
+    private:
+        memory_resource* upstream_rsrc;
+        __internal::__pool_set pools;
+        __internal::__oversized_list oversized;
+
+    public:
+        unsynchronized_pool_resource(const pool_options& opts, memory_resource* upstream);
+
+        unsynchronized_pool_resource();
+        explicit unsynchronized_pool_resource(memory_resource* upstream);
+        explicit unsynchronized_pool_resource(const pool_options& opts);
+
+        unsynchronized_pool_resource(const unsynchronized_pool_resource&) = delete;
+
+        virtual ~unsynchronized_pool_resource();
+
+        unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&) = delete;
+
+        void release();
+        memory_resource* upstream_resource() const;
+        pool_options options() const;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const memory_resource& other) const noexcept override;
+    };
+
+    class synchronized_pool_resource : public memory_resource {
+    private:
+        /* A thread's private stash of free blocks, one list per size class. Defined in the corresponding cpp file. */
+        struct thread_cache;
+
+        memory_resource* upstream_rsrc;
+        /* Guards every call into the upstream resource, as well as the list of oversized allocations. */
+        pthread_mutex_t upstream_mutex;
+        __internal::__locked_resource locked_upstream;
+        /* The shared depot. Each size class is guarded by its own mutex, so that threads refilling or flushing their caches only contend with
+         * threads working on the same size class. */
+        __internal::__pool_set pools;
+        pthread_mutex_t pool_mutexes[__internal::__pool_set::max_pool_count];
+        __internal::__oversized_list oversized;
+
+        /* Thread-specific storage key pointing to the calling thread's cache. If the key could not be created, every request goes to the depot. */
+        pthread_key_t cache_key;
+        bool has_cache_key;
+        /* Every live cache is linked into this list, so that the destructor can reach the caches of other threads. */
+        pthread_mutex_t caches_mutex;
+        thread_cache* caches;
+        /* Incremented by release(), accessed atomically. A cache whose generation is older holds blocks of chunks that were returned upstream;
+         * its owning thread drops them at its next call instead of release() reaching into a cache that another thread is using. */
+        std::size_t generation;
+
+    public:
+        synchronized_pool_resource(const pool_options& opts, memory_resource* upstream);
+
+        synchronized_pool_resource();
+        explicit synchronized_pool_resource(memory_resource* upstream);
+        explicit synchronized_pool_resource(const pool_options& opts);
+
+        synchronized_pool_resource(const synchronized_pool_resource&) = delete;
+
+        virtual ~synchronized_pool_resource();
+
+        synchronized_pool_resource& operator=(const synchronized_pool_resource&) = delete;
+
+        void release();
+        memory_resource* upstream_resource() const;
+        pool_options options() const;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const memory_resource& other) const noexcept override;
+
+    private:
+        /* Returns the calling thread's cache, creating it on first use. Returns nullptr if no cache can be used. */
+        thread_cache* local_cache() noexcept;
+        void* refill(thread_cache& cache, std::size_t index);
+        void flush(thread_cache& cache, std::size_t index, std::size_t count) noexcept;
+        /* Empties the cache if release() has been called since it was last used. */
+        void drop_if_stale(thread_cache& cache) noexcept;
+        /* Returns every block held by the cache to the depot, unlinks the cache and frees it. */
+        void retire(thread_cache* cache) noexcept;
+
+        static void destroy_thread_cache(void* cache) noexcept;
+    };
+
     class monotonic_buffer_resource : public memory_resource {
     private:
         struct metadata {
@@ -153,17 +387,32 @@ namespace std::pmr {
         };
 
         memory_resource* upstream_rsrc;
-        /* Pointer to the current buffer. Each buffer starts with sizeof(sunit_t) bytes storing the pointer to the previous buffer, or 0 for the first
-         * buffer, and another sizeof(sunit_t) bytes storing the size of the current buffer. */
+        /* The buffer passed to the constructor, if any. It is never returned to the upstream resource, and allocation resumes from it after
+         * release(). */
+        void* initial_buffer;
+        std::size_t initial_buffer_size;
+        /* Pointer to the latest buffer obtained from the upstream resource, or nullptr if there is none. Each such buffer starts with a metadata
+         * block storing the pointer to the previous buffer, or nullptr for the first buffer, and the size of the buffer. */
         void* current_buffer;
+        std::size_t initial_next_buffer_size;
         std::size_t next_buffer_size;
-        /* Marks the beginning of the unused portion of the current buffer. For a newly-allocated buffer, this points to 2 * sizeof(sunit_t) bytes after
-         * the beginning of the buffer. */
-        void* unused_buffer_part;
+        /* Marks the unused portion of the buffer currently allocated from. */
+        char* unused_begin;
+        char* unused_end;
+        /* Extension: whether release() keeps the largest buffer around. */
+        bool retain_chunks;
 
-        // These values are used by GCC's implementation.
+        // This value is used by GCC's implementation.
         static constexpr std::size_t default_buffer_size = 128 * sizeof(void*);
-        static constexpr float growth_factor = 1.5;
+        /* Buffer sizes are rounded up to this, the metadata block plus room to align one allocation, so that a buffer is never too small to serve
+         * anything and growing its size always makes progress. */
+        static constexpr std::size_t min_buffer_size = sizeof(metadata) + alignof(std::max_align_t);
+
+        /* Returns the size of the buffer to request after one of the given size, which is 1.5 times as large. Computed in integer arithmetic and
+         * saturated at the largest size_t. */
+        static std::size_t grow(std::size_t size) noexcept {
+            return size > numeric_limits<std::size_t>::max() - size / 2 ? numeric_limits<std::size_t>::max() : size + size / 2;
+        }
 
     public:
         explicit monotonic_buffer_resource(memory_resource* upstream);
@@ -183,9 +432,207 @@ namespace std::pmr {
         void release();
         memory_resource* upstream_resource() const;
 
+        /* Extension: when enabled, release() returns every buffer but the largest one to the upstream resource and rewinds into that buffer,
+         * so that a resource which is released after every unit of work stops calling the upstream resource once it has warmed up. The
+         * destructor still returns every buffer. */
+        void set_retain_chunks(bool retain) noexcept { retain_chunks = retain; }
+        bool retains_chunks() const noexcept { return retain_chunks; }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            // Bump-allocate from the current buffer. The alignment is always a power of two.
+            const std::size_t padding = -reinterpret_cast<std::uintptr_t>(unused_begin) & (alignment - 1);
+            const std::size_t remaining = unused_end - unused_begin;
+            if (unused_begin && bytes <= remaining && padding <= remaining - bytes) [[likely]] {
+                char* const p = unused_begin + padding;
+                unused_begin = p + bytes;
+                return p;
+            }
+            return allocate_from_new_buffer(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const memory_resource& other) const noexcept override;
+        /* Succeeds if p is the last block handed out and the current buffer has room left for the extra bytes. */
+        bool do_try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t alignment) override;
+
+    private:
+        void* allocate_from_new_buffer(std::size_t bytes, std::size_t alignment);
+        void release_buffers(bool keep_largest) noexcept;
+    };
+
+    /* Extension: a resource that forwards every request to an upstream resource while recording allocation statistics. Counters are kept per
+     * thread and only merged when they are read, so that threads sharing the resource never write to the same cache line, except for the
+     * bytes-in-use counter which has to be global to maintain an exact high-water mark. Since this is a memory_resource like any other, passing
+     * it to set_default_resource() profiles every polymorphic_allocator that uses the default resource. */
+    class statistics_resource : public memory_resource {
+    public:
+        /* Histogram bucket i counts the requests whose size (or alignment) has a bit width of i, i.e. lies in [2^(i-1), 2^i). */
+        static constexpr std::size_t histogram_size = numeric_limits<std::size_t>::digits + 1;
+        static constexpr std::size_t max_sample_depth = 16;
+        static constexpr std::size_t max_samples = 64;
+
+        struct statistics {
+            std::size_t allocations;
+            std::size_t deallocations;
+            std::size_t bytes_allocated;
+            std::size_t bytes_deallocated;
+            std::size_t bytes_in_use;
+            std::size_t peak_bytes_in_use;
+            std::size_t size_histogram[histogram_size];
+            std::size_t alignment_histogram[histogram_size];
+        };
+
+        /* The call stack of a sampled allocation, as returned by backtrace(). */
+        struct call_site_sample {
+            void* frames[max_sample_depth];
+            std::size_t depth;
+            std::size_t bytes;
+            std::size_t alignment;
+        };
+
+    private:
+        /* The counters written by a single thread. Defined in the corresponding cpp file. */
+        struct thread_counters;
+
+        memory_resource* upstream_rsrc;
+        /* Every sample_period-th allocation made by a thread has its call stack recorded. Sampling is disabled if this is 0. */
+        std::size_t sample_period;
+
+        std::size_t bytes_in_use;
+        std::size_t peak_bytes_in_use;
+
+        pthread_key_t counters_key;
+        bool has_counters_key;
+        /* Guards the list of live counters, the counters merged from exited threads, and the samples. */
+        mutable pthread_mutex_t counters_mutex;
+        thread_counters* counters;
+        thread_counters* retired_counters;
+        /* A ring buffer holding the latest samples. */
+        call_site_sample samples[max_samples];
+        std::size_t sample_count;
+
+    public:
+        statistics_resource();
+        explicit statistics_resource(memory_resource* upstream, std::size_t sample_period = 0);
+
+        statistics_resource(const statistics_resource&) = delete;
+
+        virtual ~statistics_resource();
+
+        statistics_resource& operator=(const statistics_resource&) = delete;
+
+        memory_resource* upstream_resource() const noexcept;
+
+        /* Merges the counters of every thread. Counters updated concurrently may or may not be reflected. */
+        statistics get_statistics() const;
+        /* Copies up to `n` of the latest samples, most recent first, into `out` and returns how many were copied. */
+        std::size_t get_samples(call_site_sample* out, std::size_t n) const;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const memory_resource& other) const noexcept override;
+        /* Forwards to the upstream resource. A successful expansion counts the extra bytes as allocated and in use, but not as an allocation. */
+        bool do_try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t alignment) override;
+
+    private:
+        thread_counters* local_counters() noexcept;
+        void record_sample(std::size_t bytes, std::size_t alignment) noexcept;
+        /* Adds to bytes_in_use and raises peak_bytes_in_use to match. */
+        void add_bytes_in_use(std::size_t bytes) noexcept;
+
+        static void retire_counters(void* counters) noexcept;
+    };
+
+    /* Extension: options for mmap_resource. */
+    struct mmap_resource_options {
+        /* Ask the kernel to back mappings with transparent huge pages where supported. Mappings are then made in multiples of the huge page
+         * size, and aligned to it, so that they can actually be backed by huge pages. */
+        bool huge_pages = false;
+        /* Pre-fault mappings, including cached mappings when they are reused and the pages added by try_expand, instead of paying a page fault
+         * on the first touch of every page. */
+        bool populate = false;
+        /* The maximum number of freed mappings kept for reuse. Their pages are handed back to the kernel with MADV_DONTNEED, but the address
+         * ranges stay mapped, which saves the mmap and munmap calls when arenas of the same size come and go. */
+        std::size_t max_cached_mappings = 8;
+    };
+
+    /* Extension: a resource that obtains every allocation directly from the kernel through mmap. It is intended as the upstream resource of
+     * monotonic_buffer_resource and the pool resources when they manage large arenas. The resource is thread-safe. */
+    class mmap_resource : public memory_resource {
+    private:
+        static constexpr std::size_t max_cache_size = 32;
+
+        struct mapping {
+            void* addr;
+            std::size_t size;
+        };
+
+        mmap_resource_options opts;
+        std::size_t page_size;
+        pthread_mutex_t cache_mutex;
+        mapping cache[max_cache_size];
+        std::size_t cache_size;
+        /* The number of slots claimed by deallocations that are still dropping the pages of their mapping outside of the lock. They count
+         * against max_cached_mappings, so that only mappings which are certain to be cached get the madvise call. */
+        std::size_t cache_reserved;
+
+    public:
+        mmap_resource();
+        explicit mmap_resource(const mmap_resource_options& opts);
+
+        mmap_resource(const mmap_resource&) = delete;
+
+        virtual ~mmap_resource();
+
+        mmap_resource& operator=(const mmap_resource&) = delete;
+
+        mmap_resource_options options() const noexcept;
+        /* Unmaps every cached mapping. */
+        void release() noexcept;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const memory_resource& other) const noexcept override;
+        /* Succeeds if the new size still fits in the pages already mapped, or, on Linux, if mremap can extend the mapping where it is. */
+        bool do_try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t alignment) override;
+
+    private:
+        // numa_resource binds the whole mapping, which extends past the requested size.
+        friend class numa_resource;
+
+        /* Returns the size and alignment of the mapping serving a request. */
+        std::size_t mapping_size(std::size_t bytes) const noexcept;
+        std::size_t mapping_alignment(std::size_t alignment) const noexcept;
+    };
+
+    /* Extension: a resource whose memory is bound to one NUMA node, so that a thread pinned to that node (see std::pin_to_node) can allocate
+     * node-local memory. Allocations are mapped through an mmap_resource and then bound with the mbind system call before any page is touched,
+     * which is why the populate option is ignored. On systems with a single node, or where binding is not permitted, the memory is simply left
+     * to the default policy. */
+    class numa_resource : public memory_resource {
+    private:
+        mmap_resource mapper;
+        unsigned int node;
+        /* Whether mbind is worth calling, i.e. whether there is more than one node. */
+        bool is_binding;
+
+    public:
+        /* Throws system_error if the node doesn't exist. */
+        explicit numa_resource(unsigned int node, const mmap_resource_options& opts = mmap_resource_options());
+
+        numa_resource(const numa_resource&) = delete;
+
+        numa_resource& operator=(const numa_resource&) = delete;
+
+        unsigned int numa_node() const noexcept;
+
     protected:
         void* do_allocate(std::size_t bytes, std::size_t alignment) override;
         void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
         bool do_is_equal(const memory_resource& other) const noexcept override;
+        bool do_try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t alignment) override;
     };
-}
\ No newline at end of file
+}
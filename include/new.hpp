@@ -6,6 +6,18 @@
 #include "util/macros.hpp"
 
 namespace std {
+    namespace __internal {
+        struct sized_allocation {
+            void* ptr;
+            std::size_t size;
+        };
+
+        /* Allocates n bytes through the non-aligned operator new and returns the block together with its usable size, at least n, as reported
+         * by the underlying allocator for this very block, so that the caller can use the bytes it was rounded up by. The block may be freed
+         * with either size. Assumes operator new isn't replaced. */
+        sized_allocation allocate_at_least(std::size_t n);
+    }
+
     /* 17.6.4 Storage allocation errors */
     class bad_alloc : public exception {
     public:
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "__tree.hpp"
+#include "compare.hpp"
+#include "functional.hpp"
+#include "initializer_list.hpp"
+#include "memory.hpp"
+#include "memory_resource.hpp"
+
+namespace std {
+    /* 22.4.6 Class template set
+     *
+     * The elements are the nodes of a red-black tree (see __internal::__tree). The allocator must use raw pointers. */
+    template<class Key, class Compare = less<Key>, class Allocator = allocator<Key>>
+    class set : public __internal::__tree<__internal::__set_policy<Key>, Compare, Allocator, false> {
+    private:
+        using base = __internal::__tree<__internal::__set_policy<Key>, Compare, Allocator, false>;
+    public:
+        using value_compare = Compare;
+        using typename base::insert_return_type;
+
+        using base::base;
+
+        // Declared here rather than inherited so that class template argument deduction sees an initializer-list constructor.
+        set(initializer_list<Key> il, const Compare& comp = Compare(), const Allocator& a = Allocator()) : base(il, comp, a) {}
+
+        set& operator=(initializer_list<Key> il) {
+            base::operator=(il);
+            return *this;
+        }
+
+        value_compare value_comp() const {
+            return this->key_comp();
+        }
+    };
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<typename iterator_traits<InputIterator>::value_type>,
+        class Allocator = allocator<typename iterator_traits<InputIterator>::value_type>>
+    set(InputIterator, InputIterator, Compare = Compare(), Allocator = Allocator())
+        -> set<typename iterator_traits<InputIterator>::value_type, Compare, Allocator>;
+
+    template<class Key, class Compare = less<Key>, class Allocator = allocator<Key>>
+    set(initializer_list<Key>, Compare = Compare(), Allocator = Allocator()) -> set<Key, Compare, Allocator>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Allocator>
+    set(InputIterator, InputIterator, Allocator)
+        -> set<typename iterator_traits<InputIterator>::value_type, less<typename iterator_traits<InputIterator>::value_type>, Allocator>;
+
+    template<class Key, class Allocator>
+    set(initializer_list<Key>, Allocator) -> set<Key, less<Key>, Allocator>;
+
+    template<class Key, class Compare, class Allocator>
+    bool operator==(const set<Key, Compare, Allocator>& x, const set<Key, Compare, Allocator>& y) {
+        return __internal::__tree_equal(x, y);
+    }
+
+    template<class Key, class Compare, class Allocator>
+    __internal::synth_three_way_result<Key> operator<=>(const set<Key, Compare, Allocator>& x, const set<Key, Compare, Allocator>& y) {
+        return __internal::__tree_three_way(x, y);
+    }
+
+    template<class Key, class Compare, class Allocator>
+    void swap(set<Key, Compare, Allocator>& x, set<Key, Compare, Allocator>& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+
+    template<class Key, class Compare, class Allocator, class Predicate>
+    typename set<Key, Compare, Allocator>::size_type erase_if(set<Key, Compare, Allocator>& c, Predicate pred) {
+        return __internal::__tree_erase_if(c, pred);
+    }
+
+    /* 22.4.7 Class template multiset */
+    template<class Key, class Compare = less<Key>, class Allocator = allocator<Key>>
+    class multiset : public __internal::__tree<__internal::__set_policy<Key>, Compare, Allocator, true> {
+    private:
+        using base = __internal::__tree<__internal::__set_policy<Key>, Compare, Allocator, true>;
+    public:
+        using value_compare = Compare;
+
+        using base::base;
+
+        // Declared here rather than inherited so that class template argument deduction sees an initializer-list constructor.
+        multiset(initializer_list<Key> il, const Compare& comp = Compare(), const Allocator& a = Allocator()) : base(il, comp, a) {}
+
+        multiset& operator=(initializer_list<Key> il) {
+            base::operator=(il);
+            return *this;
+        }
+
+        value_compare value_comp() const {
+            return this->key_comp();
+        }
+    };
+
+    template<__internal::legacy_input_iterator InputIterator, class Compare = less<typename iterator_traits<InputIterator>::value_type>,
+        class Allocator = allocator<typename iterator_traits<InputIterator>::value_type>>
+    multiset(InputIterator, InputIterator, Compare = Compare(), Allocator = Allocator())
+        -> multiset<typename iterator_traits<InputIterator>::value_type, Compare, Allocator>;
+
+    template<class Key, class Compare = less<Key>, class Allocator = allocator<Key>>
+    multiset(initializer_list<Key>, Compare = Compare(), Allocator = Allocator()) -> multiset<Key, Compare, Allocator>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Allocator>
+    multiset(InputIterator, InputIterator, Allocator)
+        -> multiset<typename iterator_traits<InputIterator>::value_type, less<typename iterator_traits<InputIterator>::value_type>, Allocator>;
+
+    template<class Key, class Allocator>
+    multiset(initializer_list<Key>, Allocator) -> multiset<Key, less<Key>, Allocator>;
+
+    template<class Key, class Compare, class Allocator>
+    bool operator==(const multiset<Key, Compare, Allocator>& x, const multiset<Key, Compare, Allocator>& y) {
+        return __internal::__tree_equal(x, y);
+    }
+
+    template<class Key, class Compare, class Allocator>
+    __internal::synth_three_way_result<Key> operator<=>(const multiset<Key, Compare, Allocator>& x, const multiset<Key, Compare, Allocator>& y) {
+        return __internal::__tree_three_way(x, y);
+    }
+
+    template<class Key, class Compare, class Allocator>
+    void swap(multiset<Key, Compare, Allocator>& x, multiset<Key, Compare, Allocator>& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+
+    template<class Key, class Compare, class Allocator, class Predicate>
+    typename multiset<Key, Compare, Allocator>::size_type erase_if(multiset<Key, Compare, Allocator>& c, Predicate pred) {
+        return __internal::__tree_erase_if(c, pred);
+    }
+
+    namespace pmr {
+        template<class Key, class Compare = less<Key>>
+        using set = std::set<Key, Compare, polymorphic_allocator<Key>>;
+
+        template<class Key, class Compare = less<Key>>
+        using multiset = std::multiset<Key, Compare, polymorphic_allocator<Key>>;
+    }
+}
\ No newline at end of file
@@ -149,7 +149,7 @@ namespace std {
             return !pthread_rwlock_timedrdlock(native_handle(), &abs_time_spec);
         }
         void unlock_shared() noexcept;   
-    }
+    };
 #endif
 
     namespace __internal {
@@ -0,0 +1,360 @@
+#pragma once
+
+#include "vector.hpp"
+
+namespace std {
+    /* Extension: a vector that keeps up to N elements in a buffer inside the object, and only allocates from the allocator once it grows beyond
+     * that. It has the interface of vector, and shares its implementation (see __internal::__vector_base) once the elements are on the heap.
+     *
+     * As the inline buffer moves along with the object, moving or swapping a small_vector whose elements are inline moves the elements one by
+     * one, and invalidates the iterators into it. For the same reason, a small_vector is not trivially relocatable, and is not usable in
+     * constant expressions. The allocator must use raw pointers. */
+    template<class T, size_t N, class Allocator = allocator<T>>
+    requires is_same_v<typename Allocator::value_type, T> && is_same_v<typename allocator_traits<Allocator>::pointer, T*>
+    class small_vector : public __internal::__vector_base<small_vector<T, N, Allocator>, T, Allocator> {
+    private:
+        static_assert(N > 0, "A small_vector needs room for at least one inline element; use vector instead.");
+
+        using base = __internal::__vector_base<small_vector<T, N, Allocator>, T, Allocator>;
+        friend base;
+
+        using typename base::traits_type;
+        using base::alloc;
+        using base::len;
+        using base::cap;
+        using base::buf;
+        using base::relocates_bitwise;
+    public:
+        using typename base::value_type;
+        using typename base::allocator_type;
+        using typename base::pointer;
+        using typename base::const_pointer;
+        using typename base::reference;
+        using typename base::const_reference;
+        using typename base::size_type;
+        using typename base::difference_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+        using typename base::reverse_iterator;
+        using typename base::const_reverse_iterator;
+
+        static constexpr size_type inline_capacity = N;
+
+        small_vector() noexcept(noexcept(Allocator()))
+        requires is_default_constructible_v<Allocator> : small_vector(Allocator()) {}
+
+        explicit small_vector(const Allocator& alloc) noexcept : base(alloc, nullptr, N) {
+            buf = inline_data();
+        }
+
+        /* The constructors below delegate to the one above first, so that the destructor cleans up if constructing an element throws. */
+        explicit small_vector(size_type n, const Allocator& alloc = Allocator())
+        requires requires (Allocator a, T* p) { traits_type::construct(a, p); } : small_vector(alloc) {
+            allocate_exactly(n);
+            this->construct_at_end(n);
+        }
+
+        small_vector(size_type n, const T& value, const Allocator& alloc = Allocator())
+        requires requires (Allocator a, T* p, const T& v) { traits_type::construct(a, p, v); } : small_vector(alloc) {
+            allocate_exactly(n);
+            this->construct_at_end(n, value);
+        }
+
+        template<__internal::legacy_input_iterator InputIterator>
+        small_vector(InputIterator first, InputIterator last, const Allocator& alloc = Allocator()) : small_vector(alloc) {
+            if constexpr (__internal::legacy_forward_iterator<InputIterator>) {
+                allocate_exactly(static_cast<size_type>(distance(first, last)));
+                for (; first != last; ++first) {
+                    traits_type::construct(this->alloc, buf + len, *first);
+                    len++;
+                }
+            } else {
+                for (; first != last; ++first) {
+                    this->emplace_back(*first);
+                }
+            }
+        }
+
+        small_vector(const small_vector& x) : small_vector(x, traits_type::select_on_container_copy_construction(x.alloc)) {}
+
+        small_vector(small_vector&& x) noexcept(is_nothrow_move_constructible_v<T>) : small_vector(move(x.alloc)) {
+            steal(x);
+        }
+
+        small_vector(const small_vector& x, const Allocator& alloc) : small_vector(x.begin(), x.end(), alloc) {}
+
+        small_vector(small_vector&& x, const Allocator& alloc) : small_vector(alloc) {
+            if (traits_type::is_always_equal::value || x.alloc == this->alloc) {
+                steal(x);
+            } else {
+                allocate_exactly(x.len);
+                for (size_type i = 0; i < x.len; i++) {
+                    traits_type::construct(this->alloc, buf + len, move(x.buf[i]));
+                    len++;
+                }
+            }
+        }
+
+        small_vector(initializer_list<T> il, const Allocator& alloc = Allocator()) : small_vector(il.begin(), il.end(), alloc) {}
+
+        ~small_vector() {
+            this->destroy_range(buf, buf + len);
+            deallocate_buffer();
+        }
+
+        small_vector& operator=(const small_vector& x) {
+            if (this == addressof(x)) {
+                return *this;
+            }
+
+            if constexpr (traits_type::propagate_on_container_copy_assignment::value) {
+                if (alloc != x.alloc) {
+                    // The current buffer can only be freed by the current allocator.
+                    this->clear();
+                    deallocate_buffer();
+                }
+                alloc = x.alloc;
+            }
+
+            this->assign(x.buf, x.buf + x.len);
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& x)
+        noexcept(is_nothrow_move_constructible_v<T>
+            && (allocator_traits<Allocator>::propagate_on_container_move_assignment::value || allocator_traits<Allocator>::is_always_equal::value)) {
+            if (this == addressof(x)) {
+                return *this;
+            }
+
+            if (traits_type::propagate_on_container_move_assignment::value || traits_type::is_always_equal::value || alloc == x.alloc) {
+                this->clear();
+                deallocate_buffer();
+                if constexpr (traits_type::propagate_on_container_move_assignment::value) {
+                    alloc = move(x.alloc);
+                }
+                steal(x);
+            } else {
+                // The buffer of x can't be adopted, as it's owned by an allocator that doesn't compare equal to ours.
+                this->assign(make_move_iterator(x.begin()), make_move_iterator(x.end()));
+                x.clear();
+            }
+
+            return *this;
+        }
+
+        small_vector& operator=(initializer_list<T> il) {
+            this->assign(il.begin(), il.end());
+            return *this;
+        }
+
+        /* Extension: whether the elements are stored in the inline buffer rather than on the heap. */
+        bool is_inline() const noexcept {
+            return buf == inline_data();
+        }
+
+        void reserve(size_type n) {
+            if (n <= cap) {
+                return;
+            } else if (n > this->max_size()) [[unlikely]] {
+                throw length_error("Invalid argument to small_vector::reserve.");
+            }
+
+            this->reallocate(n, len, 0, [](pointer) {});
+        }
+
+        /* Moves the elements back into the inline buffer if they fit there. */
+        void shrink_to_fit() {
+            if (is_inline() || cap == len) {
+                return;
+            } else if (len > N) {
+                this->reallocate(len, len, 0, [](pointer) {});
+                return;
+            }
+
+            const pointer heap_buf = buf;
+            const size_type heap_cap = cap;
+            relocate_elements(heap_buf, inline_data(), len);
+            traits_type::deallocate(alloc, heap_buf, heap_cap);
+            buf = inline_data();
+            cap = N;
+        }
+
+        const_reference at(size_type n) const {
+            if (n >= len) [[unlikely]] {
+                throw out_of_range("Invalid argument to small_vector::at.");
+            } else {
+                return buf[n];
+            }
+        }
+
+        reference at(size_type n) {
+            if (n >= len) [[unlikely]] {
+                throw out_of_range("Invalid argument to small_vector::at.");
+            } else {
+                return buf[n];
+            }
+        }
+
+        void swap(small_vector& other)
+        noexcept(is_nothrow_move_constructible_v<T> && (traits_type::propagate_on_container_swap::value || traits_type::is_always_equal::value)) {
+            swap_contents(other);
+
+            if constexpr (traits_type::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(alloc, other.alloc);
+            }
+        }
+
+    private:
+        alignas(T) unsigned char storage[N * sizeof(T)];
+
+        static constexpr const char* length_error_message = "small_vector exceeds its maximum size.";
+
+        pointer inline_data() noexcept {
+            return reinterpret_cast<pointer>(storage);
+        }
+
+        const_pointer inline_data() const noexcept {
+            return reinterpret_cast<const_pointer>(storage);
+        }
+
+        /* Makes room for n elements in a small_vector that holds none, allocating exactly n unless they fit in the inline buffer. */
+        void allocate_exactly(size_type n) {
+            if (n <= N) {
+                return;
+            } else if (n > this->max_size()) [[unlikely]] {
+                throw length_error(length_error_message);
+            }
+
+            buf = traits_type::allocate(alloc, n);
+            cap = n;
+        }
+
+        /* Frees the heap buffer if there is one, and goes back to the inline buffer. */
+        void deallocate_buffer() noexcept {
+            if (!is_inline()) {
+                traits_type::deallocate(alloc, buf, cap);
+                buf = inline_data();
+                cap = N;
+            }
+        }
+
+        // The inline buffer is never handed to the allocator.
+        bool owns_heap_buffer() const noexcept {
+            return !is_inline();
+        }
+
+        /* Moves n elements from one uninitialized buffer to another, destroying the originals. If a move constructor throws, the elements
+         * moved so far are destroyed and the originals are left untouched. */
+        void relocate_elements(pointer from, pointer to, size_type n) {
+            if constexpr (relocates_bitwise) {
+                if (n != 0) {
+                    std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+                }
+                return;
+            }
+
+            size_type moved = 0;
+            try {
+                for (; moved < n; moved++) {
+                    traits_type::construct(alloc, to + moved, move_if_noexcept(from[moved]));
+                }
+            } catch (...) {
+                this->destroy_range(to, to + moved);
+                throw;
+            }
+            this->destroy_range(from, from + n);
+        }
+
+        /* Takes the elements of x, which shares our allocator, leaving it empty. This small_vector must be empty and inline. A heap buffer is
+         * adopted as is, while inline elements are moved over one by one. */
+        void steal(small_vector& x) noexcept(is_nothrow_move_constructible_v<T>) {
+            if (!x.is_inline()) {
+                buf = x.buf;
+                cap = x.cap;
+                len = x.len;
+                x.buf = x.inline_data();
+                x.cap = N;
+                x.len = 0;
+                return;
+            }
+
+            if constexpr (relocates_bitwise) {
+                relocate_elements(x.buf, buf, x.len);
+                len = x.len;
+                x.len = 0;
+            } else {
+                for (size_type i = 0; i < x.len; i++) {
+                    traits_type::construct(alloc, buf + len, move(x.buf[i]));
+                    len++;
+                }
+                x.clear();
+            }
+        }
+
+        /* Swaps everything but the allocators. Heap buffers are swapped as is, while inline elements are moved through a temporary. */
+        void swap_contents(small_vector& other) noexcept(is_nothrow_move_constructible_v<T>) {
+            if (!is_inline() && !other.is_inline()) {
+                std::swap(len, other.len);
+                std::swap(cap, other.cap);
+                std::swap(buf, other.buf);
+                return;
+            }
+
+            small_vector temp(alloc);
+            temp.steal(*this);
+            steal(other);
+            other.steal(temp);
+        }
+    };
+
+    template<class T, size_t N, class Allocator>
+    requires requires (const T& t1, const T& t2) { { t1 == t2 } -> convertible_to<bool>; }
+    bool operator==(const small_vector<T, N, Allocator>& x, const small_vector<T, N, Allocator>& y) {
+        if (x.size() != y.size()) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < x.size(); i++) {
+            if (x[i] != y[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template<class T, size_t N, class Allocator>
+    requires requires (const T& t1, const T& t2) { __internal::synth_three_way(t1, t2); }
+    __internal::synth_three_way_result<T> operator<=>(const small_vector<T, N, Allocator>& x, const small_vector<T, N, Allocator>& y) {
+        return lexicographical_compare(x.cbegin(), x.cend(), y.cbegin(), y.cend(), __internal::synth_three_way);
+    }
+
+    template<class T, size_t N, class Allocator>
+    void swap(small_vector<T, N, Allocator>& x, small_vector<T, N, Allocator>& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+
+    template<class T, size_t N, class Allocator, class U>
+    typename small_vector<T, N, Allocator>::size_type erase(small_vector<T, N, Allocator>& c, const U& value) {
+        const typename small_vector<T, N, Allocator>::iterator it = remove(c.begin(), c.end(), value);
+        const typename small_vector<T, N, Allocator>::size_type r = distance(it, c.end());
+        c.erase(it, c.end());
+        return r;
+    }
+
+    template<class T, size_t N, class Allocator, class Predicate>
+    requires requires (Predicate pred, const T& elem) { { pred(elem) } -> convertible_to<bool>; }
+    typename small_vector<T, N, Allocator>::size_type erase_if(small_vector<T, N, Allocator>& c, Predicate pred) {
+        const typename small_vector<T, N, Allocator>::iterator it = remove_if(c.begin(), c.end(), pred);
+        const typename small_vector<T, N, Allocator>::size_type r = distance(it, c.end());
+        c.erase(it, c.end());
+        return r;
+    }
+
+    namespace pmr {
+        template<class T, size_t N>
+        using small_vector = std::small_vector<T, N, polymorphic_allocator<T>>;
+    }
+}
\ No newline at end of file
@@ -18,11 +18,164 @@
 #include "memory_resource.hpp"
 #include "functional.hpp"
 #include "ios.hpp"
+#include "bit.hpp"
 
 namespace std {
     /* 21.2 Character traits */
     template<class charT> struct char_traits {};
 
+    namespace __internal {
+        /* SSE2 versions of the searches the C library has no counterpart for, with scalar fallbacks on other targets. See src/string.cpp. */
+        std::size_t __char16_length(const char16_t* s) noexcept;
+        const char16_t* __char16_find(const char16_t* s, std::size_t n, char16_t a) noexcept;
+        std::size_t __char_mismatch(const char16_t* s1, const char16_t* s2, std::size_t n) noexcept;
+        std::size_t __char_mismatch(const char32_t* s1, const char32_t* s2, std::size_t n) noexcept;
+
+        /* The bulk operations shared by the char_traits specializations. Outside of constant evaluation they are handed to memcmp, strlen,
+         * memchr, memmove, memcpy, memset and their wide counterparts, which the C library vectorizes and dispatches at runtime to the widest
+         * instruction set the CPU supports. char32_t borrows the wchar_t functions where the two have the same size, except for compare, as
+         * wchar_t may be signed. The plain loops are only used during constant evaluation. */
+        template<class charT>
+        struct __char_traits_ops {
+        private:
+            using traits = char_traits<charT>;
+
+            static constexpr bool is_byte = is_same_v<charT, char> || is_same_v<charT, char8_t>;
+            static constexpr bool is_wide = is_same_v<charT, wchar_t> || (is_same_v<charT, char32_t> && sizeof(wchar_t) == sizeof(char32_t));
+
+            static const wchar_t* as_wide(const charT* s) noexcept {
+                return reinterpret_cast<const wchar_t*>(s);
+            }
+
+            static wchar_t* as_wide(charT* s) noexcept {
+                return reinterpret_cast<wchar_t*>(s);
+            }
+        public:
+            static constexpr int compare(const charT* s1, const charT* s2, std::size_t n) {
+                if (!is_constant_evaluated()) {
+                    if constexpr (is_byte) {
+                        return n == 0 ? 0 : __builtin_memcmp(s1, s2, n);
+                    } else if constexpr (is_same_v<charT, wchar_t>) {
+                        return std::wmemcmp(s1, s2, n);
+                    } else {
+                        const std::size_t i = __char_mismatch(s1, s2, n);
+                        return i == n ? 0 : traits::lt(s1[i], s2[i]) ? -1 : 1;
+                    }
+                }
+
+                for (std::size_t i = 0; i < n; i++) {
+                    if (traits::lt(s1[i], s2[i])) {
+                        return -1;
+                    } else if (traits::lt(s2[i], s1[i])) {
+                        return 1;
+                    }
+                }
+                return 0;
+            }
+
+            static constexpr std::size_t length(const charT* s) {
+                if (!is_constant_evaluated()) {
+                    if constexpr (is_byte) {
+                        return __builtin_strlen(reinterpret_cast<const char*>(s));
+                    } else if constexpr (is_wide) {
+                        return std::wcslen(as_wide(s));
+                    } else {
+                        return __char16_length(s);
+                    }
+                }
+
+                for (std::size_t i = 0; ; i++) {
+                    if (traits::eq(s[i], charT())) {
+                        return i;
+                    }
+                }
+            }
+
+            static constexpr const charT* find(const charT* s, std::size_t n, const charT& a) {
+                if (!is_constant_evaluated()) {
+                    if constexpr (is_byte) {
+                        return n == 0 ? nullptr : static_cast<const charT*>(__builtin_memchr(s, static_cast<unsigned char>(a), n));
+                    } else if constexpr (is_wide) {
+                        return reinterpret_cast<const charT*>(std::wmemchr(as_wide(s), static_cast<wchar_t>(a), n));
+                    } else {
+                        return __char16_find(s, n, a);
+                    }
+                }
+
+                for (std::size_t i = 0; i < n; i++) {
+                    if (traits::eq(s[i], a)) {
+                        return s + i;
+                    }
+                }
+                return nullptr;
+            }
+
+            static constexpr charT* move(charT* s1, const charT* s2, std::size_t n) {
+                if (!is_constant_evaluated()) {
+                    if (n != 0) {
+                        __builtin_memmove(s1, s2, n * sizeof(charT));
+                    }
+                    return s1;
+                }
+
+                // Only equality comparisons are allowed between pointers into unrelated objects during constant evaluation, so the ranges
+                // are known to overlap in the way that requires copying backwards if s1 is found in (s2, s2 + n).
+                bool is_backward = false;
+                for (std::size_t i = 1; i < n; i++) {
+                    if (s2 + i == s1) {
+                        is_backward = true;
+                        break;
+                    }
+                }
+
+                if (is_backward) {
+                    for (std::size_t i = n; i > 0; i--) {
+                        traits::assign(s1[i - 1], s2[i - 1]);
+                    }
+                } else {
+                    for (std::size_t i = 0; i < n; i++) {
+                        traits::assign(s1[i], s2[i]);
+                    }
+                }
+                return s1;
+            }
+
+            static constexpr charT* copy(charT* s1, const charT* s2, std::size_t n) {
+                if (!is_constant_evaluated()) {
+                    if (n != 0) {
+                        __builtin_memcpy(s1, s2, n * sizeof(charT));
+                    }
+                    return s1;
+                }
+
+                for (std::size_t i = 0; i < n; i++) {
+                    traits::assign(s1[i], s2[i]);
+                }
+                return s1;
+            }
+
+            static constexpr charT* assign(charT* s, std::size_t n, charT a) {
+                if (!is_constant_evaluated()) {
+                    if constexpr (is_byte) {
+                        if (n != 0) {
+                            __builtin_memset(s, static_cast<unsigned char>(a), n);
+                        }
+                        return s;
+                    } else if constexpr (is_wide) {
+                        std::wmemset(as_wide(s), static_cast<wchar_t>(a), n);
+                        return s;
+                    }
+                }
+
+                // The compiler vectorizes this loop for char16_t.
+                for (std::size_t i = 0; i < n; i++) {
+                    traits::assign(s[i], a);
+                }
+                return s;
+            }
+        };
+    }
+
     template<> struct char_traits<char> {
         using char_type = char;
         using int_type = int;
@@ -44,57 +197,27 @@ namespace std {
         }
 
         static constexpr int compare(const char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (lt(s1[i], s2[i])) {
-                    return -1;
-                } else if (lt(s2[i], s1[i])) {
-                    return 1;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::compare(s1, s2, n);
         }
 
         static constexpr std::size_t length(const char_type* s) {
-            for (std::size_t i = 0; ; i++) {
-                if (eq(s[i], char_type())) {
-                    return i;
-                }
-            }
+            return __internal::__char_traits_ops<char_type>::length(s);
         }
 
         static constexpr const char_type* find(const char_type* s, std::size_t n, const char_type& a) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (eq(s[i], a)) {
-                    return s + i;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::find(s, n, a);
         }
 
         static constexpr char_type* move(char_type* s1, const char_type* s2, std::size_t n) {
-            char_type* tmp = new char_type[n];
-            for (std::size_t i = 0; i < n; i++) {
-                tmp[i] = s2[i];
-            } 
-            for (std::size_t i = 0; i < n; i++) {
-                s1[i] = tmp[i];
-            }
-            delete[] tmp;
-            return s1;
+            return __internal::__char_traits_ops<char_type>::move(s1, s2, n);
         }
 
         static constexpr char_type* copy(char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s1[i], s2[i]);
-            }
-            return s1;
+            return __internal::__char_traits_ops<char_type>::copy(s1, s2, n);
         }
 
         static constexpr char_type* assign(char_type* s, std::size_t n, char_type a) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s[i], a);
-            }
-            return s;
+            return __internal::__char_traits_ops<char_type>::assign(s, n, a);
         }
 
         static constexpr int not_eof(int_type c) noexcept {
@@ -139,57 +262,27 @@ namespace std {
         }
 
         static constexpr int compare(const char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (lt(s1[i], s2[i])) {
-                    return -1;
-                } else if (lt(s2[i], s1[i])) {
-                    return 1;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::compare(s1, s2, n);
         }
 
         static constexpr std::size_t length(const char_type* s) {
-            for (std::size_t i = 0; ; i++) {
-                if (eq(s[i], char_type())) {
-                    return i;
-                }
-            }
+            return __internal::__char_traits_ops<char_type>::length(s);
         }
 
         static constexpr const char_type* find(const char_type* s, std::size_t n, const char_type& a) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (eq(s[i], a)) {
-                    return s + i;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::find(s, n, a);
         }
 
         static constexpr char_type* move(char_type* s1, const char_type* s2, std::size_t n) {
-            char_type* tmp = new char_type[n];
-            for (std::size_t i = 0; i < n; i++) {
-                tmp[i] = s2[i];
-            } 
-            for (std::size_t i = 0; i < n; i++) {
-                s1[i] = tmp[i];
-            }
-            delete[] tmp;
-            return s1;
+            return __internal::__char_traits_ops<char_type>::move(s1, s2, n);
         }
 
         static constexpr char_type* copy(char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s1[i], s2[i]);
-            }
-            return s1;
+            return __internal::__char_traits_ops<char_type>::copy(s1, s2, n);
         }
 
         static constexpr char_type* assign(char_type* s, std::size_t n, char_type a) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s[i], a);
-            }
-            return s;
+            return __internal::__char_traits_ops<char_type>::assign(s, n, a);
         }
 
         static constexpr int not_eof(int_type c) noexcept {
@@ -234,57 +327,27 @@ namespace std {
         }
 
         static constexpr int compare(const char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (lt(s1[i], s2[i])) {
-                    return -1;
-                } else if (lt(s2[i], s1[i])) {
-                    return 1;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::compare(s1, s2, n);
         }
 
         static constexpr std::size_t length(const char_type* s) {
-            for (std::size_t i = 0; ; i++) {
-                if (eq(s[i], char_type())) {
-                    return i;
-                }
-            }
+            return __internal::__char_traits_ops<char_type>::length(s);
         }
 
         static constexpr const char_type* find(const char_type* s, std::size_t n, const char_type& a) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (eq(s[i], a)) {
-                    return s + i;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::find(s, n, a);
         }
 
         static constexpr char_type* move(char_type* s1, const char_type* s2, std::size_t n) {
-            char_type* tmp = new char_type[n];
-            for (std::size_t i = 0; i < n; i++) {
-                tmp[i] = s2[i];
-            } 
-            for (std::size_t i = 0; i < n; i++) {
-                s1[i] = tmp[i];
-            }
-            delete[] tmp;
-            return s1;
+            return __internal::__char_traits_ops<char_type>::move(s1, s2, n);
         }
 
         static constexpr char_type* copy(char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s1[i], s2[i]);
-            }
-            return s1;
+            return __internal::__char_traits_ops<char_type>::copy(s1, s2, n);
         }
 
         static constexpr char_type* assign(char_type* s, std::size_t n, char_type a) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s[i], a);
-            }
-            return s;
+            return __internal::__char_traits_ops<char_type>::assign(s, n, a);
         }
 
         static constexpr int not_eof(int_type c) noexcept {
@@ -329,57 +392,27 @@ namespace std {
         }
 
         static constexpr int compare(const char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (lt(s1[i], s2[i])) {
-                    return -1;
-                } else if (lt(s2[i], s1[i])) {
-                    return 1;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::compare(s1, s2, n);
         }
 
         static constexpr std::size_t length(const char_type* s) {
-            for (std::size_t i = 0; ; i++) {
-                if (eq(s[i], char_type())) {
-                    return i;
-                }
-            }
+            return __internal::__char_traits_ops<char_type>::length(s);
         }
 
         static constexpr const char_type* find(const char_type* s, std::size_t n, const char_type& a) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (eq(s[i], a)) {
-                    return s + i;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::find(s, n, a);
         }
 
         static constexpr char_type* move(char_type* s1, const char_type* s2, std::size_t n) {
-            char_type* tmp = new char_type[n];
-            for (std::size_t i = 0; i < n; i++) {
-                tmp[i] = s2[i];
-            } 
-            for (std::size_t i = 0; i < n; i++) {
-                s1[i] = tmp[i];
-            }
-            delete[] tmp;
-            return s1;
+            return __internal::__char_traits_ops<char_type>::move(s1, s2, n);
         }
 
         static constexpr char_type* copy(char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s1[i], s2[i]);
-            }
-            return s1;
+            return __internal::__char_traits_ops<char_type>::copy(s1, s2, n);
         }
 
         static constexpr char_type* assign(char_type* s, std::size_t n, char_type a) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s[i], a);
-            }
-            return s;
+            return __internal::__char_traits_ops<char_type>::assign(s, n, a);
         }
 
         static constexpr int not_eof(int_type c) noexcept {
@@ -424,57 +457,27 @@ namespace std {
         }
 
         static constexpr int compare(const char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (lt(s1[i], s2[i])) {
-                    return -1;
-                } else if (lt(s2[i], s1[i])) {
-                    return 1;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::compare(s1, s2, n);
         }
 
         static constexpr std::size_t length(const char_type* s) {
-            for (std::size_t i = 0; ; i++) {
-                if (eq(s[i], char_type())) {
-                    return i;
-                }
-            }
+            return __internal::__char_traits_ops<char_type>::length(s);
         }
 
         static constexpr const char_type* find(const char_type* s, std::size_t n, const char_type& a) {
-            for (std::size_t i = 0; i < n; i++) {
-                if (eq(s[i], a)) {
-                    return s + i;
-                }
-            }
-            return 0;
+            return __internal::__char_traits_ops<char_type>::find(s, n, a);
         }
 
         static constexpr char_type* move(char_type* s1, const char_type* s2, std::size_t n) {
-            char_type* tmp = new char_type[n];
-            for (std::size_t i = 0; i < n; i++) {
-                tmp[i] = s2[i];
-            } 
-            for (std::size_t i = 0; i < n; i++) {
-                s1[i] = tmp[i];
-            }
-            delete[] tmp;
-            return s1;
+            return __internal::__char_traits_ops<char_type>::move(s1, s2, n);
         }
 
         static constexpr char_type* copy(char_type* s1, const char_type* s2, std::size_t n) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s1[i], s2[i]);
-            }
-            return s1;
+            return __internal::__char_traits_ops<char_type>::copy(s1, s2, n);
         }
 
         static constexpr char_type* assign(char_type* s, std::size_t n, char_type a) {
-            for (std::size_t i = 0; i < n; i++) {
-                assign(s[i], a);
-            }
-            return s;
+            return __internal::__char_traits_ops<char_type>::assign(s, n, a);
         }
 
         static constexpr int not_eof(int_type c) noexcept {
@@ -517,196 +520,317 @@ namespace std {
         using reverse_iterator = std::reverse_iterator<iterator>;
         using const_reverse_iterator = std::reverse_iterator<const_iterator>;
     private:
-        /* The maximum amount of characters (including the null-terminating character) that can be stored in the stack storage. */
-        static constexpr size_type stack_capacity = 20;
-        [[no_unique_address]] Allocator alloc;
-        union {
-            charT stack[stack_capacity];
-            struct {
-                size_type capacity;
-                charT* buf;
-            } heap;
-            // pair<size_type, charT*> heap;
+        using char_alloc_traits = typename allocator_traits<Allocator>::template rebind_traits<charT>;
+
+        /* A string is either long, with its characters in a buffer obtained from the allocator, or short, with up to short_buffer_size
+         * characters (including the null terminator) stored in the object itself, in the space the long representation takes up. With 64-bit
+         * sizes and pointers, that's 24 bytes, of which a short string of char uses 23 for up to 22 characters and the terminator.
+         *
+         * The representations are told apart by a flag bit in the first byte of the object, which is the lowest bit of the capacity word of a
+         * long string on little-endian machines, and the highest bit on big-endian ones. The capacity and the size of a short string, which
+         * takes up the rest of that byte, are stored in the other bits.
+         *
+         * Telling the representations apart reads the inactive member of the union, which constant evaluation doesn't allow, so strings
+         * created during constant evaluation are always long. */
+        struct long_rep {
+            size_type capacity_word;
+            size_type size;
+            charT* buf;
         };
 
-        size_type len;
-        bool is_heap_in_use;
+        static constexpr size_type short_buffer_size = (sizeof(long_rep) - 1) / sizeof(charT);
+
+        struct short_rep {
+            unsigned char size_byte;
+            charT buf[short_buffer_size];
+        };
+
+        static_assert(short_buffer_size >= 2 && sizeof(short_rep) <= sizeof(long_rep), "The short representation must fit in the long one.");
+
+        union rep_type {
+            long_rep l;
+            short_rep s;
+        };
+
+        static constexpr bool is_little_endian = endian::native == endian::little;
+        static constexpr size_type long_flag = is_little_endian ? 1 : ~(numeric_limits<size_type>::max() >> 1);
+        static constexpr unsigned char short_flag = is_little_endian ? 0x01 : 0x80;
+
+        [[no_unique_address]] Allocator alloc;
+        rep_type rep;
+
+        constexpr bool is_long() const noexcept {
+            return is_constant_evaluated() || (rep.s.size_byte & short_flag) != 0;
+        }
+
+        /* The capacity of the long buffer, including the null terminator. */
+        constexpr size_type long_capacity() const noexcept {
+            return is_little_endian ? rep.l.capacity_word >> 1 : rep.l.capacity_word & ~long_flag;
+        }
+
+        constexpr void set_long_capacity(size_type capacity) noexcept {
+            rep.l.capacity_word = (is_little_endian ? capacity << 1 : capacity) | long_flag;
+        }
+
+        constexpr void set_short_size(size_type n) noexcept {
+            rep.s.size_byte = static_cast<unsigned char>(is_little_endian ? n << 1 : n);
+        }
+
+        /* Sets the size and writes the null terminator after it. */
+        constexpr void set_length(size_type n) noexcept {
+            if (is_long()) {
+                rep.l.size = n;
+                traits::assign(rep.l.buf[n], charT());
+            } else {
+                set_short_size(n);
+                traits::assign(rep.s.buf[n], charT());
+            }
+        }
+
+        constexpr void set_long(charT* buf, size_type capacity, size_type n) noexcept {
+            rep.l = { .capacity_word = 0, .size = n, .buf = buf };
+            set_long_capacity(capacity);
+            traits::assign(buf[n], charT());
+        }
+
+        /* Allocates a buffer for at least n characters and the null terminator. */
+        constexpr allocation_result<charT*, size_type> allocate_long(size_type n) {
+            if (n > max_size()) [[unlikely]] {
+                throw length_error("basic_string exceeds its maximum size.");
+            }
+
+            return char_alloc_traits::allocate_at_least(alloc, n + 1);
+        }
+
+        constexpr void deallocate_long() noexcept {
+            if (is_long()) {
+                char_alloc_traits::deallocate(alloc, rep.l.buf, long_capacity());
+            }
+        }
+
+        /* Makes this an empty string, without freeing any buffer. */
+        constexpr void init_empty() {
+            if (is_constant_evaluated()) {
+                const allocation_result<charT*, size_type> allocation = allocate_long(0);
+                set_long(allocation.ptr, allocation.count, 0);
+            } else {
+                rep.s = short_rep();
+            }
+        }
+
+        /* Sets up the storage for a new string of n characters, and returns where to write them. The null terminator is written already. */
+        constexpr charT* init_storage(size_type n) {
+            if (n < short_buffer_size && !is_constant_evaluated()) {
+                rep.s = short_rep();
+                set_short_size(n);
+                return rep.s.buf;
+            }
+
+            const allocation_result<charT*, size_type> allocation = allocate_long(n);
+            set_long(allocation.ptr, allocation.count, n);
+            return allocation.ptr;
+        }
+
+        /* Returns the capacity to grow to, excluding the null terminator, when new_size characters don't fit. The capacity at least doubles
+         * on every reallocation, so that any sequence of appends costs amortized constant time per character. */
+        constexpr size_type next_capacity(size_type new_size) const {
+            const size_type max_cap = max_size();
+            if (new_size > max_cap) [[unlikely]] {
+                throw length_error("basic_string exceeds its maximum size.");
+            }
+
+            const size_type cap = capacity();
+            return cap >= max_cap / 2 ? max_cap : max(2 * cap, new_size);
+        }
+
+        /* Whether s points into the characters of this string. Only checked outside of constant evaluation, where pointers into unrelated
+         * objects can't be compared. */
+        constexpr bool is_aliasing(const charT* s) const noexcept {
+            return !is_constant_evaluated() && s >= data() && s <= data() + size();
+        }
+
+        /* Replaces the n1 characters at pos, which must be in range, with n2 characters written by fill, which is handed where to write
+         * them. When the result doesn't fit in the capacity, a long buffer is first grown in place if the allocator can, and otherwise the
+         * result is assembled in a new buffer, after which the old one is freed; fill may read from the old buffer in that case, but not when
+         * the characters are shifted in place. */
+        template<class F>
+        constexpr void replace_with(size_type pos, size_type n1, size_type n2, F&& fill) {
+            const size_type sz = size();
+            if (n2 > n1 && n2 - n1 > max_size() - sz) [[unlikely]] {
+                throw length_error("basic_string exceeds its maximum size.");
+            }
+
+            const size_type new_size = sz - n1 + n2;
+            bool fits = new_size <= capacity();
+            if (!fits) {
+                const size_type new_capacity = next_capacity(new_size);
+                if (is_long() && char_alloc_traits::try_expand(alloc, rep.l.buf, long_capacity(), new_capacity + 1)) {
+                    set_long_capacity(new_capacity + 1);
+                    fits = true;
+                } else {
+                    const allocation_result<charT*, size_type> allocation = allocate_long(new_capacity);
+                    const charT* const old_buf = data();
+                    traits::copy(allocation.ptr, old_buf, pos);
+                    fill(allocation.ptr + pos);
+                    traits::copy(allocation.ptr + pos + n2, old_buf + pos + n1, sz - pos - n1);
+                    deallocate_long();
+                    set_long(allocation.ptr, allocation.count, new_size);
+                    return;
+                }
+            }
+
+            charT* const buf = data();
+            if (n1 != n2) {
+                traits::move(buf + pos + n2, buf + pos + n1, sz - pos - n1);
+            }
+            fill(buf + pos);
+            set_length(new_size);
+        }
+
+        /* Moves the characters to a buffer for exactly n characters and the terminator, where n is at least the size. Short strings are
+         * left alone when n fits in the short buffer. */
+        constexpr void reallocate_exactly(size_type n) {
+            const size_type sz = size();
+            if (n < short_buffer_size && !is_constant_evaluated()) {
+                if (is_long()) {
+                    charT* const old_buf = rep.l.buf;
+                    const size_type old_capacity = long_capacity();
+                    rep.s = short_rep();
+                    traits::copy(rep.s.buf, old_buf, sz);
+                    set_length(sz);
+                    char_alloc_traits::deallocate(alloc, old_buf, old_capacity);
+                }
+                return;
+            }
+
+            const allocation_result<charT*, size_type> allocation = allocate_long(n);
+            traits::copy(allocation.ptr, data(), sz);
+            deallocate_long();
+            set_long(allocation.ptr, allocation.count, sz);
+        }
 
     public:
         static constexpr size_type npos = -1;
 
         /* 21.3.3.3 Construct/copy/destroy */
-        constexpr basic_string() noexcept(noexcept(Allocator())) : alloc(), stack{0}, len(0), is_heap_in_use(false) {}
+        constexpr basic_string() noexcept(noexcept(Allocator())) : basic_string(Allocator()) {}
 
-        constexpr explicit basic_string(const Allocator& a) noexcept : alloc(a), stack{0}, len(0), is_heap_in_use(false) {}
+        constexpr explicit basic_string(const Allocator& a) noexcept : alloc(a), rep() {
+            init_empty();
+        }
 
         constexpr basic_string(const basic_string& str) : basic_string(str, allocator_traits<Allocator>::select_on_container_copy_construction(str.alloc)) {}
 
-        constexpr basic_string(basic_string&& str) noexcept : basic_string(move(str), move(str).alloc) {}
+        constexpr basic_string(basic_string&& str) noexcept : alloc(move(str.alloc)), rep(str.rep) {
+            str.init_empty();
+        }
 
-        constexpr basic_string(const basic_string& str, size_type pos, const Allocator& a = Allocator()) 
+        constexpr basic_string(const basic_string& str, size_type pos, const Allocator& a = Allocator())
             : basic_string(basic_string_view<charT, traits>(str).substr(pos, npos), a) {}
 
-        constexpr basic_string(const basic_string& str, size_type pos, size_type n, const Allocator& a = Allocator()) 
+        constexpr basic_string(const basic_string& str, size_type pos, size_type n, const Allocator& a = Allocator())
             : basic_string(basic_string_view<charT, traits>(str).substr(pos, n), a) {}
 
-        template<class T> 
+        template<class T>
         requires is_convertible_v<const T&, basic_string_view<charT, traits>>
-        constexpr basic_string(const T& t, size_type pos, size_type n, const Allocator& a = Allocator()) 
+        constexpr basic_string(const T& t, size_type pos, size_type n, const Allocator& a = Allocator())
             : basic_string(basic_string_view<charT, traits>(t).substr(pos, n), a) {}
 
-        template<class T> 
+        template<class T>
         requires is_convertible_v<const T&, basic_string_view<charT, traits>> && (!is_convertible_v<const T&, const charT*>)
         constexpr explicit basic_string(const T& t, const Allocator& a = Allocator())
             : basic_string(basic_string_view<charT, traits>(t).data(), basic_string_view<charT, traits>(t).size(), a) {}
 
-        constexpr basic_string(const charT* s, size_type n, const Allocator& a = Allocator())
-            : basic_string(s, s + n, a) {}
+        constexpr basic_string(const charT* s, size_type n, const Allocator& a = Allocator()) : alloc(a), rep() {
+            traits::copy(init_storage(n), s, n);
+        }
 
         constexpr basic_string(const charT* s, const Allocator& a = Allocator())
             : basic_string(s, traits::length(s), a) {}
 
-        constexpr basic_string(size_type n, charT c, const Allocator& a = Allocator())
-            : alloc(a), stack(), len(n), is_heap_in_use(n + 1 > stack_capacity) {
-            if (is_heap_in_use) {
-                const size_type capacity = n + 1;
-                charT* const buf = allocator_traits<Allocator>::template rebind_traits<charT>::allocate(alloc, capacity);
-                traits::assign(buf, n, c);
-                traits::assign(buf[n], 0);
-                heap = { .capacity = capacity, .buf = buf };
-            } else {
-                traits::assign(stack, n, c);
-                traits::assign(stack[n], 0);
-            }
+        constexpr basic_string(size_type n, charT c, const Allocator& a = Allocator()) : alloc(a), rep() {
+            traits::assign(init_storage(n), n, c);
         }
 
         template<__internal::legacy_input_iterator InputIterator>
-        constexpr basic_string(InputIterator begin, InputIterator end, const Allocator& a = Allocator())
-            : alloc(a), stack(), len(0), is_heap_in_use(false) {
-            /* Always points to the next address to write character to. */
-            charT* it = stack;
-            const auto add_character = [&](charT c) {
-                if (!is_heap_in_use && len == stack_capacity) [[unlikely]] {
-                    // Need to switch from stack to heap.
-                    const size_type capacity = stack_capacity * 2;
-                    charT* const new_buf = allocator_traits<Allocator>::template rebind_traits<charT>::allocate(alloc, capacity);
-                    traits::copy(new_buf, stack, stack_capacity);
-                    heap = { .capacity = capacity, .buf = new_buf };
-                    
-                    is_heap_in_use = true;
-                    it = heap.buf + stack_capacity;
-                } else if (is_heap_in_use && len == heap.capacity) [[unlikely]] {
-                    // Need to allocate a larger buffer on the heap.
-                    const size_type new_capacity = stack_capacity * 2;
-                    charT* const new_buf = allocator_traits<Allocator>::template rebind_traits<charT>::allocate(alloc, new_capacity);
-                    traits::copy(new_buf, heap.buf, len);
-                    allocator_traits<Allocator>::template rebind_traits<charT>::deallocate(alloc, heap.buf, heap.capacity);
-
-                    it = new_buf + heap.capacity;
-                    heap = { .capacity = new_capacity, .buf = new_buf };
+        constexpr basic_string(InputIterator begin, InputIterator end, const Allocator& a = Allocator()) : alloc(a), rep() {
+            if constexpr (__internal::legacy_forward_iterator<InputIterator>) {
+                charT* it = init_storage(static_cast<size_type>(distance(begin, end)));
+                for (; begin != end; ++begin, ++it) {
+                    traits::assign(*it, *begin);
+                }
+            } else {
+                init_empty();
+                try {
+                    for (; begin != end; ++begin) {
+                        push_back(*begin);
+                    }
+                } catch (...) {
+                    deallocate_long();
+                    throw;
                 }
-
-                traits::assign(*it, c);
-                len++;
-                it++;
-            };
-
-            while (begin != end) {
-                add_character(*begin);
             }
-
-            add_character(0);
         }
 
-        constexpr basic_string(initializer_list<charT> il, const Allocator& a = Allocator()) 
-            : basic_string(il.begin(), il.end(), a) {}
+        constexpr basic_string(initializer_list<charT> il, const Allocator& a = Allocator())
+            : basic_string(il.begin(), il.size(), a) {}
 
-        constexpr basic_string(const basic_string& str, const Allocator& a)
-            : alloc(a), stack(), len(str.len), is_heap_in_use(len + 1 > stack_capacity) {
-            if (is_heap_in_use) {
-                charT* const new_addr = allocator_traits<Allocator>::template rebind_traits<charT>::allocate(alloc, str.heap.capacity);
-                traits::copy(new_addr, str.heap.buf, len + 1);
-                heap = { .capacity = str.heap.capacity, .buf = new_addr };
-            } else {
-                traits::copy(stack, str.stack, len + 1);
-            }
-        }
+        constexpr basic_string(const basic_string& str, const Allocator& a) : basic_string(str.data(), str.size(), a) {}
 
-        constexpr basic_string(basic_string&& str, const Allocator& a) : alloc(a), stack(), len(str.len), is_heap_in_use(str.is_heap_in_use) {
-            if (is_heap_in_use) {
-                heap = str.heap;
-                str.stack[0] = typename traits::char_type(0);
-                str.is_heap_in_use = false;
+        constexpr basic_string(basic_string&& str, const Allocator& a) : alloc(a), rep() {
+            if (allocator_traits<Allocator>::is_always_equal::value || alloc == str.alloc) {
+                rep = str.rep;
+                str.init_empty();
             } else {
-                traits::copy(stack, str.stack, len + 1);
+                traits::copy(init_storage(str.size()), str.data(), str.size());
             }
-
-            str.len = 0;
         }
 
         constexpr ~basic_string() {
-            if (is_heap_in_use) {
-                allocator_traits<Allocator>::template rebind_traits<charT>::deallocate(alloc, heap.buf, heap.capacity);
-            }
+            deallocate_long();
         }
 
         constexpr basic_string& operator=(const basic_string& str) {
-            if (*this != str) {
-                if (is_heap_in_use) {
-                    allocator_traits<Allocator>::template rebind_traits<charT>::deallocate(alloc, heap.buf, heap.capacity);
-                }
+            if (this == addressof(str)) {
+                return *this;
+            }
 
-                if constexpr (allocator_traits<Allocator>::propagate_on_container_copy_assignment::value) {
+            if constexpr (allocator_traits<Allocator>::propagate_on_container_copy_assignment::value) {
+                if (alloc != str.alloc) {
+                    // The current buffer can only be freed by the current allocator.
+                    deallocate_long();
                     alloc = str.alloc;
-                }
-
-                len = str.len;
-                is_heap_in_use = str.is_heap_in_use;
-                if (is_heap_in_use) {
-                    charT* const this_buf = allocator_traits<Allocator>::template rebind_traits<charT>::allocate(alloc, str.heap.capacity);
-                    traits::copy(this_buf, str.heap.buf, len + 1);
-                    heap = { .capacity = str.heap.capacity, .buf = this_buf };
+                    init_empty();
                 } else {
-                    traits::copy(stack, str.stack, len + 1);
+                    alloc = str.alloc;
                 }
             }
 
-            return *this;
+            return assign(str.data(), str.size());
         }
 
         constexpr basic_string& operator=(basic_string&& str)
         noexcept(allocator_traits<Allocator>::propagate_on_container_move_assignment::value || allocator_traits<Allocator>::is_always_equal::value) {
-            if (is_heap_in_use) {
-                allocator_traits<Allocator>::template rebind_traits<charT>::deallocate(alloc, heap.buf, heap.capacity);
+            if (this == addressof(str)) {
+                return *this;
             }
-            
-            len = str.len;
-            is_heap_in_use = str.is_heap_in_use;
 
-            if constexpr (allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
-                alloc = str.alloc;
-            }
-            
-            if (is_heap_in_use) {
-                if constexpr (!allocator_traits<Allocator>::propagate_on_container_move_assignment::value && !allocator_traits<Allocator>::is_always_equal::value) {
-                    charT* const this_buf = allocator_traits<Allocator>::template rebind_traits<charT>::allocate(alloc, str.heap.capacity);
-                    traits::copy(this_buf, str.heap.buf, len + 1);
-                    allocator_traits<Allocator>::template rebind_traits<charT>::deallocate(str.alloc, str.heap.buf, str.heap.capacity);
-                    heap = { .capacity = str.heap.capacity, .buf = this_buf };
-                } else {
-                    heap = str.heap;
+            if (allocator_traits<Allocator>::propagate_on_container_move_assignment::value || allocator_traits<Allocator>::is_always_equal::value
+                || alloc == str.alloc) {
+                deallocate_long();
+                if constexpr (allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
+                    alloc = move(str.alloc);
                 }
-
-                str.stack[0] = typename traits::char_type(0);
-                str.is_heap_in_use = false;
-                str.len = 0;
+                rep = str.rep;
+                str.init_empty();
             } else {
-                traits::copy(stack, str.stack, len + 1);
+                // The buffer of str can't be adopted, as it's owned by an allocator that doesn't compare equal to ours.
+                assign(str.data(), str.size());
             }
 
             return *this;
         }
-        
+
         template<class T>
         requires is_convertible_v<const T&, basic_string_view<charT, traits>> && (!is_convertible_v<const T&, const charT*>)
         constexpr basic_string& operator=(const T& t) {
@@ -776,40 +900,28 @@ namespace std {
 
         /* 21.3.3.5 Capacity */
         constexpr size_type size() const noexcept {
-            return len;
+            if (is_long()) {
+                return rep.l.size;
+            }
+            return is_little_endian ? rep.s.size_byte >> 1 : rep.s.size_byte;
         }
 
         constexpr size_type length() const noexcept {
-            return len;
+            return size();
         }
 
+        /* One bit of the capacity word is taken by the flag, and one character by the null terminator. */
         constexpr size_type max_size() const noexcept {
-            return numeric_limits<size_type>::max();
+            return min<size_type>(char_alloc_traits::max_size(alloc), numeric_limits<size_type>::max() >> 1) - 2;
         }
 
+        /* The capacity is kept when the string shrinks. */
         constexpr void resize(size_type n, charT c) {
-            if (n == size()) {
-                return;
-            } else if (n > size()) {
-                append(n - size(), c);
-            }
-
-            const bool new_buf_on_stack = n + 1 <= stack_capacity;
-
-            len = n;
-            if (new_buf_on_stack && !is_heap_in_use) {
-                // Storage remains on the stack. So we just need to add a null-terminating character at the appropriate spot.
-                traits::assign(stack[n], 0);
-            } else if (!new_buf_on_stack && is_heap_in_use) {
-                // Storage remains on the heap. We don't want to release overused capacity, so similarly add a null-terminating
-                // character at the appropriate spot.
-                traits::assign(heap.buf[n], 0);
+            const size_type sz = size();
+            if (n <= sz) {
+                set_length(n);
             } else {
-                // Storage needs to change from heap to stack.
-                traits::copy(stack, heap.buf, n);
-                traits::assign(stack[n], 0);
-                is_heap_in_use = false;
-                allocator_traits<Allocator>::template rebind_traits<charT>::deallocate(alloc, heap.buf, heap.capacity);
+                append(n - sz, c);
             }
         }
 
@@ -818,33 +930,34 @@ namespace std {
         }
 
         constexpr size_type capacity() const noexcept {
-            // In our data structures we store the capacity including the null-terminating character, so need to subtract that from the result.
-            return is_heap_in_use ? heap.first - 1 : stack_capacity - 1;
+            // The capacity is stored including the null-terminating character, so need to subtract that from the result.
+            return is_long() ? long_capacity() - 1 : short_buffer_size - 1;
         }
 
         constexpr void reserve(size_type res_arg) {
             if (capacity() >= res_arg) {
                 return;
+            } else if (res_arg > max_size()) [[unlikely]] {
+                throw length_error("Invalid argument when calling basic_string::reserve.");
             }
 
-            // At this point, the new storage is guaranteed to be on the heap, with capacity res_arg.
-            charT* const new_buf = allocator_traits<Allocator>::template rebind_traits<charT>::allocate(alloc, res_arg + 1);
-            if (is_heap_in_use) {
-                traits::copy(new_buf, heap.buf, len + 1);
-                allocator_traits<Allocator>::template rebind_traits<charT>::deallocate(alloc, heap.buf, len + 1);
-            } else {
-                traits::copy(new_buf, stack, len + 1);
-                is_heap_in_use = true;
+            if (is_long() && char_alloc_traits::try_expand(alloc, rep.l.buf, long_capacity(), res_arg + 1)) {
+                set_long_capacity(res_arg + 1);
+                return;
             }
-            heap = { .capacity = res_arg + 1, .buf = new_buf };
+
+            reallocate_exactly(res_arg);
         }
 
+        /* Moves a long string back into the short buffer if it fits there. */
         constexpr void shrink_to_fit() {
-            resize(size());
+            if (is_long() && size() + 1 < long_capacity()) {
+                reallocate_exactly(size());
+            }
         }
 
         constexpr void clear() noexcept {
-            erase(begin(), end());
+            set_length(0);
         }
 
         [[nodiscard]] constexpr bool empty() const noexcept {
@@ -906,7 +1019,8 @@ namespace std {
         }
 
         constexpr basic_string& operator+=(charT c) {
-            return append(size_type(1), c);
+            push_back(c);
+            return *this;
         }
 
         constexpr basic_string& operator+=(initializer_list<charT> il) {
@@ -934,42 +1048,10 @@ namespace std {
             return append(basic_string_view<charT, traits>(t).substr(pos, n));
         }
 
+        /* Nothing is shifted, so s may point into this string: it's either left in place, or read before the old buffer is freed. */
         constexpr basic_string& append(const charT* s, size_type n) {
-            const bool new_buf_on_heap = len + n + 1 > stack_capacity;
-            if (new_buf_on_heap && is_heap_in_use) {
-                // We stay on the heap.
-                const auto [old_capacity, old_buf] = heap;
-                if (size() + n + 1 > heap.capacity) {
-                    // Needs to expand the capacity.
-                    const size_type new_capacity = (size() + n) * 2;
-                    charT* const new_buf = allocator_traits<Allocator>::template rebind_traits<charT>::allocate(alloc, new_capacity);
-                    traits::copy(new_buf, heap.buf, len);
-                    traits::copy(new_buf + len, s, n);
-                    traits::assign(new_buf[len + n], 0);
-                    len = size() + n;
-                    allocator_traits<Allocator>::template rebind_traits<charT>::deallocate(alloc, heap.buf, heap.capacity);
-                    heap = { .capacity = new_capacity, .buf = new_buf };
-                } else {
-                    traits::copy(heap.buf + len, s, n);
-                    traits::assign(heap.buf[len + n], 0);
-                    len = size() + n;
-                }
-            } else if (!new_buf_on_heap && !is_heap_in_use) {
-                // We stay on the stack.
-                traits::copy(stack + len, s, n);
-                traits::assign(stack[len + n], 0);
-                len = size() + n;
-            } else {
-                // Need to switch from stack to heap.
-                const size_type new_capacity = (size() + n) * 2;
-                charT* const new_buf = allocator_traits<Allocator>::template rebind_traits<charT>::allocate(alloc, new_capacity);
-                traits::copy(new_buf, stack, len);
-                traits::copy(new_buf + len, s, n);
-                traits::assign(new_buf[len + n], 0);
-                len = size() + n;
-                heap = { .capacity = new_capacity, .buf = new_buf };
-                is_heap_in_use = true;
-            }
+            replace_with(size(), 0, n, [s, n](charT* dest) { traits::copy(dest, s, n); });
+            return *this;
         }
 
         constexpr basic_string& append(const charT* s) {
@@ -977,7 +1059,8 @@ namespace std {
         }
 
         constexpr basic_string& append(size_type n, charT c) {
-            return append(basic_string(n, c, get_allocator()));
+            replace_with(size(), 0, n, [n, c](charT* dest) { traits::assign(dest, n, c); });
+            return *this;
         }
 
         template<__internal::legacy_input_iterator InputIterator>
@@ -986,11 +1069,17 @@ namespace std {
         }
 
         constexpr basic_string& append(initializer_list<charT> il) {
-            return append(il.begin(), il.end());
+            return append(il.begin(), il.size());
         }
 
         constexpr void push_back(charT c) {
-            append(size_type(1), c);
+            const size_type sz = size();
+            if (sz < capacity()) [[likely]] {
+                traits::assign(data()[sz], c);
+                set_length(sz + 1);
+            } else {
+                append(size_type(1), c);
+            }
         }
 
         constexpr basic_string& assign(const basic_string& str) {
@@ -1019,8 +1108,17 @@ namespace std {
             return assign(basic_string_view<charT, traits>(t).substr(pos, n));
         }
 
+        /* The current buffer is reused if it's large enough, in which case s may point into it. Otherwise s can't point into it, and the
+         * buffer is replaced by one of exactly n characters. */
         constexpr basic_string& assign(const charT* s, size_type n) {
-            return *this = basic_string(s, n, get_allocator());
+            if (n > capacity()) {
+                clear();
+                reserve(n);
+            }
+
+            traits::move(data(), s, n);
+            set_length(n);
+            return *this;
         }
 
         constexpr basic_string& assign(const charT* s) {
@@ -1028,15 +1126,13 @@ namespace std {
         }
 
         constexpr basic_string& assign(size_type n, charT c) {
-            const size_type curr_size = len;
-            resize(n, c);
-
-            if (is_heap_in_use) {
-                traits::assign(heap.buf, min(n, curr_size), c);
-            } else {
-                traits::assign(stack, min(n, curr_size), c);
+            if (n > capacity()) {
+                clear();
+                reserve(n);
             }
 
+            traits::assign(data(), n, c);
+            set_length(n);
             return *this;
         }
 
@@ -1071,19 +1167,7 @@ namespace std {
         }
 
         constexpr basic_string& insert(size_type pos, const charT* s, size_type n) {
-            if (pos > len) {
-                throw out_of_range("Invalid argument when calling basic_string::insert.");
-            } else if (n > max_size() - len) {
-                throw length_error("Invalid argument when calling basic_string::insert.");
-            }
-
-            reserve(len + n);
-            charT* const buf = is_heap_in_use ? heap.buf : stack;
-            traits::copy(buf + pos + n, buf + pos, len - pos);
-            traits::copy(buf + pos, s, n);
-            len += n;
-            traits::assign(buf[len], 0);
-            return *this;
+            return replace(pos, 0, s, n);
         }
 
         constexpr basic_string& insert(size_type pos, const charT* s) {
@@ -1091,19 +1175,7 @@ namespace std {
         }
 
         constexpr basic_string& insert(size_type pos, size_type n, charT c) {
-            if (pos > len) {
-                throw out_of_range("Invalid argument when calling basic_string::insert.");
-            } else if (n > max_size() - len) {
-                throw length_error("Invalid argument when calling basic_string::insert.");
-            }
-
-            reserve(len + n);
-            charT* const buf = is_heap_in_use ? heap.buf : stack;
-            traits::copy(buf + pos + n, buf + pos, len - pos);
-            traits::assign(buf + pos, n, c);
-            len += n;
-            traits::assign(buf[len], 0);
-            return *this;
+            return replace(pos, 0, n, c);
         }
 
         constexpr iterator insert(const_iterator p, charT c) {
@@ -1120,7 +1192,9 @@ namespace std {
 
         template<__internal::legacy_input_iterator InputIterator>
         constexpr iterator insert(const_iterator p, InputIterator first, InputIterator last) {
-            return insert(p - begin(), basic_string(first, last, get_allocator()));
+            const size_type pos = p - begin();
+            insert(pos, basic_string(first, last, get_allocator()));
+            return begin() + pos;
         }
 
         constexpr iterator insert(const_iterator p, initializer_list<charT> il) {
@@ -1128,16 +1202,15 @@ namespace std {
         }
 
         constexpr basic_string& erase(size_type pos = 0, size_type n = npos) {
-            if (pos > size()) {
+            const size_type sz = size();
+            if (pos > sz) {
                 throw out_of_range("Invalid argument when calling basic_string::erase.");
             }
 
-            const size_type xlen = min(n, size() - pos);
-            charT* const buf = is_heap_in_use ? heap.buf : stack;
-            traits::copy(buf + pos, buf + pos + xlen, len - pos - xlen);
-            resize(len - xlen);
-            traits::assign(buf[len], 0);
-
+            const size_type xlen = min(n, sz - pos);
+            charT* const buf = data();
+            traits::move(buf + pos, buf + pos + xlen, sz - pos - xlen);
+            set_length(sz - xlen);
             return *this;
         }
 
@@ -1154,7 +1227,7 @@ namespace std {
         }
 
         constexpr void pop_back() {
-            erase(end() - 1);
+            set_length(size() - 1);
         }
 
         constexpr basic_string& replace(size_type pos1, size_type n1, const basic_string& str) {
@@ -1179,24 +1252,18 @@ namespace std {
         }
 
         constexpr basic_string& replace(size_type pos, size_type n1, const charT* s, size_type n2) {
-            /* This is the length of the string to be removed. */
-            if (pos > len) {
+            if (pos > size()) {
                 throw out_of_range("Invalid argument when calling basic_string::replace.");
-            }
-            const size_type xlen = min(n1, size() - pos);
-            if (size() - xlen >= max_size() - n2) {
-                throw length_error("Invalid argument when calling basic_string::replace.");
+            } else if (is_aliasing(s)) {
+                // The characters of s might be shifted before they are copied, so they are copied out first.
+                const basic_string copy(s, n2, alloc);
+                return replace(pos, n1, copy.data(), n2);
             }
 
-            const size_type new_len = len - xlen + n2;
-            reserve(new_len);
-
-            charT* const buf = is_heap_in_use ? heap.buf : stack;
-            // Move the segment after the removed part to where it should be.
-            traits::move(buf + pos + n2, buf + pos + xlen, len - pos - xlen);
-            traits::copy(buf + pos, s, n2);
-            len = new_len;
-            traits::assign(buf[len], 0);
+            /* This is the length of the string to be removed. */
+            const size_type xlen = min(n1, size() - pos);
+            replace_with(pos, xlen, n2, [s, n2](charT* dest) { traits::copy(dest, s, n2); });
+            return *this;
         }
 
         constexpr basic_string& replace(size_type pos, size_type n1, const charT* s) {
@@ -1204,24 +1271,14 @@ namespace std {
         }
 
         constexpr basic_string& replace(size_type pos, size_type n1, size_type n2, charT c) {
-            /* This is the length of the string to be removed. */
-            if (pos > len) {
+            if (pos > size()) {
                 throw out_of_range("Invalid argument when calling basic_string::replace.");
             }
-            const size_type xlen = min(n1, size() - pos);
-            if (size() - xlen >= max_size() - n2) {
-                throw length_error("Invalid argument when calling basic_string::replace.");
-            }
-
-            const size_type new_len = len - xlen + n2;
-            reserve(new_len);
 
-            charT* const buf = is_heap_in_use ? heap.buf : stack;
-            // Move the segment after the removed part to where it should be.
-            traits::move(buf + pos + n2, buf + pos + xlen, len - pos - xlen);
-            traits::assign(buf + pos, n2, c);
-            len = new_len;
-            traits::assign(buf[len], 0);
+            /* This is the length of the string to be removed. */
+            const size_type xlen = min(n1, size() - pos);
+            replace_with(pos, xlen, n2, [n2, c](charT* dest) { traits::assign(dest, n2, c); });
+            return *this;
         }
 
         constexpr basic_string& replace(const_iterator i1, const_iterator i2, const basic_string& str) {
@@ -1260,34 +1317,20 @@ namespace std {
             return basic_string_view<charT, traits>(*this).copy(s, n, pos);
         }
 
+        /* Both representations are swapped as plain bytes, since neither points into the object. */
         constexpr void swap(basic_string& str)
         noexcept(allocator_traits<Allocator>::propagate_on_container_swap::value || allocator_traits<Allocator>::is_always_equal::value) {
             using std::swap;
             if constexpr (allocator_traits<Allocator>::propagate_on_container_swap::value) {
                 swap(alloc, str.alloc);
-            } else if (!allocator_traits<Allocator>::is_always_equal::value) {
+            } else if (!allocator_traits<Allocator>::is_always_equal::value && alloc != str.alloc) {
                 // Triggers undefined behavior. Here we don't do anything.
                 return;
             }
 
-            swap(len, str.len);
-            if (is_heap_in_use && str.is_heap_in_use) {
-                swap(heap, str.heap);
-            } else if (!is_heap_in_use && !str.is_heap_in_use) {
-                swap(stack, str.stack);
-            } else if (is_heap_in_use && !str.is_heap_in_use) {
-                auto heap_info = heap;
-                stack[0] = typename traits::char_type(0);
-                traits::copy(stack, str.stack, stack_capacity);
-                str.heap = heap_info;
-            } else {
-                auto heap_info = str.heap;
-                str.stack[0] = typename traits::char_type(0);
-                traits::copy(str.stack, stack, stack_capacity);
-                heap = heap_info;
-            }
-
-            swap(is_heap_in_use, str.is_heap_in_use);
+            const rep_type temp = rep;
+            rep = str.rep;
+            str.rep = temp;
         }
 
         /* 21.3.3.8 String operations */
@@ -1296,11 +1339,11 @@ namespace std {
         }
 
         constexpr const charT* data() const noexcept {
-            return is_heap_in_use ? heap.buf : stack;
+            return is_long() ? rep.l.buf : rep.s.buf;
         }
 
         constexpr charT* data() noexcept {
-            return is_heap_in_use ? heap.buf : stack;
+            return is_long() ? rep.l.buf : rep.s.buf;
         }
 
         constexpr operator basic_string_view<charT, traits>() const noexcept {
@@ -1335,11 +1378,11 @@ namespace std {
 
         template<class T> 
         requires is_convertible_v<const T&, basic_string_view<charT, traits>> && (!is_convertible_v<const T&, const charT*>)
-        constexpr size_type rfind(const T& t, size_type pos = 0) const noexcept(is_nothrow_convertible_v<const T&, basic_string_view<charT, traits>>) {
+        constexpr size_type rfind(const T& t, size_type pos = npos) const noexcept(is_nothrow_convertible_v<const T&, basic_string_view<charT, traits>>) {
             return basic_string_view<charT, traits>(*this).rfind(basic_string_view<charT, traits>(t), pos);
         }
 
-        constexpr size_type rfind(const basic_string& str, size_type pos = 0) const noexcept {
+        constexpr size_type rfind(const basic_string& str, size_type pos = npos) const noexcept {
             return rfind(basic_string_view<charT, traits>(str), pos);
         }
 
@@ -1347,11 +1390,11 @@ namespace std {
             return rfind(basic_string_view<charT, traits>(s, n), pos);
         }
 
-        constexpr size_type rfind(const charT* s, size_type pos = 0) const {
+        constexpr size_type rfind(const charT* s, size_type pos = npos) const {
             return rfind(basic_string_view<charT, traits>(s), pos);
         }
 
-        constexpr size_type rfind(charT c, size_type pos = 0) const noexcept {
+        constexpr size_type rfind(charT c, size_type pos = npos) const noexcept {
             return rfind(basic_string_view<charT, traits>(addressof(c), 1), pos);
         }
 
@@ -1379,11 +1422,11 @@ namespace std {
 
         template<class T> 
         requires is_convertible_v<const T&, basic_string_view<charT, traits>> && (!is_convertible_v<const T&, const charT*>)
-        constexpr size_type find_last_of(const T& t, size_type pos = 0) const noexcept(is_nothrow_convertible_v<const T&, basic_string_view<charT, traits>>) {
+        constexpr size_type find_last_of(const T& t, size_type pos = npos) const noexcept(is_nothrow_convertible_v<const T&, basic_string_view<charT, traits>>) {
             return basic_string_view<charT, traits>(*this).find_last_of(basic_string_view<charT, traits>(t), pos);
         }
 
-        constexpr size_type find_last_of(const basic_string& str, size_type pos = 0) const noexcept {
+        constexpr size_type find_last_of(const basic_string& str, size_type pos = npos) const noexcept {
             return find_last_of(basic_string_view<charT, traits>(str), pos);
         }
 
@@ -1391,11 +1434,11 @@ namespace std {
             return find_last_of(basic_string_view<charT, traits>(s, n), pos);
         }
 
-        constexpr size_type find_last_of(const charT* s, size_type pos = 0) const {
+        constexpr size_type find_last_of(const charT* s, size_type pos = npos) const {
             return find_last_of(basic_string_view<charT, traits>(s), pos);
         }
 
-        constexpr size_type find_last_of(charT c, size_type pos = 0) const noexcept {
+        constexpr size_type find_last_of(charT c, size_type pos = npos) const noexcept {
             return find_last_of(basic_string_view<charT, traits>(addressof(c), 1), pos);
         }
 
@@ -1423,11 +1466,11 @@ namespace std {
 
         template<class T> 
         requires is_convertible_v<const T&, basic_string_view<charT, traits>> && (!is_convertible_v<const T&, const charT*>)
-        constexpr size_type find_last_not_of(const T& t, size_type pos = 0) const noexcept(is_nothrow_convertible_v<const T&, basic_string_view<charT, traits>>) {
+        constexpr size_type find_last_not_of(const T& t, size_type pos = npos) const noexcept(is_nothrow_convertible_v<const T&, basic_string_view<charT, traits>>) {
             return basic_string_view<charT, traits>(*this).find_last_not_of(basic_string_view<charT, traits>(t), pos);
         }
 
-        constexpr size_type find_last_not_of(const basic_string& str, size_type pos = 0) const noexcept {
+        constexpr size_type find_last_not_of(const basic_string& str, size_type pos = npos) const noexcept {
             return find_last_not_of(basic_string_view<charT, traits>(str), pos);
         }
 
@@ -1435,11 +1478,11 @@ namespace std {
             return find_last_not_of(basic_string_view<charT, traits>(s, n), pos);
         }
 
-        constexpr size_type find_last_not_of(const charT* s, size_type pos = 0) const {
+        constexpr size_type find_last_not_of(const charT* s, size_type pos = npos) const {
             return find_last_not_of(basic_string_view<charT, traits>(s), pos);
         }
 
-        constexpr size_type find_last_not_of(charT c, size_type pos = 0) const noexcept {
+        constexpr size_type find_last_not_of(charT c, size_type pos = npos) const noexcept {
             return find_last_not_of(basic_string_view<charT, traits>(addressof(c), 1), pos);
         }
 
@@ -1447,7 +1490,7 @@ namespace std {
             if (pos > size()) {
                 throw out_of_range("Invalid argument when calling basic_string::substr.");
             }
-            return basic_string(data() + pos, min(n, size(), - pos));
+            return basic_string(data() + pos, min(n, size() - pos));
         }
 
         template<class T>
@@ -1517,6 +1560,12 @@ namespace std {
         }
     };
 
+    // Short strings keep their characters in the object, but data() finds them from a flag rather than through a pointer into the object.
+    template<class charT, class traits, class Allocator>
+    struct is_trivially_relocatable<basic_string<charT, traits, Allocator>> : is_trivially_relocatable<Allocator> {};
+
+    static_assert(sizeof(void*) != 8 || sizeof(size_t) != 8 || sizeof(string) == 24, "A string must be three words on LP64 targets.");
+
     template<class InputIterator, class Allocator = allocator<typename iterator_traits<InputIterator>::value_type>>
     basic_string(InputIterator, InputIterator, Allocator = Allocator()) 
         -> basic_string<typename iterator_traits<InputIterator>::value_type, char_traits<typename iterator_traits<InputIterator>::value_type>, Allocator>;
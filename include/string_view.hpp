@@ -12,6 +12,187 @@
 #include "algorithm.hpp"
 
 namespace std {
+    namespace __internal {
+        /* Finds the first occurrence of a needle of at least 2 bytes, comparing the first and last byte of the needle against 16 positions of the
+         * haystack at a time with SSE2 and only calling memcmp on the positions where both match. See src/string_view.cpp. */
+        const char* __byte_search(const char* s, std::size_t n, const char* needle, std::size_t m) noexcept;
+
+        /* The same filter run from the end of the haystack backwards, finding the last occurrence. */
+        const char* __byte_rsearch(const char* s, std::size_t n, const char* needle, std::size_t m) noexcept;
+
+        // Needles at least this long are searched with Horspool's algorithm, whose shifts grow with the needle.
+        inline constexpr std::size_t __long_needle = 32;
+
+        /* The search engine behind basic_string_view and basic_string::find. The bitmaps, skip tables and SIMD filters rely on characters
+         * comparing equal exactly when their values are equal, so user-supplied traits always go through traits::find and traits::compare. */
+        template<class charT, class traits>
+        inline constexpr bool __plain_char_traits = is_same_v<traits, char_traits<charT>>;
+
+        /* Returns the position of the first occurrence of needle in s, or size_t(-1). Requires 0 < m <= n. */
+        template<class charT, class traits>
+        constexpr std::size_t __str_search(const charT* s, std::size_t n, const charT* needle, std::size_t m) noexcept {
+            if (m == 1) {
+                const charT* const p = traits::find(s, n, needle[0]);
+                return p != nullptr ? p - s : std::size_t(-1);
+            }
+
+            if constexpr (__plain_char_traits<charT, traits>) {
+                if (m >= __long_needle) {
+                    const __byte_skip_table<std::ptrdiff_t> skip(needle, m);
+                    const charT* const p = __horspool_search(s, s + n, needle, std::ptrdiff_t(m), skip, [](charT a, charT b) { return traits::eq(a, b); });
+                    return p != s + n ? p - s : std::size_t(-1);
+                }
+                if constexpr (sizeof(charT) == 1) {
+                    if (!is_constant_evaluated()) {
+                        const char* const p = __byte_search(reinterpret_cast<const char*>(s), n, reinterpret_cast<const char*>(needle), m);
+                        return p != nullptr ? p - reinterpret_cast<const char*>(s) : std::size_t(-1);
+                    }
+                }
+            }
+
+            // Let traits::find skip to the next candidate for the first character, and check the last one before comparing the rest.
+            const charT* const candidates_end = s + (n - m + 1);
+            for (const charT* p = s; (p = traits::find(p, candidates_end - p, needle[0])) != nullptr; p++) {
+                if (traits::eq(p[m - 1], needle[m - 1]) && traits::compare(p + 1, needle + 1, m - 2) == 0) {
+                    return p - s;
+                }
+            }
+            return std::size_t(-1);
+        }
+
+        /* Returns the position of the last occurrence of needle in s, or size_t(-1). Requires 0 < m <= n. The mirror image of __str_search:
+         * Horspool's algorithm runs over reverse iterators, so that its skip table is built from the needle read backwards and the window
+         * shifts towards the front, and short byte needles go through __byte_rsearch. */
+        template<class charT, class traits>
+        constexpr std::size_t __str_rsearch(const charT* s, std::size_t n, const charT* needle, std::size_t m) noexcept {
+            if (m == 1) {
+                for (std::size_t i = n; i-- > 0;) {
+                    if (traits::eq(s[i], needle[0])) {
+                        return i;
+                    }
+                }
+                return std::size_t(-1);
+            }
+
+            if constexpr (__plain_char_traits<charT, traits>) {
+                if (m >= __long_needle) {
+                    using reverse = reverse_iterator<const charT*>;
+                    const reverse reversed_needle(needle + m);
+                    const __byte_skip_table<std::ptrdiff_t> skip(reversed_needle, std::ptrdiff_t(m));
+                    const reverse p = __horspool_search(reverse(s + n), reverse(s), reversed_needle, std::ptrdiff_t(m), skip,
+                                                        [](charT a, charT b) { return traits::eq(a, b); });
+                    // A match found backwards ends where p points, and starts m characters before that.
+                    return p != reverse(s) ? static_cast<std::size_t>(p.base() - s) - m : std::size_t(-1);
+                }
+                if constexpr (sizeof(charT) == 1) {
+                    if (!is_constant_evaluated()) {
+                        const char* const p = __byte_rsearch(reinterpret_cast<const char*>(s), n, reinterpret_cast<const char*>(needle), m);
+                        return p != nullptr ? p - reinterpret_cast<const char*>(s) : std::size_t(-1);
+                    }
+                }
+            }
+
+            // Check the first and last characters before comparing the whole window.
+            for (std::size_t i = n - m + 1; i-- > 0;) {
+                if (traits::eq(s[i], needle[0]) && traits::eq(s[i + m - 1], needle[m - 1]) && traits::compare(s + i + 1, needle + 1, m - 2) == 0) {
+                    return i;
+                }
+            }
+            return std::size_t(-1);
+        }
+
+        /* A 256-bit membership table for the set argument of find_first_of and friends. It only applies when every character of the set fits in
+         * a byte, which is always the case for the byte-sized character types. */
+        template<class charT>
+        struct __char_bitmap {
+            constexpr __char_bitmap(const charT* set, std::size_t n) noexcept : words(), usable(true) {
+                for (std::size_t i = 0; i < n; i++) {
+                    const unsigned long long c = index(set[i]);
+                    if (c > 255) {
+                        usable = false;
+                        return;
+                    }
+                    words[c / 64] |= 1ULL << (c % 64);
+                }
+            }
+
+            constexpr bool contains(charT x) const noexcept {
+                const unsigned long long c = index(x);
+                return c <= 255 && (words[c / 64] >> (c % 64) & 1) != 0;
+            }
+
+            // Negative values of the signed wide character types land far outside the table.
+            static constexpr unsigned long long index(charT c) noexcept {
+                if constexpr (sizeof(charT) == 1) {
+                    return static_cast<unsigned char>(c);
+                } else {
+                    return static_cast<unsigned long long>(c);
+                }
+            }
+
+            unsigned long long words[4];
+            bool usable;
+        };
+
+        /* find_first_of when in_set is true, find_first_not_of otherwise. */
+        template<class charT, class traits, bool in_set>
+        constexpr std::size_t __find_first_of(const charT* s, std::size_t n, std::size_t pos, const charT* set, std::size_t m) noexcept {
+            if constexpr (in_set) {
+                if (m == 1 && pos < n) {
+                    const charT* const p = traits::find(s + pos, n - pos, set[0]);
+                    return p != nullptr ? p - s : std::size_t(-1);
+                }
+            }
+
+            if constexpr (__plain_char_traits<charT, traits>) {
+                const __char_bitmap<charT> bitmap(set, m);
+                if (bitmap.usable) {
+                    for (; pos < n; pos++) {
+                        if (bitmap.contains(s[pos]) == in_set) {
+                            return pos;
+                        }
+                    }
+                    return std::size_t(-1);
+                }
+            }
+
+            for (; pos < n; pos++) {
+                if ((traits::find(set, m, s[pos]) != nullptr) == in_set) {
+                    return pos;
+                }
+            }
+            return std::size_t(-1);
+        }
+
+        /* find_last_of when in_set is true, find_last_not_of otherwise. */
+        template<class charT, class traits, bool in_set>
+        constexpr std::size_t __find_last_of(const charT* s, std::size_t n, std::size_t pos, const charT* set, std::size_t m) noexcept {
+            if (n == 0) {
+                return std::size_t(-1);
+            }
+
+            std::size_t i = (pos < n - 1 ? pos : n - 1) + 1;
+            if constexpr (__plain_char_traits<charT, traits>) {
+                const __char_bitmap<charT> bitmap(set, m);
+                if (bitmap.usable) {
+                    while (i-- > 0) {
+                        if (bitmap.contains(s[i]) == in_set) {
+                            return i;
+                        }
+                    }
+                    return std::size_t(-1);
+                }
+            }
+
+            while (i-- > 0) {
+                if ((traits::find(set, m, s[i]) != nullptr) == in_set) {
+                    return i;
+                }
+            }
+            return std::size_t(-1);
+        }
+    }
+
     /* 21.4.3 Class template basic_string_view */
     template<class charT, class traits = char_traits<charT>>
     class basic_string_view {
@@ -202,17 +383,24 @@ namespace std {
         }
 
         constexpr size_type find(basic_string_view s, size_type pos = 0) const noexcept {
-            for (size_type i = pos; i <= size() - s.size(); i++) {
-                if (traits::compare(s.data(), data()[i], s.size()) == 0) {
-                    return i;
-                }
+            if (pos > size() || s.size() > size() - pos) {
+                return npos;
+            }
+            if (s.empty()) {
+                return pos;
             }
 
-            return npos;
+            const size_type i = __internal::__str_search<charT, traits>(data() + pos, size() - pos, s.data(), s.size());
+            return i != npos ? pos + i : npos;
         }
 
         constexpr size_type find(charT c, size_type pos = 0) const noexcept {
-            return find(basic_string_view(addressof(c), 1), pos);
+            if (pos >= size()) {
+                return npos;
+            }
+
+            const charT* const p = traits::find(data() + pos, size() - pos, c);
+            return p != nullptr ? p - data() : npos;
         }
 
         constexpr size_type find(const charT* s, size_type pos, size_type n) const {
@@ -224,17 +412,30 @@ namespace std {
         }
 
         constexpr size_type rfind(basic_string_view s, size_type pos = npos) const noexcept {
-            for (size_type i = size() - s.size(); i >= pos; i--) {
-                if (traits::compare(s.data(), data()[i], s.size()) == 0) {
-                    return i;
-                }
+            if (s.size() > size()) {
+                return npos;
             }
 
-            return npos;
+            const size_type last = min(pos, size() - s.size());
+            if (s.empty()) {
+                return last;
+            }
+
+            // Only the part of the view where a match starts at or before last is searched.
+            return __internal::__str_rsearch<charT, traits>(data(), last + s.size(), s.data(), s.size());
         }
 
         constexpr size_type rfind(charT c, size_type pos = npos) const noexcept {
-            return rfind(basic_string_view(addressof(c), 1), pos);
+            if (empty()) {
+                return npos;
+            }
+
+            for (size_type i = min(pos, size() - 1) + 1; i-- > 0;) {
+                if (traits::eq(data()[i], c)) {
+                    return i;
+                }
+            }
+            return npos;
         }
 
         constexpr size_type rfind(const charT* s, size_type pos, size_type n) const {
@@ -246,12 +447,7 @@ namespace std {
         }
 
         constexpr size_type find_first_of(basic_string_view s, size_type pos = 0) const noexcept {
-            for (; pos < length(); pos++) {
-                if (traits::find(s.data(), s.size(), data()[pos]) != nullptr) {
-                    return pos;
-                }
-            }
-            return npos;
+            return __internal::__find_first_of<charT, traits, true>(data(), size(), pos, s.data(), s.size());
         }
 
         constexpr size_type find_first_of(charT c, size_type pos = 0) const noexcept {
@@ -267,12 +463,7 @@ namespace std {
         }
 
         constexpr size_type find_last_of(basic_string_view s, size_type pos = npos) const noexcept {
-            for (size_type i = min(pos, size() - 1); i >= 0; i--) {
-                if (traits::find(s.data(), s.size(), data()[pos]) != nullptr) {
-                    return i;
-                }
-            }
-            return npos;
+            return __internal::__find_last_of<charT, traits, true>(data(), size(), pos, s.data(), s.size());
         }
 
         constexpr size_type find_last_of(charT c, size_type pos = npos) const noexcept {
@@ -288,12 +479,7 @@ namespace std {
         }
 
         constexpr size_type find_first_not_of(basic_string_view s, size_type pos = 0) const noexcept {
-            for (; pos < length(); pos++) {
-                if (traits::find(s.data(), s.size(), data()[pos]) == nullptr) {
-                    return pos;
-                }
-            }
-            return npos;
+            return __internal::__find_first_of<charT, traits, false>(data(), size(), pos, s.data(), s.size());
         }
 
         constexpr size_type find_first_not_of(charT c, size_type pos = 0) const noexcept {
@@ -309,12 +495,7 @@ namespace std {
         }
 
         constexpr size_type find_last_not_of(basic_string_view s, size_type pos = npos) const noexcept {
-            for (size_type i = min(pos, size() - 1); i >= 0; i--) {
-                if (traits::find(s.data(), s.size(), data()[pos]) == nullptr) {
-                    return i;
-                }
-            }
-            return npos;
+            return __internal::__find_last_of<charT, traits, false>(data(), size(), pos, s.data(), s.size());
         }
 
         constexpr size_type find_last_not_of(charT c, size_type pos = npos) const noexcept {
@@ -158,10 +158,24 @@ namespace std {
 
     void swap(jthread& x, jthread& y) noexcept;
 
+    /* Extension: NUMA topology and thread placement. The topology is read from /sys/devices/system/node on Linux. Elsewhere, and on machines
+     * without that directory, the system is reported as a single node 0 holding every CPU. The pinning functions throw system_error if the
+     * CPU or node doesn't exist, or if the platform can't restrict threads to CPUs. */
+    unsigned int numa_node_count() noexcept;
+
+    void pin_to_cpu(thread& t, unsigned int cpu);
+    void pin_to_cpu(jthread& t, unsigned int cpu);
+    void pin_to_node(thread& t, unsigned int node);
+    void pin_to_node(jthread& t, unsigned int node);
+
     namespace this_thread {
         thread::id get_id() noexcept;
         void yield() noexcept;
 
+        /* Extension: see std::pin_to_cpu and std::pin_to_node. */
+        void pin_to_cpu(unsigned int cpu);
+        void pin_to_node(unsigned int node);
+
         template<class Clock, class Duration>
         void sleep_until(const chrono::time_point<Clock, Duration>& abs_time) {
             return sleep_for(abs_time - chrono::steady_clock::now());
@@ -349,4 +349,14 @@ namespace std {
 #if __has_intrinsics_for(builtin_is_constant_evaluated)
     using __internal::is_constant_evaluated;
 #endif
+
+#if __has_intrinsics_for(is_trivially_copyable)
+    /* Extension: whether an object of type T can be relocated, i.e. moved to another address and destroyed at the old one, by copying its bytes.
+     * Containers use it to move elements around with memcpy and memmove. It holds for trivially copyable types, and is specialized for the
+     * library types that qualify. A program may specialize it for a class type that neither points into itself nor hands out its address. */
+    template<class T>
+    struct is_trivially_relocatable : bool_constant<is_trivially_copyable_v<T>> {};
+
+    template<class T> inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+#endif
 }
\ No newline at end of file
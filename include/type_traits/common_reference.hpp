@@ -37,9 +37,15 @@ namespace std::__internal {
     template<class T1, class T2> requires is_reference<T1>::value && is_reference<T2>::value
     constexpr auto __simple_common_reference_type() noexcept -> decltype(auto) {
         if constexpr (is_lvalue_reference<T1>::value && is_lvalue_reference<T2>::value) {
-            using C = decltype(false ? declval<typename __cv_union<T1, T2, T1>::type>() : declval<typename __cv_union<T1, T2, T2>::type>());
-            if constexpr (is_reference<C>::value) {
-                return __val<C>();
+            using A = typename __cv_union<T1, T2, T1>::type;
+            using B = typename __cv_union<T1, T2, T2>::type;
+            if constexpr (requires { false ? declval<A>() : declval<B>(); }) {
+                using C = decltype(false ? declval<A>() : declval<B>());
+                if constexpr (is_reference<C>::value) {
+                    return __val<C>();
+                } else {
+                    return __no_type();
+                }
             } else {
                 return __no_type();
             }
@@ -64,21 +70,47 @@ namespace std::__internal {
         }
     }
 
+    /* Applies the cv and reference qualifiers of T to its argument, as XREF(T) does in the standard. */
+    template<class T>
+    struct __xref {
+        template<class U>
+        using type = typename conditional<is_rvalue_reference<T>::value, typename __cv_union<typename remove_reference<T>::type, U, U>::type&&,
+            typename conditional<is_lvalue_reference<T>::value, typename __cv_union<typename remove_reference<T>::type, U, U>::type&,
+                typename __cv_union<T, U, U>::type>::type>::type;
+    };
+
+    template<class T1, class T2>
+    using __basic_common_reference_t = typename basic_common_reference<typename remove_cv<typename remove_reference<T1>::type>::type,
+        typename remove_cv<typename remove_reference<T2>::type>::type, __xref<T1>::template type, __xref<T2>::template type>::type;
+
+    // The common reference of two reference types, or __no_type if either isn't a reference or they have none.
+    template<class T1, class T2>
+    constexpr auto __simple_common_reference_or_none() noexcept -> decltype(auto) {
+        if constexpr (is_reference<T1>::value && is_reference<T2>::value) {
+            return __simple_common_reference_type<T1, T2>();
+        } else {
+            return __no_type();
+        }
+    }
+
     template<class ...T>
     constexpr auto __common_reference_impl(...) noexcept -> __no_type;
     template<>
     constexpr auto __common_reference_impl(...) noexcept -> __no_type;
     template<class T>
     constexpr auto __common_reference_impl(int) noexcept -> T;
+    /* Tries each way of finding the common reference in the order of 20.15.7.6 [meta.trans.other]: the common reference of two reference types,
+     * a basic_common_reference specialization, the type of a conditional expression, and the common type. */
     template<class T1, class T2>
     constexpr auto __common_reference_impl(int) noexcept -> decltype(auto) {
-        if constexpr (is_reference<T1>::value && is_reference<T2>::value) {
-            using C = decltype(__simple_common_reference_type<T1, T2>());
-            return __val<C>();
-        } else if constexpr (auto val = false ? __val<T1>() : __val<T2>(); true) {
-            return __val<decltype(val)>();
-        } else if constexpr (auto val = declval<common_type<T1, T2>::type>(); true) {
-            return __val<decltype(val)>();
+        if constexpr (!is_same<decltype(__simple_common_reference_or_none<T1, T2>()), __no_type>::value) {
+            return __simple_common_reference_or_none<T1, T2>();
+        } else if constexpr (requires { typename __basic_common_reference_t<T1, T2>; }) {
+            return __val<__basic_common_reference_t<T1, T2>>();
+        } else if constexpr (requires { false ? __val<T1>() : __val<T2>(); }) {
+            return __val<decltype(false ? __val<T1>() : __val<T2>())>();
+        } else if constexpr (requires { typename common_type<T1, T2>::type; }) {
+            return __val<typename common_type<T1, T2>::type>();
         } else {
             return __no_type();
         }
@@ -14,7 +14,7 @@ namespace std::__internal {
 
     template<std::size_t Size, class Type, class ...Types>
     struct find_first_with_size<Size, Type, Types...>
-        : conditional<Size <= sizeof(Type), Type, typename find_first_with_size<Size, Types...>::type> {};
+        : conditional<Size <= sizeof(Type), type_identity<Type>, find_first_with_size<Size, Types...>>::type {};
 
     /* Add the cv qualifiers of From to To. */
     template<class From, class To> struct __add_cv_of { using type = To; };
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "__hash_table.hpp"
+#include "compare.hpp"
+#include "functional.hpp"
+#include "initializer_list.hpp"
+#include "memory.hpp"
+#include "memory_resource.hpp"
+#include "stdexcept.hpp"
+#include "tuple.hpp"
+
+namespace std {
+    /* 22.5.4 Class template unordered_map
+     *
+     * The elements are stored in an open-addressing table (see __internal::__hash_table), with the same departures from the standard as
+     * unordered_set: rehashing invalidates references to the elements, there is no bucket interface beyond the counts and no node handles,
+     * and the allocator must use raw pointers. */
+    template<class Key, class T, class Hash = hash<Key>, class Pred = equal_to<Key>, class Allocator = allocator<pair<const Key, T>>>
+    class unordered_map : public __internal::__hash_table<__internal::__map_policy<Key, T>, Hash, Pred, Allocator> {
+    private:
+        using base = __internal::__hash_table<__internal::__map_policy<Key, T>, Hash, Pred, Allocator>;
+    public:
+        using mapped_type = T;
+        using typename base::key_type;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        using base::base;
+
+        // Declared here rather than inherited so that class template argument deduction sees an initializer-list constructor.
+        unordered_map(initializer_list<value_type> il, typename base::size_type n = 0, const Hash& hf = Hash(), const Pred& eql = Pred(),
+            const Allocator& a = Allocator()) : base(il, n, hf, eql, a) {}
+
+        unordered_map& operator=(initializer_list<value_type> il) {
+            base::operator=(il);
+            return *this;
+        }
+
+        using base::insert;
+
+        template<class P>
+        requires is_constructible_v<value_type, P&&>
+        pair<iterator, bool> insert(P&& obj) {
+            return this->emplace(forward<P>(obj));
+        }
+
+        template<class P>
+        requires is_constructible_v<value_type, P&&>
+        iterator insert(const_iterator, P&& obj) {
+            return this->emplace(forward<P>(obj)).first;
+        }
+
+        /* 22.5.4.4 Modifiers */
+        template<class ...Args>
+        pair<iterator, bool> try_emplace(const key_type& k, Args&& ...args) {
+            return this->emplace_key(k, piecewise_construct, forward_as_tuple(k), forward_as_tuple(forward<Args>(args)...));
+        }
+
+        template<class ...Args>
+        pair<iterator, bool> try_emplace(key_type&& k, Args&& ...args) {
+            return this->emplace_key(k, piecewise_construct, forward_as_tuple(move(k)), forward_as_tuple(forward<Args>(args)...));
+        }
+
+        template<class ...Args>
+        iterator try_emplace(const_iterator, const key_type& k, Args&& ...args) {
+            return try_emplace(k, forward<Args>(args)...).first;
+        }
+
+        template<class ...Args>
+        iterator try_emplace(const_iterator, key_type&& k, Args&& ...args) {
+            return try_emplace(move(k), forward<Args>(args)...).first;
+        }
+
+        // obj is only used if try_emplace didn't use it.
+        template<class M>
+        requires is_assignable_v<T&, M&&>
+        pair<iterator, bool> insert_or_assign(const key_type& k, M&& obj) {
+            const pair<iterator, bool> r = try_emplace(k, forward<M>(obj));
+            if (!r.second) {
+                r.first->second = forward<M>(obj);
+            }
+            return r;
+        }
+
+        template<class M>
+        requires is_assignable_v<T&, M&&>
+        pair<iterator, bool> insert_or_assign(key_type&& k, M&& obj) {
+            const pair<iterator, bool> r = try_emplace(move(k), forward<M>(obj));
+            if (!r.second) {
+                r.first->second = forward<M>(obj);
+            }
+            return r;
+        }
+
+        template<class M>
+        requires is_assignable_v<T&, M&&>
+        iterator insert_or_assign(const_iterator, const key_type& k, M&& obj) {
+            return insert_or_assign(k, forward<M>(obj)).first;
+        }
+
+        template<class M>
+        requires is_assignable_v<T&, M&&>
+        iterator insert_or_assign(const_iterator, key_type&& k, M&& obj) {
+            return insert_or_assign(move(k), forward<M>(obj)).first;
+        }
+
+        /* 22.5.4.3 Element access */
+        mapped_type& operator[](const key_type& k) {
+            return try_emplace(k).first->second;
+        }
+
+        mapped_type& operator[](key_type&& k) {
+            return try_emplace(move(k)).first->second;
+        }
+
+        mapped_type& at(const key_type& k) {
+            value_type* const p = this->find_slot(k);
+            if (p == nullptr) [[unlikely]] {
+                throw out_of_range("Invalid argument to unordered_map::at.");
+            }
+            return p->second;
+        }
+
+        const mapped_type& at(const key_type& k) const {
+            const value_type* const p = this->find_slot(k);
+            if (p == nullptr) [[unlikely]] {
+                throw out_of_range("Invalid argument to unordered_map::at.");
+            }
+            return p->second;
+        }
+    };
+
+    template<class Key, class T, class Hash, class Pred, class Allocator>
+    struct is_trivially_relocatable<unordered_map<Key, T, Hash, Pred, Allocator>>
+        : bool_constant<is_trivially_relocatable_v<Hash> && is_trivially_relocatable_v<Pred> && is_trivially_relocatable_v<Allocator>> {};
+
+    template<__internal::legacy_input_iterator InputIterator, class Hash = hash<__internal::__iter_key_t<InputIterator>>,
+        class Pred = equal_to<__internal::__iter_key_t<InputIterator>>, class Allocator = allocator<__internal::__iter_to_alloc_t<InputIterator>>>
+    unordered_map(InputIterator, InputIterator, std::size_t = 0, Hash = Hash(), Pred = Pred(), Allocator = Allocator())
+        -> unordered_map<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>, Hash, Pred, Allocator>;
+
+    template<class Key, class T, class Hash = hash<Key>, class Pred = equal_to<Key>, class Allocator = allocator<pair<const Key, T>>>
+    unordered_map(initializer_list<pair<Key, T>>, std::size_t = 0, Hash = Hash(), Pred = Pred(), Allocator = Allocator())
+        -> unordered_map<Key, T, Hash, Pred, Allocator>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Allocator>
+    unordered_map(InputIterator, InputIterator, std::size_t, Allocator)
+        -> unordered_map<__internal::__iter_key_t<InputIterator>, __internal::__iter_mapped_t<InputIterator>,
+            hash<__internal::__iter_key_t<InputIterator>>, equal_to<__internal::__iter_key_t<InputIterator>>, Allocator>;
+
+    template<class Key, class T, class Allocator>
+    unordered_map(initializer_list<pair<Key, T>>, std::size_t, Allocator) -> unordered_map<Key, T, hash<Key>, equal_to<Key>, Allocator>;
+
+    template<class Key, class T, class Hash, class Pred, class Allocator>
+    bool operator==(const unordered_map<Key, T, Hash, Pred, Allocator>& x, const unordered_map<Key, T, Hash, Pred, Allocator>& y) {
+        return __internal::__hash_table_equal(x, y);
+    }
+
+    template<class Key, class T, class Hash, class Pred, class Allocator>
+    void swap(unordered_map<Key, T, Hash, Pred, Allocator>& x, unordered_map<Key, T, Hash, Pred, Allocator>& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+
+    template<class Key, class T, class Hash, class Pred, class Allocator, class Predicate>
+    typename unordered_map<Key, T, Hash, Pred, Allocator>::size_type erase_if(unordered_map<Key, T, Hash, Pred, Allocator>& c, Predicate pred) {
+        return __internal::__hash_table_erase_if(c, pred);
+    }
+
+    namespace pmr {
+        template<class Key, class T, class Hash = hash<Key>, class Pred = equal_to<Key>>
+        using unordered_map = std::unordered_map<Key, T, Hash, Pred, polymorphic_allocator<pair<const Key, T>>>;
+    }
+}
\ No newline at end of file
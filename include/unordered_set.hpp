@@ -0,0 +1,78 @@
+#pragma once
+
+#include "__hash_table.hpp"
+#include "compare.hpp"
+#include "functional.hpp"
+#include "initializer_list.hpp"
+#include "memory.hpp"
+#include "memory_resource.hpp"
+
+namespace std {
+    /* 22.5.6 Class template unordered_set
+     *
+     * The elements are stored in an open-addressing table (see __internal::__hash_table), so unlike the standard's node-based design:
+     * - Rehashing moves the elements and invalidates references and pointers to them, not just iterators. Inserting without a prior
+     *   reserve can rehash.
+     * - Every slot counts as a bucket of at most one element, so there are no local iterators, bucket() or bucket_size(), and the maximum
+     *   load factor is fixed at 7/8.
+     * - There are no node handles, so extract and the insert overloads taking a node are missing, and merge moves the elements.
+     * - The allocator must use raw pointers. */
+    template<class Key, class Hash = hash<Key>, class Pred = equal_to<Key>, class Allocator = allocator<Key>>
+    class unordered_set : public __internal::__hash_table<__internal::__set_policy<Key>, Hash, Pred, Allocator> {
+    private:
+        using base = __internal::__hash_table<__internal::__set_policy<Key>, Hash, Pred, Allocator>;
+    public:
+        using base::base;
+
+        // Declared here rather than inherited so that class template argument deduction sees an initializer-list constructor.
+        unordered_set(initializer_list<Key> il, typename base::size_type n = 0, const Hash& hf = Hash(), const Pred& eql = Pred(),
+            const Allocator& a = Allocator()) : base(il, n, hf, eql, a) {}
+
+        unordered_set& operator=(initializer_list<Key> il) {
+            base::operator=(il);
+            return *this;
+        }
+    };
+
+    template<class Key, class Hash, class Pred, class Allocator>
+    struct is_trivially_relocatable<unordered_set<Key, Hash, Pred, Allocator>>
+        : bool_constant<is_trivially_relocatable_v<Hash> && is_trivially_relocatable_v<Pred> && is_trivially_relocatable_v<Allocator>> {};
+
+    template<__internal::legacy_input_iterator InputIterator, class Hash = hash<typename iterator_traits<InputIterator>::value_type>,
+        class Pred = equal_to<typename iterator_traits<InputIterator>::value_type>,
+        class Allocator = allocator<typename iterator_traits<InputIterator>::value_type>>
+    unordered_set(InputIterator, InputIterator, std::size_t = 0, Hash = Hash(), Pred = Pred(), Allocator = Allocator())
+        -> unordered_set<typename iterator_traits<InputIterator>::value_type, Hash, Pred, Allocator>;
+
+    template<class T, class Hash = hash<T>, class Pred = equal_to<T>, class Allocator = allocator<T>>
+    unordered_set(initializer_list<T>, std::size_t = 0, Hash = Hash(), Pred = Pred(), Allocator = Allocator())
+        -> unordered_set<T, Hash, Pred, Allocator>;
+
+    template<__internal::legacy_input_iterator InputIterator, class Allocator>
+    unordered_set(InputIterator, InputIterator, std::size_t, Allocator)
+        -> unordered_set<typename iterator_traits<InputIterator>::value_type, hash<typename iterator_traits<InputIterator>::value_type>,
+            equal_to<typename iterator_traits<InputIterator>::value_type>, Allocator>;
+
+    template<class T, class Allocator>
+    unordered_set(initializer_list<T>, std::size_t, Allocator) -> unordered_set<T, hash<T>, equal_to<T>, Allocator>;
+
+    template<class Key, class Hash, class Pred, class Allocator>
+    bool operator==(const unordered_set<Key, Hash, Pred, Allocator>& x, const unordered_set<Key, Hash, Pred, Allocator>& y) {
+        return __internal::__hash_table_equal(x, y);
+    }
+
+    template<class Key, class Hash, class Pred, class Allocator>
+    void swap(unordered_set<Key, Hash, Pred, Allocator>& x, unordered_set<Key, Hash, Pred, Allocator>& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+
+    template<class Key, class Hash, class Pred, class Allocator, class Predicate>
+    typename unordered_set<Key, Hash, Pred, Allocator>::size_type erase_if(unordered_set<Key, Hash, Pred, Allocator>& c, Predicate pred) {
+        return __internal::__hash_table_erase_if(c, pred);
+    }
+
+    namespace pmr {
+        template<class Key, class Hash = hash<Key>, class Pred = equal_to<Key>>
+        using unordered_set = std::unordered_set<Key, Hash, Pred, polymorphic_allocator<Key>>;
+    }
+}
\ No newline at end of file
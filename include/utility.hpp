@@ -41,6 +41,11 @@ namespace std {
     using __internal::forward;
     using __internal::move;
 
+    template<class T>
+    constexpr conditional_t<!is_nothrow_move_constructible_v<T> && is_copy_constructible_v<T>, const T&, T&&> move_if_noexcept(T& x) noexcept {
+        return move(x);
+    }
+
     /* 20.2.5 Function template as_const */
     template<class T>
     constexpr add_const_t<T>& as_const(T& t) noexcept {
@@ -190,8 +195,14 @@ namespace std {
         constexpr explicit(!is_convertible_v<U1, T1> || !is_convertible_v<U2, T2>)
         pair(U1&& x, U2&& y) : first(forward<U1>(x)), second(forward<U2>(y)) {}
 
+        // C++23: makes a pair of references to the members of an lvalue pair.
+        template<class U1, class U2>
+        requires is_constructible_v<T1, U1&> && is_constructible_v<T2, U2&>
+        constexpr explicit(!is_convertible_v<U1&, T1> || !is_convertible_v<U2&, T2>)
+        pair(pair<U1, U2>& p) : first(p.first), second(p.second) {}
+
         template<class U1, class U2>
-        requires is_constructible_v<T1, const T1&> && is_constructible_v<T2, const T2&>
+        requires is_constructible_v<T1, const U1&> && is_constructible_v<T2, const U2&>
         constexpr explicit(!is_convertible_v<const U1&, T1> || !is_convertible_v<const U2&, T2>)
         pair(const pair<U1, U2>& p) : first(p.first), second(p.second) {}
 
@@ -204,7 +215,7 @@ private:
         // This is a helper constructor for the actual public constructor below.
         template<class ...Args1, class ...Args2, std::size_t ...I1, std::size_t ...I2>
         constexpr pair(piecewise_construct_t, index_sequence<I1...>, index_sequence<I2...>, tuple<Args1...>&& first_args, tuple<Args2...>&& second_args)
-            : T1(forward<Args1>(get<I1>(first_args))...), T2(forward<Args2>(get<I2>(second_args))...) {}
+            : first(forward<Args1>(get<I1>(first_args))...), second(forward<Args2>(get<I2>(second_args))...) {}
 public:
         template<class ...Args1, class ...Args2>
         requires is_constructible_v<T1, Args1...> && is_constructible_v<T2, Args2...>
@@ -273,6 +284,18 @@ public:
         return x.swap(y);
     }
 
+    // The members are looked at without cv-qualifiers, so that the elements of maps, whose keys are const, qualify as well.
+    template<class T1, class T2>
+    struct is_trivially_relocatable<pair<T1, T2>>
+        : bool_constant<is_trivially_relocatable_v<remove_cv_t<T1>> && is_trivially_relocatable_v<remove_cv_t<T2>>> {};
+
+    /* C++23: pairs of references, such as the elements of flat_map, have a common reference with the pairs they refer to. */
+    template<class T1, class T2, class U1, class U2, template<class> class TQual, template<class> class UQual>
+    requires requires { typename pair<common_reference_t<TQual<T1>, UQual<U1>>, common_reference_t<TQual<T2>, UQual<U2>>>; }
+    struct basic_common_reference<pair<T1, T2>, pair<U1, U2>, TQual, UQual> {
+        using type = pair<common_reference_t<TQual<T1>, UQual<U1>>, common_reference_t<TQual<T2>, UQual<U2>>>;
+    };
+
     template<class T1, class T2>
     constexpr pair<unwrap_ref_decay_t<T1>, unwrap_ref_decay_t<T2>> make_pair(T1&& x, T2&& y) {
         return pair<unwrap_ref_decay_t<T1>, unwrap_ref_decay_t<T2>>(forward<T1>(x), forward<T2>(y));
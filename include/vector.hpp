@@ -11,630 +11,769 @@
 #include "memory_resource.hpp"
 #include "stdexcept.hpp"
 #include "algorithm.hpp"
+#include "cstring.hpp"
 
 // TODO: Implement vector<bool>.
 
 namespace std {
-    template<class T, class Allocator = allocator<T>>
-    requires is_same_v<typename Allocator::value_type, T>
-    class vector {
-    private:
-        using traits_type = allocator_traits<Allocator>;
-        using rebound_traits = typename allocator_traits<Allocator>::template rebind_traits<T>;
-    public:
-        using value_type = T;
-        using allocator_type = Allocator;
-        using pointer = typename allocator_traits<Allocator>::pointer;
-        using const_pointer = typename allocator_traits<Allocator>::const_pointer;
-        using reference = value_type&;
-        using const_reference = const value_type&;
-        using size_type = typename allocator_traits<Allocator>::size_type;
-        using difference_type = typename allocator_traits<Allocator>::difference_type;
-        using iterator = pointer;
-        using const_iterator = const_pointer;
-        using reverse_iterator = std::reverse_iterator<iterator>;
-        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
-
-        constexpr vector() noexcept(noexcept(Allocator()))
-        requires is_default_constructible_v<Allocator> : vector(Allocator()) {}
+    namespace __internal {
+        /* Whether a container can relocate its elements with memcpy and memmove rather than with a move construction followed by a destruction
+         * each. Besides a trivially relocatable element type, this needs an allocator that doesn't observe constructions and destructions: one
+         * without a destroy member, or polymorphic_allocator, which only customizes construct to hand itself to allocator-aware elements. */
+        template<class T, class Allocator>
+        inline constexpr bool relocates_bitwise = is_trivially_relocatable_v<T> && is_same_v<typename allocator_traits<Allocator>::pointer, T*>
+            && (!requires (Allocator& a, T* p) { a.destroy(p); } || is_same_v<Allocator, pmr::polymorphic_allocator<T>>);
+    }
 
-        constexpr explicit vector(const Allocator& alloc) noexcept : alloc(alloc), len(0), cap(0), buf(rebound_traits::allocate(this->alloc, 0)) {}
+    namespace __internal {
+        /* Holds one T that is constructed and destroyed explicitly, through an allocator. Unlike a byte buffer, it can be used in constant
+         * expressions. */
+        template<class T>
+        union __uninitialized {
+            T value;
+
+            constexpr __uninitialized() noexcept {}
+            constexpr ~__uninitialized() {}
+        };
+
+        /* The part of vector that doesn't depend on where the buffer lives, shared with small_vector. The elements are [buf, buf + len) in a
+         * buffer of cap slots. Derived provides:
+         * - allocate_exactly(n), which makes room for n elements in a container that holds none;
+         * - deallocate_buffer(), which gives up the buffer, leaving the container with whatever an empty one holds;
+         * - owns_heap_buffer(), whether the buffer was obtained from the allocator, and so may be grown in place;
+         * - swap_contents(Derived&), which swaps everything but the allocators;
+         * - length_error_message, thrown when an operation would exceed max_size(). */
+        template<class Derived, class T, class Allocator>
+        class __vector_base {
+        protected:
+            using traits_type = allocator_traits<Allocator>;
+        public:
+            using value_type = T;
+            using allocator_type = Allocator;
+            using pointer = typename allocator_traits<Allocator>::pointer;
+            using const_pointer = typename allocator_traits<Allocator>::const_pointer;
+            using reference = value_type&;
+            using const_reference = const value_type&;
+            using size_type = typename allocator_traits<Allocator>::size_type;
+            using difference_type = typename allocator_traits<Allocator>::difference_type;
+            using iterator = pointer;
+            using const_iterator = const_pointer;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+            template<legacy_input_iterator InputIterator>
+            constexpr void assign(InputIterator first, InputIterator last) {
+                if constexpr (legacy_forward_iterator<InputIterator>) {
+                    const size_type n = static_cast<size_type>(distance(first, last));
+                    if (n > cap) {
+                        // None of the existing elements or storage can be reused.
+                        clear();
+                        derived().deallocate_buffer();
+                        derived().allocate_exactly(n);
+                        for (; first != last; ++first) {
+                            traits_type::construct(alloc, buf + len, *first);
+                            len++;
+                        }
+                        return;
+                    }
 
-        constexpr explicit vector(size_type n, const Allocator& alloc = Allocator())
-        requires requires (Allocator a, T* p) { rebound_traits::construct(a, p); } 
-            : alloc(alloc), len(n), cap(n ? bit_ceil(n) : 0), buf(rebound_traits::allocate(this->alloc, cap)) {
-            for (pointer p = buf; p < p + len; p++) {
-                rebound_traits::construct(this->alloc, p);
-            }
-        }
+                    size_type i = 0;
+                    for (; i < len && first != last; i++, ++first) {
+                        buf[i] = *first;
+                    }
 
-        constexpr vector(size_type n, const T& value, const Allocator& alloc = Allocator())
-        requires requires (Allocator a, T* p, const T& v) { rebound_traits::construct(a, p, v); }
-            : alloc(alloc), len(n), cap(n ? bit_ceil(n) : 0), buf(rebound_traits::allocate(this->alloc, cap)) {
-            for (pointer p = buf; p < p + len; p++) {
-                rebound_traits::construct(this->alloc, p, value);
+                    if (first == last) {
+                        destroy_range(buf + i, buf + len);
+                        len = i;
+                    } else {
+                        for (; first != last; ++first) {
+                            traits_type::construct(alloc, buf + len, *first);
+                            len++;
+                        }
+                    }
+                } else {
+                    clear();
+                    for (; first != last; ++first) {
+                        emplace_back(*first);
+                    }
+                }
             }
-        }
 
-        template<__internal::legacy_input_iterator InputIterator>
-        constexpr vector(InputIterator first, InputIterator last, const Allocator& alloc = Allocator())
-            : alloc(alloc), len(0), cap(0), buf(rebound_traits::allocate(this->alloc, 0)) {
-            if (first == last) [[unlikely]] {
-                return;
-            }
+            constexpr void assign(size_type n, const T& u) {
+                if (n > cap) {
+                    // Constructing the new buffer before freeing the current one keeps `u` alive if it's an element.
+                    Derived temp(n, u, alloc);
+                    derived().swap_contents(temp);
+                    return;
+                }
 
-            if constexpr (__internal::legacy_random_access_iterator<InputIterator>) {
-                cap = static_cast<size_type>(last - first);
-            } else if constexpr (__internal::legacy_forward_iterator<InputIterator>) {
-                for (InputIterator it = first; it != last; it++) {
-                    cap++;
+                for (size_type i = 0; i < min(n, len); i++) {
+                    buf[i] = u;
                 }
-            } else {
-                cap = 1;
-            }
 
-            cap = bit_ceil(cap);
-            rebound_traits::deallocate(this->alloc, buf, 0);
-            buf = rebound_traits::allocate(alloc, cap);
-            
-            while (first != last) {
-                if (len == cap) {
-                    cap *= 2;
-                    pointer new_buf = rebound_traits::allocate(alloc, cap);
-                    for (std::size_t i = 0; i < len; i++) {
-                        rebound_traits::construct(alloc, new_buf + i, buf[i]);
-                        rebound_traits::destroy(alloc, buf + i);
-                    }
-                    rebound_traits::deallocate(alloc, buf);
-                    buf = new_buf;
+                if (n < len) {
+                    destroy_range(buf + n, buf + len);
+                    len = n;
+                } else {
+                    construct_at_end(n - len, u);
                 }
+            }
 
-                rebound_traits::construct(alloc, buf + len, *first);
-                first++;
+            constexpr void assign(initializer_list<T> il) {
+                assign(il.begin(), il.end());
             }
-        }
 
-        constexpr vector(const vector& x) : alloc(allocator_traits<allocator_type>::select_on_container_copy_construction(x.alloc)), len(x.len),
-            cap(x.cap), buf(rebound_traits::allocate(alloc, cap)) {
-            for (std::size_t i = 0; i < len; i++) {
-                rebound_traits::construct(alloc, buf + i, x.buf[i]);
+            constexpr allocator_type get_allocator() const noexcept {
+                return alloc;
             }
-        }
 
-        constexpr vector(vector&& x) noexcept : alloc(move(x).alloc), len(x.len), cap(x.cap), buf(x.buf) {
-            x.buf = nullptr;
-            x.len = 0;
-            x.cap = 0;
-        }   
+            constexpr iterator begin() noexcept {
+                return buf;
+            }
 
-        constexpr vector(const vector& x, const Allocator& alloc) 
-        requires requires (Allocator alloc, T* p, const T& v) {
-            traits_type::construct(alloc, p, declval<T>()); 
-            traits_type::construct(alloc, p, v); 
-        } : alloc(alloc), len(x.len), cap(x.cap), buf(rebound_traits::allocate(this->alloc, cap)) {
-            for (std::size_t i = 0; i < len; i++) {
-                rebound_traits::construct(this->alloc, buf + i, x.buf[i]);
+            constexpr const_iterator begin() const noexcept {
+                return buf;
             }
-        }
 
-        constexpr vector(vector&& x, const Allocator& alloc)
-        requires requires (Allocator alloc, T* p) { traits_type::construct(alloc, p, declval<T>()); }
-            : alloc(alloc), len(x.len), cap(x.cap), buf(x.buf) {
-            if (x.alloc != this->alloc) {
-                buf = rebound_traits::allocate(this->alloc, cap);
-                for (std::size_t i = 0; i < len; i++) {
-                    rebound_traits::construct(this->alloc, buf + i, move(x.buf[i]));
-                }
-            } else {
-                x.buf = nullptr;
-                x.len = 0;
-                x.cap = 0;
+            constexpr iterator end() noexcept {
+                return buf + len;
             }
-        }
 
-        constexpr vector(initializer_list<T> il, const Allocator& alloc = Allocator()) : vector(il.begin(), il.end(), alloc) {}
+            constexpr const_iterator end() const noexcept {
+                return buf + len;
+            }
 
-        constexpr ~vector() {
-            for (pointer p = buf; p != p + len; p++) {
-                rebound_traits::destroy(alloc, p);
+            constexpr reverse_iterator rbegin() noexcept {
+                return reverse_iterator(end());
             }
 
-            rebound_traits::deallocate(alloc, buf, cap);
-        }
+            constexpr const_reverse_iterator rbegin() const noexcept {
+                return const_reverse_iterator(end());
+            }
 
-        constexpr vector& operator=(const vector& x)
-        requires is_copy_assignable_v<T> && requires (Allocator alloc, T* p, const T& v) {
-            allocator_traits<Allocator>::construct(alloc, p, declval<T>()); 
-            allocator_traits<Allocator>::construct(alloc, p, v); 
-        } {
-            ~vector();
-            if constexpr (allocator_traits<Allocator>::propagate_on_container_copy_assignment::value) {
-                alloc = x.alloc;
+            constexpr reverse_iterator rend() noexcept {
+                return reverse_iterator(begin());
             }
 
-            len = x.len;
-            cap = x.cap;
-            buf = rebound_traits::allocate(alloc, cap);
-            for (std::size_t i = 0; i < len; i++) {
-                rebound_traits::construct(alloc, buf + i, x.buf[i]);
+            constexpr const_reverse_iterator rend() const noexcept {
+                return const_reverse_iterator(begin());
             }
 
-            return *this;
-        }
+            constexpr const_iterator cbegin() const noexcept {
+                return begin();
+            }
 
-        constexpr vector& operator=(vector&& x)
-        noexcept(allocator_traits<Allocator>::propagate_on_container_move_assignment::value || allocator_traits<Allocator>::is_always_equal::value)
-        requires allocator_traits<Allocator>::propagate_on_container_move_assignment::value || (is_move_assignable_v<T> && requires (Allocator alloc, T* p) {
-            allocator_traits<Allocator>::construct(alloc, p, declval<T>());
-        }) {
-            ~vector();
-            len = 0;
-            cap = 0;
-            std::swap(len, x.len);
-            std::swap(cap, x.cap);
-
-            if constexpr (allocator_traits<Allocator>::is_always_equal::value) {
-                buf = x.buf;
-                x.buf = rebound_traits::allocate(alloc, 0);
-                std::swap(buf, x.buf);
-                return;
-            } else if constexpr (allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
-                alloc = move(x).alloc;
+            constexpr const_iterator cend() const noexcept {
+                return end();
             }
 
-            allocator_traits<Allocator>::template rebind_traits<T>::allocate(alloc, cap);
-            for (std::size_t i = 0; i < len; i++) {
-                rebound_traits::construct(alloc, buf + i, move(x.buf[i]));
+            constexpr const_reverse_iterator crbegin() const noexcept {
+                return rbegin();
             }
-            x.buf = rebound_traits::allocate(alloc, 0);
 
-            return *this;
-        }
+            constexpr const_reverse_iterator crend() const noexcept {
+                return rend();
+            }
 
-        constexpr vector& operator=(initializer_list<T> il) {
-            return *this = vector(il, alloc);
-        }
+            [[nodiscard]] constexpr bool empty() const noexcept {
+                return len == 0;
+            }
 
-        template<__internal::legacy_input_iterator InputIterator>
-        requires requires (Allocator alloc, T* p, InputIterator it, T& lv) { 
-            traits_type::construct(alloc, p, *it);
-            lv = *it;
-        } && (__internal::legacy_forward_iterator<InputIterator> || requires (Allocator alloc, T* p) {
-            traits_type::construct(alloc, p, declval<T>());
-        })
-        constexpr void assign(InputIterator first, InputIterator last) {
-            if constexpr (__internal::legacy_forward_iterator<InputIterator>) {
-                const typename iterator_traits<InputIterator>::difference_type new_len = [&]() {
-                    if constexpr (__internal::legacy_random_access_iterator<InputIterator>) {
-                        return last - first;
-                    } else {
-                        typename iterator_traits<InputIterator>::difference_type new_cap = 0;
-                        while (first != last) {
-                            new_cap++;
-                            first++;
-                        }
-                        return new_cap;
-                    }
-                }();
+            constexpr size_type size() const noexcept {
+                return len;
+            }
 
-                reserve(new_len);
+            constexpr size_type max_size() const noexcept {
+                return min<size_type>(traits_type::max_size(alloc), static_cast<size_type>(numeric_limits<difference_type>::max()));
+            }
 
-                // For the first stretch of array (new and old segment overlaps)
-                for (std::size_t i = 0; i < min(new_len, len); i++) {
-                    buf[i] = *first;
-                    first++;
-                }
+            constexpr size_type capacity() const noexcept {
+                return cap;
+            }
 
-                if (new_len < len) {
-                    // If there's more old elements than new ones.
-                    for (std::size_t i = new_len; i < len; i++) {
-                        rebound_traits::destroy(alloc, buf + i);
-                    }
-                } else if (new_len > len) {
-                    // If there's more new elements than old ones.
-                    for (std::size_t i = len; i < new_len; i++, first++) {
-                        rebound_traits::construct(alloc, buf + i, *first);
-                    }
+            constexpr void resize(size_type sz) {
+                if (sz <= len) {
+                    destroy_range(buf + sz, buf + len);
+                    len = sz;
+                } else if (sz <= cap) {
+                    construct_at_end(sz - len);
+                } else {
+                    reallocate(next_capacity(sz), len, sz - len, [this](pointer p) { traits_type::construct(alloc, p); });
                 }
+            }
 
-                len = new_len;
-            } else {
-                clear();
-                while (first != last) {
-                    emplace_back(*first);
-                    first++;
+            constexpr void resize(size_type sz, const T& c) {
+                if (sz <= len) {
+                    destroy_range(buf + sz, buf + len);
+                    len = sz;
+                } else if (sz <= cap) {
+                    construct_at_end(sz - len, c);
+                } else {
+                    reallocate(next_capacity(sz), len, sz - len, [this, &c](pointer p) { traits_type::construct(alloc, p, c); });
                 }
             }
-        }
 
-        constexpr void assign(size_type n, const T& u)
-        requires is_copy_assignable_v<T> && requires (Allocator alloc, T* p, const T& v) { traits_type::construct(alloc, p, v); } {
-            resize(n, u);
-        }
-
-        constexpr void assign(initializer_list<T> il) {
-            assign(il.begin(), il.end());
-        }
+            constexpr reference operator[](size_type n) {
+                return buf[n];
+            }
 
-        constexpr allocator_type get_allocator() const noexcept {
-            return alloc;
-        }
+            constexpr const_reference operator[](size_type n) const {
+                return buf[n];
+            }
 
-        constexpr iterator begin() noexcept {
-            return buf;
-        }
+            constexpr reference front() {
+                return *buf;
+            }
 
-        constexpr const_iterator begin() const noexcept {
-            return buf;
-        }
+            constexpr const_reference front() const {
+                return *buf;
+            }
 
-        constexpr iterator end() noexcept {
-            return buf + len;
-        }
+            constexpr reference back() {
+                return buf[len - 1];
+            }
 
-        constexpr const_iterator end() const noexcept {
-            return buf + len;
-        }
+            constexpr const_reference back() const {
+                return buf[len - 1];
+            }
 
-        constexpr reverse_iterator rbegin() noexcept {
-            return reverse_iterator(end());
-        }
+            constexpr T* data() noexcept {
+                return buf;
+            }
 
-        constexpr const_reverse_iterator rbegin() const noexcept {
-            return const_reverse_iterator(end());
-        }
+            constexpr const T* data() const noexcept {
+                return buf;
+            }
 
-        constexpr reverse_iterator rend() noexcept {
-            return reverse_iterator(begin());
-        }
+            template<class ...Args>
+            constexpr reference emplace_back(Args&& ...args) {
+                if (len != cap) [[likely]] {
+                    traits_type::construct(alloc, buf + len, forward<Args>(args)...);
+                    len++;
+                } else {
+                    reallocate(next_capacity(len + 1), len, 1, [&](pointer p) { traits_type::construct(alloc, p, forward<Args>(args)...); });
+                }
 
-        constexpr const_reverse_iterator rend() const noexcept {
-            return const_reverse_iterator(begin());
-        }
+                return buf[len - 1];
+            }
 
-        constexpr const_iterator cbegin() const noexcept {
-            return begin();
-        }
+            constexpr void push_back(const T& x) {
+                emplace_back(x);
+            }
 
-        constexpr const_iterator cend() const noexcept {
-            return end();
-        }
+            constexpr void push_back(T&& x) {
+                emplace_back(move(x));
+            }
 
-        constexpr const_reverse_iterator crbegin() const noexcept {
-            return rbegin();
-        }
+            constexpr void pop_back() {
+                len--;
+                traits_type::destroy(alloc, buf + len);
+            }
 
-        constexpr const_reverse_iterator crend() const noexcept {
-            return rend();
-        }
+            template<class ...Args>
+            constexpr iterator emplace(const_iterator position, Args&& ...args) {
+                const size_type i = static_cast<size_type>(position - cbegin());
+                if (len == cap) {
+                    reallocate(next_capacity(len + 1), i, 1, [&](pointer p) { traits_type::construct(alloc, p, forward<Args>(args)...); });
+                } else if (i == len) {
+                    traits_type::construct(alloc, buf + len, forward<Args>(args)...);
+                    len++;
+                } else {
+                    // The arguments may refer to an element that is about to be moved, so the new element is constructed aside first, through
+                    // the allocator like every other element.
+                    __uninitialized<T> temp;
+                    traits_type::construct(alloc, addressof(temp.value), forward<Args>(args)...);
+                    try {
+                        if (bitwise()) {
+                            insert_bitwise(i, 1, [this, &temp](pointer p) { traits_type::construct(alloc, p, move(temp.value)); });
+                        } else {
+                            open_gap(i, 1);
+                            buf[i] = move(temp.value);
+                        }
+                    } catch (...) {
+                        traits_type::destroy(alloc, addressof(temp.value));
+                        throw;
+                    }
+                    traits_type::destroy(alloc, addressof(temp.value));
+                }
 
-        [[nodiscard]] constexpr bool empty() const noexcept {
-            return len == 0;
-        }
+                return buf + i;
+            }
 
-        constexpr size_type size() const noexcept {
-            return len;
-        }
+            constexpr iterator insert(const_iterator position, const T& x) {
+                return emplace(position, x);
+            }
 
-        constexpr size_type max_size() const noexcept {
-            return numeric_limits<std::size_t>::max();
-        }
+            constexpr iterator insert(const_iterator position, T&& x) {
+                return emplace(position, move(x));
+            }
 
-        constexpr size_type capacity() const noexcept {
-            return cap;
-        }
+            constexpr iterator insert(const_iterator position, size_type n, const T& x) {
+                const size_type i = static_cast<size_type>(position - cbegin());
+                if (n == 0) {
+                    return buf + i;
+                } else if (n > cap - len) {
+                    reallocate(next_capacity(len + n), i, n, [this, &x](pointer p) { traits_type::construct(alloc, p, x); });
+                    return buf + i;
+                }
 
-        constexpr void resize(size_type sz)
-        requires requires (Allocator alloc, T* p) { 
-            traits_type::construct(alloc, p, declval<T>()); 
-            traits_type::construct(alloc, p);
-        } {
-            if (sz < len) {
-                for (std::size_t i = sz; i < len; i++) {
-                    rebound_traits::destroy(alloc, buf + i);
+                // If x is one of the elements being shifted, it ends up n slots further.
+                const T* xp = addressof(x);
+                if (buf + i <= xp && xp < buf + len) {
+                    xp += n;
                 }
 
-                len = sz;
-            } else if (sz == len) {
-                return;
-            } else {
-                const std::size_t new_cap = bit_ceil(sz);
-                T* const new_buf = rebound_traits::allocate(alloc, new_cap);
-                for (std::size_t i = 0; i < len; i++) {
-                    rebound_traits::construct(alloc, new_buf + i, move(buf[i]));
+                if (bitwise()) {
+                    insert_bitwise(i, n, [this, xp](pointer p) { traits_type::construct(alloc, p, *xp); });
+                    return buf + i;
                 }
 
-                for (std::size_t i = len; i < sz; i++) {
-                    rebound_traits::construct(alloc, new_buf + i);
+                const size_type old_len = len;
+                if (old_len - i < n) {
+                    // Part of the new elements go past the current end.
+                    construct_at_end(n - (old_len - i), x);
+                    move_to_end(i, old_len);
+                    for (size_type j = i; j < old_len; j++) {
+                        buf[j] = *xp;
+                    }
+                } else {
+                    open_gap(i, n);
+                    for (size_type j = i; j < i + n; j++) {
+                        buf[j] = *xp;
+                    }
                 }
 
-                for (std::size_t i = 0; i < len; i++) {
-                    rebound_traits::destroy(alloc, buf[i]);
+                return buf + i;
+            }
+
+            template<legacy_input_iterator InputIterator>
+            constexpr iterator insert(const_iterator position, InputIterator first, InputIterator last) {
+                const size_type i = static_cast<size_type>(position - cbegin());
+                if constexpr (legacy_forward_iterator<InputIterator>) {
+                    const size_type n = static_cast<size_type>(distance(first, last));
+                    if (n == 0) {
+                        return buf + i;
+                    } else if (n > cap - len) {
+                        reallocate(next_capacity(len + n), i, n, [this, &first](pointer p) {
+                            traits_type::construct(alloc, p, *first);
+                            ++first;
+                        });
+                        return buf + i;
+                    }
+
+                    if (bitwise()) {
+                        insert_bitwise(i, n, [this, &first](pointer p) {
+                            traits_type::construct(alloc, p, *first);
+                            ++first;
+                        });
+                        return buf + i;
+                    }
+
+                    const size_type old_len = len;
+                    if (old_len - i < n) {
+                        // The new elements past the current end are constructed, and the rest are assigned to the slots vacated by the shift.
+                        InputIterator mid = next(first, static_cast<difference_type>(old_len - i));
+                        for (InputIterator it = mid; it != last; ++it) {
+                            traits_type::construct(alloc, buf + len, *it);
+                            len++;
+                        }
+                        move_to_end(i, old_len);
+                        for (size_type j = i; first != mid; j++, ++first) {
+                            buf[j] = *first;
+                        }
+                    } else {
+                        open_gap(i, n);
+                        for (size_type j = i; first != last; j++, ++first) {
+                            buf[j] = *first;
+                        }
+                    }
+                } else if (first != last) {
+                    // The number of elements is unknown until the input is consumed, so it's buffered first.
+                    Derived temp(first, last, alloc);
+                    insert(position, make_move_iterator(temp.begin()), make_move_iterator(temp.end()));
                 }
 
-                rebound_traits::deallocate(alloc, buf, cap);
-                buf = new_buf;
-                cap = new_cap;
-                len = sz;
+                return buf + i;
             }
-        }
 
-        constexpr void resize(size_type sz, const T& c)
-        requires requires (Allocator alloc, T* p) { traits_type::construct(alloc, p, c); } {
-            if (sz < len) {
-                for (std::size_t i = sz; i < len; i++) {
-                    rebound_traits::destroy(alloc, buf + i);
-                }
+            constexpr iterator insert(const_iterator position, initializer_list<T> il) {
+                return insert(position, il.begin(), il.end());
+            }
 
-                len = sz;
-            } else if (sz == len) {
-                return;
-            } else {
-                const std::size_t new_cap = bit_ceil(sz);
-                T* const new_buf = rebound_traits::allocate(alloc, new_cap);
-                for (std::size_t i = 0; i < len; i++) {
-                    rebound_traits::construct(alloc, new_buf + i, move(buf[i]));
+            constexpr iterator erase(const_iterator position) {
+                return erase(position, next(position));
+            }
+
+            constexpr iterator erase(const_iterator first, const_iterator last) {
+                const iterator write_begin = buf + (first - cbegin());
+                if (first == last) {
+                    return write_begin;
                 }
 
-                for (std::size_t i = len; i < sz; i++) {
-                    rebound_traits::construct(alloc, new_buf + i, c);
+                if (bitwise()) {
+                    const iterator read_begin = buf + (last - cbegin());
+                    destroy_range(write_begin, read_begin);
+                    std::memmove(static_cast<void*>(write_begin), static_cast<const void*>(read_begin), (end() - read_begin) * sizeof(T));
+                    len -= static_cast<size_type>(read_begin - write_begin);
+                    return write_begin;
                 }
 
-                for (std::size_t i = 0; i < len; i++) {
-                    rebound_traits::destroy(alloc, buf[i]);
+                iterator write_it = write_begin;
+                for (iterator read_it = buf + (last - cbegin()); read_it != end(); ++read_it, ++write_it) {
+                    *write_it = move(*read_it);
                 }
 
-                rebound_traits::deallocate(alloc, buf, cap);
-                buf = new_buf;
-                cap = new_cap;
-                len = sz;
+                destroy_range(write_it, end());
+                len = static_cast<size_type>(write_it - buf);
+                return write_begin;
             }
-        }
 
-        constexpr void reserve(size_type n)
-        requires requires (Allocator alloc, T* p) { traits_type::construct(alloc, p, declval<T>()); } {
-            if (cap >= n) {
-                return;
-            } else if (n > max_size()) [[unlikely]] {
-                throw length_error("Invalid argument to vector::reserve.");
+            constexpr void clear() noexcept {
+                destroy_range(buf, buf + len);
+                len = 0;
             }
 
-            const size_type new_cap = bit_ceil(n);
-            T* const new_buf = rebound_traits::allocate(alloc, new_cap);
-            for (std::size_t i = 0; i < len; i++) {
-                rebound_traits::construct(alloc, new_buf + i, move(buf[i]));
-                rebound_traits::destroy(alloc, buf[i]);
-            }
+        protected:
+            [[no_unique_address]] Allocator alloc;
+            size_type len;
+            size_type cap;
+            pointer buf;
 
-            rebound_traits::deallocate(alloc, buf, cap);
-            buf = new_buf;
-            cap = new_cap;
-        }
+            static constexpr bool relocates_bitwise = __internal::relocates_bitwise<T, Allocator>;
 
-        constexpr void shrink_to_fit()
-        requires requires (Allocator alloc, T* p) { traits_type::construct(alloc, p, declval<T>()); } {
-            if (cap == len) {
-                return;
-            }
+            constexpr __vector_base(const Allocator& alloc, pointer buf, size_type cap) noexcept : alloc(alloc), len(0), cap(cap), buf(buf) {}
+            constexpr __vector_base(Allocator&& alloc, pointer buf, size_type cap) noexcept : alloc(move(alloc)), len(0), cap(cap), buf(buf) {}
 
-            T* const new_buf = rebound_traits::allocate(alloc, len);
-            for (std::size_t i = 0; i < len; i++) {
-                rebound_traits::construct(alloc, new_buf + i, move(buf[i]));
-                rebound_traits::destroy(alloc, buf[i]);
+            constexpr Derived& derived() noexcept {
+                return static_cast<Derived&>(*this);
             }
 
-            rebound_traits::deallocate(alloc, buf, cap);
-            buf = new_buf;
-            cap = len;
-        }
+            // Whether the elements are moved with memcpy and memmove. Constant evaluation can't, so it moves them one by one.
+            constexpr bool bitwise() const noexcept {
+                return relocates_bitwise && !is_constant_evaluated();
+            }
 
-        constexpr reference operator[](size_type n) {
-            return buf[n];
-        }
+            /* Returns the capacity to grow to when `new_size` elements don't fit. The capacity at least doubles on every reallocation, so that
+             * any sequence of insertions at the end costs amortized constant time per element. */
+            constexpr size_type next_capacity(size_type new_size) const {
+                const size_type max_cap = max_size();
+                if (new_size > max_cap) [[unlikely]] {
+                    throw length_error(Derived::length_error_message);
+                }
 
-        constexpr const_reference operator[](size_type n) const {
-            return buf[n];
-        }
+                return cap >= max_cap / 2 ? max_cap : max(2 * cap, new_size);
+            }
 
-        constexpr const_reference at(size_type n) const {
-            if (n < 0 || n >= len) [[unlikely]] {
-                throw out_of_range("Invalid argument to vector::at.");
-            } else {
-                return buf[n];
+            constexpr void destroy_range(pointer first, pointer last) noexcept {
+                for (; first != last; ++first) {
+                    traits_type::destroy(alloc, first);
+                }
             }
-        }
 
-        constexpr reference at(size_type n) {
-            if (n < 0 || n >= len) [[unlikely]] {
-                throw out_of_range("Invalid argument to vector::at.");
-            } else {
-                return buf[n];
+            /* Constructs n elements from args after the last one, which must fit in the capacity. The length is bumped after every element, so
+             * that the container stays consistent if a constructor throws. */
+            template<class ...Args>
+            constexpr void construct_at_end(size_type n, const Args& ...args) {
+                for (size_type i = 0; i < n; i++) {
+                    traits_type::construct(alloc, buf + len, args...);
+                    len++;
+                }
             }
-        }
 
-        constexpr reference front() {
-            return *buf;
-        }
+            /* Moves the elements to a new buffer of capacity new_cap, leaving a gap of n slots at index i, and fills the gap by calling
+             * construct_new on every slot in order. The new elements are constructed before any element is moved, as their arguments may refer
+             * to elements of the container.
+             *
+             * If anything throws, the new buffer is discarded and the container is left untouched, unless the elements are moved with a
+             * throwing move constructor, which only happens if they can't be copied. When relocates_bitwise holds, the elements are moved with
+             * memcpy.
+             *
+             * When the gap is at the end of a buffer obtained from the allocator, the allocator is first asked to grow it in place, which saves
+             * moving the elements altogether. Otherwise the new buffer is requested with allocate_at_least, so that the capacity covers whatever
+             * the allocator rounds up to. */
+            template<class F>
+            constexpr void reallocate(size_type new_cap, size_type i, size_type n, F&& construct_new) {
+                if (i == len && new_cap > cap && derived().owns_heap_buffer() && traits_type::try_expand(alloc, buf, cap, new_cap)) {
+                    cap = new_cap;
+                    for (size_type j = 0; j < n; j++) {
+                        construct_new(buf + len);
+                        len++;
+                    }
+                    return;
+                }
 
-        constexpr const_reference front() const {
-            return *buf;
-        }
+                const allocation_result<pointer, size_type> allocation = traits_type::allocate_at_least(alloc, new_cap);
+                const pointer new_buf = allocation.ptr;
+                const size_type allocated_cap = allocation.count;
+                const bool bitwise = this->bitwise();
+                size_type constructed = 0, moved_front = 0, moved_back = 0;
+                try {
+                    for (; constructed < n; constructed++) {
+                        construct_new(new_buf + i + constructed);
+                    }
 
-        constexpr reference back() {
-            return buf[len - 1];
-        }
+                    if (!bitwise) {
+                        for (; moved_front < i; moved_front++) {
+                            traits_type::construct(alloc, new_buf + moved_front, move_if_noexcept(buf[moved_front]));
+                        }
 
-        constexpr const_reference back() const {
-            return buf[len - 1];
-        }
+                        for (; moved_back < len - i; moved_back++) {
+                            traits_type::construct(alloc, new_buf + i + n + moved_back, move_if_noexcept(buf[i + moved_back]));
+                        }
+                    }
+                } catch (...) {
+                    destroy_range(new_buf, new_buf + moved_front);
+                    destroy_range(new_buf + i, new_buf + i + constructed);
+                    destroy_range(new_buf + i + n, new_buf + i + n + moved_back);
+                    traits_type::deallocate(alloc, new_buf, allocated_cap);
+                    throw;
+                }
 
-        constexpr T* data() noexcept {
-            return buf;
-        }
+                if (bitwise) {
+                    // The elements are copied over as bytes, and their old copies are given up without running any destructor.
+                    if (len != 0) {
+                        std::memcpy(static_cast<void*>(new_buf), static_cast<const void*>(buf), i * sizeof(T));
+                        std::memcpy(static_cast<void*>(new_buf + i + n), static_cast<const void*>(buf + i), (len - i) * sizeof(T));
+                    }
+                } else {
+                    destroy_range(buf, buf + len);
+                }
 
-        constexpr const T* data() const noexcept {
-            return buf;
-        }
+                derived().deallocate_buffer();
+                buf = new_buf;
+                cap = allocated_cap;
+                len += n;
+            }
 
-        template<class ...Args>
-        requires requires (Allocator& alloc, T* p, Args&& ...args) { 
-            traits_type::construct(alloc, p, forward<Args>(args)...);
-            traits_type::construct(alloc, p, declval<T>()); 
-        }
-        constexpr reference emplace_back(Args&& ...args) {
-            reserve(len + 1);
-            rebound_traits::construct(alloc, buf + len, forward<Args>(args)...);
-            len++;
-            return buf[len - 1];
-        }
+            /* The counterpart of open_gap for when relocates_bitwise holds: moves the elements from index i onwards n slots towards the end with
+             * a memmove, then fills the gap by calling construct_new on every slot in order. If a construction throws, the elements are moved
+             * back. */
+            template<class F>
+            constexpr void insert_bitwise(size_type i, size_type n, F&& construct_new) {
+                const size_type tail_bytes = (len - i) * sizeof(T);
+                std::memmove(static_cast<void*>(buf + i + n), static_cast<const void*>(buf + i), tail_bytes);
+                size_type constructed = 0;
+                try {
+                    for (; constructed < n; constructed++) {
+                        construct_new(buf + i + constructed);
+                    }
+                } catch (...) {
+                    destroy_range(buf + i, buf + i + constructed);
+                    std::memmove(static_cast<void*>(buf + i), static_cast<const void*>(buf + i + n), tail_bytes);
+                    throw;
+                }
+                len += n;
+            }
 
-        constexpr void push_back(const T& x) {
-            resize(len + 1, x);
-        }
+            /* Shifts the elements from index i onwards n slots towards the end, where n is at most the number of shifted elements and the result
+             * fits in the capacity. The slots [i, i + n) are left holding moved-from elements. */
+            constexpr void open_gap(size_type i, size_type n) {
+                const size_type old_len = len;
+                move_to_end(old_len - n, old_len);
+                for (size_type j = old_len - n; j > i; j--) {
+                    buf[j - 1 + n] = move(buf[j - 1]);
+                }
+            }
+
+            /* Move-constructs the elements [first, last) after the last element, leaving them moved-from. */
+            constexpr void move_to_end(size_type first, size_type last) {
+                for (size_type j = first; j < last; j++) {
+                    traits_type::construct(alloc, buf + len, move(buf[j]));
+                    len++;
+                }
+            }
+        };
+    }
+
+    template<class T, class Allocator = allocator<T>>
+    requires is_same_v<typename Allocator::value_type, T>
+    class vector : public __internal::__vector_base<vector<T, Allocator>, T, Allocator> {
+    private:
+        using base = __internal::__vector_base<vector<T, Allocator>, T, Allocator>;
+        friend base;
+
+        using typename base::traits_type;
+        using base::alloc;
+        using base::len;
+        using base::cap;
+        using base::buf;
+    public:
+        using typename base::value_type;
+        using typename base::allocator_type;
+        using typename base::pointer;
+        using typename base::const_pointer;
+        using typename base::reference;
+        using typename base::const_reference;
+        using typename base::size_type;
+        using typename base::difference_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+        using typename base::reverse_iterator;
+        using typename base::const_reverse_iterator;
 
-        constexpr void push_back(T&& x) {
-            reserve(len + 1);
-            rebound_traits::construct(alloc, buf + len, move(x));
-            len++;
+        constexpr vector() noexcept(noexcept(Allocator()))
+        requires is_default_constructible_v<Allocator> : vector(Allocator()) {}
+
+        // An empty vector doesn't own a buffer.
+        constexpr explicit vector(const Allocator& alloc) noexcept : base(alloc, nullptr, 0) {}
+
+        /* The constructors below delegate to the one above first, so that the destructor cleans up if constructing an element throws. */
+        constexpr explicit vector(size_type n, const Allocator& alloc = Allocator())
+        requires requires (Allocator a, T* p) { traits_type::construct(a, p); } : vector(alloc) {
+            if (n != 0) {
+                allocate_exactly(n);
+                this->construct_at_end(n);
+            }
         }
 
-        constexpr void pop_back() {
-            len--;
-            rebound_traits::destroy(alloc, buf + len);
+        constexpr vector(size_type n, const T& value, const Allocator& alloc = Allocator())
+        requires requires (Allocator a, T* p, const T& v) { traits_type::construct(a, p, v); } : vector(alloc) {
+            if (n != 0) {
+                allocate_exactly(n);
+                this->construct_at_end(n, value);
+            }
         }
 
-        template<class ...Args>
-        constexpr iterator emplace(const_iterator position, Args&& ...args) 
-        requires is_move_assignable_v<T> && requires (Allocator alloc, T* p, Args&& ...args) { 
-            traits_type::construct(alloc, p, declval<T>()); 
-            traits_type::construct(alloc, p, forward<Args>(args)...);
-        } {
-            reserve(len + 1);
-            if (len == 0) {
-                traits_type::construct(alloc, buf, forward<Args>(args)...);
-                len++;
-                return end();
+        template<__internal::legacy_input_iterator InputIterator>
+        constexpr vector(InputIterator first, InputIterator last, const Allocator& alloc = Allocator()) : vector(alloc) {
+            if constexpr (__internal::legacy_forward_iterator<InputIterator>) {
+                if (const size_type n = static_cast<size_type>(distance(first, last)); n != 0) {
+                    allocate_exactly(n);
+                    for (; first != last; ++first) {
+                        traits_type::construct(this->alloc, buf + len, *first);
+                        len++;
+                    }
+                }
             } else {
-                traits_type::construct(alloc, buf + len, move(buf[len - 1]));
-                iterator it = buf + len - 1;
-                while (it != position) {
-                    *it = move(*(--it));
+                for (; first != last; ++first) {
+                    this->emplace_back(*first);
                 }
-
-                *it = T(forward<Args>(args)...);
-                len++;
-                return next(it);
             }
         }
 
-        constexpr iterator insert(const_iterator position, const T& x)
-        requires is_copy_assignable_v<T> && requires (Allocator alloc, T* p, const T& v) { traits_type::construct(alloc, p, v); } {
-            return insert(position, 1, x);
+        constexpr vector(const vector& x) : vector(x, traits_type::select_on_container_copy_construction(x.alloc)) {}
+
+        constexpr vector(vector&& x) noexcept : base(move(x.alloc), x.buf, x.cap) {
+            len = x.len;
+            x.buf = nullptr;
+            x.len = 0;
+            x.cap = 0;
         }
 
-        constexpr iterator insert(const_iterator position, T&& x) 
-        requires is_move_assignable_v<T> && requires (Allocator alloc, T* p) { traits_type::construct(alloc, p, declval<T>()); } {
-            reserve(len + 1);
-            if (len == 0) {
-                traits_type::construct(alloc, buf, move(x));
-                len++;
-                return end();
-            } else {
-                traits_type::construct(alloc, buf + len, move(buf[len - 1]));
-                iterator it = buf + len - 1;
-                while (it != position) {
-                    *it = move(*(--it));
+        constexpr vector(const vector& x, const Allocator& alloc) : vector(alloc) {
+            if (x.len != 0) {
+                allocate_exactly(x.len);
+                for (size_type i = 0; i < x.len; i++) {
+                    traits_type::construct(this->alloc, buf + len, x.buf[i]);
+                    len++;
                 }
-
-                *it = move(x);
-                len++;
-                return next(it);
             }
         }
 
-        constexpr iterator insert(const_iterator position, size_type n, const T& x)
-        requires is_copy_assignable_v<T> && requires (Allocator alloc, T* p, const T& v) { traits_type::construct(alloc, p, v); } {
-            reserve(len + n);
-            if (len == 0) {
-                for (std::size_t i = 0; i < n; i++) {
-                    traits_type::construct(alloc, buf + i, x);
+        constexpr vector(vector&& x, const Allocator& alloc) : vector(alloc) {
+            if (traits_type::is_always_equal::value || x.alloc == this->alloc) {
+                swap_contents(x);
+            } else if (x.len != 0) {
+                allocate_exactly(x.len);
+                for (size_type i = 0; i < x.len; i++) {
+                    traits_type::construct(this->alloc, buf + len, move(x.buf[i]));
                     len++;
                 }
+            }
+        }
 
-                return end();
-            } else {
-                traits_type::construct(alloc, buf + len + n - 1, buf[buf + len - 1]);
-                iterator it = buf + len + n - 1;
-                while (it != position + n - 1) {
-                    *it = *(it - n);
-                    it--;
-                }
+        constexpr vector(initializer_list<T> il, const Allocator& alloc = Allocator()) : vector(il.begin(), il.end(), alloc) {}
 
-                while (it != position) {
-                    *it = x;
-                    it--;
-                }
+        constexpr ~vector() {
+            this->destroy_range(buf, buf + len);
+            deallocate_buffer();
+        }
 
-                len += n;
-                return it + n;
+        constexpr vector& operator=(const vector& x) {
+            if (this == addressof(x)) {
+                return *this;
             }
-        }
 
-        template<__internal::legacy_input_iterator InputIterator>
-        requires requires (Allocator alloc, T* p, InputIterator i) { 
-            traits_type::construct(alloc, p, *i);
-            traits_type::construct(alloc, p, declval<T>());
-        } && is_move_assignable_v<T> && is_move_constructible_v<T> && is_swappable_v<T>
-        constexpr iterator insert(const_iterator position, InputIterator first, InputIterator last) {
-            const iterator old_end = end();
-            while (first != last) {
-                emplace_back(*first);
-                first++;
-            }
-            
-            rotate(position, old_end, end());
-            return position;
+            if constexpr (traits_type::propagate_on_container_copy_assignment::value) {
+                if (alloc != x.alloc) {
+                    // The current buffer can only be freed by the current allocator.
+                    this->clear();
+                    deallocate_buffer();
+                }
+                alloc = x.alloc;
+            }
+
+            this->assign(x.buf, x.buf + x.len);
+            return *this;
         }
 
-        constexpr iterator insert(const_iterator position, initializer_list<T> il) {
-            return insert(position, il.begin(), il.end());
+        constexpr vector& operator=(vector&& x)
+        noexcept(allocator_traits<Allocator>::propagate_on_container_move_assignment::value || allocator_traits<Allocator>::is_always_equal::value) {
+            if (this == addressof(x)) {
+                return *this;
+            }
+
+            if (traits_type::propagate_on_container_move_assignment::value || traits_type::is_always_equal::value || alloc == x.alloc) {
+                this->clear();
+                deallocate_buffer();
+                if constexpr (traits_type::propagate_on_container_move_assignment::value) {
+                    alloc = move(x.alloc);
+                }
+                swap_contents(x);
+            } else {
+                // The buffer of x can't be adopted, as it's owned by an allocator that doesn't compare equal to ours.
+                this->assign(make_move_iterator(x.begin()), make_move_iterator(x.end()));
+                x.clear();
+            }
+
+            return *this;
         }
 
-        constexpr iterator erase(const_iterator position)
-        requires is_move_assignable_v<T> {
-            return erase(position, next(position));
+        constexpr vector& operator=(initializer_list<T> il) {
+            this->assign(il.begin(), il.end());
+            return *this;
         }
 
-        constexpr iterator erase(const_iterator first, const_iterator last)
-        requires is_move_assignable_v<T> {
-            if (first == last) {
-                return last;
+        constexpr void reserve(size_type n) {
+            if (n <= cap) {
+                return;
+            } else if (n > this->max_size()) [[unlikely]] {
+                throw length_error("Invalid argument to vector::reserve.");
             }
 
-            iterator overwrite_it = first;
-            iterator write_it = last;
+            this->reallocate(n, len, 0, [](pointer) {});
+        }
 
-            while (write_it != end() && overwrite_it != last) {
-                *overwrite_it = move(*write_it);
-                write_it++;
-                overwrite_it++;
-                len--;
+        constexpr void shrink_to_fit() {
+            if (cap == len) {
+                return;
+            } else if (len == 0) {
+                deallocate_buffer();
+                return;
             }
 
-            while (write_it != end()) {
-                *overwrite_it = move(*write_it);
-                write_it++;
-                overwrite_it++;
+            this->reallocate(len, len, 0, [](pointer) {});
+        }
+
+        constexpr const_reference at(size_type n) const {
+            if (n >= len) [[unlikely]] {
+                throw out_of_range("Invalid argument to vector::at.");
+            } else {
+                return buf[n];
             }
+        }
 
-            return first;
+        constexpr reference at(size_type n) {
+            if (n >= len) [[unlikely]] {
+                throw out_of_range("Invalid argument to vector::at.");
+            } else {
+                return buf[n];
+            }
         }
 
         constexpr void swap(vector& other)
         noexcept(traits_type::propagate_on_container_swap::value || traits_type::is_always_equal::value) {
-            std::swap(len, other.len);
-            std::swap(cap, other.cap);
-            std::swap(buf, other.buf);
+            swap_contents(other);
 
             if constexpr (traits_type::propagate_on_container_swap::value) {
                 using std::swap;
@@ -642,20 +781,42 @@ namespace std {
             }
         }
 
-        constexpr void clear() noexcept {
-            for (std::size_t i = 0; i < len; i++) {
-                rebound_traits::destroy(alloc, buf + i);
+    private:
+        static constexpr const char* length_error_message = "vector exceeds its maximum size.";
+
+        /* Allocates a buffer of exactly n elements for a vector that doesn't hold one. */
+        constexpr void allocate_exactly(size_type n) {
+            if (n > this->max_size()) [[unlikely]] {
+                throw length_error(length_error_message);
             }
-            len = 0;
+
+            buf = traits_type::allocate(alloc, n);
+            cap = n;
         }
 
-    private:
-        [[no_unique_address]] Allocator alloc;
-        size_type len;
-        size_type cap;
-        pointer buf;
+        constexpr void deallocate_buffer() noexcept {
+            if (buf != nullptr) {
+                traits_type::deallocate(alloc, buf, cap);
+                buf = nullptr;
+                cap = 0;
+            }
+        }
+
+        constexpr bool owns_heap_buffer() const noexcept {
+            return buf != nullptr;
+        }
+
+        /* Swaps everything but the allocators. */
+        constexpr void swap_contents(vector& other) noexcept {
+            std::swap(len, other.len);
+            std::swap(cap, other.cap);
+            std::swap(buf, other.buf);
+        }
     };
 
+    template<class T, class Allocator>
+    struct is_trivially_relocatable<vector<T, Allocator>> : is_trivially_relocatable<Allocator> {};
+
     template<__internal::legacy_input_iterator InputIterator, class Allocator = allocator<typename iterator_traits<InputIterator>::value_type>>
     vector(InputIterator, InputIterator, Allocator = Allocator()) -> vector<typename iterator_traits<InputIterator>::value_type, Allocator>;
 
@@ -695,7 +856,7 @@ namespace std {
     }
 
     template<class T, class Allocator, class Predicate>
-    requires requires (const T& elem) { { pred(elem) } -> convertible_to<bool>; }
+    requires requires (Predicate pred, const T& elem) { { pred(elem) } -> convertible_to<bool>; }
     constexpr typename vector<T, Allocator>::size_type erase_if(vector<T, Allocator>& c, Predicate pred) {
         const typename vector<T, Allocator>::iterator it = remove_if(c.begin(), c.end(), pred);
         const typename vector<T, Allocator>::size_type r = distance(it, c.end());
@@ -0,0 +1,53 @@
+#include "sched.h"
+#include "sys/syscall.h"
+#include "unistd.h"
+
+#include "atomic.hpp"
+#include "cstdint.hpp"
+#include "climits.hpp"
+
+#if defined(__APPLE__)
+// From the private <sys/ulock.h>, which is what libc++ waits on as well.
+extern "C" int __ulock_wait(std::uint32_t operation, void* addr, std::uint64_t value, std::uint32_t timeout);
+extern "C" int __ulock_wake(std::uint32_t operation, void* addr, std::uint64_t wake_value);
+#endif
+
+namespace std::__internal {
+    static constexpr std::size_t wait_slot_count = 256;
+
+    // Trivially constructed and destroyed, so the slots stay usable by atomics that are waited on during static destruction.
+    static __wait_slot wait_slots[wait_slot_count];
+
+    __wait_slot& __wait_slot_for(const volatile void* addr) noexcept {
+        // Objects closer than a cache line apart would usually be notified together anyway.
+        std::uintptr_t key = reinterpret_cast<std::uintptr_t>(addr) >> 6;
+        key ^= key >> 17;
+        return wait_slots[key % wait_slot_count];
+    }
+
+    void __wait_on_slot(__wait_slot& slot, std::uint32_t epoch) noexcept {
+#if defined(__linux__) && defined(SYS_futex)
+        // FUTEX_WAIT | FUTEX_PRIVATE_FLAG, from <linux/futex.h>.
+        constexpr int futex_wait_private = 0 | 128;
+        syscall(SYS_futex, &slot.epoch, futex_wait_private, epoch, nullptr, nullptr, 0);
+#elif defined(__APPLE__)
+        // UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, with no timeout.
+        __ulock_wait(1 | 0x01000000, &slot.epoch, epoch, 0);
+#else
+        if (__atomic_load_n(&slot.epoch, __ATOMIC_SEQ_CST) == epoch) {
+            sched_yield();
+        }
+#endif
+    }
+
+    void __wake_slot([[maybe_unused]] __wait_slot& slot) noexcept {
+#if defined(__linux__) && defined(SYS_futex)
+        // FUTEX_WAKE | FUTEX_PRIVATE_FLAG.
+        constexpr int futex_wake_private = 1 | 128;
+        syscall(SYS_futex, &slot.epoch, futex_wake_private, INT_MAX, nullptr, nullptr, 0);
+#elif defined(__APPLE__)
+        // UL_COMPARE_AND_WAIT | ULF_WAKE_ALL | ULF_NO_ERRNO.
+        __ulock_wake(1 | 0x100 | 0x01000000, &slot.epoch, 0);
+#endif
+    }
+}
\ No newline at end of file
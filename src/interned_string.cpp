@@ -0,0 +1,131 @@
+#include "interned_string.hpp"
+#include "shared_mutex.hpp"
+#include "mutex.hpp"
+#include "new.hpp"
+#include "cstddef.hpp"
+
+namespace std {
+    namespace __internal {
+        constinit const __interned_entry __empty_interned_entry = { 0, 0, "" };
+
+        struct interned_hasher : hash<__enabled_hash_t> {
+            // The empty string hashes to 0 so that the constant empty entry above agrees with the pool.
+            std::size_t operator()(string_view s) const noexcept {
+                return s.empty() ? 0 : hash_bytes(s.data(), s.size());
+            }
+        };
+
+        /* One shard of the pool: an open addressing table of entries with linear probing, kept at most half full, and an arena the entries are
+         * carved out of. */
+        struct intern_shard {
+            static constexpr std::size_t arena_chunk = 64 * 1024;
+
+            const __interned_entry* find(string_view s, std::size_t h) const noexcept {
+                if (slots == nullptr) {
+                    return nullptr;
+                }
+                for (std::size_t i = h & mask; slots[i] != nullptr; i = (i + 1) & mask) {
+                    if (slots[i]->hash == h && string_view(slots[i]->data, slots[i]->length) == s) {
+                        return slots[i];
+                    }
+                }
+                return nullptr;
+            }
+
+            const __interned_entry* insert(string_view s, std::size_t h) {
+                if (2 * (count + 1) > capacity()) {
+                    grow();
+                }
+
+                const std::size_t bytes = sizeof(__interned_entry) + s.size() + 1;
+                char* storage;
+                if (bytes > arena_chunk / 4) {
+                    storage = static_cast<char*>(::operator new(bytes));
+                } else {
+                    if (static_cast<std::size_t>(end - cursor) < bytes) {
+                        cursor = static_cast<char*>(::operator new(arena_chunk));
+                        end = cursor + arena_chunk;
+                    }
+                    storage = cursor;
+                    cursor += (bytes + alignof(__interned_entry) - 1) / alignof(__interned_entry) * alignof(__interned_entry);
+                    if (cursor > end) {
+                        cursor = end;
+                    }
+                }
+
+                char* const data = storage + sizeof(__interned_entry);
+                __builtin_memcpy(data, s.data(), s.size());
+                data[s.size()] = '\0';
+                const __interned_entry* const e = ::new (storage) __interned_entry{ h, s.size(), data };
+
+                std::size_t i = h & mask;
+                while (slots[i] != nullptr) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = e;
+                count++;
+                return e;
+            }
+
+            std::size_t capacity() const noexcept {
+                return slots != nullptr ? mask + 1 : 0;
+            }
+
+            void grow() {
+                const std::size_t new_capacity = capacity() != 0 ? 2 * capacity() : 64;
+                const __interned_entry** const new_slots = new const __interned_entry*[new_capacity]();
+                for (std::size_t i = 0; i < capacity(); i++) {
+                    if (slots[i] != nullptr) {
+                        std::size_t j = slots[i]->hash & (new_capacity - 1);
+                        while (new_slots[j] != nullptr) {
+                            j = (j + 1) & (new_capacity - 1);
+                        }
+                        new_slots[j] = slots[i];
+                    }
+                }
+                delete[] slots;
+                slots = new_slots;
+                mask = new_capacity - 1;
+            }
+
+            std::shared_mutex mtx;
+            const __interned_entry** slots = nullptr;
+            std::size_t mask = 0;
+            std::size_t count = 0;
+            char* cursor = nullptr;
+            char* end = nullptr;
+        };
+
+        // The shards are picked by the top bits of the hash, and the slots within a shard by the bottom ones.
+        static constexpr std::size_t intern_shard_bits = 4;
+
+        /* The shards are allocated on first use and never destroyed, so that strings can still be interned from static constructors in other
+         * translation units and from static destructors, where a static array of shared_mutex might not be constructed yet or already gone. */
+        static intern_shard* intern_shards() {
+            static intern_shard* const shards = new intern_shard[std::size_t(1) << intern_shard_bits];
+            return shards;
+        }
+
+        const __interned_entry* __intern(string_view s) {
+            if (s.empty()) {
+                return &__empty_interned_entry;
+            }
+
+            const std::size_t h = interned_hasher()(s);
+            intern_shard& shard = intern_shards()[h >> (8 * sizeof(std::size_t) - intern_shard_bits)];
+            {
+                const shared_lock<std::shared_mutex> lock(shard.mtx);
+                if (const __interned_entry* const e = shard.find(s, h); e != nullptr) {
+                    return e;
+                }
+            }
+
+            // Another thread may have added s between the two locks.
+            const unique_lock<std::shared_mutex> lock(shard.mtx);
+            if (const __interned_entry* const e = shard.find(s, h); e != nullptr) {
+                return e;
+            }
+            return shard.insert(s, h);
+        }
+    }
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "cstddef.hpp"
+#include "cstdlib.hpp"
 #include "type_traits.hpp"
 
 #include "memory/shared_ptr.hpp"
@@ -24,41 +25,90 @@ namespace std {
     const char* bad_weak_ptr::what() const noexcept { return "std::bad_weak_ptr"; }
 
     namespace __internal {
-        __ctrl::__ctrl() noexcept {
-            __atomic_store_n(&weak_count, 1, __ATOMIC_SEQ_CST);
-            __atomic_store_n(&shared_count, 1, __ATOMIC_SEQ_CST);
-        }
-
         void* __ctrl::get_deleter() const noexcept { return nullptr; }
 
-        long __ctrl::get_weak_count() const noexcept { return __atomic_load_n(&weak_count, __ATOMIC_SEQ_CST); }
-        long __ctrl::get_shared_count() const noexcept { return __atomic_load_n(&shared_count, __ATOMIC_SEQ_CST); }
+        void __ctrl::count_overflow() noexcept { abort(); }
+
+        void __ctrl::decrement_shared_count() noexcept {
+            // If this is the only reference of any kind, nobody else can observe or create a reference to the block, so it can be torn down
+            // without any read-modify-write. The acquire load still orders the teardown after the releases made by former owners.
+            if (__atomic_load_n(&counts, __ATOMIC_ACQUIRE) == (shared_one | weak_one)) {
+                delete_content();
+                delete_block();
+                return;
+            }
 
-        long __ctrl::decrement_shared_count() noexcept {
-            if (is_null()) return 0;
+            if ((__atomic_fetch_sub(&counts, shared_one, __ATOMIC_ACQ_REL) & shared_mask) == 1) {
+                delete_content();
+                decrement_weak_count();
+            }
+        }
+
+        void __ctrl::decrement_weak_count() noexcept {
+            if ((__atomic_fetch_sub(&counts, weak_one, __ATOMIC_ACQ_REL) & weak_mask) == weak_one) {
+                delete_block();
+            }
+        }
 
-            const long count = __atomic_sub_fetch(&shared_count, 1, __ATOMIC_SEQ_CST);
-            if (!count) {
+        void __ctrl::add_shared_count(long delta) noexcept {
+            const unsigned long long c = __atomic_fetch_add(&counts, static_cast<unsigned long long>(delta), __ATOMIC_ACQ_REL);
+            if (delta > 0) {
+                check_shared_increment(c, static_cast<unsigned long long>(delta));
+            } else if (((c + static_cast<unsigned long long>(delta)) & shared_mask) == 0) {
                 delete_content();
                 decrement_weak_count();
             }
+        }
 
-            return count;
+        bool __ctrl::try_increment_shared_count() noexcept {
+            unsigned long long curr = __atomic_load_n(&counts, __ATOMIC_RELAXED);
+            do {
+                if ((curr & shared_mask) == 0) {
+                    return false;
+                }
+                check_shared_increment(curr, shared_one);
+            } while (!__atomic_compare_exchange_n(&counts, &curr, curr + shared_one, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+            return true;
         }
 
-        long __ctrl::decrement_weak_count() noexcept {
-            const long count = __atomic_sub_fetch(&weak_count, 1, __ATOMIC_SEQ_CST);
-            if (!count) delete_block();
+        void __ctrl::local_decrement_shared_count() noexcept {
+            const unsigned long long c = __atomic_load_n(&counts, __ATOMIC_RELAXED);
+            if (!(c & local_flag)) {
+                decrement_shared_count();
+                return;
+            }
 
-            return count;
+            __atomic_store_n(&counts, c - shared_one, __ATOMIC_RELAXED);
+            if ((c & shared_mask) == 1) {
+                delete_content();
+                local_decrement_weak_count();
+            }
         }
 
-        long __ctrl::increment_shared_count() noexcept {
-            return is_null() ? 0 : __atomic_add_fetch(&shared_count, 1, __ATOMIC_SEQ_CST);
+        void __ctrl::local_decrement_weak_count() noexcept {
+            const unsigned long long c = __atomic_load_n(&counts, __ATOMIC_RELAXED);
+            if (!(c & local_flag)) {
+                decrement_weak_count();
+                return;
+            }
+
+            __atomic_store_n(&counts, c - weak_one, __ATOMIC_RELAXED);
+            if ((c & weak_mask) == weak_one) {
+                delete_block();
+            }
         }
 
-        long __ctrl::increment_weak_count() noexcept {
-            return __atomic_add_fetch(&weak_count, 1, __ATOMIC_SEQ_CST);
+        bool __ctrl::local_try_increment_shared_count() noexcept {
+            const unsigned long long c = __atomic_load_n(&counts, __ATOMIC_RELAXED);
+            if (!(c & local_flag)) {
+                return try_increment_shared_count();
+            } else if ((c & shared_mask) == 0) {
+                return false;
+            }
+
+            check_shared_increment(c, shared_one);
+            __atomic_store_n(&counts, c + shared_one, __ATOMIC_RELAXED);
+            return true;
         }
 
         void __ctrl::delete_block() noexcept { delete this; }
@@ -1,8 +1,17 @@
+#include "execinfo.h"
+#include "sys/mman.h"
+#include "sys/syscall.h"
+#include "unistd.h"
+
 #include "memory_resource.hpp"
 #include "cstddef.hpp"
 #include "new.hpp"
 #include "memory.hpp"
 #include "cstdint.hpp"
+#include "bit.hpp"
+#include "algorithm.hpp"
+#include "thread.hpp"
+#include "system_error.hpp"
 
 namespace std::pmr {
     void* memory_resource::allocate(std::size_t bytes, std::size_t alignment) {
@@ -17,6 +26,12 @@ namespace std::pmr {
         return do_is_equal(other);
     }
 
+    bool memory_resource::try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t alignment) {
+        return new_bytes == bytes || (new_bytes > bytes && do_try_expand(p, bytes, new_bytes, alignment));
+    }
+
+    bool memory_resource::do_try_expand(void*, std::size_t, std::size_t, std::size_t) { return false; }
+
     bool operator==(const memory_resource& a, const memory_resource& b) noexcept {
         return &a == &b && a.is_equal(b);
     }
@@ -56,7 +71,9 @@ namespace std::pmr {
 
         constinit null_memory_resource null_memory_resource::singleton;
         constinit new_delete_memory_resource new_delete_memory_resource::singleton;
-        constinit memory_resource* default_memory_resource = nullptr;
+        /* Accessed atomically, since any thread may replace the default resource at any time. */
+        constinit memory_resource* default_memory_resource = &new_delete_memory_resource::singleton;
+        constinit thread_local memory_resource* thread_default_memory_resource = nullptr;
     }
 
     memory_resource* new_delete_resource() noexcept {
@@ -68,69 +85,923 @@ namespace std::pmr {
     }
 
     memory_resource* set_default_resource(memory_resource* r) noexcept {
-        memory_resource* old = __internal::default_memory_resource;
-        __internal::default_memory_resource = r ? r : new_delete_resource();
-        return old;
+        return __atomic_exchange_n(&__internal::default_memory_resource, r ? r : new_delete_resource(), __ATOMIC_ACQ_REL);
     }
 
     memory_resource* get_default_resource() noexcept {
-        return __internal::default_memory_resource;
+        if (memory_resource* const r = __internal::thread_default_memory_resource; r) {
+            return r;
+        }
+        return __atomic_load_n(&__internal::default_memory_resource, __ATOMIC_ACQUIRE);
+    }
+
+    memory_resource* set_thread_default_resource(memory_resource* r) noexcept {
+        memory_resource* const old = __internal::thread_default_memory_resource;
+        __internal::thread_default_memory_resource = r;
+        return old;
     }
 
     monotonic_buffer_resource::monotonic_buffer_resource(memory_resource* upstream)
-        : memory_resource(), upstream_rsrc(upstream), current_buffer(nullptr), next_buffer_size(default_buffer_size), unused_buffer_part(nullptr) {}
+        : monotonic_buffer_resource(default_buffer_size, upstream) {}
 
     monotonic_buffer_resource::monotonic_buffer_resource(std::size_t initial_size, memory_resource* upstream)
-        : memory_resource(), upstream_rsrc(upstream), current_buffer(nullptr), next_buffer_size(initial_size), unused_buffer_part(nullptr) {}
+        : memory_resource(), upstream_rsrc(upstream), initial_buffer(nullptr), initial_buffer_size(0), current_buffer(nullptr),
+            initial_next_buffer_size(std::max(initial_size, min_buffer_size)), next_buffer_size(initial_next_buffer_size), unused_begin(nullptr),
+            unused_end(nullptr), retain_chunks(false) {}
 
     monotonic_buffer_resource::monotonic_buffer_resource(void* buffer, std::size_t buffer_size, memory_resource* upstream)
-        : memory_resource(), upstream_rsrc(upstream), current_buffer(buffer), next_buffer_size(buffer_size * growth_factor), 
-            unused_buffer_part(static_cast<void*>(static_cast<metadata*>(buffer) + 1)) {
-        *static_cast<metadata*>(buffer) = { .prev_buffer = nullptr, .buffer_size = buffer_size };
-    }
+        : memory_resource(), upstream_rsrc(upstream), initial_buffer(buffer), initial_buffer_size(buffer_size), current_buffer(nullptr),
+            initial_next_buffer_size(grow(std::max(buffer_size, min_buffer_size))), next_buffer_size(initial_next_buffer_size),
+            unused_begin(static_cast<char*>(buffer)), unused_end(static_cast<char*>(buffer) + buffer_size), retain_chunks(false) {}
 
     monotonic_buffer_resource::monotonic_buffer_resource() : monotonic_buffer_resource(get_default_resource()) {}
     monotonic_buffer_resource::monotonic_buffer_resource(std::size_t initial_size) : monotonic_buffer_resource(initial_size, get_default_resource()) {}
     monotonic_buffer_resource::monotonic_buffer_resource(void* buffer, std::size_t buffer_size) : monotonic_buffer_resource(buffer, buffer_size, get_default_resource()) {}
 
-    monotonic_buffer_resource::~monotonic_buffer_resource() { release(); }
+    monotonic_buffer_resource::~monotonic_buffer_resource() { release_buffers(false); }
+
+    void monotonic_buffer_resource::release() { release_buffers(retain_chunks); }
 
-    void monotonic_buffer_resource::release() {
+    void monotonic_buffer_resource::release_buffers(bool keep_largest) noexcept {
+        void* kept_buffer = nullptr;
+        std::size_t kept_size = 0;
         while (current_buffer) {
-            const struct metadata& metadata = *static_cast<struct metadata*>(current_buffer);
-            upstream_rsrc->deallocate(current_buffer, metadata.buffer_size);
+            const struct metadata metadata = *static_cast<struct metadata*>(current_buffer);
+            if (keep_largest && metadata.buffer_size > kept_size) {
+                if (kept_buffer) {
+                    upstream_rsrc->deallocate(kept_buffer, kept_size);
+                }
+                kept_buffer = current_buffer;
+                kept_size = metadata.buffer_size;
+            } else {
+                upstream_rsrc->deallocate(current_buffer, metadata.buffer_size);
+            }
             current_buffer = metadata.prev_buffer;
         }
+
+        if (kept_buffer) {
+            *static_cast<metadata*>(kept_buffer) = { .prev_buffer = nullptr, .buffer_size = kept_size };
+            current_buffer = kept_buffer;
+            unused_begin = static_cast<char*>(kept_buffer) + sizeof(metadata);
+            unused_end = static_cast<char*>(kept_buffer) + kept_size;
+        } else {
+            next_buffer_size = initial_next_buffer_size;
+            unused_begin = static_cast<char*>(initial_buffer);
+            unused_end = static_cast<char*>(initial_buffer) + initial_buffer_size;
+        }
     }
 
     memory_resource* monotonic_buffer_resource::upstream_resource() const { return upstream_rsrc; }
 
-    void* monotonic_buffer_resource::do_allocate(std::size_t bytes, std::size_t alignment) {
-        if (current_buffer) {
-            const struct metadata& metadata = *static_cast<struct metadata*>(current_buffer);
-            std::size_t remaining_space = metadata.buffer_size - (static_cast<char*>(unused_buffer_part) - static_cast<char*>(current_buffer));
-            if (void* addr = align(alignment, bytes, unused_buffer_part, remaining_space); addr) {
-                unused_buffer_part = static_cast<void*>(static_cast<char*>(unused_buffer_part) + bytes);
-                return addr;
+    void* monotonic_buffer_resource::allocate_from_new_buffer(std::size_t bytes, std::size_t alignment) {
+        // Leave enough room to align the allocation no matter where the upstream buffer ends up.
+        if (bytes > numeric_limits<std::size_t>::max() - alignment - sizeof(metadata)) {
+            throw bad_alloc();
+        }
+        const std::size_t required_size = bytes + alignment + sizeof(metadata);
+        if (next_buffer_size < required_size) {
+            next_buffer_size = std::max(required_size, grow(next_buffer_size));
+        }
+
+        void* const buffer = upstream_rsrc->allocate(next_buffer_size);
+        *static_cast<metadata*>(buffer) = { .prev_buffer = current_buffer, .buffer_size = next_buffer_size };
+        current_buffer = buffer;
+        unused_begin = static_cast<char*>(buffer) + sizeof(metadata);
+        unused_end = static_cast<char*>(buffer) + next_buffer_size;
+        next_buffer_size = grow(next_buffer_size);
+
+        char* const p = unused_begin + (-reinterpret_cast<std::uintptr_t>(unused_begin) & (alignment - 1));
+        unused_begin = p + bytes;
+        return p;
+    }
+
+    void monotonic_buffer_resource::do_deallocate(void*, size_t, size_t) {}
+
+    bool monotonic_buffer_resource::do_try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t) {
+        if (static_cast<char*>(p) + bytes != unused_begin || new_bytes - bytes > static_cast<std::size_t>(unused_end - unused_begin)) {
+            return false;
+        }
+        unused_begin += new_bytes - bytes;
+        return true;
+    }
+    bool monotonic_buffer_resource::do_is_equal(const memory_resource& other) const noexcept { return this == &other; }
+
+    namespace __internal {
+        /* Chunks never grow beyond this size unless a single block is larger, so that pools serving large blocks do not request gigantic chunks. */
+        static constexpr std::size_t max_chunk_size = std::size_t(1) << 22;
+        /* The first chunk of every pool is roughly one page worth of blocks. */
+        static constexpr std::size_t initial_chunk_size = 4096;
+
+        void __pool::initialize(std::size_t block_size, std::size_t max_blocks_per_chunk) noexcept {
+            this->block_size = block_size;
+            next_blocks_per_chunk = std::min(std::max(initial_chunk_size / block_size, std::size_t(1)), max_blocks_per_chunk);
+        }
+
+        void* __pool::allocate_from_new_chunk(memory_resource* upstream, std::size_t max_blocks_per_chunk) {
+            const std::size_t blocks = next_blocks_per_chunk;
+            // block_size is a power of two no smaller than a pointer, so the footer placed right after the last block is suitably aligned.
+            const std::size_t chunk_size = blocks * block_size + sizeof(chunk_footer);
+            void* const chunk = upstream->allocate(chunk_size, alignof(max_align_t));
+
+            chunk_footer* const footer = reinterpret_cast<chunk_footer*>(static_cast<char*>(chunk) + blocks * block_size);
+            *footer = { .prev = last_chunk, .begin = chunk, .size = chunk_size };
+            last_chunk = footer;
+
+            const std::size_t blocks_cap = std::max(max_chunk_size / block_size, std::size_t(1));
+            next_blocks_per_chunk = std::min(std::min(blocks * 2, max_blocks_per_chunk), std::max(blocks_cap, blocks));
+
+            unused_begin = static_cast<char*>(chunk) + block_size;
+            unused_end = static_cast<char*>(chunk) + blocks * block_size;
+            return chunk;
+        }
+
+        void __pool::release(memory_resource* upstream) noexcept {
+            while (last_chunk) {
+                chunk_footer* const prev = last_chunk->prev;
+                upstream->deallocate(last_chunk->begin, last_chunk->size, alignof(max_align_t));
+                last_chunk = prev;
+            }
+
+            free_list = nullptr;
+            unused_begin = unused_end = nullptr;
+        }
+
+        /* The header of an oversized allocation is placed immediately before the returned pointer, and the distance to the start of the upstream
+         * allocation is rounded up so that the returned pointer keeps the requested alignment. The size and alignment of the upstream allocation are
+         * stashed right after the links so that release() can return every allocation upstream. */
+        struct __oversized_header_data {
+            __oversized_list::header links;
+            std::size_t bytes;
+            std::size_t alignment;
+        };
+
+        static constexpr std::size_t oversized_header_space(std::size_t alignment) noexcept {
+            return (sizeof(__oversized_header_data) + alignment - 1) & ~(alignment - 1);
+        }
+
+        void* __oversized_list::allocate(memory_resource* upstream, std::size_t bytes, std::size_t alignment) {
+            alignment = std::max(alignment, alignof(__oversized_header_data));
+            const std::size_t header_space = oversized_header_space(alignment);
+            if (bytes > numeric_limits<std::size_t>::max() - header_space) {
+                throw bad_alloc();
+            }
+
+            char* const base = static_cast<char*>(upstream->allocate(bytes + header_space, alignment));
+            __oversized_header_data* const data = reinterpret_cast<__oversized_header_data*>(base + header_space) - 1;
+            *data = { .links = { .prev = nullptr, .next = head }, .bytes = bytes + header_space, .alignment = alignment };
+            if (head) {
+                head->prev = &data->links;
+            }
+            head = &data->links;
+            return base + header_space;
+        }
+
+        void __oversized_list::deallocate(memory_resource* upstream, void* p, std::size_t, std::size_t) noexcept {
+            __oversized_header_data* const data = static_cast<__oversized_header_data*>(p) - 1;
+            if (data->links.prev) {
+                data->links.prev->next = data->links.next;
+            } else {
+                head = data->links.next;
+            }
+            if (data->links.next) {
+                data->links.next->prev = data->links.prev;
+            }
+
+            upstream->deallocate(static_cast<char*>(p) - oversized_header_space(data->alignment), data->bytes, data->alignment);
+        }
+
+        void __oversized_list::release(memory_resource* upstream) noexcept {
+            while (head) {
+                __oversized_header_data* const data = reinterpret_cast<__oversized_header_data*>(head);
+                head = head->next;
+                upstream->deallocate(reinterpret_cast<char*>(data + 1) - oversized_header_space(data->alignment), data->bytes, data->alignment);
+            }
+        }
+
+        __pool_set::__pool_set(const pool_options& opts) noexcept : opts(opts), pool_count(0), pools() {
+            // Replace the values left to the implementation, and clamp the rest into the supported range.
+            std::size_t& max_blocks = this->opts.max_blocks_per_chunk;
+            if (max_blocks == 0) {
+                max_blocks = default_max_blocks_per_chunk;
+            }
+            max_blocks = std::min(max_blocks, max_max_blocks_per_chunk);
+
+            std::size_t& largest = this->opts.largest_required_pool_block;
+            if (largest == 0) {
+                largest = default_largest_required_pool_block;
+            }
+            largest = std::min(std::max(largest, min_block_size), max_largest_required_pool_block);
+            largest = std::size_t(1) << bit_width(largest - 1);
+
+            pool_count = bit_width(largest - 1) - countr_zero(min_block_size) + 1;
+            for (std::size_t i = 0; i < pool_count; i++) {
+                pools[i].initialize(min_block_size << i, max_blocks);
+            }
+        }
+
+        std::size_t __pool_set::index(std::size_t bytes, std::size_t alignment) const noexcept {
+            // Chunks are only aligned to max_align_t, so over-aligned requests always go upstream.
+            const std::size_t n = std::max(std::max(bytes, alignment), min_block_size);
+            if (n > opts.largest_required_pool_block || alignment > alignof(max_align_t)) [[unlikely]] {
+                return pool_count;
+            }
+            return bit_width(n - 1) - countr_zero(min_block_size);
+        }
+
+        void __pool_set::release(memory_resource* upstream) noexcept {
+            for (std::size_t i = 0; i < pool_count; i++) {
+                pools[i].release(upstream);
+            }
+        }
+    }
+
+    unsynchronized_pool_resource::unsynchronized_pool_resource(const pool_options& opts, memory_resource* upstream)
+        : memory_resource(), upstream_rsrc(upstream), pools(opts), oversized() {}
+
+    unsynchronized_pool_resource::unsynchronized_pool_resource() : unsynchronized_pool_resource(pool_options(), get_default_resource()) {}
+    unsynchronized_pool_resource::unsynchronized_pool_resource(memory_resource* upstream) : unsynchronized_pool_resource(pool_options(), upstream) {}
+    unsynchronized_pool_resource::unsynchronized_pool_resource(const pool_options& opts) : unsynchronized_pool_resource(opts, get_default_resource()) {}
+
+    unsynchronized_pool_resource::~unsynchronized_pool_resource() { release(); }
+
+    void unsynchronized_pool_resource::release() {
+        pools.release(upstream_rsrc);
+        oversized.release(upstream_rsrc);
+    }
+
+    memory_resource* unsynchronized_pool_resource::upstream_resource() const { return upstream_rsrc; }
+    pool_options unsynchronized_pool_resource::options() const { return pools.opts; }
+
+    void* unsynchronized_pool_resource::do_allocate(std::size_t bytes, std::size_t alignment) {
+        if (const std::size_t i = pools.index(bytes, alignment); i < pools.pool_count) [[likely]] {
+            return pools.pools[i].allocate(upstream_rsrc, pools.opts.max_blocks_per_chunk);
+        }
+        return oversized.allocate(upstream_rsrc, bytes, alignment);
+    }
+
+    void unsynchronized_pool_resource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+        if (const std::size_t i = pools.index(bytes, alignment); i < pools.pool_count) [[likely]] {
+            pools.pools[i].deallocate(p);
+        } else {
+            oversized.deallocate(upstream_rsrc, p, bytes, alignment);
+        }
+    }
+
+    bool unsynchronized_pool_resource::do_is_equal(const memory_resource& other) const noexcept { return this == &other; }
+
+    namespace __internal {
+        /* Holds a pthread mutex for the lifetime of the guard. */
+        class pthread_mutex_guard {
+        private:
+            pthread_mutex_t& mutex;
+
+        public:
+            explicit pthread_mutex_guard(pthread_mutex_t& mutex) noexcept : mutex(mutex) { pthread_mutex_lock(&mutex); }
+            pthread_mutex_guard(const pthread_mutex_guard&) = delete;
+            ~pthread_mutex_guard() { pthread_mutex_unlock(&mutex); }
+        };
+
+        void* __locked_resource::do_allocate(std::size_t bytes, std::size_t alignment) {
+            const pthread_mutex_guard guard(*mutex);
+            return upstream->allocate(bytes, alignment);
+        }
+
+        void __locked_resource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+            const pthread_mutex_guard guard(*mutex);
+            upstream->deallocate(p, bytes, alignment);
+        }
+
+        bool __locked_resource::do_is_equal(const memory_resource& other) const noexcept { return this == &other; }
+
+        /* The number of blocks moved between a thread cache and the depot at once. Small blocks move in larger batches, so that the depot's mutex
+         * is taken less often, while caches of large blocks stay small. */
+        static constexpr std::size_t cache_batch_size(std::size_t block_size) noexcept {
+            return std::min(std::max(std::size_t(4096) / block_size, std::size_t(1)), std::size_t(32));
+        }
+    }
+
+    struct synchronized_pool_resource::thread_cache {
+        struct bin {
+            __internal::__pool::free_block* head;
+            std::size_t count;
+        };
+
+        synchronized_pool_resource* owner;
+        thread_cache* prev;
+        thread_cache* next;
+        // The owner's generation when the bins were last known to be valid.
+        std::size_t generation;
+        bin bins[__internal::__pool_set::max_pool_count];
+    };
+
+    synchronized_pool_resource::synchronized_pool_resource(const pool_options& opts, memory_resource* upstream)
+        : memory_resource(), upstream_rsrc(upstream), upstream_mutex(PTHREAD_MUTEX_INITIALIZER), locked_upstream(upstream, &upstream_mutex), pools(opts),
+            oversized(), cache_key(), has_cache_key(false), caches_mutex(PTHREAD_MUTEX_INITIALIZER), caches(nullptr), generation(0) {
+        for (pthread_mutex_t& mutex : pool_mutexes) {
+            pthread_mutex_init(&mutex, nullptr);
+        }
+        has_cache_key = pthread_key_create(&cache_key, destroy_thread_cache) == 0;
+    }
+
+    synchronized_pool_resource::synchronized_pool_resource() : synchronized_pool_resource(pool_options(), get_default_resource()) {}
+    synchronized_pool_resource::synchronized_pool_resource(memory_resource* upstream) : synchronized_pool_resource(pool_options(), upstream) {}
+    synchronized_pool_resource::synchronized_pool_resource(const pool_options& opts) : synchronized_pool_resource(opts, get_default_resource()) {}
+
+    synchronized_pool_resource::~synchronized_pool_resource() {
+        release();
+
+        // Deleting the key first guarantees that no exiting thread runs destroy_thread_cache on a cache that is about to be freed here.
+        if (has_cache_key) {
+            pthread_key_delete(cache_key);
+        }
+        while (caches) {
+            thread_cache* const next = caches->next;
+            delete caches;
+            caches = next;
+        }
+
+        for (pthread_mutex_t& mutex : pool_mutexes) {
+            pthread_mutex_destroy(&mutex);
+        }
+        pthread_mutex_destroy(&caches_mutex);
+        pthread_mutex_destroy(&upstream_mutex);
+    }
+
+    /* The cached blocks belong to chunks that are about to be returned upstream, but the caches are only ever touched by their own threads: the
+     * generation goes up first, and each thread drops its blocks when it sees that. The increment happens before each pool's mutex is taken
+     * here, so a flush that takes the mutex afterwards sees it and doesn't put stale blocks into the emptied pool. Blocks that are allocated or
+     * deallocated while release() runs are released with the rest. */
+    void synchronized_pool_resource::release() {
+        __atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+
+        for (std::size_t i = 0; i < pools.pool_count; i++) {
+            const __internal::pthread_mutex_guard guard(pool_mutexes[i]);
+            pools.pools[i].release(&locked_upstream);
+        }
+
+        const __internal::pthread_mutex_guard guard(upstream_mutex);
+        oversized.release(upstream_rsrc);
+    }
+
+    memory_resource* synchronized_pool_resource::upstream_resource() const { return upstream_rsrc; }
+    pool_options synchronized_pool_resource::options() const { return pools.opts; }
+
+    synchronized_pool_resource::thread_cache* synchronized_pool_resource::local_cache() noexcept {
+        if (!has_cache_key) [[unlikely]] {
+            return nullptr;
+        } else if (void* const cache = pthread_getspecific(cache_key); cache) [[likely]] {
+            return static_cast<thread_cache*>(cache);
+        }
+
+        thread_cache* const cache = new (nothrow) thread_cache{
+            .owner = this, .prev = nullptr, .next = nullptr, .generation = __atomic_load_n(&generation, __ATOMIC_ACQUIRE), .bins = {} };
+        if (!cache) {
+            return nullptr;
+        } else if (pthread_setspecific(cache_key, cache) != 0) {
+            delete cache;
+            return nullptr;
+        }
+
+        const __internal::pthread_mutex_guard guard(caches_mutex);
+        cache->next = caches;
+        if (caches) {
+            caches->prev = cache;
+        }
+        caches = cache;
+        return cache;
+    }
+
+    void* synchronized_pool_resource::refill(thread_cache& cache, std::size_t index) {
+        thread_cache::bin& bin = cache.bins[index];
+        __internal::__pool& pool = pools.pools[index];
+        const std::size_t batch = __internal::cache_batch_size(pool.block_size);
+
+        const __internal::pthread_mutex_guard guard(pool_mutexes[index]);
+        void* const result = pool.allocate(&locked_upstream, pools.opts.max_blocks_per_chunk);
+        // Fill the rest of the batch with whatever the depot has at hand, without asking upstream for another chunk.
+        while (bin.count + 1 < batch && (pool.free_list || pool.unused_begin != pool.unused_end)) {
+            __internal::__pool::free_block* const block = static_cast<__internal::__pool::free_block*>(pool.allocate(&locked_upstream, pools.opts.max_blocks_per_chunk));
+            block->next = bin.head;
+            bin.head = block;
+            bin.count++;
+        }
+        return result;
+    }
+
+    void synchronized_pool_resource::flush(thread_cache& cache, std::size_t index, std::size_t count) noexcept {
+        thread_cache::bin& bin = cache.bins[index];
+        if (count == 0) {
+            return;
+        }
+
+        __internal::__pool::free_block* const first = bin.head;
+        __internal::__pool::free_block* last = first;
+        for (std::size_t i = 1; i < count; i++) {
+            last = last->next;
+        }
+        bin.head = last->next;
+        bin.count -= count;
+
+        __internal::__pool& pool = pools.pools[index];
+        const __internal::pthread_mutex_guard guard(pool_mutexes[index]);
+        // After a release() the blocks point into chunks that are gone, and are dropped rather than handed to the pool.
+        if (cache.generation == __atomic_load_n(&generation, __ATOMIC_ACQUIRE)) [[likely]] {
+            last->next = pool.free_list;
+            pool.free_list = first;
+        }
+    }
+
+    void synchronized_pool_resource::drop_if_stale(thread_cache& cache) noexcept {
+        if (const std::size_t current = __atomic_load_n(&generation, __ATOMIC_ACQUIRE); cache.generation != current) [[unlikely]] {
+            for (thread_cache::bin& bin : cache.bins) {
+                bin = { .head = nullptr, .count = 0 };
+            }
+            cache.generation = current;
+        }
+    }
+
+    void synchronized_pool_resource::retire(thread_cache* cache) noexcept {
+        for (std::size_t i = 0; i < pools.pool_count; i++) {
+            flush(*cache, i, cache->bins[i].count);
+        }
+
+        {
+            const __internal::pthread_mutex_guard guard(caches_mutex);
+            if (cache->prev) {
+                cache->prev->next = cache->next;
+            } else {
+                caches = cache->next;
+            }
+            if (cache->next) {
+                cache->next->prev = cache->prev;
+            }
+        }
+        delete cache;
+    }
+
+    void synchronized_pool_resource::destroy_thread_cache(void* cache) noexcept {
+        thread_cache* const c = static_cast<thread_cache*>(cache);
+        c->owner->retire(c);
+    }
+
+    void* synchronized_pool_resource::do_allocate(std::size_t bytes, std::size_t alignment) {
+        const std::size_t i = pools.index(bytes, alignment);
+        if (i == pools.pool_count) [[unlikely]] {
+            const __internal::pthread_mutex_guard guard(upstream_mutex);
+            return oversized.allocate(upstream_rsrc, bytes, alignment);
+        }
+
+        thread_cache* const cache = local_cache();
+        if (!cache) [[unlikely]] {
+            const __internal::pthread_mutex_guard guard(pool_mutexes[i]);
+            return pools.pools[i].allocate(&locked_upstream, pools.opts.max_blocks_per_chunk);
+        }
+
+        drop_if_stale(*cache);
+        thread_cache::bin& bin = cache->bins[i];
+        if (__internal::__pool::free_block* const block = bin.head; block) [[likely]] {
+            bin.head = block->next;
+            bin.count--;
+            return block;
+        }
+        return refill(*cache, i);
+    }
+
+    void synchronized_pool_resource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+        const std::size_t i = pools.index(bytes, alignment);
+        if (i == pools.pool_count) [[unlikely]] {
+            const __internal::pthread_mutex_guard guard(upstream_mutex);
+            oversized.deallocate(upstream_rsrc, p, bytes, alignment);
+            return;
+        }
+
+        thread_cache* const cache = local_cache();
+        if (!cache) [[unlikely]] {
+            const __internal::pthread_mutex_guard guard(pool_mutexes[i]);
+            pools.pools[i].deallocate(p);
+            return;
+        }
+
+        drop_if_stale(*cache);
+        thread_cache::bin& bin = cache->bins[i];
+        __internal::__pool::free_block* const block = static_cast<__internal::__pool::free_block*>(p);
+        block->next = bin.head;
+        bin.head = block;
+        // Once the cache holds two batches, hand one back so that blocks freed by a consumer thread flow back to producer threads.
+        if (const std::size_t batch = __internal::cache_batch_size(pools.pools[i].block_size); ++bin.count > 2 * batch) [[unlikely]] {
+            flush(*cache, i, batch);
+        }
+    }
+
+    bool synchronized_pool_resource::do_is_equal(const memory_resource& other) const noexcept { return this == &other; }
+
+    struct statistics_resource::thread_counters {
+        statistics_resource* owner;
+        thread_counters* prev;
+        thread_counters* next;
+        /* Only written by the owning thread, and read by get_statistics() through relaxed atomic loads. */
+        std::size_t allocations;
+        std::size_t deallocations;
+        std::size_t bytes_allocated;
+        std::size_t bytes_deallocated;
+        std::size_t size_histogram[histogram_size];
+        std::size_t alignment_histogram[histogram_size];
+        std::size_t until_next_sample;
+    };
+
+    namespace __internal {
+        /* Increments a counter that only the calling thread writes to, without a locked read-modify-write. */
+        static void bump_counter(std::size_t& counter, std::size_t n) noexcept {
+            __atomic_store_n(&counter, __atomic_load_n(&counter, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+        }
+    }
+
+    statistics_resource::statistics_resource() : statistics_resource(get_default_resource()) {}
+
+    statistics_resource::statistics_resource(memory_resource* upstream, std::size_t sample_period)
+        : memory_resource(), upstream_rsrc(upstream), sample_period(sample_period), bytes_in_use(0), peak_bytes_in_use(0), counters_key(),
+            has_counters_key(false), counters_mutex(PTHREAD_MUTEX_INITIALIZER), counters(nullptr), retired_counters(nullptr), samples(), sample_count(0) {
+        has_counters_key = pthread_key_create(&counters_key, retire_counters) == 0;
+        retired_counters = new thread_counters{};
+    }
+
+    statistics_resource::~statistics_resource() {
+        if (has_counters_key) {
+            pthread_key_delete(counters_key);
+        }
+        while (counters) {
+            thread_counters* const next = counters->next;
+            delete counters;
+            counters = next;
+        }
+        delete retired_counters;
+        pthread_mutex_destroy(&counters_mutex);
+    }
+
+    memory_resource* statistics_resource::upstream_resource() const noexcept { return upstream_rsrc; }
+
+    statistics_resource::thread_counters* statistics_resource::local_counters() noexcept {
+        if (!has_counters_key) [[unlikely]] {
+            return nullptr;
+        } else if (void* const c = pthread_getspecific(counters_key); c) [[likely]] {
+            return static_cast<thread_counters*>(c);
+        }
+
+        thread_counters* const c = new (nothrow) thread_counters{};
+        if (!c) {
+            return nullptr;
+        } else if (pthread_setspecific(counters_key, c) != 0) {
+            delete c;
+            return nullptr;
+        }
+        c->owner = this;
+        c->until_next_sample = sample_period;
+
+        const __internal::pthread_mutex_guard guard(counters_mutex);
+        c->next = counters;
+        if (counters) {
+            counters->prev = c;
+        }
+        counters = c;
+        return c;
+    }
+
+    void statistics_resource::retire_counters(void* counters) noexcept {
+        thread_counters* const c = static_cast<thread_counters*>(counters);
+        statistics_resource& owner = *c->owner;
+        {
+            const __internal::pthread_mutex_guard guard(owner.counters_mutex);
+            thread_counters& retired = *owner.retired_counters;
+            retired.allocations += c->allocations;
+            retired.deallocations += c->deallocations;
+            retired.bytes_allocated += c->bytes_allocated;
+            retired.bytes_deallocated += c->bytes_deallocated;
+            for (std::size_t i = 0; i < histogram_size; i++) {
+                retired.size_histogram[i] += c->size_histogram[i];
+                retired.alignment_histogram[i] += c->alignment_histogram[i];
+            }
+
+            if (c->prev) {
+                c->prev->next = c->next;
+            } else {
+                owner.counters = c->next;
+            }
+            if (c->next) {
+                c->next->prev = c->prev;
+            }
+        }
+        delete c;
+    }
+
+    void statistics_resource::record_sample(std::size_t bytes, std::size_t alignment) noexcept {
+        call_site_sample sample;
+        // Skip the frames of this function and of do_allocate.
+        void* frames[max_sample_depth + 2];
+        const int depth = backtrace(frames, max_sample_depth + 2);
+        sample.depth = depth > 2 ? depth - 2 : 0;
+        for (std::size_t i = 0; i < sample.depth; i++) {
+            sample.frames[i] = frames[i + 2];
+        }
+        sample.bytes = bytes;
+        sample.alignment = alignment;
+
+        const __internal::pthread_mutex_guard guard(counters_mutex);
+        samples[sample_count % max_samples] = sample;
+        sample_count++;
+    }
+
+    void statistics_resource::add_bytes_in_use(std::size_t bytes) noexcept {
+        const std::size_t in_use = __atomic_add_fetch(&bytes_in_use, bytes, __ATOMIC_RELAXED);
+        std::size_t peak = __atomic_load_n(&peak_bytes_in_use, __ATOMIC_RELAXED);
+        while (in_use > peak && !__atomic_compare_exchange_n(&peak_bytes_in_use, &peak, in_use, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+    }
+
+    void* statistics_resource::do_allocate(std::size_t bytes, std::size_t alignment) {
+        void* const p = upstream_rsrc->allocate(bytes, alignment);
+
+        add_bytes_in_use(bytes);
+        if (thread_counters* const c = local_counters(); c) [[likely]] {
+            __internal::bump_counter(c->allocations, 1);
+            __internal::bump_counter(c->bytes_allocated, bytes);
+            __internal::bump_counter(c->size_histogram[bit_width(bytes)], 1);
+            __internal::bump_counter(c->alignment_histogram[bit_width(alignment)], 1);
+            if (sample_period != 0 && --c->until_next_sample == 0) [[unlikely]] {
+                c->until_next_sample = sample_period;
+                record_sample(bytes, alignment);
+            }
+        }
+        return p;
+    }
+
+    void statistics_resource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+        upstream_rsrc->deallocate(p, bytes, alignment);
+
+        __atomic_sub_fetch(&bytes_in_use, bytes, __ATOMIC_RELAXED);
+        if (thread_counters* const c = local_counters(); c) [[likely]] {
+            __internal::bump_counter(c->deallocations, 1);
+            __internal::bump_counter(c->bytes_deallocated, bytes);
+        }
+    }
+
+    bool statistics_resource::do_is_equal(const memory_resource& other) const noexcept { return this == &other; }
+
+    bool statistics_resource::do_try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t alignment) {
+        if (!upstream_rsrc->try_expand(p, bytes, new_bytes, alignment)) {
+            return false;
+        }
+
+        // The block is deallocated with new_bytes, so the extra bytes are counted as allocated for bytes_deallocated to balance out.
+        add_bytes_in_use(new_bytes - bytes);
+        if (thread_counters* const c = local_counters(); c) [[likely]] {
+            __internal::bump_counter(c->bytes_allocated, new_bytes - bytes);
+        }
+        return true;
+    }
+
+    statistics_resource::statistics statistics_resource::get_statistics() const {
+        statistics result{};
+        const auto merge = [&result](const thread_counters& c) {
+            result.allocations += __atomic_load_n(&c.allocations, __ATOMIC_RELAXED);
+            result.deallocations += __atomic_load_n(&c.deallocations, __ATOMIC_RELAXED);
+            result.bytes_allocated += __atomic_load_n(&c.bytes_allocated, __ATOMIC_RELAXED);
+            result.bytes_deallocated += __atomic_load_n(&c.bytes_deallocated, __ATOMIC_RELAXED);
+            for (std::size_t i = 0; i < histogram_size; i++) {
+                result.size_histogram[i] += __atomic_load_n(&c.size_histogram[i], __ATOMIC_RELAXED);
+                result.alignment_histogram[i] += __atomic_load_n(&c.alignment_histogram[i], __ATOMIC_RELAXED);
+            }
+        };
+
+        const __internal::pthread_mutex_guard guard(counters_mutex);
+        merge(*retired_counters);
+        for (const thread_counters* c = counters; c; c = c->next) {
+            merge(*c);
+        }
+        result.bytes_in_use = __atomic_load_n(&bytes_in_use, __ATOMIC_RELAXED);
+        result.peak_bytes_in_use = __atomic_load_n(&peak_bytes_in_use, __ATOMIC_RELAXED);
+        return result;
+    }
+
+    std::size_t statistics_resource::get_samples(call_site_sample* out, std::size_t n) const {
+        const __internal::pthread_mutex_guard guard(counters_mutex);
+        n = std::min(n, std::min(sample_count, max_samples));
+        for (std::size_t i = 0; i < n; i++) {
+            out[i] = samples[(sample_count - 1 - i) % max_samples];
+        }
+        return n;
+    }
+
+    namespace __internal {
+        /* The size of a transparent huge page on the platforms supporting them. */
+        static constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+        /* Faults in the pages of [addr, addr + size) that MAP_POPULATE didn't: those of a cached mapping, which MADV_DONTNEED dropped, and
+         * those mremap adds. Where the kernel can't populate them itself (MADV_POPULATE_WRITE is Linux 5.14), every page is written to;
+         * these pages are known to be zero-filled, so writing zero doesn't change them. */
+        static void prefault(void* addr, std::size_t size, std::size_t page_size) noexcept {
+#if defined(MADV_POPULATE_WRITE)
+            if (madvise(addr, size, MADV_POPULATE_WRITE) == 0) {
+                return;
+            }
+#endif
+            for (std::size_t offset = 0; offset < size; offset += page_size) {
+                static_cast<volatile char*>(addr)[offset] = 0;
+            }
+        }
+    }
+
+    mmap_resource::mmap_resource() : mmap_resource(mmap_resource_options()) {}
+
+    mmap_resource::mmap_resource(const mmap_resource_options& opts)
+        : memory_resource(), opts(opts), page_size(sysconf(_SC_PAGESIZE)), cache_mutex(PTHREAD_MUTEX_INITIALIZER), cache(), cache_size(0),
+            cache_reserved(0) {
+        this->opts.max_cached_mappings = std::min(this->opts.max_cached_mappings, max_cache_size);
+    }
+
+    mmap_resource::~mmap_resource() {
+        release();
+        pthread_mutex_destroy(&cache_mutex);
+    }
+
+    mmap_resource_options mmap_resource::options() const noexcept { return opts; }
+
+    void mmap_resource::release() noexcept {
+        const __internal::pthread_mutex_guard guard(cache_mutex);
+        for (std::size_t i = 0; i < cache_size; i++) {
+            munmap(cache[i].addr, cache[i].size);
+        }
+        cache_size = 0;
+    }
+
+    std::size_t mmap_resource::mapping_size(std::size_t bytes) const noexcept {
+        const std::size_t granularity = opts.huge_pages ? __internal::huge_page_size : page_size;
+        return bytes == 0 ? granularity : (bytes + granularity - 1) & ~(granularity - 1);
+    }
+
+    std::size_t mmap_resource::mapping_alignment(std::size_t alignment) const noexcept {
+        return std::max(alignment, opts.huge_pages ? __internal::huge_page_size : page_size);
+    }
+
+    void* mmap_resource::do_allocate(std::size_t bytes, std::size_t alignment) {
+        if (bytes > numeric_limits<std::size_t>::max() / 2) {
+            throw bad_alloc();
+        }
+        const std::size_t size = mapping_size(bytes);
+        alignment = mapping_alignment(alignment);
+
+        void* cached = nullptr;
+        {
+            const __internal::pthread_mutex_guard guard(cache_mutex);
+            for (std::size_t i = 0; i < cache_size; i++) {
+                if (cache[i].size == size && (reinterpret_cast<std::uintptr_t>(cache[i].addr) & (alignment - 1)) == 0) {
+                    cached = cache[i].addr;
+                    cache[i] = cache[--cache_size];
+                    break;
+                }
+            }
+        }
+        if (cached != nullptr) {
+            // Done outside of the lock, as this can take a while for large mappings.
+            if (opts.populate) {
+                __internal::prefault(cached, size, page_size);
             }
+            return cached;
+        }
+
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_POPULATE)
+        if (opts.populate) {
+            flags |= MAP_POPULATE;
         }
+#endif
 
-        void* prev_buffer = current_buffer;
-        while (next_buffer_size < bytes + alignment + sizeof(metadata)) {
-            next_buffer_size *= growth_factor;
+        // mmap only guarantees page alignment, so over-map and trim the excess on both sides when more is needed.
+        const std::size_t slack = alignment > page_size ? alignment : 0;
+        char* const base = static_cast<char*>(mmap(nullptr, size + slack, PROT_READ | PROT_WRITE, flags, -1, 0));
+        if (base == MAP_FAILED) {
+            throw bad_alloc();
         }
-        current_buffer = upstream_rsrc->allocate(next_buffer_size);
-        
-        *static_cast<metadata*>(current_buffer) = { .prev_buffer = prev_buffer, .buffer_size = next_buffer_size };
-        std::size_t remaining_space = next_buffer_size - sizeof(metadata);
-        next_buffer_size *= growth_factor;
-        unused_buffer_part = static_cast<void*>(static_cast<char*>(current_buffer) + sizeof(metadata));
 
-        void* const addr = align(alignment, bytes, unused_buffer_part, remaining_space);
-        unused_buffer_part = static_cast<void*>(static_cast<char*>(unused_buffer_part) + bytes);
+        char* const addr = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(base) + alignment - 1) & ~(alignment - 1));
+        if (slack != 0) {
+            if (addr != base) {
+                munmap(base, addr - base);
+            }
+            if (const std::size_t tail = base + size + slack - (addr + size); tail != 0) {
+                munmap(addr + size, tail);
+            }
+        }
+
+#if defined(MADV_HUGEPAGE)
+        if (opts.huge_pages) {
+            madvise(addr, size, MADV_HUGEPAGE);
+        }
+#endif
         return addr;
     }
 
-    void monotonic_buffer_resource::do_deallocate(void*, size_t, size_t) {}
-    bool monotonic_buffer_resource::do_is_equal(const memory_resource& other) const noexcept { return this == &other; }
-}
\ No newline at end of file
+    void mmap_resource::do_deallocate(void* p, std::size_t bytes, std::size_t) {
+        const std::size_t size = mapping_size(bytes);
+        bool reserved = false;
+        if (opts.max_cached_mappings != 0) {
+            const __internal::pthread_mutex_guard guard(cache_mutex);
+            if (cache_size + cache_reserved < opts.max_cached_mappings) {
+                ++cache_reserved;
+                reserved = true;
+            }
+        }
+        if (!reserved) {
+            munmap(p, size);
+            return;
+        }
+
+        // Done outside of the lock, as this can take a while for large mappings.
+        madvise(p, size, MADV_DONTNEED);
+
+        const __internal::pthread_mutex_guard guard(cache_mutex);
+        --cache_reserved;
+        cache[cache_size++] = { .addr = p, .size = size };
+    }
+
+    bool mmap_resource::do_is_equal(const memory_resource& other) const noexcept { return this == &other; }
+
+    bool mmap_resource::do_try_expand([[maybe_unused]] void* p, std::size_t bytes, std::size_t new_bytes, std::size_t) {
+        if (new_bytes > numeric_limits<std::size_t>::max() / 2) {
+            return false;
+        }
+
+        const std::size_t size = mapping_size(bytes), new_size = mapping_size(new_bytes);
+        if (new_size == size) {
+            return true;
+        }
+#if defined(__linux__)
+        // Without MREMAP_MAYMOVE, this fails rather than moving the mapping if the pages that follow it are taken.
+        if (mremap(p, size, new_size, 0) == MAP_FAILED) {
+            return false;
+        }
+        if (opts.populate) {
+            __internal::prefault(static_cast<char*>(p) + size, new_size - size, page_size);
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    namespace __internal {
+        static mmap_resource_options without_populate(mmap_resource_options opts) noexcept {
+            opts.populate = false;
+            return opts;
+        }
+
+        /* Binds the pages of [addr, addr + size) to `node`. glibc has no wrapper for mbind, and libnuma is not a dependency of this library, so
+         * the system call is made directly. Failures are ignored, as the memory stays usable under the default policy. */
+        static void bind_to_node([[maybe_unused]] void* addr, [[maybe_unused]] std::size_t size, [[maybe_unused]] unsigned int node) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+            // From <linux/mempolicy.h>.
+            constexpr int mpol_bind = 2;
+            constexpr std::size_t bits_per_word = numeric_limits<unsigned long>::digits;
+            unsigned long node_mask[1024 / bits_per_word] = {};
+            if (node >= 1024) {
+                return;
+            }
+            node_mask[node / bits_per_word] = 1ul << (node % bits_per_word);
+            syscall(SYS_mbind, addr, size, mpol_bind, node_mask, 1024, 0);
+#endif
+        }
+    }
+
+    numa_resource::numa_resource(unsigned int node, const mmap_resource_options& opts)
+        : memory_resource(), mapper(__internal::without_populate(opts)), node(node), is_binding(false) {
+        const unsigned int node_count = numa_node_count();
+        if (node >= node_count) {
+            throw system_error(make_error_code(errc::invalid_argument));
+        }
+        is_binding = node_count > 1;
+    }
+
+    unsigned int numa_resource::numa_node() const noexcept { return node; }
+
+    void* numa_resource::do_allocate(std::size_t bytes, std::size_t alignment) {
+        void* const p = mapper.allocate(bytes, alignment);
+        if (is_binding) {
+            __internal::bind_to_node(p, mapper.mapping_size(bytes), node);
+        }
+        return p;
+    }
+
+    void numa_resource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+        mapper.deallocate(p, bytes, alignment);
+    }
+
+    bool numa_resource::do_try_expand(void* p, std::size_t bytes, std::size_t new_bytes, std::size_t alignment) {
+        if (!mapper.try_expand(p, bytes, new_bytes, alignment)) {
+            return false;
+        }
+        if (is_binding) {
+            __internal::bind_to_node(p, mapper.mapping_size(new_bytes), node);
+        }
+        return true;
+    }
+
+    bool numa_resource::do_is_equal(const memory_resource& other) const noexcept { return this == &other; }
+}
@@ -1,7 +1,14 @@
+#include "pthread.h"
+#if defined(__APPLE__)
+#include "malloc/malloc.h"
+#elif defined(__linux__)
+#include "malloc.h"
+#endif
+
 #include "new.hpp"
 #include "cstddef.hpp"
 #include "cstdlib.hpp"
-#include "cmath.hpp"
+#include "limits.hpp"
 
 namespace std {
     const char* bad_alloc::what() const noexcept { return "std::bad_alloc"; }
@@ -21,10 +28,183 @@ namespace std {
     }
 }
 
+namespace std::__internal {
+    /* Calls `allocate` until it returns a non-null pointer, invoking the installed new handler after every failure as required by the standard. */
+    template<class F>
+    static void* allocate_or_call_handler(F allocate) {
+        void* ptr = nullptr;
+        while ((ptr = allocate()) == nullptr) {
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr) {
+                throw std::bad_alloc();
+            } else {
+                (*handler)();
+            }
+        }
+
+        return ptr;
+    }
+
+#if defined(YILIB_SIZE_CLASS_NEW)
+    /* An opt-in allocator backend for the non-aligned `operator new` family, enabled by defining YILIB_SIZE_CLASS_NEW when building the library.
+     *
+     * Small requests are rounded up to a multiple of 16 bytes, and freed blocks of each of these size classes are kept on a thread-local free list
+     * so that they can be handed out again without going through malloc. Every block is prefixed by a header recording its size class, which is
+     * only read by the unsized `operator delete`; the sized overloads compute the size class from the size instead. Over-aligned requests don't go
+     * through this backend, because they are always released through the aligned `operator delete` overloads. */
+    namespace size_class_new {
+        static constexpr std::size_t header_size = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+        static constexpr std::size_t class_granularity = 16;
+        static constexpr std::size_t small_size_limit = 1024;
+        static constexpr std::size_t class_count = small_size_limit / class_granularity;
+        /* Recorded in the header of blocks that are too large for any size class. */
+        static constexpr std::size_t large_class = class_count;
+        /* The amount of memory each thread may keep cached per size class. */
+        static constexpr std::size_t cache_bytes_per_class = 8192;
+
+        struct free_block {
+            free_block* next;
+        };
+
+        struct thread_cache {
+            free_block* heads[class_count];
+            std::size_t counts[class_count];
+            bool is_registered;
+        };
+
+        /* Zero-initialized and trivially destructible, so that accessing it needs neither a guard variable nor a registered destructor. Cached
+         * blocks are returned to malloc when the thread exits by the destructor attached to `teardown_key`. */
+        static constinit thread_local thread_cache local_cache = {};
+        static constinit pthread_key_t teardown_key;
+
+        static constexpr std::size_t class_of(std::size_t size) noexcept {
+            return size == 0 ? 0 : (size - 1) / class_granularity;
+        }
+
+        static constexpr std::size_t class_size(std::size_t c) noexcept {
+            return (c + 1) * class_granularity;
+        }
+
+        static constexpr std::size_t cache_limit(std::size_t c) noexcept {
+            return cache_bytes_per_class / class_size(c);
+        }
+
+        static std::size_t& header_of(void* ptr) noexcept {
+            return *reinterpret_cast<std::size_t*>(static_cast<char*>(ptr) - header_size);
+        }
+
+        static void teardown(void* p) noexcept {
+            thread_cache& cache = *static_cast<thread_cache*>(p);
+            for (std::size_t c = 0; c < class_count; c++) {
+                while (free_block* const block = cache.heads[c]) {
+                    cache.heads[c] = block->next;
+                    std::free(reinterpret_cast<char*>(block) - header_size);
+                }
+                cache.counts[c] = 0;
+            }
+            cache.is_registered = false;
+        }
+
+        /* Makes sure that the calling thread's cache is drained when the thread exits. Returns false if that can't be guaranteed, in which case
+         * nothing should be cached. */
+        static bool register_teardown(thread_cache& cache) noexcept {
+            static constinit pthread_once_t once_control = PTHREAD_ONCE_INIT;
+            static constinit bool has_key = false;
+            pthread_once(&once_control, [] { has_key = pthread_key_create(&teardown_key, teardown) == 0; });
+
+            cache.is_registered = has_key && pthread_setspecific(teardown_key, &cache) == 0;
+            return cache.is_registered;
+        }
+
+        static void* allocate(std::size_t size) {
+            if (size <= small_size_limit) [[likely]] {
+                const std::size_t c = class_of(size);
+                thread_cache& cache = local_cache;
+                if (free_block* const block = cache.heads[c]; block) [[likely]] {
+                    cache.heads[c] = block->next;
+                    cache.counts[c]--;
+                    return block;
+                }
+
+                char* const base = static_cast<char*>(allocate_or_call_handler([c] { return std::malloc(header_size + class_size(c)); }));
+                header_of(base + header_size) = c;
+                return base + header_size;
+            }
+
+            if (size > numeric_limits<std::size_t>::max() - header_size) {
+                throw std::bad_alloc();
+            }
+            char* const base = static_cast<char*>(allocate_or_call_handler([size] { return std::malloc(header_size + size); }));
+            header_of(base + header_size) = large_class;
+            return base + header_size;
+        }
+
+        static void deallocate_in_class(void* ptr, std::size_t c) noexcept {
+            thread_cache& cache = local_cache;
+            if (cache.counts[c] < cache_limit(c) && (cache.is_registered || register_teardown(cache))) [[likely]] {
+                free_block* const block = static_cast<free_block*>(ptr);
+                block->next = cache.heads[c];
+                cache.heads[c] = block;
+                cache.counts[c]++;
+            } else {
+                std::free(static_cast<char*>(ptr) - header_size);
+            }
+        }
+
+        static void deallocate(void* ptr) noexcept {
+            if (ptr == nullptr) {
+                return;
+            } else if (const std::size_t c = header_of(ptr); c != large_class) {
+                deallocate_in_class(ptr, c);
+            } else {
+                std::free(static_cast<char*>(ptr) - header_size);
+            }
+        }
+
+        static void deallocate(void* ptr, std::size_t size) noexcept {
+            if (ptr == nullptr) {
+                return;
+            } else if (size <= small_size_limit) {
+                deallocate_in_class(ptr, class_of(size));
+            } else {
+                std::free(static_cast<char*>(ptr) - header_size);
+            }
+        }
+    }
+#endif
+
+    /* Returns the usable size of a block returned by malloc for a request of n bytes. */
+    static std::size_t malloc_block_size([[maybe_unused]] void* ptr, [[maybe_unused]] std::size_t n) noexcept {
+#if defined(__APPLE__)
+        return malloc_size(ptr);
+#elif defined(__linux__)
+        return malloc_usable_size(ptr);
+#else
+        return n;
+#endif
+    }
+
+    sized_allocation allocate_at_least(std::size_t n) {
+        void* const ptr = ::operator new(n);
+#if defined(YILIB_SIZE_CLASS_NEW)
+        if (n <= size_class_new::small_size_limit) {
+            return { ptr, size_class_new::class_size(size_class_new::class_of(n)) };
+        }
+        return { ptr, malloc_block_size(static_cast<char*>(ptr) - size_class_new::header_size, n + size_class_new::header_size)
+            - size_class_new::header_size };
+#else
+        return { ptr, malloc_block_size(ptr, n == 0 ? 1 : n) };
+#endif
+    }
+}
+
 [[nodiscard]] void* operator new(std::size_t size) {
-    // Here, we assume that malloc always uses the maximum alignment needed in the system. We can then
-    // defer the call to the new operator that requires alignment.
-    return operator new(size, std::align_val_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__));
+#if defined(YILIB_SIZE_CLASS_NEW)
+    return std::__internal::size_class_new::allocate(size);
+#else
+    // Here, we assume that malloc always uses the maximum alignment needed in the system.
+    return std::__internal::allocate_or_call_handler([size] { return std::malloc(size == 0 ? 1 : size); });
+#endif
 }
 
 [[nodiscard]] void* operator new(std::size_t size, std::align_val_t alignment) {
@@ -32,21 +212,14 @@ namespace std {
         alignment = std::align_val_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__);
     }
 
-    if (size % static_cast<size_t>(alignment) != 0) {
-        size = std::ceil(double(size) / static_cast<size_t>(alignment)) * static_cast<size_t>(alignment);
-    }
-
-    void* ptr = nullptr;
-    while ((ptr = std::aligned_alloc(static_cast<std::size_t>(alignment), size)) == nullptr) {
-        std::new_handler handler = std::get_new_handler();
-        if (handler == nullptr) {
-            throw std::bad_alloc();
-        } else {
-            (*handler)();
-        }
+    // aligned_alloc requires the size to be a multiple of the alignment, which is always a power of two.
+    const std::size_t mask = static_cast<std::size_t>(alignment) - 1;
+    if (size > std::numeric_limits<std::size_t>::max() - mask) {
+        throw std::bad_alloc();
     }
+    size = size == 0 ? mask + 1 : (size + mask) & ~mask;
 
-    return ptr;
+    return std::__internal::allocate_or_call_handler([size, alignment] { return std::aligned_alloc(static_cast<std::size_t>(alignment), size); });
 }
 
 [[nodiscard]] void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
@@ -66,15 +239,24 @@ namespace std {
 }
 
 void operator delete(void* ptr) noexcept {
+#if defined(YILIB_SIZE_CLASS_NEW)
+    std::__internal::size_class_new::deallocate(ptr);
+#else
     std::free(ptr);
+#endif
 }
 
-void operator delete(void* ptr, std::size_t) noexcept {
-    operator delete(ptr);
+void operator delete(void* ptr, [[maybe_unused]] std::size_t size) noexcept {
+#if defined(YILIB_SIZE_CLASS_NEW)
+    std::__internal::size_class_new::deallocate(ptr, size);
+#else
+    std::free(ptr);
+#endif
 }
 
+// Memory returned by the aligned `operator new` overloads always comes straight from aligned_alloc.
 void operator delete(void* ptr, std::align_val_t) noexcept {
-    operator delete(ptr);
+    std::free(ptr);
 }
 
 void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept {
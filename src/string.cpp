@@ -1,329 +1,367 @@
 #include "string.hpp"
 #include "cstddef.hpp"
 #include "string_view.hpp"
-#include "cstdlib.hpp"
-#include "cerrno.hpp"
+#include "charconv.hpp"
 #include "stdexcept.hpp"
 #include "limits.hpp"
 #include "memory.hpp"
+#include "cstdint.hpp"
+#include "cerrno.hpp"
 #include "cstdio.hpp"
-#include "cwchar.hpp"
+#include "cstdlib.hpp"
+
+#if defined(__SSE2__)
+#include "emmintrin.h"
+#endif
 
 namespace std {
-    int stoi(const string& str, std::size_t* idx, int base) {
-        char* conv_end = nullptr;
-        const long res = std::strtol(str.data(), &conv_end, base);
-        if (errno == ERANGE || res > numeric_limits<int>::max()) {
-            throw out_of_range("Calling stoi with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stoi with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
+    namespace __internal {
+        // The SSE2 loops compare 8 char16_t or 4 char32_t at a time, and find the first hit from the byte mask of the comparison.
+        // Once aligned, 16-byte loads never cross a page boundary, so reading past the terminator can't fault, although AddressSanitizer would
+        // flag it.
+        __attribute__((no_sanitize("address"))) std::size_t __char16_length(const char16_t* s) noexcept {
+            const char16_t* p = s;
+#if defined(__SSE2__)
+            for (; reinterpret_cast<std::uintptr_t>(p) % 16 != 0; p++) {
+                if (*p == 0) {
+                    return p - s;
+                }
+            }
+
+            const __m128i zero = _mm_setzero_si128();
+            for (; ; p += 8) {
+                const int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(p)), zero));
+                if (mask != 0) {
+                    return (p - s) + __builtin_ctz(mask) / 2;
+                }
+            }
+#else
+            for (; *p != 0; p++) {}
+            return p - s;
+#endif
+        }
+
+        const char16_t* __char16_find(const char16_t* s, std::size_t n, char16_t a) noexcept {
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            const __m128i needle = _mm_set1_epi16(static_cast<short>(a));
+            for (; i + 8 <= n; i += 8) {
+                const int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), needle));
+                if (mask != 0) {
+                    return s + i + __builtin_ctz(mask) / 2;
+                }
+            }
+#endif
+            for (; i < n; i++) {
+                if (s[i] == a) {
+                    return s + i;
+                }
+            }
+            return nullptr;
+        }
+
+        std::size_t __char_mismatch(const char16_t* s1, const char16_t* s2, std::size_t n) noexcept {
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            for (; i + 8 <= n; i += 8) {
+                const int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(s2 + i))));
+                if (mask != 0xffff) {
+                    return i + __builtin_ctz(~mask) / 2;
+                }
+            }
+#endif
+            for (; i < n && s1[i] == s2[i]; i++) {}
+            return i;
+        }
+
+        std::size_t __char_mismatch(const char32_t* s1, const char32_t* s2, std::size_t n) noexcept {
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            for (; i + 4 <= n; i += 4) {
+                const int mask = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(s2 + i))));
+                if (mask != 0xffff) {
+                    return i + __builtin_ctz(~mask) / 4;
+                }
+            }
+#endif
+            for (; i < n && s1[i] == s2[i]; i++) {}
+            return i;
+        }
+
+        // The C locale's whitespace, which strtol and strtod skip.
+        static bool __is_space(char c) noexcept {
+            return c == ' ' || (c >= '\t' && c <= '\r');
+        }
+
+        /* strtol's grammar on top of from_chars: leading whitespace, an optional sign, and a 0x or 0 prefix choosing the base when base is
+         * 0 (0x is also allowed with base 16). A minus sign on an unsigned type negates modulo 2^N, as strtoul does. */
+        template<class T>
+        static T __sto_integer(const char* first, const char* last, std::size_t* idx, int base, const char* name) {
+            const char* p = first;
+            for (; p != last && __is_space(*p); p++) {}
+            bool negative = false;
+            if (p != last && (*p == '+' || *p == '-')) {
+                negative = *p == '-';
+                p++;
+            }
+            if ((base == 0 || base == 16) && last - p >= 3 && p[0] == '0' && (p[1] | 0x20) == 'x'
+                && __digit_values.values[static_cast<unsigned char>(p[2])] < 16) {
+                p += 2;
+                base = 16;
+            } else if (base == 0) {
+                base = p != last && *p == '0' ? 8 : 10;
+            }
+
+            unsigned long long magnitude;
+            const from_chars_result r = from_chars(p, last, magnitude, base);
+            if (r.ec == errc::invalid_argument) {
+                throw invalid_argument(string("Calling ") + name + " with invalid arguments.");
+            }
+            bool in_range = r.ec == errc();
+            if constexpr (is_signed_v<T>) {
+                in_range = in_range && magnitude <= static_cast<unsigned long long>(numeric_limits<T>::max()) + negative;
+            } else {
+                in_range = in_range && magnitude <= numeric_limits<T>::max();
+            }
+            if (!in_range) {
+                throw out_of_range(string("Calling ") + name + " with out-of-range arguments.");
+            }
+
+            if (idx != nullptr) {
+                *idx = r.ptr - first;
+            }
+            return negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+        }
+
+        /* strtod's grammar on top of from_chars: leading whitespace, an optional sign, and hex digits after a 0x prefix. */
+        template<class T>
+        static T __sto_floating(const char* first, const char* last, std::size_t* idx, const char* name) {
+            const char* p = first;
+            for (; p != last && __is_space(*p); p++) {}
+            bool negative = false;
+            if (p != last && (*p == '+' || *p == '-')) {
+                negative = *p == '-';
+                p++;
+            }
+
+            T value;
+            from_chars_result r = { first, errc::invalid_argument };
+            if (last - p >= 2 && p[0] == '0' && (p[1] | 0x20) == 'x') {
+                r = from_chars(p + 2, last, value, chars_format::hex);
+                if (r.ec == errc::invalid_argument) {
+                    // A bare 0x is the number 0 followed by junk.
+                    value = 0;
+                    r = { p + 1, errc() };
+                }
+            } else if (p != last && *p != '-') {
+                r = from_chars(p, last, value);
+            }
+            if (r.ec == errc::invalid_argument) {
+                throw invalid_argument(string("Calling ") + name + " with invalid arguments.");
+            } else if (r.ec == errc::result_out_of_range) {
+                throw out_of_range(string("Calling ") + name + " with out-of-range arguments.");
+            }
+
+            if (idx != nullptr) {
+                *idx = r.ptr - first;
+            }
+            return negative ? -value : value;
+        }
+
+        /* stold and to_string(long double) are specified in terms of strtold and %Lf, and go straight to them, which keeps the full range
+         * and precision of long double where it is wider than double. */
+        static long double __stold(const string& str, std::size_t* idx) {
+            const char* const s = str.c_str();
+            char* end;
+            const int saved_errno = errno;
+            errno = 0;
+            const long double value = std::strtold(s, &end);
+            const bool out_of_range = errno == ERANGE;
+            errno = saved_errno;
+            if (end == s) {
+                throw invalid_argument("Calling stold with invalid arguments.");
+            } else if (out_of_range) {
+                throw std::out_of_range("Calling stold with out-of-range arguments.");
+            }
+
+            if (idx != nullptr) {
+                *idx = end - s;
+            }
+            return value;
+        }
+
+        // The integer part of the largest long double has max_exponent10 + 1 digits, which come with a sign, a point and six decimals.
+        template<class charT>
+        static basic_string<charT> __long_double_to_string(long double val) {
+            char buf[numeric_limits<long double>::max_exponent10 + 10];
+            const int n = std::snprintf(buf, sizeof(buf), "%Lf", val);
+            return basic_string<charT>(buf, buf + n);
+        }
+
+        // Only ASCII can be part of a number, so a wide string is narrowed up to its first character outside it.
+        static string __narrow_prefix(const wstring& str) {
+            string narrow;
+            for (const wchar_t c : str) {
+                if (c <= 0 || c > 0x7f) {
+                    break;
+                }
+                narrow.push_back(static_cast<char>(c));
+            }
+            return narrow;
+        }
+
+        template<class charT, class T>
+        static basic_string<charT> __integer_to_string(T val) {
+            char buf[numeric_limits<T>::digits10 + 2];
+            const to_chars_result r = to_chars(buf, buf + sizeof(buf), val);
+            return basic_string<charT>(buf, r.ptr);
         }
+
+        // %f: the integer part in full and six decimals.
+        template<class charT, class T>
+        static basic_string<charT> __floating_to_string(T val) {
+            char buf[numeric_limits<T>::max_exponent10 + 10];
+            const to_chars_result r = to_chars(buf, buf + sizeof(buf), val, chars_format::fixed, 6);
+            return basic_string<charT>(buf, r.ptr);
+        }
+    }
+
+    int stoi(const string& str, std::size_t* idx, int base) {
+        return __internal::__sto_integer<int>(str.data(), str.data() + str.size(), idx, base, "stoi");
     }
 
     long stol(const string& str, std::size_t* idx, int base) {
-        char* conv_end = nullptr;
-        const long res = std::strtol(str.data(), &conv_end, base);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return __internal::__sto_integer<long>(str.data(), str.data() + str.size(), idx, base, "stol");
     }
 
     unsigned long stoul(const string& str, std::size_t* idx, int base) {
-        char* conv_end = nullptr;
-        const unsigned long res = std::strtoul(str.data(), &conv_end, base);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return __internal::__sto_integer<unsigned long>(str.data(), str.data() + str.size(), idx, base, "stoul");
     }
 
     long long stoll(const string& str, std::size_t* idx, int base) {
-        char* conv_end = nullptr;
-        const long long res = std::strtoll(str.data(), &conv_end, base);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return __internal::__sto_integer<long long>(str.data(), str.data() + str.size(), idx, base, "stoll");
     }
 
     unsigned long long stoull(const string& str, std::size_t* idx, int base) {
-        char* conv_end = nullptr;
-        const unsigned long long res = std::strtoull(str.data(), &conv_end, base);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return __internal::__sto_integer<unsigned long long>(str.data(), str.data() + str.size(), idx, base, "stoull");
     }
 
     float stof(const string& str, std::size_t* idx) {
-        char* conv_end = nullptr;
-        const float res = std::strtof(str.data(), &conv_end);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return __internal::__sto_floating<float>(str.data(), str.data() + str.size(), idx, "stof");
     }
 
     double stod(const string& str, std::size_t* idx) {
-        char* conv_end = nullptr;
-        const double res = std::strtod(str.data(), &conv_end);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return __internal::__sto_floating<double>(str.data(), str.data() + str.size(), idx, "stod");
     }
 
     long double stold(const string& str, std::size_t* idx) {
-        char* conv_end = nullptr;
-        const long double res = std::strtold(str.data(), &conv_end);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return __internal::__stold(str, idx);
     }
     
     string to_string(int val) {
-        char buf[numeric_limits<int>::digits10 + 1];
-        std::sprintf(buf, "%d", val);
-        return string(buf);
+        return __internal::__integer_to_string<char>(val);
     }
 
     string to_string(unsigned int val) {
-        char buf[numeric_limits<unsigned int>::digits10 + 1];
-        std::sprintf(buf, "%u", val);
-        return string(buf);
+        return __internal::__integer_to_string<char>(val);
     }
 
     string to_string(long val) {
-        char buf[numeric_limits<long>::digits10 + 1];
-        std::sprintf(buf, "%ld", val);
-        return string(buf);
+        return __internal::__integer_to_string<char>(val);
     }
 
     string to_string(unsigned long val) {
-        char buf[numeric_limits<unsigned long>::digits10 + 1];
-        std::sprintf(buf, "%lu", val);
-        return string(buf);
+        return __internal::__integer_to_string<char>(val);
     }
 
     string to_string(long long val) {
-        char buf[numeric_limits<long long>::digits10 + 1];
-        std::sprintf(buf, "%lld", val);
-        return string(buf);
+        return __internal::__integer_to_string<char>(val);
     }
 
     string to_string(unsigned long long val) {
-        char buf[numeric_limits<unsigned long long>::digits10 + 1];
-        std::sprintf(buf, "%llu", val);
-        return string(buf);
+        return __internal::__integer_to_string<char>(val);
     }
 
     string to_string(float val) {
-        char buf[numeric_limits<float>::max_digits10 + 1];
-        std::sprintf(buf, "%f", val);
-        return string(buf);
+        return __internal::__floating_to_string<char>(val);
     }
 
     string to_string(double val) {
-        char buf[numeric_limits<double>::max_digits10 + 1];
-        std::sprintf(buf, "%f", val);
-        return string(buf);
+        return __internal::__floating_to_string<char>(val);
     }
 
     string to_string(long double val) {
-        char buf[numeric_limits<long double>::max_digits10 + 1];
-        std::sprintf(buf, "%Lf", val);
-        return string(buf);
+        return __internal::__long_double_to_string<char>(val);
     }
 
     int stoi(const wstring& str, std::size_t* idx, int base) {
-        wchar_t* conv_end = nullptr;
-        const long res = std::wcstol(str.data(), &conv_end, base);
-        if (errno == ERANGE || res > numeric_limits<int>::max()) {
-            throw out_of_range("Calling stoi with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stoi with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return stoi(__internal::__narrow_prefix(str), idx, base);
     }
 
     long stol(const wstring& str, std::size_t* idx, int base) {
-        wchar_t* conv_end = nullptr;
-        const long res = std::wcstol(str.data(), &conv_end, base);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return stol(__internal::__narrow_prefix(str), idx, base);
     }
 
     unsigned long stoul(const wstring& str, std::size_t* idx, int base) {
-        wchar_t* conv_end = nullptr;
-        const unsigned long res = std::wcstoul(str.data(), &conv_end, base);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return stoul(__internal::__narrow_prefix(str), idx, base);
     }
 
     long long stoll(const wstring& str, std::size_t* idx, int base) {
-        wchar_t* conv_end = nullptr;
-        const long long res = std::wcstoll(str.data(), &conv_end, base);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return stoll(__internal::__narrow_prefix(str), idx, base);
     }
 
     unsigned long long stoull(const wstring& str, std::size_t* idx, int base) {
-        wchar_t* conv_end = nullptr;
-        const unsigned long long res = std::wcstoull(str.data(), &conv_end, base);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return stoull(__internal::__narrow_prefix(str), idx, base);
     }
 
     float stof(const wstring& str, std::size_t* idx) {
-        wchar_t* conv_end = nullptr;
-        const float res = std::wcstof(str.data(), &conv_end);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return stof(__internal::__narrow_prefix(str), idx);
     }
 
     double stod(const wstring& str, std::size_t* idx) {
-        wchar_t* conv_end = nullptr;
-        const double res = std::wcstod(str.data(), &conv_end);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return stod(__internal::__narrow_prefix(str), idx);
     }
 
     long double stold(const wstring& str, std::size_t* idx) {
-        wchar_t* conv_end = nullptr;
-        const long double res = std::wcstold(str.data(), &conv_end);
-        if (errno == ERANGE) {
-            throw out_of_range("Calling stol with out-of-range arguments.");
-        } else if (conv_end == str.c_str()) {
-            throw invalid_argument("Calling stol with invalid arguments.");
-        } else {
-            *idx = conv_end - str.begin();
-            return res;
-        }
+        return stold(__internal::__narrow_prefix(str), idx);
     }
     
     wstring to_wstring(int val) {
-        wchar_t buf[numeric_limits<int>::digits10 + 1];
-        std::swprintf(buf, extent_v<decltype(buf)>, L"%d", val);
-        return wstring(buf);
+        return __internal::__integer_to_string<wchar_t>(val);
     }
 
     wstring to_wstring(unsigned int val) {
-        wchar_t buf[numeric_limits<unsigned int>::digits10 + 1];
-        std::swprintf(buf, extent_v<decltype(buf)>, L"%u", val);
-        return wstring(buf);
+        return __internal::__integer_to_string<wchar_t>(val);
     }
 
     wstring to_wstring(long val) {
-        wchar_t buf[numeric_limits<long>::digits10 + 1];
-        std::swprintf(buf, extent_v<decltype(buf)>, L"%ld", val);
-        return wstring(buf);
+        return __internal::__integer_to_string<wchar_t>(val);
     }
 
     wstring to_wstring(unsigned long val) {
-        wchar_t buf[numeric_limits<unsigned long>::digits10 + 1];
-        std::swprintf(buf, extent_v<decltype(buf)>, L"%lu", val);
-        return wstring(buf);
+        return __internal::__integer_to_string<wchar_t>(val);
     }
 
     wstring to_wstring(long long val) {
-        wchar_t buf[numeric_limits<long long>::digits10 + 1];
-        std::swprintf(buf, extent_v<decltype(buf)>, L"%lld", val);
-        return wstring(buf);
+        return __internal::__integer_to_string<wchar_t>(val);
     }
 
     wstring to_wstring(unsigned long long val) {
-        wchar_t buf[numeric_limits<unsigned long long>::digits10 + 1];
-        std::swprintf(buf, extent_v<decltype(buf)>, L"%llu", val);
-        return wstring(buf);
+        return __internal::__integer_to_string<wchar_t>(val);
     }
 
     wstring to_wstring(float val) {
-        wchar_t buf[numeric_limits<float>::max_digits10 + 1];
-        std::swprintf(buf, extent_v<decltype(buf)>, L"%f", val);
-        return wstring(buf);
+        return __internal::__floating_to_string<wchar_t>(val);
     }
 
     wstring to_wstring(double val) {
-        wchar_t buf[numeric_limits<double>::max_digits10 + 1];
-        std::swprintf(buf, extent_v<decltype(buf)>, L"%f", val);
-        return wstring(buf);
+        return __internal::__floating_to_string<wchar_t>(val);
     }
 
     wstring to_wstring(long double val) {
-        wchar_t buf[numeric_limits<long double>::max_digits10 + 1];
-        std::swprintf(buf, extent_v<decltype(buf)>, L"%Lf", val);
-        return wstring(buf);
+        return __internal::__long_double_to_string<wchar_t>(val);
     }
 
     std::size_t hash<string>::operator()(const string& key) const noexcept {
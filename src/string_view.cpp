@@ -1,6 +1,67 @@
 #include "string_view.hpp"
 
+#if defined(__SSE2__)
+#include "emmintrin.h"
+#endif
+
 namespace std {
+    namespace __internal {
+        // A position can only start a match if its byte equals the first byte of the needle and the byte m - 1 further equals the last one. Two
+        // unaligned loads cover 16 candidate positions, and the AND of both comparisons leaves few enough candidates for memcmp to verify.
+        const char* __byte_search(const char* s, std::size_t n, const char* needle, std::size_t m) noexcept {
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last = _mm_set1_epi8(needle[m - 1]);
+            for (; i + m + 15 <= n; i += 16) {
+                const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+                const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + m - 1));
+                for (int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))); mask != 0; mask &= mask - 1) {
+                    const char* const p = s + i + __builtin_ctz(mask);
+                    if (__builtin_memcmp(p + 1, needle + 1, m - 2) == 0) {
+                        return p;
+                    }
+                }
+            }
+#endif
+            const char* const candidates_end = s + (n - m + 1);
+            for (const char* p = s + i; p < candidates_end && (p = static_cast<const char*>(__builtin_memchr(p, needle[0], candidates_end - p))) != nullptr; p++) {
+                if (p[m - 1] == needle[m - 1] && __builtin_memcmp(p + 1, needle + 1, m - 2) == 0) {
+                    return p;
+                }
+            }
+            return nullptr;
+        }
+
+        // The same filter as __byte_search, over blocks of 16 candidate positions taken from the end, and the highest candidate first in each.
+        const char* __byte_rsearch(const char* s, std::size_t n, const char* needle, std::size_t m) noexcept {
+            // One past the last position a match can start at.
+            std::size_t end = n - m + 1;
+#if defined(__SSE2__)
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last = _mm_set1_epi8(needle[m - 1]);
+            for (; end >= 16; end -= 16) {
+                const std::size_t i = end - 16;
+                const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+                const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + m - 1));
+                for (int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))); mask != 0;) {
+                    const int bit = 31 - __builtin_clz(mask);
+                    if (__builtin_memcmp(s + i + bit + 1, needle + 1, m - 2) == 0) {
+                        return s + i + bit;
+                    }
+                    mask ^= 1 << bit;
+                }
+            }
+#endif
+            for (std::size_t i = end; i-- > 0;) {
+                if (s[i] == needle[0] && s[i + m - 1] == needle[m - 1] && __builtin_memcmp(s + i + 1, needle + 1, m - 2) == 0) {
+                    return s + i;
+                }
+            }
+            return nullptr;
+        }
+    }
+
     std::size_t hash<string_view>::operator()(const string_view& key) const noexcept {
         return hash_bytes(key.data(), key.size() + 1);
     }
@@ -3,9 +3,14 @@
 #include "cstddef.hpp"
 #include "exception.hpp"
 #include "system_error.hpp"
+#include "cstdio.hpp"
+#include "cstdlib.hpp"
 
 #include "pthread.h"
 #include "unistd.h"
+#if defined(__linux__)
+#include "sched.h"
+#endif
 
 namespace std {
     thread::thread() noexcept : handle(0) {}
@@ -195,4 +200,134 @@ namespace std {
             sched_yield();
         }
     }
-}
\ No newline at end of file
+
+    namespace __internal {
+        /* Reads a sysfs list such as "0-3,8,10-11" from `path` and calls `f` on every number in it. Returns false if the file can't be read. */
+        template<class F>
+        static bool read_sysfs_list(const char* path, F f) {
+            std::FILE* const file = std::fopen(path, "r");
+            if (file == nullptr) {
+                return false;
+            }
+            char buf[4096];
+            const bool is_read = std::fgets(buf, sizeof(buf), file) != nullptr;
+            std::fclose(file);
+            if (!is_read) {
+                return false;
+            }
+
+            char* p = buf;
+            while (*p >= '0' && *p <= '9') {
+                const unsigned long first = std::strtoul(p, &p, 10);
+                unsigned long last = first;
+                if (*p == '-') {
+                    last = std::strtoul(p + 1, &p, 10);
+                }
+                for (unsigned long i = first; i <= last; i++) {
+                    f(i);
+                }
+                if (*p != ',') {
+                    break;
+                }
+                p++;
+            }
+            return true;
+        }
+
+#if defined(__linux__)
+        static void set_affinity(pthread_t handle, const cpu_set_t& cpus) {
+            const int ec = pthread_setaffinity_np(handle, sizeof(cpus), &cpus);
+            if (ec != 0) {
+                throw system_error(ec, system_category());
+            }
+        }
+#endif
+
+        static void pin_to_cpu(pthread_t handle, [[maybe_unused]] unsigned int cpu) {
+#if defined(__linux__)
+            if (cpu >= CPU_SETSIZE) {
+                throw system_error(make_error_code(errc::invalid_argument));
+            }
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+            set_affinity(handle, cpus);
+#else
+            (void) handle;
+            throw system_error(make_error_code(errc::function_not_supported));
+#endif
+        }
+
+        static void pin_to_node(pthread_t handle, unsigned int node) {
+#if defined(__linux__)
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            char path[64];
+            std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+            const bool has_node = read_sysfs_list(path, [&cpus](unsigned long cpu) {
+                if (cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &cpus);
+                }
+            });
+
+            if (!has_node) {
+                // Without NUMA information, the whole machine is node 0.
+                if (node != 0 || numa_node_count() != 1) {
+                    throw system_error(make_error_code(errc::invalid_argument));
+                }
+                for (unsigned int cpu = 0; cpu < thread::hardware_concurrency() && cpu < CPU_SETSIZE; cpu++) {
+                    CPU_SET(cpu, &cpus);
+                }
+            }
+            set_affinity(handle, cpus);
+#else
+            (void) handle;
+            // A single node holding every CPU is the only topology reported here, so pinning to it is a no-op.
+            if (node != 0) {
+                throw system_error(make_error_code(errc::invalid_argument));
+            }
+#endif
+        }
+    }
+
+    unsigned int numa_node_count() noexcept {
+        unsigned long count = 1;
+        __internal::read_sysfs_list("/sys/devices/system/node/online", [&count](unsigned long node) {
+            count = node + 1 > count ? node + 1 : count;
+        });
+        return count;
+    }
+
+    void pin_to_cpu(thread& t, unsigned int cpu) {
+        if (!t.joinable()) {
+            throw system_error(make_error_code(errc::invalid_argument));
+        }
+        __internal::pin_to_cpu(t.native_handle(), cpu);
+    }
+
+    void pin_to_cpu(jthread& t, unsigned int cpu) {
+        if (!t.joinable()) {
+            throw system_error(make_error_code(errc::invalid_argument));
+        }
+        __internal::pin_to_cpu(t.native_handle(), cpu);
+    }
+
+    void pin_to_node(thread& t, unsigned int node) {
+        if (!t.joinable()) {
+            throw system_error(make_error_code(errc::invalid_argument));
+        }
+        __internal::pin_to_node(t.native_handle(), node);
+    }
+
+    void pin_to_node(jthread& t, unsigned int node) {
+        if (!t.joinable()) {
+            throw system_error(make_error_code(errc::invalid_argument));
+        }
+        __internal::pin_to_node(t.native_handle(), node);
+    }
+
+    namespace this_thread {
+        void pin_to_cpu(unsigned int cpu) { __internal::pin_to_cpu(pthread_self(), cpu); }
+        void pin_to_node(unsigned int node) { __internal::pin_to_node(pthread_self(), node); }
+    }
+}
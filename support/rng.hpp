@@ -0,0 +1,25 @@
+#pragma once
+
+#include "cstdint.hpp"
+
+/* The random number generator of the benchmarks and the tests. */
+namespace support {
+    // splitmix64; the library has no <random>, and the benchmarks and tests only need a fast, reproducible stream.
+    struct rng {
+        std::uint64_t state;
+
+        explicit rng(std::uint64_t seed = 0x9e3779b97f4a7c15) : state(seed) {}
+
+        std::uint64_t operator()() {
+            std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
+        // Returns a value in [0, n).
+        std::uint64_t below(std::uint64_t n) {
+            return (*this)() % n;
+        }
+    };
+}
\ No newline at end of file
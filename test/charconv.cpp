@@ -0,0 +1,142 @@
+#include "bit.hpp"
+#include "charconv.hpp"
+#include "cstring.hpp"
+#include "limits.hpp"
+#include "string.hpp"
+#include "test.hpp"
+
+/* to_chars and from_chars round trips: every finite value written in each format, with the shortest digits or with enough precision to be
+ * exact, must read back as the same value, and must consume exactly what was written. Values are drawn from random bit patterns so that
+ * every binade and the subnormals are covered, and a few known texts pin down the formatting itself. */
+namespace {
+    constexpr std::chars_format formats[] = {std::chars_format::general, std::chars_format::fixed, std::chars_format::scientific, std::chars_format::hex};
+
+    template<class Float>
+    bool same(Float a, Float b) {
+        return a == b && __builtin_signbit(a) == __builtin_signbit(b);
+    }
+
+    template<class Float>
+    void check_round_trip(Float value, int exact_precision) {
+        // Large enough for a fixed long double, which runs to the 4933rd decimal place.
+        static char buf[6000];
+        Float back;
+
+        std::to_chars_result w = std::to_chars(buf, buf + sizeof(buf), value);
+        CHECK(w.ec == std::errc());
+        std::from_chars_result r = std::from_chars(buf, w.ptr, back);
+        CHECK(r.ec == std::errc() && r.ptr == w.ptr && same(back, value));
+
+        for (const std::chars_format fmt : formats) {
+            w = std::to_chars(buf, buf + sizeof(buf), value, fmt);
+            CHECK(w.ec == std::errc());
+            r = std::from_chars(buf, w.ptr, back, fmt);
+            CHECK(r.ec == std::errc() && r.ptr == w.ptr && same(back, value));
+
+            // Every digit a fixed long double needs would take too long to check on every value.
+            if (fmt != std::chars_format::fixed) {
+                // exact_precision digits after the point in scientific, one more significant digit in general, and all of them in hex.
+                const int precision = fmt == std::chars_format::hex ? -1 : fmt == std::chars_format::general ? exact_precision + 1 : exact_precision;
+                w = std::to_chars(buf, buf + sizeof(buf), value, fmt, precision);
+                CHECK(w.ec == std::errc());
+                r = std::from_chars(buf, w.ptr, back, fmt);
+                CHECK(r.ec == std::errc() && r.ptr == w.ptr && same(back, value));
+            }
+        }
+
+        // A buffer one character short is too small, and says so.
+        w = std::to_chars(buf, buf + sizeof(buf), value);
+        const std::size_t length = static_cast<std::size_t>(w.ptr - buf);
+        CHECK(std::to_chars(buf, buf + length - 1, value).ec == std::errc::value_too_large);
+    }
+
+    template<class Float, class Bits>
+    void check_random(std::size_t count, int exact_precision) {
+        test::rng rng;
+        for (std::size_t i = 0; i < count; ) {
+            const Float value = std::bit_cast<Float>(static_cast<Bits>(rng()));
+            if (value == value && value - value == 0) {
+                check_round_trip(value, exact_precision);
+                ++i;
+            }
+        }
+    }
+
+    void check_long_double(std::size_t count) {
+        test::rng rng;
+        for (std::size_t i = 0; i < count; ++i) {
+            // Random digits and exponents rather than random bits, which would include encodings that aren't valid numbers.
+            char text[64];
+            std::snprintf(text, sizeof(text), "%s%llu.%llue%d", rng.below(2) ? "-" : "", static_cast<unsigned long long>(rng() % 1000000000),
+                static_cast<unsigned long long>(rng()), static_cast<int>(rng.below(9800)) - 4900);
+            long double value;
+            const std::from_chars_result r = std::from_chars(text, text + std::strlen(text), value);
+            CHECK(r.ec == std::errc() && r.ptr == text + std::strlen(text));
+            check_round_trip(value, std::numeric_limits<long double>::max_digits10 - 1);
+        }
+    }
+
+    template<class Float>
+    bool writes(Float value, std::string_view expected) {
+        char buf[64];
+        const std::to_chars_result w = std::to_chars(buf, buf + sizeof(buf), value);
+        return w.ec == std::errc() && std::string_view(buf, static_cast<std::size_t>(w.ptr - buf)) == expected;
+    }
+
+    template<class Float>
+    bool writes(Float value, std::chars_format fmt, int precision, std::string_view expected) {
+        char buf[64];
+        const std::to_chars_result w = std::to_chars(buf, buf + sizeof(buf), value, fmt, precision);
+        return w.ec == std::errc() && std::string_view(buf, static_cast<std::size_t>(w.ptr - buf)) == expected;
+    }
+
+    template<class Float>
+    bool reads(std::string_view text, Float expected, std::errc ec = std::errc()) {
+        Float value = 7;
+        const std::from_chars_result r = std::from_chars(text.data(), text.data() + text.size(), value);
+        return r.ec == ec && (ec != std::errc() || same(value, expected));
+    }
+
+    void check_known() {
+        CHECK(writes(0.1, "0.1"));
+        CHECK(writes(-0.0, "-0"));
+        CHECK(writes(1e23, "1e+23"));
+        CHECK(writes(123456.0, "123456"));
+        CHECK(writes(5e-324, "5e-324"));
+        CHECK(writes(1.7976931348623157e308, "1.7976931348623157e+308"));
+        CHECK(writes(0.1f, "0.1"));
+        CHECK(writes(3.4028235e38f, "3.4028235e+38"));
+        CHECK(writes(std::numeric_limits<double>::infinity(), "inf"));
+        CHECK(writes(-std::numeric_limits<double>::quiet_NaN(), "-nan"));
+        CHECK(writes(1.5, std::chars_format::fixed, 3, "1.500"));
+        CHECK(writes(1.5, std::chars_format::scientific, 2, "1.50e+00"));
+        CHECK(writes(1.5, std::chars_format::hex, 2, "1.80p+0"));
+        CHECK(writes(0.5L, "0.5"));
+        CHECK(writes(-0.1L, "-0.1"));
+
+        CHECK(reads("0.1", 0.1));
+        CHECK(reads("-0", -0.0));
+        CHECK(reads("1e23", 1e23));
+        CHECK(reads("1e400", 0.0, std::errc::result_out_of_range));
+        CHECK(reads("e5", 0.0, std::errc::invalid_argument));
+        CHECK(reads("1.5f", 1.5f));
+        CHECK(reads("-1.5L", -1.5L));
+
+        // Where long double is wider than double, its whole range and precision are kept.
+        if constexpr (std::numeric_limits<long double>::max_exponent > std::numeric_limits<double>::max_exponent) {
+            CHECK(writes(1e400L, "1e+400"));
+            CHECK(writes(1e-4000L, "1e-4000"));
+            CHECK(reads("1e400", 1e400L));
+            CHECK(reads("1e-4000", 1e-4000L));
+            CHECK(reads("1e5000", 0.0L, std::errc::result_out_of_range));
+        }
+    }
+}
+
+int main() {
+    check_known();
+    check_random<double, std::uint64_t>(200000, 16);
+    check_random<float, std::uint32_t>(200000, 8);
+    check_long_double(20000);
+    return test::result();
+}
\ No newline at end of file
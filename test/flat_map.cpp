@@ -0,0 +1,241 @@
+#include "flat_map.hpp"
+#include "flat_set.hpp"
+#include "iterator.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "string.hpp"
+#include "test.hpp"
+#include "vector.hpp"
+
+/* flat_map, flat_multimap and flat_set against map, multimap and set. Each round starts from empty containers and applies a few hundred
+ * random operations to both sides, including bulk insertion of unsorted and of sorted ranges, erasure by key, by position and by
+ * predicate, and hinted insertion into the multimap; after every operation the flat container must hold the same elements in the same
+ * order. The key range varies between rounds, so that some rounds are dense with duplicates and others are mostly distinct keys. */
+namespace {
+    template<class Flat, class Tree>
+    bool same(const Flat& flat, const Tree& tree) {
+        if (flat.size() != tree.size()) {
+            return false;
+        }
+        auto f = flat.begin();
+        for (const auto& element : tree) {
+            const auto [key, value] = *f;
+            if (!(key == element.first && value == element.second)) {
+                return false;
+            }
+            ++f;
+        }
+        return f == flat.end();
+    }
+
+    template<class Key>
+    void check_map(std::size_t rounds) {
+        test::rng rng;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            std::flat_map<Key, long> fm;
+            std::map<Key, long> m;
+            std::flat_multimap<Key, long> fmm;
+            std::multimap<Key, long> mm;
+            const std::uint64_t range = 1 + rng.below(300);
+            for (std::size_t op = 0; op < 300; ++op) {
+                const Key k = test::make_key<Key>(rng.below(range));
+                const long v = static_cast<long>(rng.below(1000000));
+                switch (rng.below(12)) {
+                case 0: {
+                    const auto a = fm.emplace(k, v);
+                    const auto b = m.emplace(k, v);
+                    CHECK(a.second == b.second && (*a.first).second == b.first->second);
+                    const auto c = fmm.emplace(k, v);
+                    const auto d = mm.emplace(k, v);
+                    CHECK(c - fmm.begin() == std::distance(mm.begin(), d));
+                    break;
+                }
+                case 1:
+                    fm[k] += v;
+                    m[k] += v;
+                    break;
+                case 2:
+                    CHECK(fm.erase(k) == m.erase(k));
+                    CHECK(fmm.erase(k) == mm.erase(k));
+                    break;
+                case 3: {
+                    // An unsorted range with duplicates, which the flat containers append, sort and merge in one pass.
+                    std::vector<std::pair<Key, long>> in;
+                    for (std::size_t i = rng.below(50); i > 0; --i) {
+                        in.push_back(std::pair<Key, long>(test::make_key<Key>(rng.below(range)), static_cast<long>(rng.below(1000000))));
+                    }
+                    fm.insert(in.begin(), in.end());
+                    fmm.insert(in.begin(), in.end());
+                    for (const std::pair<Key, long>& p : in) {
+                        m.insert(p);
+                        mm.insert(p);
+                    }
+                    break;
+                }
+                case 4: {
+                    std::map<Key, long> sorted;
+                    for (std::size_t i = rng.below(50); i > 0; --i) {
+                        sorted.emplace(test::make_key<Key>(rng.below(2 * range)), static_cast<long>(rng.below(1000000)));
+                    }
+                    fm.insert(std::sorted_unique, sorted.begin(), sorted.end());
+                    fmm.insert(std::sorted_equivalent, sorted.begin(), sorted.end());
+                    for (const auto& p : sorted) {
+                        m.insert(p);
+                        mm.insert(p);
+                    }
+                    break;
+                }
+                case 5: {
+                    const auto a = fm.find(k);
+                    const auto b = m.find(k);
+                    CHECK((a == fm.end()) == (b == m.end()));
+                    if (b != m.end()) {
+                        CHECK(a->second == b->second);
+                    }
+                    CHECK(fm.count(k) == m.count(k) && fmm.count(k) == mm.count(k));
+                    CHECK(fm.lower_bound(k) - fm.begin() == std::distance(m.begin(), m.lower_bound(k)));
+                    CHECK(fmm.upper_bound(k) - fmm.begin() == std::distance(mm.begin(), mm.upper_bound(k)));
+                    const auto fr = fmm.equal_range(k);
+                    const auto r = mm.equal_range(k);
+                    CHECK(fr.first - fmm.begin() == std::distance(mm.begin(), r.first) && fr.second - fr.first == std::distance(r.first, r.second));
+                    break;
+                }
+                case 6:
+                    CHECK(fm.insert_or_assign(k, v).second == m.insert_or_assign(k, v).second);
+                    break;
+                case 7:
+                    CHECK(fm.try_emplace(k, v).second == m.try_emplace(k, v).second);
+                    break;
+                case 8:
+                    if (!m.empty()) {
+                        const std::size_t i = rng.below(m.size());
+                        m.erase(std::next(m.begin(), static_cast<long>(i)));
+                        fm.erase(fm.begin() + static_cast<long>(i));
+                    }
+                    if (!mm.empty()) {
+                        const std::size_t i = rng.below(mm.size());
+                        mm.erase(std::next(mm.begin(), static_cast<long>(i)));
+                        fmm.erase(fmm.begin() + static_cast<long>(i));
+                    }
+                    break;
+                case 9: {
+                    const long t = static_cast<long>(rng.below(1000000));
+                    const auto odd = [t](const auto& p) { return (p.second ^ t) % 7 == 0; };
+                    CHECK(std::erase_if(fm, odd) == std::erase_if(m, odd));
+                    CHECK(std::erase_if(fmm, odd) == std::erase_if(mm, odd));
+                    break;
+                }
+                case 10: {
+                    // Any hint is allowed, and equal keys must still end up where the multimap puts them.
+                    const long i = static_cast<long>(rng.below(fmm.size() + 1));
+                    const auto c = fmm.emplace_hint(fmm.begin() + i, k, v);
+                    const auto d = mm.emplace_hint(std::next(mm.begin(), i), k, v);
+                    CHECK(c - fmm.begin() == std::distance(mm.begin(), d));
+                    break;
+                }
+                default: {
+                    // Construction from separate key and value containers.
+                    std::vector<Key> keys;
+                    std::vector<long> values;
+                    std::map<Key, long> m2;
+                    std::multimap<Key, long> mm2;
+                    for (std::size_t i = rng.below(40); i > 0; --i) {
+                        keys.push_back(test::make_key<Key>(rng.below(range)));
+                        values.push_back(static_cast<long>(rng.below(1000000)));
+                        m2.emplace(keys.back(), values.back());
+                        mm2.emplace(keys.back(), values.back());
+                    }
+                    CHECK(same(std::flat_map<Key, long>(keys, values), m2));
+                    CHECK(same(std::flat_multimap<Key, long>(keys, values), mm2));
+                    break;
+                }
+                }
+                CHECK(same(fm, m));
+                CHECK(same(fmm, mm));
+            }
+
+            std::flat_map<Key, long> copy = fm;
+            CHECK(copy == fm);
+            if (!copy.empty()) {
+                copy.begin()->second++;
+                CHECK(!(copy == fm));
+                CHECK((fm < copy) == (m < std::map<Key, long>(copy.begin(), copy.end())));
+                CHECK(fm.at(m.begin()->first) == m.begin()->second);
+            }
+            bool threw = false;
+            try {
+                fm.at(test::make_key<Key>(2 * range));
+            } catch (const std::out_of_range&) {
+                threw = true;
+            }
+            CHECK(threw);
+
+            // The containers can be taken out and put back without changing the map.
+            auto containers = std::move(fm).extract();
+            CHECK(fm.empty());
+            fm.replace(std::move(containers.keys), std::move(containers.values));
+            CHECK(same(fm, m));
+            auto r = m.rbegin();
+            for (auto f = fm.rbegin(); f != fm.rend(); ++f, ++r) {
+                CHECK((*f).first == r->first);
+            }
+        }
+    }
+
+    template<class Key>
+    void check_set(std::size_t rounds) {
+        test::rng rng(7);
+        for (std::size_t round = 0; round < rounds; ++round) {
+            std::flat_set<Key> fs;
+            std::set<Key> s;
+            const std::uint64_t range = 1 + rng.below(300);
+            for (std::size_t op = 0; op < 300; ++op) {
+                const Key k = test::make_key<Key>(rng.below(range));
+                switch (rng.below(5)) {
+                case 0:
+                    CHECK(fs.insert(k).second == s.insert(k).second);
+                    break;
+                case 1:
+                    CHECK(fs.erase(k) == s.erase(k));
+                    break;
+                case 2: {
+                    std::vector<Key> in;
+                    for (std::size_t i = rng.below(60); i > 0; --i) {
+                        in.push_back(test::make_key<Key>(rng.below(range)));
+                    }
+                    fs.insert(in.begin(), in.end());
+                    s.insert(in.begin(), in.end());
+                    break;
+                }
+                case 3: {
+                    std::set<Key> sorted;
+                    for (std::size_t i = rng.below(60); i > 0; --i) {
+                        sorted.insert(test::make_key<Key>(rng.below(2 * range)));
+                    }
+                    fs.insert(std::sorted_unique, sorted.begin(), sorted.end());
+                    s.insert(sorted.begin(), sorted.end());
+                    break;
+                }
+                default:
+                    CHECK(fs.contains(k) == s.contains(k));
+                    CHECK(fs.upper_bound(k) - fs.begin() == std::distance(s.begin(), s.upper_bound(k)));
+                    break;
+                }
+                CHECK(fs.size() == s.size());
+                auto f = fs.begin();
+                for (const Key& key : s) {
+                    CHECK(*f == key);
+                    ++f;
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    check_map<long>(300);
+    check_map<std::string>(100);
+    check_set<long>(300);
+    check_set<std::string>(100);
+    return test::result();
+}
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "iterator.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "string.hpp"
+#include "test.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+/* map, multimap and set against test::reference, with the red-black invariants of the tree checked after every operation: the root is
+ * black, no red node has a red child, every path down has the same number of black nodes, every child links back to its parent, and the
+ * keys are in order. Besides insertion and erasure, the operations move nodes between two maps through node handles, insert with right and
+ * wrong hints, and erase ranges; each round also loads sorted and reverse-sorted keys with hints at the ends, which is the case where the
+ * rebalancing after every insertion is the same rotation over and over. */
+namespace {
+    // Exposes the invariant check that __tree keeps for tests.
+    template<class Tree>
+    class checked : public Tree {
+    public:
+        using Tree::Tree;
+        using Tree::invariant;
+    };
+
+    template<class Map, class Key>
+    bool same(const Map& map, const test::reference<Key>& ref) {
+        if (!map.invariant() || map.size() != ref.elements.size()) {
+            return false;
+        }
+        std::size_t i = 0;
+        for (const auto& element : map) {
+            if (!(element.first == ref.elements[i].first && element.second == ref.elements[i].second)) {
+                return false;
+            }
+            ++i;
+        }
+        return true;
+    }
+
+    template<class Map>
+    std::size_t index_of(const Map& map, typename Map::const_iterator it) {
+        return static_cast<std::size_t>(std::distance(map.begin(), it));
+    }
+
+    template<class Key>
+    void check_map(std::size_t rounds) {
+        test::rng rng;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            checked<std::map<Key, long>> map;
+            checked<std::map<Key, long>> other;
+            test::reference<Key> ref;
+            test::reference<Key> other_ref;
+            const std::uint64_t range = 1 + rng.below(400);
+            for (std::size_t op = 0; op < 300; ++op) {
+                const Key k = test::make_key<Key>(rng.below(range));
+                const long v = static_cast<long>(rng.below(1000000));
+                switch (rng.below(10)) {
+                case 0:
+                case 1: {
+                    const bool absent = !ref.contains(k);
+                    const auto r = map.emplace(k, v);
+                    CHECK(r.second == absent);
+                    if (absent) {
+                        ref.insert_at(ref.lower(k), k, v);
+                    }
+                    break;
+                }
+                case 2:
+                    map[k] += v;
+                    if (!ref.contains(k)) {
+                        ref.insert_at(ref.lower(k), k, 0);
+                    }
+                    ref.elements[ref.lower(k)].second += v;
+                    break;
+                case 3: {
+                    const bool present = ref.contains(k);
+                    CHECK(map.erase(k) == present);
+                    if (present) {
+                        ref.erase(ref.lower(k), ref.upper(k));
+                    }
+                    break;
+                }
+                case 4:
+                    if (!ref.elements.empty()) {
+                        // Erasing by position returns the element after it.
+                        const std::size_t i = rng.below(ref.elements.size());
+                        const auto next = map.erase(std::next(map.begin(), static_cast<long>(i)));
+                        CHECK(index_of(map, next) == i);
+                        ref.erase(i, i + 1);
+                    }
+                    break;
+                case 5: {
+                    // The right hint half of the time, and anywhere at all otherwise.
+                    const std::size_t hint = rng.below(2) == 0 ? ref.lower(k) : rng.below(ref.elements.size() + 1);
+                    const bool absent = !ref.contains(k);
+                    const auto it = map.emplace_hint(std::next(map.cbegin(), static_cast<long>(hint)), k, v);
+                    CHECK(it->first == k && index_of(map, it) == ref.lower(k));
+                    if (absent) {
+                        ref.insert_at(ref.lower(k), k, v);
+                    }
+                    break;
+                }
+                case 6: {
+                    CHECK((map.find(k) != map.end()) == ref.contains(k));
+                    CHECK(index_of(map, map.lower_bound(k)) == ref.lower(k));
+                    CHECK(index_of(map, map.upper_bound(k)) == ref.upper(k));
+                    break;
+                }
+                case 7: {
+                    // Moving an element to the other map and back goes through node handles, without allocating.
+                    auto nh = map.extract(k);
+                    CHECK(nh.empty() == !ref.contains(k));
+                    if (nh.empty()) {
+                        break;
+                    }
+                    const std::size_t i = ref.lower(k);
+                    const bool absent = !other_ref.contains(k);
+                    const long* const element = &nh.mapped();
+                    auto r = other.insert(std::move(nh));
+                    CHECK(r.inserted == absent && r.node.empty() == absent);
+                    if (absent) {
+                        CHECK(&r.position->second == element);
+                        other_ref.insert_at(other_ref.lower(k), k, ref.elements[i].second);
+                        ref.erase(i, i + 1);
+                    } else {
+                        // The key was taken, so the node comes back in the result and goes back where it came from.
+                        CHECK(r.node.key() == k && map.insert(std::move(r.node)).inserted);
+                    }
+                    break;
+                }
+                case 8: {
+                    const std::size_t first = rng.below(ref.elements.size() + 1);
+                    const std::size_t last = first + rng.below(ref.elements.size() - first + 1);
+                    const auto it = map.erase(std::next(map.cbegin(), static_cast<long>(first)), std::next(map.cbegin(), static_cast<long>(last)));
+                    CHECK(index_of(map, it) == first);
+                    ref.erase(first, last);
+                    break;
+                }
+                default: {
+                    const bool absent = !ref.contains(k);
+                    CHECK(map.insert_or_assign(k, v).second == absent);
+                    if (absent) {
+                        ref.insert_at(ref.lower(k), k, v);
+                    } else {
+                        ref.elements[ref.lower(k)].second = v;
+                    }
+                    break;
+                }
+                }
+                CHECK(same(map, ref));
+                CHECK(same(other, other_ref));
+            }
+
+            // A copy is a tree of its own, and assigning over it reuses its nodes.
+            checked<std::map<Key, long>> copy(map);
+            CHECK(same(copy, ref));
+            copy = other;
+            CHECK(same(copy, other_ref));
+        }
+    }
+
+    void check_multimap(std::size_t rounds) {
+        test::rng rng(3);
+        for (std::size_t round = 0; round < rounds; ++round) {
+            checked<std::multimap<long, long>> map;
+            test::reference<long> ref;
+            const std::uint64_t range = 1 + rng.below(100);
+            for (std::size_t op = 0; op < 300; ++op) {
+                const long k = static_cast<long>(rng.below(range));
+                const long v = static_cast<long>(rng.below(1000000));
+                switch (rng.below(5)) {
+                case 0:
+                case 1: {
+                    // A new element goes after the equivalent ones already there.
+                    const auto it = map.emplace(k, v);
+                    CHECK(index_of(map, it) == ref.upper(k));
+                    ref.insert_at(ref.upper(k), k, v);
+                    break;
+                }
+                case 2: {
+                    // With a hint, it goes as close to the hint as the order allows.
+                    const std::size_t hint = rng.below(ref.elements.size() + 1);
+                    const auto it = map.emplace_hint(std::next(map.cbegin(), static_cast<long>(hint)), k, v);
+                    const std::size_t i = index_of(map, it);
+                    CHECK(i >= ref.lower(k) && i <= ref.upper(k));
+                    CHECK(i == (hint < ref.lower(k) ? ref.lower(k) : hint > ref.upper(k) ? ref.upper(k) : hint));
+                    ref.insert_at(i, k, v);
+                    break;
+                }
+                case 3:
+                    CHECK(map.erase(k) == ref.upper(k) - ref.lower(k));
+                    ref.erase(ref.lower(k), ref.upper(k));
+                    break;
+                default: {
+                    const auto r = map.equal_range(k);
+                    CHECK(index_of(map, r.first) == ref.lower(k) && index_of(map, r.second) == ref.upper(k));
+                    CHECK(map.count(k) == ref.upper(k) - ref.lower(k));
+                    break;
+                }
+                }
+                CHECK(same(map, ref));
+            }
+        }
+    }
+
+    // Sorted keys hinted at the end, and reverse-sorted keys hinted at the beginning, as a bulk load would insert them.
+    void check_sorted_load(std::size_t n) {
+        checked<std::map<long, long>> ascending;
+        checked<std::map<long, long>> descending;
+        checked<std::set<long>> set;
+        for (std::size_t i = 0; i < n; ++i) {
+            ascending.emplace_hint(ascending.end(), static_cast<long>(i), 0);
+            descending.emplace_hint(descending.begin(), static_cast<long>(n - i), 0);
+            set.insert(set.end(), static_cast<long>(i));
+        }
+        CHECK(ascending.invariant() && ascending.size() == n);
+        CHECK(descending.invariant() && descending.size() == n);
+        CHECK(set.invariant() && set.size() == n);
+        // Emptying the tree from one end rebalances on every erasure.
+        while (!ascending.empty()) {
+            ascending.erase(ascending.begin());
+            if (ascending.size() % 1000 == 0) {
+                CHECK(ascending.invariant());
+            }
+        }
+    }
+}
+
+int main() {
+    check_map<long>(300);
+    check_map<std::string>(100);
+    check_multimap(300);
+    check_sorted_load(100000);
+    return test::result();
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "cstddef.hpp"
+#include "cstdint.hpp"
+#include "new.hpp"
+#include "test.hpp"
+
+#include "pthread.h"
+
+/* The replaceable operator new and delete, in whichever backend the library was built with (make SIZE_CLASS_NEW=1 selects the size-class
+ * backend of src/new.cpp), and __internal::allocate_at_least on top of them. Every block must be aligned, must be writable up to the usable
+ * size allocate_at_least reports for it, and must come back intact when it is freed, whether through the sized or the unsized operator
+ * delete. Blocks are allocated on one thread and freed on another, and every thread exits with blocks in its cache, so that the
+ * size-class backend frees blocks into caches other than the one they came from and drains those caches through its pthread key at thread
+ * exit. The sizes cluster around the 1 KiB limit of its size classes. */
+namespace {
+    constexpr std::size_t sizes[] = {0, 1, 8, 15, 16, 17, 32, 100, 1008, 1009, 1023, 1024, 1025, 1040, 4096, 70000};
+
+    std::size_t random_size(test::rng& rng) {
+        return rng.below(2) == 0 ? sizes[rng.below(sizeof(sizes) / sizeof(sizes[0]))] : 1000 + rng.below(50);
+    }
+
+    unsigned char pattern(std::uint64_t tag, std::size_t i) {
+        return static_cast<unsigned char>(tag * 31 + i);
+    }
+
+    struct block {
+        unsigned char* ptr;
+        std::size_t size;
+        std::uint64_t tag;
+    };
+
+    // Blocks with an odd tag come from allocate_at_least, and span the whole usable size it reports.
+    block make_block(std::size_t size, std::uint64_t tag) {
+        unsigned char* ptr;
+        if (tag % 2 == 0) {
+            ptr = static_cast<unsigned char*>(::operator new(size));
+        } else {
+            const std::__internal::sized_allocation allocation = std::__internal::allocate_at_least(size);
+            CHECK(allocation.size >= size);
+            ptr = static_cast<unsigned char*>(allocation.ptr);
+            size = allocation.size;
+        }
+        CHECK(reinterpret_cast<std::uintptr_t>(ptr) % __STDCPP_DEFAULT_NEW_ALIGNMENT__ == 0);
+        for (std::size_t i = 0; i < size; ++i) {
+            ptr[i] = pattern(tag, i);
+        }
+        return block{ptr, size, tag};
+    }
+
+    // Checks that the block still holds its pattern, and frees it through the sized or the unsized operator delete.
+    void free_block(const block& b, bool sized) {
+        bool intact = true;
+        for (std::size_t i = 0; i < b.size; ++i) {
+            intact = intact && b.ptr[i] == pattern(b.tag, i);
+        }
+        CHECK(intact);
+        if (sized) {
+            ::operator delete(b.ptr, b.size);
+        } else {
+            ::operator delete(b.ptr);
+        }
+    }
+
+    void check_single_thread() {
+        for (std::size_t size = 0; size <= 1100; ++size) {
+            free_block(make_block(size, size), true);
+            free_block(make_block(size, size), false);
+        }
+        // Reused blocks, taken back from the cache in the reverse order they were freed in.
+        block blocks[64];
+        for (std::size_t round = 0; round < 3; ++round) {
+            for (std::size_t i = 0; i < 64; ++i) {
+                blocks[i] = make_block(1000 + i, round * 64 + i);
+            }
+            for (std::size_t i = 0; i < 64; ++i) {
+                free_block(blocks[i], i % 2 == 0);
+            }
+        }
+        ::operator delete(nullptr);
+        ::operator delete(nullptr, 16);
+    }
+
+    constexpr std::size_t thread_count = 4;
+    constexpr std::size_t blocks_per_thread = 2000;
+
+    struct slot {
+        block blocks[blocks_per_thread];
+        bool filled;
+    };
+
+    struct work {
+        slot* own;
+        slot* other;
+        std::uint64_t seed;
+    };
+
+    // Frees the blocks another thread allocated in the previous round, interleaved with allocating this round's blocks.
+    void* run(void* p) {
+        work& w = *static_cast<work*>(p);
+        test::rng rng(w.seed);
+        for (std::size_t i = 0; i < blocks_per_thread; ++i) {
+            if (w.other->filled) {
+                free_block(w.other->blocks[i], i % 3 != 0);
+            }
+            w.own->blocks[i] = make_block(random_size(rng), w.seed + i);
+        }
+        w.other->filled = false;
+        // Blocks that are freed and allocated again on the same thread, which leaves blocks of other threads in this thread's cache on exit.
+        for (std::size_t i = 0; i < 100; ++i) {
+            free_block(make_block(random_size(rng), i), i % 2 == 0);
+        }
+        return nullptr;
+    }
+
+    void check_threads(std::size_t rounds) {
+        static slot slots[2][thread_count];
+        for (std::size_t round = 0; round < rounds; ++round) {
+            pthread_t threads[thread_count];
+            work works[thread_count];
+            slot* const own = slots[round % 2];
+            slot* const previous = slots[(round + 1) % 2];
+            for (std::size_t t = 0; t < thread_count; ++t) {
+                works[t] = work{&own[t], &previous[(t + 1) % thread_count], round * thread_count + t + 1};
+                CHECK(pthread_create(&threads[t], nullptr, run, &works[t]) == 0);
+            }
+            for (std::size_t t = 0; t < thread_count; ++t) {
+                pthread_join(threads[t], nullptr);
+                own[t].filled = true;
+            }
+        }
+        // The last round's blocks are freed on the main thread.
+        for (slot& s : slots[(rounds + 1) % 2]) {
+            if (s.filled) {
+                for (std::size_t i = 0; i < blocks_per_thread; ++i) {
+                    free_block(s.blocks[i], i % 2 == 0);
+                }
+                s.filled = false;
+            }
+        }
+    }
+}
+
+int main() {
+    check_single_thread();
+    check_threads(20);
+    return test::result();
+}
\ No newline at end of file
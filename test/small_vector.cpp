@@ -0,0 +1,227 @@
+#include "memory.hpp"
+#include "small_vector.hpp"
+#include "string.hpp"
+#include "test.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+/* small_vector<T, N> against vector<T>, which holds the same elements in a plain heap buffer. Two small_vectors go through random operations
+ * at sizes up to 3N, so that they keep crossing between the inline buffer and the heap: growth past N, shrink_to_fit back into the inline
+ * buffer, and copies, moves and swaps between every combination of inline and heap states. After every operation both must hold the same
+ * elements as their references, and be inline exactly when their capacity is N. The element types cover memcpy relocation (long) and element
+ * by element moves (string and counted, which also checks that every element is destroyed exactly once), and the allocator counts its
+ * blocks, so that a leaked heap buffer, or an inline buffer handed to the allocator, shows up. */
+namespace {
+    struct counted {
+        static inline long live = 0;
+        long value;
+
+        counted(long value) : value(value) { ++live; }
+        counted(const counted& other) : value(other.value) { ++live; }
+        counted(counted&& other) noexcept : value(other.value) { other.value = -1; ++live; }
+        ~counted() { --live; }
+
+        counted& operator=(const counted&) = default;
+        counted& operator=(counted&&) = default;
+        bool operator==(const counted&) const = default;
+    };
+
+    template<class T>
+    struct counting_allocator {
+        using value_type = T;
+
+        static inline long blocks = 0;
+
+        counting_allocator() = default;
+
+        template<class U>
+        counting_allocator(const counting_allocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n) {
+            ++blocks;
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) {
+            --blocks;
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        bool operator==(const counting_allocator&) const = default;
+    };
+
+    template<class T>
+    T make(std::uint64_t x) {
+        if constexpr (std::is_same_v<T, counted>) {
+            return counted(static_cast<long>(x));
+        } else {
+            return test::make_key<T>(x);
+        }
+    }
+
+    template<class Vector, class T>
+    bool same(const Vector& v, const std::vector<T>& ref) {
+        if (v.size() != ref.size() || v.size() > v.capacity() || v.is_inline() != (v.capacity() == Vector::inline_capacity)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            if (!(v[i] == ref[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The transitions themselves, with the buffers they are expected to end up in.
+    template<class T, std::size_t N>
+    void check_transitions() {
+        using vector = std::small_vector<T, N, counting_allocator<T>>;
+        std::vector<T> ref;
+        vector v;
+        for (std::size_t i = 0; i < N; ++i) {
+            v.push_back(make<T>(i));
+            ref.push_back(make<T>(i));
+        }
+        CHECK(v.is_inline() && same(v, ref));
+        v.push_back(make<T>(N));
+        ref.push_back(make<T>(N));
+        CHECK(!v.is_inline() && same(v, ref));
+
+        // Back into the inline buffer once the elements fit there, and not before.
+        v.reserve(3 * N);
+        v.shrink_to_fit();
+        CHECK(!v.is_inline() && v.capacity() == N + 1 && same(v, ref));
+        v.pop_back();
+        ref.pop_back();
+        v.shrink_to_fit();
+        CHECK(v.is_inline() && same(v, ref));
+
+        // A heap buffer is adopted by a move, while inline elements are moved one by one and leave the source empty.
+        vector heap(N + 1, make<T>(7));
+        const T* const heap_data = heap.data();
+        vector moved(std::move(heap));
+        CHECK(!moved.is_inline() && moved.data() == heap_data && moved.size() == N + 1);
+        CHECK(heap.is_inline() && heap.empty());
+        vector moved_inline(std::move(v));
+        CHECK(moved_inline.is_inline() && same(moved_inline, ref) && v.empty());
+
+        // Swapping an inline small_vector with a heap one trades the heap buffer.
+        moved.swap(moved_inline);
+        CHECK(moved.is_inline() && same(moved, ref));
+        CHECK(!moved_inline.is_inline() && moved_inline.data() == heap_data && moved_inline.size() == N + 1);
+    }
+
+    template<class T, std::size_t N>
+    void check_random(std::size_t rounds) {
+        using vector = std::small_vector<T, N, counting_allocator<T>>;
+        test::rng rng;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            vector a;
+            vector b;
+            std::vector<T> ref_a;
+            std::vector<T> ref_b;
+            for (std::size_t op = 0; op < 200; ++op) {
+                const std::uint64_t x = rng.below(1000);
+                const std::size_t pos = static_cast<std::size_t>(rng.below(ref_a.size() + 1));
+                switch (rng.below(16)) {
+                case 0:
+                case 1:
+                    a.push_back(make<T>(x));
+                    ref_a.push_back(make<T>(x));
+                    break;
+                case 2:
+                    a.emplace_back(make<T>(x));
+                    ref_a.emplace_back(make<T>(x));
+                    break;
+                case 3:
+                    if (!ref_a.empty()) {
+                        a.pop_back();
+                        ref_a.pop_back();
+                    }
+                    break;
+                case 4:
+                    a.insert(a.begin() + static_cast<long>(pos), make<T>(x));
+                    ref_a.insert(ref_a.begin() + static_cast<long>(pos), make<T>(x));
+                    break;
+                case 5: {
+                    const std::size_t last = pos + static_cast<std::size_t>(rng.below(ref_a.size() - pos + 1));
+                    a.erase(a.begin() + static_cast<long>(pos), a.begin() + static_cast<long>(last));
+                    ref_a.erase(ref_a.begin() + static_cast<long>(pos), ref_a.begin() + static_cast<long>(last));
+                    break;
+                }
+                case 6: {
+                    const std::size_t n = static_cast<std::size_t>(rng.below(3 * N + 1));
+                    a.resize(n, make<T>(x));
+                    ref_a.resize(n, make<T>(x));
+                    break;
+                }
+                case 7:
+                    a.reserve(static_cast<std::size_t>(rng.below(3 * N + 1)));
+                    break;
+                case 8:
+                    a.shrink_to_fit();
+                    CHECK(a.is_inline() == (a.size() <= N));
+                    break;
+                case 9:
+                    if (rng.below(4) == 0) {
+                        a.clear();
+                        ref_a.clear();
+                    }
+                    break;
+                case 10: {
+                    const std::size_t n = static_cast<std::size_t>(rng.below(3 * N + 1));
+                    a.assign(n, make<T>(x));
+                    ref_a.assign(n, make<T>(x));
+                    break;
+                }
+                case 11:
+                    b = a;
+                    ref_b = ref_a;
+                    break;
+                case 12:
+                    b = std::move(a);
+                    ref_b = std::move(ref_a);
+                    ref_a.clear();
+                    CHECK(a.empty());
+                    break;
+                case 13:
+                    a.swap(b);
+                    ref_a.swap(ref_b);
+                    break;
+                case 14: {
+                    vector copy(a);
+                    CHECK(same(copy, ref_a));
+                    vector moved(std::move(copy));
+                    CHECK(same(moved, ref_a) && copy.empty() && copy.is_inline());
+                    break;
+                }
+                default:
+                    std::swap(a, b);
+                    ref_a.swap(ref_b);
+                    break;
+                }
+                CHECK(same(a, ref_a) && same(b, ref_b));
+            }
+        }
+    }
+
+    template<class T>
+    void check_all(std::size_t rounds) {
+        check_transitions<T, 1>();
+        check_transitions<T, 4>();
+        check_transitions<T, 16>();
+        check_random<T, 1>(rounds);
+        check_random<T, 4>(rounds);
+        check_random<T, 16>(rounds);
+        CHECK(counting_allocator<T>::blocks == 0);
+    }
+}
+
+int main() {
+    check_all<long>(300);
+    check_all<std::string>(100);
+    check_all<counted>(300);
+    CHECK(counted::live == 0);
+    return test::result();
+}
\ No newline at end of file
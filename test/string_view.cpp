@@ -0,0 +1,214 @@
+#include "functional.hpp"
+#include "string.hpp"
+#include "string_view.hpp"
+#include "test.hpp"
+
+/* find, rfind and the find_first_of family of basic_string_view, and the Boyer-Moore searchers, against naive searches. Haystacks and needles
+ * are drawn from two- and three-letter alphabets, so that partial matches are everywhere, at lengths on both sides of every cut-over of the
+ * search engine: the 16-byte blocks of the SSE2 filter (with a match in the last window a block covers, where i + m + 15 == n), the switch to
+ * Horspool's algorithm at __long_needle, and needles longer than the haystack. Positions run past the end. Wide characters include values over
+ * 255, which the membership bitmap can't hold, and values sharing their low byte with the needle, which the skip table indexes by. */
+namespace {
+    constexpr std::size_t npos = std::size_t(-1);
+
+    template<class charT>
+    bool matches_at(std::basic_string_view<charT> haystack, std::size_t i, std::basic_string_view<charT> needle) {
+        for (std::size_t j = 0; j < needle.size(); ++j) {
+            if (haystack[i + j] != needle[j]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<class charT>
+    std::size_t naive_find(std::basic_string_view<charT> haystack, std::basic_string_view<charT> needle, std::size_t pos) {
+        for (std::size_t i = pos; i <= haystack.size() && needle.size() <= haystack.size() - i; ++i) {
+            if (matches_at(haystack, i, needle)) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    template<class charT>
+    std::size_t naive_rfind(std::basic_string_view<charT> haystack, std::basic_string_view<charT> needle, std::size_t pos) {
+        if (needle.size() > haystack.size()) {
+            return npos;
+        }
+        for (std::size_t i = pos < haystack.size() - needle.size() ? pos : haystack.size() - needle.size(); ; --i) {
+            if (matches_at(haystack, i, needle)) {
+                return i;
+            }
+            if (i == 0) {
+                return npos;
+            }
+        }
+    }
+
+    template<class charT>
+    bool in(std::basic_string_view<charT> set, charT c) {
+        for (const charT x : set) {
+            if (x == c) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template<class charT>
+    std::size_t naive_find_first_of(std::basic_string_view<charT> s, std::basic_string_view<charT> set, std::size_t pos, bool in_set) {
+        for (std::size_t i = pos; i < s.size(); ++i) {
+            if (in(set, s[i]) == in_set) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    template<class charT>
+    std::size_t naive_find_last_of(std::basic_string_view<charT> s, std::basic_string_view<charT> set, std::size_t pos, bool in_set) {
+        for (std::size_t i = s.empty() ? 0 : (pos < s.size() - 1 ? pos : s.size() - 1) + 1; i-- > 0;) {
+            if (in(set, s[i]) == in_set) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    template<class charT>
+    std::basic_string<charT> random_string(test::rng& rng, std::size_t n, const charT* alphabet, std::size_t letters) {
+        std::basic_string<charT> s;
+        for (std::size_t i = 0; i < n; ++i) {
+            s.push_back(alphabet[rng.below(letters)]);
+        }
+        return s;
+    }
+
+    std::size_t random_pos(test::rng& rng, std::size_t n) {
+        switch (rng.below(4)) {
+        case 0:
+            return npos;
+        case 1:
+            return n + rng.below(3);
+        default:
+            return static_cast<std::size_t>(rng.below(n + 1));
+        }
+    }
+
+    template<class charT>
+    void check_search(std::basic_string_view<charT> haystack, std::basic_string_view<charT> needle, std::size_t pos) {
+        CHECK(haystack.find(needle, pos) == naive_find(haystack, needle, pos));
+        CHECK(haystack.rfind(needle, pos) == naive_rfind(haystack, needle, pos));
+    }
+
+    template<class charT>
+    void check_searchers(std::basic_string_view<charT> haystack, std::basic_string_view<charT> needle) {
+        const std::size_t expected = naive_find(haystack, needle, 0);
+        const charT* const end = haystack.data() + haystack.size();
+        const auto bm = std::boyer_moore_searcher(needle.begin(), needle.end())(haystack.data(), end);
+        const auto bmh = std::boyer_moore_horspool_searcher(needle.begin(), needle.end())(haystack.data(), end);
+        if (expected == npos) {
+            CHECK(bm.first == end && bm.second == end);
+            CHECK(bmh.first == end && bmh.second == end);
+        } else {
+            CHECK(bm.first == haystack.data() + expected && bm.second == bm.first + needle.size());
+            CHECK(bmh.first == haystack.data() + expected && bmh.second == bmh.first + needle.size());
+        }
+    }
+
+    template<class charT>
+    void check_random(const charT* alphabet, std::size_t letters, std::size_t rounds) {
+        test::rng rng;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            const std::basic_string<charT> haystack = random_string(rng, rng.below(200), alphabet, letters);
+            // Needle lengths on both sides of __long_needle, and sometimes longer than the haystack.
+            const std::size_t m = rng.below(3) == 0 ? std::__internal::__long_needle - 2 + rng.below(5) : rng.below(70);
+            std::basic_string<charT> needle = random_string(rng, m, alphabet, letters);
+            // Half of the needles are cut from the haystack, so that there is a match to find.
+            if (rng.below(2) == 0 && m <= haystack.size()) {
+                needle = haystack.substr(static_cast<std::size_t>(rng.below(haystack.size() - m + 1)), m);
+            }
+            const std::basic_string_view<charT> h(haystack);
+            const std::basic_string_view<charT> n(needle);
+            for (std::size_t k = 0; k < 4; ++k) {
+                check_search(h, n, random_pos(rng, h.size()));
+                const std::basic_string_view<charT> set = n.substr(0, static_cast<std::size_t>(rng.below(5)));
+                const std::size_t pos = random_pos(rng, h.size());
+                CHECK(h.find_first_of(set, pos) == naive_find_first_of(h, set, pos, true));
+                CHECK(h.find_first_not_of(set, pos) == naive_find_first_of(h, set, pos, false));
+                CHECK(h.find_last_of(set, pos) == naive_find_last_of(h, set, pos, true));
+                CHECK(h.find_last_not_of(set, pos) == naive_find_last_of(h, set, pos, false));
+            }
+            check_searchers(h, n);
+        }
+    }
+
+    /* One occurrence of the needle at every position of haystacks whose lengths cover every offset from the 16-byte blocks of the SSE2 filter,
+     * in both directions. The filler shares the first and last characters of the needle, so that the filter keeps finding candidates. A block
+     * that reached one character past either end of the view would find a match there. */
+    void check_byte_edges() {
+        for (const std::size_t m : {2, 3, 15, 16, 17, 31}) {
+            std::string needle(m, 'b');
+            needle.front() = 'a';
+            needle.back() = 'c';
+            for (std::size_t n = m; n <= m + 48; ++n) {
+                for (std::size_t q = 0; q + m <= n; ++q) {
+                    std::string haystack(n, 'a');
+                    for (std::size_t i = 0; i < n; i += 3) {
+                        haystack[i] = 'c';
+                    }
+                    haystack.replace(q, m, needle);
+                    const std::string_view h(haystack);
+                    CHECK(h.find(needle) == naive_find<char>(h, needle, 0));
+                    CHECK(h.rfind(needle) == naive_rfind<char>(h, needle, npos));
+                    CHECK(h.find(needle, q) == q);
+                    CHECK(h.rfind(needle, q) == q);
+                    // Views that cut the match short by one character at either end, so that reading past them would find it.
+                    const std::string_view head(haystack.data(), q + m - 1);
+                    const std::string_view tail(haystack.data() + q + 1, n - q - 1);
+                    CHECK(head.find(needle) == naive_find<char>(head, needle, 0));
+                    CHECK(head.rfind(needle) == naive_rfind<char>(head, needle, npos));
+                    CHECK(tail.find(needle) == naive_find<char>(tail, needle, 0));
+                    CHECK(tail.rfind(needle) == naive_rfind<char>(tail, needle, npos));
+                }
+            }
+        }
+    }
+
+    // Needles that repeat themselves, where the good-suffix rule of boyer_moore_searcher decides most shifts.
+    void check_periodic(std::size_t rounds) {
+        test::rng rng;
+        const char alphabet[] = "ab";
+        for (std::size_t round = 0; round < rounds; ++round) {
+            const std::string period = random_string(rng, 1 + rng.below(4), alphabet, 2);
+            std::string needle;
+            while (needle.size() < 2 + rng.below(40)) {
+                needle += period;
+            }
+            if (rng.below(2) == 0) {
+                needle.back() = needle.back() == 'a' ? 'b' : 'a';
+            }
+            std::string haystack;
+            while (haystack.size() < rng.below(300)) {
+                haystack += rng.below(4) == 0 ? random_string(rng, 3, alphabet, 2) : period;
+            }
+            check_searchers<char>(haystack, needle);
+            check_search<char>(haystack, needle, random_pos(rng, haystack.size()));
+        }
+    }
+}
+
+int main() {
+    const char bytes[] = "abc";
+    check_random<char>(bytes, 2, 3000);
+    check_random<char>(bytes, 3, 3000);
+    // 0x141 and 0x161 share their low byte with 'A' and 'a'.
+    const char32_t wide[] = {U'a', U'A', 0x141, 0x161, 0x10000};
+    check_random<char32_t>(wide, 5, 3000);
+    const wchar_t wchars[] = {L'a', L'b', 0x161, 0x2603};
+    check_random<wchar_t>(wchars, 4, 2000);
+    check_byte_edges();
+    check_periodic(3000);
+    return test::result();
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "cstdint.hpp"
+#include "cstdio.hpp"
+#include "string.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+#include "../support/rng.hpp"
+
+/* Helpers shared by the tests. Each test is a standalone program that reports every failed check on stderr and exits with a nonzero status
+ * if there was one, so that make test can stop at the first failing program. Randomized tests draw from rng with a fixed seed, so a failure
+ * reproduces on every run. */
+namespace test {
+    using support::rng;
+
+    inline int failures = 0;
+
+    inline void fail(const char* file, int line, const char* condition) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+        ++failures;
+    }
+
+    inline int result() {
+        if (failures != 0) {
+            std::fprintf(stderr, "%d checks failed\n", failures);
+        }
+        return failures != 0;
+    }
+
+    // The key numbered x, as an integer or as a string, so that one test can run over both kinds of key.
+    template<class Key>
+    Key make_key(std::uint64_t x) {
+        if constexpr (std::is_same_v<Key, std::string>) {
+            return "key" + std::to_string(x);
+        } else {
+            return static_cast<Key>(x);
+        }
+    }
+
+    /* The reference the container tests compare against: the elements in a vector sorted by key, searched linearly, which is slow but
+     * plainly correct. Equivalent keys are kept in the order they were inserted in, as in a multimap. */
+    template<class Key, class T = long>
+    class reference {
+    public:
+        std::vector<std::pair<Key, T>> elements;
+
+        std::size_t lower(const Key& k) const {
+            std::size_t i = 0;
+            while (i < elements.size() && elements[i].first < k) {
+                ++i;
+            }
+            return i;
+        }
+
+        std::size_t upper(const Key& k) const {
+            std::size_t i = lower(k);
+            while (i < elements.size() && !(k < elements[i].first)) {
+                ++i;
+            }
+            return i;
+        }
+
+        bool contains(const Key& k) const {
+            return lower(k) != upper(k);
+        }
+
+        // The first element with key k, or nullptr.
+        std::pair<Key, T>* find(const Key& k) {
+            const std::size_t i = lower(k);
+            return i != upper(k) ? &elements[i] : nullptr;
+        }
+
+        void insert_at(std::size_t i, const Key& k, const T& v) {
+            elements.insert(elements.begin() + static_cast<long>(i), std::pair<Key, T>(k, v));
+        }
+
+        // Returns whether k was new, as map::insert_or_assign does.
+        bool insert_or_assign(const Key& k, const T& v) {
+            if (std::pair<Key, T>* const e = find(k)) {
+                e->second = v;
+                return false;
+            }
+            insert_at(lower(k), k, v);
+            return true;
+        }
+
+        void erase(std::size_t first, std::size_t last) {
+            elements.erase(elements.begin() + static_cast<long>(first), elements.begin() + static_cast<long>(last));
+        }
+
+        // Erases every element with key k and returns how many there were.
+        std::size_t erase(const Key& k) {
+            const std::size_t first = lower(k);
+            const std::size_t last = upper(k);
+            erase(first, last);
+            return last - first;
+        }
+    };
+}
+
+#define CHECK(condition) ((condition) ? void() : test::fail(__FILE__, __LINE__, #condition))
\ No newline at end of file
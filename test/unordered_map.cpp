@@ -0,0 +1,140 @@
+#include "string.hpp"
+#include "test.hpp"
+#include "unordered_map.hpp"
+#include "unordered_set.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+/* unordered_map and unordered_set against test::reference. Random insertions, assignments, erasures, lookups, rehashes and clears run on
+ * both, and after every step the sizes must agree; every so often, and at the end, the whole table is walked and compared with the
+ * reference. Key ranges are small enough that the same keys are inserted and erased many times over, which leaves tombstones for the
+ * probing and rehashing to deal with. */
+namespace {
+    template<class Key>
+    void check_contents(const std::unordered_map<Key, long>& map, test::reference<Key>& ref) {
+        CHECK(map.size() == ref.elements.size());
+        std::size_t walked = 0;
+        for (const auto& element : map) {
+            const std::pair<Key, long>* const e = ref.find(element.first);
+            CHECK(e != nullptr && e->second == element.second);
+            ++walked;
+        }
+        CHECK(walked == ref.elements.size());
+    }
+
+    template<class Key, class MakeKey>
+    void check_map(std::size_t ops, std::uint64_t seed, MakeKey make_key) {
+        test::rng rng(seed);
+        std::unordered_map<Key, long> map;
+        test::reference<Key> ref;
+        for (std::size_t i = 0; i < ops; ++i) {
+            const Key k = make_key(rng);
+            const long v = static_cast<long>(rng() >> 1);
+            switch (rng.below(12)) {
+            case 0:
+            case 1:
+                CHECK(map.insert_or_assign(k, v).second == ref.insert_or_assign(k, v));
+                break;
+            case 2: {
+                const bool inserted = map.try_emplace(k, v).second;
+                CHECK(inserted == (ref.find(k) == nullptr));
+                if (inserted) {
+                    ref.insert_or_assign(k, v);
+                }
+                break;
+            }
+            case 3:
+                map[k] = v;
+                ref.insert_or_assign(k, v);
+                break;
+            case 4:
+            case 5:
+                CHECK(map.erase(k) == ref.erase(k));
+                break;
+            case 6: {
+                // Erasing through an iterator, which must return the next element or end.
+                const auto it = map.find(k);
+                CHECK((it != map.end()) == (ref.find(k) != nullptr));
+                if (it != map.end()) {
+                    auto next = it;
+                    ++next;
+                    CHECK(map.erase(it) == next);
+                    ref.erase(k);
+                }
+                break;
+            }
+            case 7:
+            case 8:
+            case 9: {
+                const auto it = map.find(k);
+                const std::pair<Key, long>* const e = ref.find(k);
+                CHECK((it != map.end()) == (e != nullptr));
+                CHECK(map.contains(k) == (e != nullptr) && map.count(k) == (e != nullptr));
+                if (it != map.end() && e != nullptr) {
+                    CHECK(it->second == e->second);
+                }
+                break;
+            }
+            case 10:
+                if (rng.below(200) == 0) {
+                    map.rehash(rng.below(3) == 0 ? 0 : rng.below(4000));
+                } else if (rng.below(2000) == 0) {
+                    map.clear();
+                    ref.elements.clear();
+                }
+                break;
+            default:
+                if (rng.below(500) == 0) {
+                    check_contents(map, ref);
+                    // A copy must hold the same elements, and compare equal.
+                    const std::unordered_map<Key, long> copy = map;
+                    CHECK(copy == map);
+                    check_contents(copy, ref);
+                }
+                break;
+            }
+            CHECK(map.size() == ref.elements.size());
+        }
+        check_contents(map, ref);
+    }
+
+    void check_set(std::size_t ops, std::uint64_t seed) {
+        test::rng rng(seed);
+        std::unordered_set<long> set;
+        test::reference<long> ref;
+        for (std::size_t i = 0; i < ops; ++i) {
+            const long k = static_cast<long>(rng.below(2000));
+            switch (rng.below(3)) {
+            case 0:
+                CHECK(set.insert(k).second == ref.insert_or_assign(k, 0));
+                break;
+            case 1:
+                CHECK(set.erase(k) == ref.erase(k));
+                break;
+            default:
+                CHECK(set.contains(k) == (ref.find(k) != nullptr));
+                break;
+            }
+            CHECK(set.size() == ref.elements.size());
+        }
+        std::size_t walked = 0;
+        for (const long k : set) {
+            CHECK(ref.find(k) != nullptr);
+            ++walked;
+        }
+        CHECK(walked == ref.elements.size());
+    }
+}
+
+int main() {
+    for (std::uint64_t seed = 1; seed <= 4; ++seed) {
+        check_map<long>(100000, seed, [](test::rng& rng) { return static_cast<long>(rng.below(1500)); });
+        // Keys that share their low bits, for a hash that doesn't spread them.
+        check_map<long>(100000, seed, [](test::rng& rng) { return static_cast<long>(rng.below(1500)) << 12; });
+        check_map<std::string>(50000, seed, [](test::rng& rng) {
+            return std::to_string(rng.below(100)) + std::string(rng.below(15), 'x');
+        });
+        check_set(100000, seed);
+    }
+    return test::result();
+}
\ No newline at end of file